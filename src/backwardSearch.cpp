@@ -0,0 +1,696 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "backwardSearch.hpp"
+#include <iterator>
+
+using namespace std;
+
+
+//! Constructor.
+/*!
+   The rules are referenced, not copied, so the list must outlive the
+   search.
+   \param rules the rule list to be applied.
+   \param patterns the forbidden pattern list to be found.
+*/
+BackwardSearch::BackwardSearch(list<Rule> *rules, list<ForbiddenPattern> *patterns) : placement(rules, patterns)
+{
+    width = -1;
+    height = -1;
+    bidirectional = false;
+}
+
+
+//! Destructor.
+BackwardSearch::~BackwardSearch()
+{
+}
+
+
+//! Enables or disables the bidirectional mode.
+/*!
+   \param bidirectional true to search forward from the initial space too.
+*/
+void BackwardSearch::setBidirectional(bool bidirectional)
+{
+    this->bidirectional = bidirectional;
+}
+
+
+//! Searches a failure of a row.
+/*!
+   \param space the initial space of the row.
+   \param outputs the output coordinates of the table.
+   \param expected the output values of the row.
+   \param care the outputs that must have their value, false for the
+   don't-cares.
+   \return True if a failure has been found, the simulation would report
+   it for sure. It can be got with the accessors. False if no failure has
+   been found within the limits, the row may still fail.
+*/
+bool BackwardSearch::findFailure(Grid space, vector<coordinate> outputs, vector<bool> expected, vector<bool> care)
+{
+    stable.clear();
+    forbidden.clear();
+    outOfBounds.clear();
+    backward.clear();
+    forward.clear();
+    seen.clear();
+    if (!placement.isSupported())
+    {
+        return false;
+    }
+    if (space.getWidth() != width || space.getHeight() != height)
+    {
+        width = space.getWidth();
+        height = space.getHeight();
+        placement.buildInstances(width, height);
+        vector<bitInstance> &rules = placement.getRuleInstances();
+        writers.assign(width * height, vector<int>());
+        for (unsigned int r = 0; r < rules.size(); r++)
+        {
+            //Out of bounds placements end the row, they lead nowhere
+            for (unsigned int i = 0; !rules[r].outOfBounds && i < rules[r].writes.size(); i++)
+            {
+                writers[rules[r].writes[i]].push_back(r);
+            }
+        }
+    }
+    
+    initial.assign(width * height, nMAYANY);
+    for (int x = 0; x < width; x++)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            int status = space(x, y);
+            if (status != nDISABLED && status != nENABLED && status != nNOSPACE)
+            {
+                return false;
+            }
+            initial[x * height + y] = getSet(status);
+        }
+    }
+    outputCells.clear();
+    for (unsigned int o = 0; o < outputs.size(); o++)
+    {
+        outputCells.push_back(outputs[o].x * height + outputs[o].y);
+    }
+    this->expected = expected;
+    this->care = care;
+    
+    searchNode first;
+    first.cells = initial;
+    first.parent = -1;
+    first.instance = -1;
+    forward.push_back(first);
+    if (bidirectional && searchForward())
+    {
+        return true;
+    }
+    
+    addTargets();
+    vector<bitInstance> &rules = placement.getRuleInstances();
+    for (unsigned int n = 0; n < backward.size(); n++)
+    {
+        vector<char> cells = backward[n].cells;
+        vector<int> constrained;
+        for (unsigned int c = 0; c < cells.size(); c++)
+        {
+            if (cells[c] != nMAYANY)
+            {
+                constrained.push_back(c);
+            }
+        }
+        
+        //Rules leading from the partial space to the failure
+        vector<int> chain;
+        for (int m = n; backward[m].parent != -1; m = backward[m].parent)
+        {
+            chain.push_back(backward[m].instance);
+        }
+        for (unsigned int f = 0; f < forward.size(); f++)
+        {
+            if (meets(cells, constrained, forward[f].cells))
+            {
+                vector<int> instances = getForwardPath(f);
+                instances.insert(instances.end(), chain.begin(), chain.end());
+                if (replay(instances))
+                {
+                    return true;
+                }
+            }
+        }
+        
+        //Only the rules changing a constrained cell can lead to it
+        vector<bool> tried(rules.size(), false);
+        for (unsigned int c = 0; c < constrained.size() && backward.size() < BACKWARD_SPACES; c++)
+        {
+            vector<int> &candidates = writers[constrained[c]];
+            for (unsigned int i = 0; i < candidates.size() && backward.size() < BACKWARD_SPACES; i++)
+            {
+                if (tried[candidates[i]])
+                {
+                    continue;
+                }
+                tried[candidates[i]] = true;
+                vector<char> result;
+                if (preImage(cells, rules[candidates[i]], result) && seen.insert(getHash(result)).second)
+                {
+                    searchNode node;
+                    node.cells = result;
+                    node.parent = n;
+                    node.instance = candidates[i];
+                    backward.push_back(node);
+                }
+            }
+        }
+    }
+    return false;
+}
+
+
+//! Adds a partial space where the search starts.
+/*!
+   \param cells the statuses every cell may have.
+*/
+void BackwardSearch::addTarget(vector<char> &cells)
+{
+    for (unsigned int c = 0; c < cells.size(); c++)
+    {
+        //Cells no rule changes keep their initial status
+        if (cells[c] == 0 || (writers[c].empty() && (cells[c] & initial[c]) == 0))
+        {
+            return;
+        }
+    }
+    if (seen.insert(getHash(cells)).second)
+    {
+        searchNode node;
+        node.cells = cells;
+        node.parent = -1;
+        node.instance = -1;
+        backward.push_back(node);
+    }
+}
+
+
+//! Adds the partial spaces where a row fails.
+/*!
+   These are the spaces with an output cell, not a don't-care, holding the
+   wrong status, the
+   ones with a forbidden pattern and the ones where a rule puts a molecule
+   out of the space.
+*/
+void BackwardSearch::addTargets()
+{
+    vector<bitInstance> &rules = placement.getRuleInstances();
+    vector<bitInstance> &patterns = placement.getPatternInstances();
+    for (unsigned int o = 0; o < outputCells.size(); o++)
+    {
+        if (!care[o])
+        {
+            continue;
+        }
+        vector<char> cells(width * height, nMAYANY);
+        cells[outputCells[o]] = expected[o] ? nMAYDISABLED | nMAYNOSPACE : nMAYENABLED | nMAYNOSPACE;
+        addTarget(cells);
+    }
+    for (unsigned int p = 0; p < patterns.size(); p++)
+    {
+        vector<char> cells(width * height, nMAYANY);
+        for (unsigned int i = 0; i < patterns[p].enabled.size(); i++)
+        {
+            cells[patterns[p].enabled[i]] &= nMAYENABLED;
+        }
+        for (unsigned int i = 0; i < patterns[p].disabled.size(); i++)
+        {
+            cells[patterns[p].disabled[i]] &= nMAYDISABLED;
+        }
+        for (unsigned int i = 0; i < patterns[p].space.size(); i++)
+        {
+            cells[patterns[p].space[i]] &= nMAYDISABLED | nMAYENABLED;
+        }
+        addTarget(cells);
+    }
+    for (unsigned int r = 0; r < rules.size(); r++)
+    {
+        if (!rules[r].outOfBounds && rules[r].bounds.empty())
+        {
+            continue;
+        }
+        vector<char> cells(width * height, nMAYANY);
+        for (unsigned int i = 0; i < rules[r].enabled.size(); i++)
+        {
+            cells[rules[r].enabled[i]] &= nMAYENABLED;
+        }
+        for (unsigned int i = 0; i < rules[r].disabled.size(); i++)
+        {
+            cells[rules[r].disabled[i]] &= nMAYDISABLED | nMAYNOSPACE;
+        }
+        if (rules[r].outOfBounds)
+        {
+            addTarget(cells);
+            continue;
+        }
+        for (unsigned int i = 0; i < rules[r].bounds.size(); i++)
+        {
+            vector<char> bound = cells;
+            bound[rules[r].bounds[i]] &= nMAYNOSPACE;
+            addTarget(bound);
+        }
+    }
+}
+
+
+//! Computes the pre-image of a partial space by a rule placement.
+/*!
+   \param cells the statuses every cell may have after the rule.
+   \param instance the rule placed at a coordinate.
+   \param result the statuses every cell may have before the rule.
+   \return False if the rule can not lead to the partial space, or if it
+   does not change any of its constrained cells.
+*/
+bool BackwardSearch::preImage(vector<char> &cells, bitInstance &instance, vector<char> &result)
+{
+    bool relevant = false;
+    for (unsigned int i = 0; i < instance.writes.size(); i++)
+    {
+        if ((cells[instance.writes[i]] & getSet(instance.values[i])) == 0)
+        {
+            return false;
+        }
+        if (cells[instance.writes[i]] != nMAYANY)
+        {
+            relevant = true;
+        }
+    }
+    if (!relevant)
+    {
+        return false;
+    }
+    result = cells;
+    for (unsigned int i = 0; i < instance.writes.size(); i++)
+    {
+        result[instance.writes[i]] = nMAYANY;
+    }
+    for (unsigned int i = 0; i < instance.enabled.size(); i++)
+    {
+        result[instance.enabled[i]] &= nMAYENABLED;
+    }
+    for (unsigned int i = 0; i < instance.disabled.size(); i++)
+    {
+        result[instance.disabled[i]] &= nMAYDISABLED | nMAYNOSPACE;
+    }
+    //Otherwise the rule would put a molecule out of bounds
+    for (unsigned int i = 0; i < instance.bounds.size(); i++)
+    {
+        result[instance.bounds[i]] &= nMAYDISABLED | nMAYENABLED;
+    }
+    
+    vector<int> touched = instance.enabled;
+    touched.insert(touched.end(), instance.disabled.begin(), instance.disabled.end());
+    touched.insert(touched.end(), instance.bounds.begin(), instance.bounds.end());
+    for (unsigned int i = 0; i < touched.size(); i++)
+    {
+        int c = touched[i];
+        if (result[c] == 0 || (writers[c].empty() && (result[c] & initial[c]) == 0))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//! Tells if a space belongs to a partial space.
+/*!
+   \param cells the statuses every cell may have.
+   \param constrained the cells of the partial space not holding any status.
+   \param space the space.
+   \return True if every cell of the space has one of the statuses allowed.
+*/
+bool BackwardSearch::meets(vector<char> &cells, vector<int> &constrained, vector<char> &space)
+{
+    for (unsigned int i = 0; i < constrained.size(); i++)
+    {
+        if ((cells[constrained[i]] & space[constrained[i]]) == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//! Tells if a rule or pattern matches a space.
+/*!
+   \param instance the rule or pattern placed at a coordinate.
+   \param space the space.
+   \param pattern true for a forbidden pattern, false for a rule.
+   \return True if the instance matches the space.
+*/
+bool BackwardSearch::matches(bitInstance &instance, vector<char> &space, bool pattern)
+{
+    for (unsigned int i = 0; i < instance.enabled.size(); i++)
+    {
+        if (space[instance.enabled[i]] != nMAYENABLED)
+        {
+            return false;
+        }
+    }
+    //Rules take not available cells as disabled, patterns do not
+    int disabled = pattern ? nMAYDISABLED : nMAYDISABLED | nMAYNOSPACE;
+    for (unsigned int i = 0; i < instance.disabled.size(); i++)
+    {
+        if ((space[instance.disabled[i]] & disabled) == 0)
+        {
+            return false;
+        }
+    }
+    for (unsigned int i = 0; i < instance.space.size(); i++)
+    {
+        if (space[instance.space[i]] == nMAYNOSPACE)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//! Explores the row forward from its initial space.
+/*!
+   The spaces reached, up to FORWARD_SPACES, are kept for the backward
+   search to meet them.
+   \return True if a failure has been found on the way.
+*/
+bool BackwardSearch::searchForward()
+{
+    vector<bitInstance> &rules = placement.getRuleInstances();
+    vector<bitInstance> &patterns = placement.getPatternInstances();
+    set<unsigned long> reached;
+    reached.insert(getHash(initial));
+    for (unsigned int n = 0; n < forward.size(); n++)
+    {
+        vector<char> space = forward[n].cells;
+        bool failure = false;
+        for (unsigned int p = 0; !failure && p < patterns.size(); p++)
+        {
+            failure = matches(patterns[p], space, true);
+        }
+        vector<int> applicable;
+        for (unsigned int r = 0; !failure && r < rules.size(); r++)
+        {
+            if (!matches(rules[r], space, false))
+            {
+                continue;
+            }
+            failure = rules[r].outOfBounds;
+            for (unsigned int i = 0; i < rules[r].bounds.size(); i++)
+            {
+                failure = failure || space[rules[r].bounds[i]] == nMAYNOSPACE;
+            }
+            applicable.push_back(r);
+        }
+        if (failure || applicable.empty())
+        {
+            //Replaying it reports the failure or the wrong outputs
+            vector<int> instances = getForwardPath(n);
+            if (replay(instances))
+            {
+                return true;
+            }
+            continue;
+        }
+        for (unsigned int a = 0; a < applicable.size() && forward.size() < FORWARD_SPACES; a++)
+        {
+            bitInstance &instance = rules[applicable[a]];
+            vector<char> next = space;
+            for (unsigned int i = 0; i < instance.writes.size(); i++)
+            {
+                next[instance.writes[i]] = getSet(instance.values[i]);
+            }
+            if (reached.insert(getHash(next)).second)
+            {
+                searchNode node;
+                node.cells = next;
+                node.parent = n;
+                node.instance = applicable[a];
+                forward.push_back(node);
+            }
+        }
+    }
+    return false;
+}
+
+
+//! Gets the rules leading to a space reached forward.
+/*!
+   \param node the node of the space.
+   \return The rule placements from the initial space, in order.
+*/
+vector<int> BackwardSearch::getForwardPath(int node)
+{
+    vector<int> result;
+    for (int m = node; forward[m].parent != -1; m = forward[m].parent)
+    {
+        result.insert(result.begin(), forward[m].instance);
+    }
+    return result;
+}
+
+
+//! Replays a path from the initial space of the row.
+/*!
+   The first forbidden pattern or out of bounds found on the way is the
+   failure of the row. Otherwise the path must end on a stable space with
+   wrong outputs.
+   \param instances the rule placements to apply, in order.
+   \return True if the path leads to a failure.
+*/
+bool BackwardSearch::replay(vector<int> &instances)
+{
+    vector<bitInstance> &rules = placement.getRuleInstances();
+    vector<bitInstance> &patterns = placement.getPatternInstances();
+    vector<char> space = initial;
+    vector< vector<char> > spaces;
+    list<spaceHighlighted> path;
+    for (unsigned int k = 0; ; k++)
+    {
+        for (unsigned int p = 0; p < patterns.size(); p++)
+        {
+            if (matches(patterns[p], space, true))
+            {
+                forbidden.push_back(getStep(path, space));
+                return true;
+            }
+        }
+        bool applicable = false;
+        for (unsigned int r = 0; r < rules.size(); r++)
+        {
+            if (!matches(rules[r], space, false))
+            {
+                continue;
+            }
+            applicable = true;
+            bool outside = rules[r].outOfBounds;
+            for (unsigned int i = 0; i < rules[r].bounds.size(); i++)
+            {
+                outside = outside || space[rules[r].bounds[i]] == nMAYNOSPACE;
+            }
+            if (outside)
+            {
+                outOfBounds.push_back(getStep(path, space));
+                return true;
+            }
+        }
+        if (k == instances.size())
+        {
+            if (applicable)
+            {
+                return false;
+            }
+            for (unsigned int o = 0; o < outputCells.size(); o++)
+            {
+                if (care[o] && space[outputCells[o]] != (expected[o] ? nMAYENABLED : nMAYDISABLED))
+                {
+                    stable.push_back(getStep(path, space));
+                    return true;
+                }
+            }
+            return false;
+        }
+        
+        bitInstance &instance = rules[instances[k]];
+        if (!matches(instance, space, false))
+        {
+            return false;
+        }
+        Rule *rule = placement.getRule(instance.index);
+        spaceHighlighted step;
+        step.g = getGrid(space);
+        step.h.top = instance.c.y - rule->getHeight() + 1;
+        step.h.left = instance.c.x - rule->getWidth() + 1;
+        step.h.width = rule->getWidth();
+        step.h.height = rule->getHeight();
+        path.push_back(step);
+        spaces.push_back(space);
+        for (unsigned int i = 0; i < instance.writes.size(); i++)
+        {
+            space[instance.writes[i]] = getSet(instance.values[i]);
+        }
+        
+        //The simulation does not follow cycles, so they are cut off
+        for (unsigned int j = 0; j < spaces.size(); j++)
+        {
+            if (spaces[j] == space)
+            {
+                spaces.resize(j);
+                list<spaceHighlighted>::iterator first = path.begin();
+                advance(first, j);
+                path.erase(first, path.end());
+                break;
+            }
+        }
+    }
+}
+
+
+//! Builds the simulation step of a failure.
+/*!
+   \param path the spaces that lead to the failure.
+   \param space the space of the failure.
+   \return The simulation step, as the normal simulation builds it.
+*/
+simulationStep BackwardSearch::getStep(list<spaceHighlighted> &path, vector<char> &space)
+{
+    simulationStep result;
+    result.path = path;
+    result.space.g = getGrid(space);
+    result.space.h.top = result.space.h.left = result.space.h.width = result.space.h.height = 0;
+    result.matched = false;
+    return result;
+}
+
+
+//! Gets the grid of a space.
+/*!
+   \param space the status of every cell, as a set with only one status.
+   \return The grid.
+*/
+Grid BackwardSearch::getGrid(vector<char> &space)
+{
+    Grid result(width, height);
+    for (int x = 0; x < width; x++)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            switch (space[x * height + y])
+            {
+                case nMAYENABLED:
+                    result(x, y) = nENABLED;
+                    break;
+                case nMAYNOSPACE:
+                    result(x, y) = nNOSPACE;
+                    break;
+                default:
+                    result(x, y) = nDISABLED;
+            }
+        }
+    }
+    return result;
+}
+
+
+//! Gets the set of statuses of a status.
+/*!
+   \param status the status of a cell.
+   \return The set with only that status.
+*/
+char BackwardSearch::getSet(int status)
+{
+    if (status == nENABLED)
+    {
+        return nMAYENABLED;
+    }
+    if (status == nNOSPACE)
+    {
+        return nMAYNOSPACE;
+    }
+    return nMAYDISABLED;
+}
+
+
+//! Hashes a space or a partial space.
+/*!
+   \param cells the cells.
+   \return The FNV-1a hash of the cells.
+*/
+unsigned long BackwardSearch::getHash(vector<char> &cells)
+{
+    unsigned long hash = 2166136261UL;
+    for (unsigned int c = 0; c < cells.size(); c++)
+    {
+        hash ^= (unsigned char)cells[c];
+        hash *= 16777619UL;
+    }
+    return hash;
+}
+
+
+//! Returns the stable space with wrong outputs found.
+/*!
+   \return A list with the space, empty if the failure is another one.
+*/
+list<simulationStep> BackwardSearch::getStableLayouts()
+{
+    return stable;
+}
+
+
+//! Returns the forbidden space found.
+/*!
+   \return A list with the space, empty if the failure is another one.
+*/
+list<simulationStep> BackwardSearch::getForbiddenLayouts()
+{
+    return forbidden;
+}
+
+
+//! Returns the out of bounds space found.
+/*!
+   \return A list with the space, empty if the failure is another one.
+*/
+list<simulationStep> BackwardSearch::getOutOfBounds()
+{
+    return outOfBounds;
+}
+
+
+//! Returns the number of spaces searched for the last row.
+/*!
+   \return The spaces searched backward and forward.
+*/
+int BackwardSearch::getExplored()
+{
+    return backward.size() + forward.size();
+}
@@ -0,0 +1,121 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class BackwardSearch
+ * \brief Backward search of the spaces that make a row fail.
+ * 
+ * Instead of exploring a row from its initial space, this class starts
+ * from partial spaces that fail for sure or may fail: an output cell with
+ * the wrong status, a forbidden pattern or a rule putting a molecule out
+ * of the space. Every cell of a partial space holds the set of statuses it
+ * may have. The pre-image of a partial space by a rule placement is the
+ * partial space where the rule matches and leads to it, so the search goes
+ * backward through the rules until it meets the initial space of the row.
+ * The path found is then replayed forward to confirm the failure. With the
+ * bidirectional mode, the spaces reached forward from the initial one are
+ * searched too, so the two searches meet in the middle.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef BACKWARDSEARCH_HPP_
+#define BACKWARDSEARCH_HPP_
+
+#include "bitSimulation.hpp"
+#include "ternarySimulation.hpp"
+#include <vector>
+#include <list>
+#include <set>
+
+//! Maximum number of partial spaces searched backward for every row.
+#define BACKWARD_SPACES 10000
+//! Maximum number of spaces reached forward in the bidirectional mode.
+#define FORWARD_SPACES 4096
+
+using namespace std;
+
+
+//! Search node struct.
+/*! A space of the search and the rule placement that links it to the
+    previous one. */
+struct searchNode
+{
+    vector<char> cells; /*!< Statuses of the cells, or sets of statuses on partial spaces. */
+    int parent; /*!< Index of the node it comes from, -1 for the first ones. */
+    int instance; /*!< Rule placement between the node and its parent. */
+};
+
+
+class BackwardSearch
+{
+public:
+    BackwardSearch(list<Rule> *rules, list<ForbiddenPattern> *patterns);
+    virtual ~BackwardSearch();
+    void setBidirectional(bool bidirectional);
+    bool findFailure(Grid space, vector<coordinate> outputs, vector<bool> expected, vector<bool> care);
+    list<simulationStep> getStableLayouts();
+    list<simulationStep> getForbiddenLayouts();
+    list<simulationStep> getOutOfBounds();
+    int getExplored();
+
+private:
+    void addTarget(vector<char> &cells);
+    void addTargets();
+    bool preImage(vector<char> &cells, bitInstance &instance, vector<char> &result);
+    bool meets(vector<char> &cells, vector<int> &constrained, vector<char> &space);
+    bool matches(bitInstance &instance, vector<char> &space, bool pattern);
+    bool searchForward();
+    vector<int> getForwardPath(int node);
+    bool replay(vector<int> &instances);
+    simulationStep getStep(list<spaceHighlighted> &path, vector<char> &space);
+    char getSet(int status);
+    Grid getGrid(vector<char> &space);
+    unsigned long getHash(vector<char> &cells);
+    //! Rules and patterns placed at every coordinate.
+    BitSimulation placement;
+    //! Width of the spaces the rules are placed on.
+    int width;
+    //! Height of the spaces the rules are placed on.
+    int height;
+    //! Rule placements that change every cell.
+    vector< vector<int> > writers;
+    //! Initial space of the row.
+    vector<char> initial;
+    //! Output cells of the table.
+    vector<int> outputCells;
+    //! Expected output values of the row.
+    vector<bool> expected;
+    //! Outputs of the row that must have their value.
+    vector<bool> care;
+    //! Partial spaces searched backward.
+    vector<searchNode> backward;
+    //! Spaces reached forward.
+    vector<searchNode> forward;
+    //! Hashes of the partial spaces already searched.
+    set<unsigned long> seen;
+    //! Use the bidirectional mode?
+    bool bidirectional;
+    //! Stable space with wrong outputs found.
+    list<simulationStep> stable;
+    //! Forbidden space found.
+    list<simulationStep> forbidden;
+    //! Out of bounds space found.
+    list<simulationStep> outOfBounds;
+};
+
+#endif /*BACKWARDSEARCH_HPP_*/
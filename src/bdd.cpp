@@ -0,0 +1,390 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "bdd.hpp"
+
+using namespace std;
+
+//! Binary operations of apply.
+enum BddOperation
+{
+    nBDDAND = 0,
+    nBDDOR,
+    nBDDXOR
+};
+
+//! Size of the unique table and of the operation cache, a power of two.
+#define BDD_TABLE (1 << 20)
+
+
+//! Constructor.
+/*!
+   \param variables the number of variables. The variable 0 is the
+   top of the order.
+*/
+BddManager::BddManager(int variables)
+{
+    this->variables = variables;
+    full = false;
+    buckets.assign(BDD_TABLE, -1);
+    bddCache empty;
+    empty.op = -1;
+    empty.f = empty.g = empty.result = 0;
+    cache.assign(BDD_TABLE, empty);
+    bddNode constant;
+    constant.var = variables;
+    constant.low = constant.high = BDD_FALSE;
+    constant.next = -1;
+    nodes.push_back(constant);
+    constant.low = constant.high = BDD_TRUE;
+    nodes.push_back(constant);
+}
+
+
+//! Destructor.
+BddManager::~BddManager()
+{
+}
+
+
+//! Member accessor.
+/*!
+   \return The number of variables.
+*/
+int BddManager::getVariables()
+{
+    return variables;
+}
+
+
+//! Member accessor.
+/*!
+   \return The number of nodes created.
+*/
+int BddManager::getNodes()
+{
+    return nodes.size();
+}
+
+
+//! Tells if the node limit has been reached.
+/*!
+   Once the manager is full the results of the operations are not valid
+   any more.
+   \return True if an operation needed more than BDD_NODES nodes.
+*/
+bool BddManager::isFull()
+{
+    return full;
+}
+
+
+//! Gets the node of a variable, creating it if needed.
+/*!
+   \param var the variable.
+   \param low the function when the variable is false.
+   \param high the function when the variable is true.
+   \return The node.
+*/
+int BddManager::makeNode(int var, int low, int high)
+{
+    if (low == high)
+    {
+        return low;
+    }
+    unsigned int hash = ((unsigned int)var * 12582917u + (unsigned int)low * 4256249u + (unsigned int)high * 741457u) & (BDD_TABLE - 1);
+    for (int i = buckets[hash]; i != -1; i = nodes[i].next)
+    {
+        if (nodes[i].var == var && nodes[i].low == low && nodes[i].high == high)
+        {
+            return i;
+        }
+    }
+    if ((int)nodes.size() >= BDD_NODES)
+    {
+        full = true;
+        return BDD_FALSE;
+    }
+    bddNode node;
+    node.var = var;
+    node.low = low;
+    node.high = high;
+    node.next = buckets[hash];
+    nodes.push_back(node);
+    buckets[hash] = nodes.size() - 1;
+    return nodes.size() - 1;
+}
+
+
+//! Gets the function of a variable.
+/*!
+   \param var the variable.
+   \return The function that is true iif the variable is true.
+*/
+int BddManager::variable(int var)
+{
+    return makeNode(var, BDD_FALSE, BDD_TRUE);
+}
+
+
+//! Negation.
+/*!
+   \param f the function.
+   \return Not f.
+*/
+int BddManager::bddNot(int f)
+{
+    return apply(nBDDXOR, f, BDD_TRUE);
+}
+
+
+//! Conjunction.
+/*!
+   \param f the first function.
+   \param g the second function.
+   \return f and g.
+*/
+int BddManager::bddAnd(int f, int g)
+{
+    return apply(nBDDAND, f, g);
+}
+
+
+//! Disjunction.
+/*!
+   \param f the first function.
+   \param g the second function.
+   \return f or g.
+*/
+int BddManager::bddOr(int f, int g)
+{
+    return apply(nBDDOR, f, g);
+}
+
+
+//! Exclusive disjunction.
+/*!
+   \param f the first function.
+   \param g the second function.
+   \return f xor g.
+*/
+int BddManager::bddXor(int f, int g)
+{
+    return apply(nBDDXOR, f, g);
+}
+
+
+//! If then else.
+/*!
+   \param f the condition.
+   \param g the function when the condition is true.
+   \param h the function when the condition is false.
+   \return (f and g) or (not f and h).
+*/
+int BddManager::bddIte(int f, int g, int h)
+{
+    if (f == BDD_TRUE)
+    {
+        return g;
+    }
+    if (f == BDD_FALSE)
+    {
+        return h;
+    }
+    if (g == h)
+    {
+        return g;
+    }
+    return bddOr(bddAnd(f, g), bddAnd(bddNot(f), h));
+}
+
+
+//! Gets the top variable of two functions.
+/*!
+   \param f the first function.
+   \param g the second function.
+   \return The first variable in the order any of them depends on.
+*/
+int BddManager::topVariable(int f, int g)
+{
+    return nodes[f].var < nodes[g].var ? nodes[f].var : nodes[g].var;
+}
+
+
+//! Applies a binary operation.
+/*!
+   \param op the operation.
+   \param f the first function.
+   \param g the second function.
+   \return The result of the operation.
+*/
+int BddManager::apply(int op, int f, int g)
+{
+    //Terminal cases
+    switch (op)
+    {
+        case nBDDAND:
+            if (f == BDD_FALSE || g == BDD_FALSE)
+            {
+                return BDD_FALSE;
+            }
+            if (f == BDD_TRUE || f == g)
+            {
+                return g;
+            }
+            if (g == BDD_TRUE)
+            {
+                return f;
+            }
+            break;
+        case nBDDOR:
+            if (f == BDD_TRUE || g == BDD_TRUE)
+            {
+                return BDD_TRUE;
+            }
+            if (f == BDD_FALSE || f == g)
+            {
+                return g;
+            }
+            if (g == BDD_FALSE)
+            {
+                return f;
+            }
+            break;
+        default:
+            if (f == g)
+            {
+                return BDD_FALSE;
+            }
+            if (f == BDD_FALSE)
+            {
+                return g;
+            }
+            if (g == BDD_FALSE)
+            {
+                return f;
+            }
+            if (f == BDD_TRUE && g == BDD_TRUE)
+            {
+                return BDD_FALSE;
+            }
+            break;
+    }
+    if (full)
+    {
+        return BDD_FALSE;
+    }
+    //The operations are commutative
+    if (f > g)
+    {
+        int swap = f;
+        f = g;
+        g = swap;
+    }
+    unsigned int hash = ((unsigned int)op * 7919u + (unsigned int)f * 12582917u + (unsigned int)g * 4256249u) & (BDD_TABLE - 1);
+    if (cache[hash].op == op && cache[hash].f == f && cache[hash].g == g)
+    {
+        return cache[hash].result;
+    }
+    int var = topVariable(f, g);
+    int fLow = nodes[f].var == var ? nodes[f].low : f;
+    int fHigh = nodes[f].var == var ? nodes[f].high : f;
+    int gLow = nodes[g].var == var ? nodes[g].low : g;
+    int gHigh = nodes[g].var == var ? nodes[g].high : g;
+    int low = apply(op, fLow, gLow);
+    int high = apply(op, fHigh, gHigh);
+    int result = makeNode(var, low, high);
+    cache[hash].op = op;
+    cache[hash].f = f;
+    cache[hash].g = g;
+    cache[hash].result = result;
+    return result;
+}
+
+
+//! Evaluates a function.
+/*!
+   \param f the function.
+   \param values the value of every variable.
+   \return The value of the function.
+*/
+bool BddManager::evaluate(int f, vector<bool> &values)
+{
+    while (f != BDD_FALSE && f != BDD_TRUE)
+    {
+        f = values[nodes[f].var] ? nodes[f].high : nodes[f].low;
+    }
+    return f == BDD_TRUE;
+}
+
+
+//! Counts the assignments that satisfy a function.
+/*!
+   \param f the function.
+   \return The number of variable assignments for which f is true.
+*/
+double BddManager::satCount(int f)
+{
+    vector<double> counts(nodes.size(), -1);
+    double result = satCount(f, counts);
+    //Variables above the root are free
+    for (int i = 0; i < nodes[f].var; i++)
+    {
+        result *= 2;
+    }
+    return result;
+}
+
+
+//! Counts the assignments that satisfy a function below its variable.
+/*!
+   \param f the function.
+   \param counts the counts already computed.
+   \return The number of assignments of the variables from the variable of
+   f on for which f is true.
+*/
+double BddManager::satCount(int f, vector<double> &counts)
+{
+    if (f == BDD_FALSE)
+    {
+        return 0;
+    }
+    if (f == BDD_TRUE)
+    {
+        return 1;
+    }
+    if (counts[f] >= 0)
+    {
+        return counts[f];
+    }
+    double result = 0;
+    int children[2] = {nodes[f].low, nodes[f].high};
+    for (int k = 0; k < 2; k++)
+    {
+        double count = satCount(children[k], counts);
+        for (int i = nodes[f].var + 1; i < nodes[children[k]].var; i++)
+        {
+            count *= 2;
+        }
+        result += count;
+    }
+    counts[f] = result;
+    return result;
+}
@@ -0,0 +1,100 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class BddManager
+ * \brief Reduced ordered binary decision diagrams.
+ * 
+ * A small BDD package used by the symbolic simulation. Every function is
+ * referenced by the index of its root node; equal functions always get
+ * the same index, so comparing functions is comparing integers. Nodes are
+ * never freed: the manager is meant to live as long as one symbolic
+ * simulation, and it stops creating nodes when BDD_NODES is reached.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef BDD_HPP_
+#define BDD_HPP_
+
+#include <vector>
+
+//! The constant false function.
+#define BDD_FALSE 0
+//! The constant true function.
+#define BDD_TRUE 1
+//! Maximum number of nodes of a manager.
+#define BDD_NODES 2000000
+
+using namespace std;
+
+
+//! BDD node struct.
+struct bddNode
+{
+    int var; /*!< Variable of the node, the number of variables for the constants. */
+    int low; /*!< Function when the variable is false. */
+    int high; /*!< Function when the variable is true. */
+    int next; /*!< Next node with the same hash. */
+};
+
+
+//! BDD operation cache entry struct.
+struct bddCache
+{
+    int op; /*!< Operation, -1 if the entry is empty. */
+    int f; /*!< First operand. */
+    int g; /*!< Second operand. */
+    int result; /*!< Result of the operation. */
+};
+
+
+class BddManager
+{
+public:
+    BddManager(int variables);
+    virtual ~BddManager();
+    int getVariables();
+    int getNodes();
+    bool isFull();
+    int variable(int var);
+    int bddNot(int f);
+    int bddAnd(int f, int g);
+    int bddOr(int f, int g);
+    int bddXor(int f, int g);
+    int bddIte(int f, int g, int h);
+    bool evaluate(int f, vector<bool> &values);
+    double satCount(int f);
+
+private:
+    int makeNode(int var, int low, int high);
+    int apply(int op, int f, int g);
+    int topVariable(int f, int g);
+    double satCount(int f, vector<double> &counts);
+    //! Nodes of the diagrams.
+    vector<bddNode> nodes;
+    //! First node of every hash bucket.
+    vector<int> buckets;
+    //! Cache of the operations already computed.
+    vector<bddCache> cache;
+    //! Number of variables.
+    int variables;
+    //! True if the node limit has been reached.
+    bool full;
+};
+
+#endif /*BDD_HPP_*/
@@ -0,0 +1,508 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "bddSimulation.hpp"
+#include <cstddef>
+
+using namespace std;
+
+
+//! Constructor.
+/*!
+   The rules are referenced, not copied, so the list must outlive the
+   simulation.
+   \param rules the rule list to be applied.
+   \param patterns the forbidden pattern list to be found.
+*/
+BddSimulation::BddSimulation(list<Rule> *rules, list<ForbiddenPattern> *patterns) : placement(rules, patterns)
+{
+    bdd = NULL;
+    width = 0;
+    height = 0;
+    decided = BDD_FALSE;
+    verified = BDD_FALSE;
+}
+
+
+//! Destructor.
+BddSimulation::~BddSimulation()
+{
+    delete bdd;
+}
+
+
+//! Builds the function of a truth table output.
+/*!
+   \param table the truth table.
+   \param output the output.
+   \param care true for the rows where the output must have its value,
+   false for its value.
+   \param var the first variable not fixed yet.
+   \param first the first row with the fixed variables.
+   \return The function of the output for the rows from first on.
+*/
+int BddSimulation::buildTable(RowOutputs *table, int output, bool care, int var, int first)
+{
+    int variables = bdd->getVariables();
+    if (var == variables)
+    {
+        vector<bool> values = care ? table->getCare(first) : table->getOutput(first);
+        return values[output] ? BDD_TRUE : BDD_FALSE;
+    }
+    //The first input is the most significant bit of the row
+    int low = buildTable(table, output, care, var + 1, first);
+    int high = buildTable(table, output, care, var + 1, first + (1 << (variables - var - 1)));
+    return bdd->bddIte(bdd->variable(var), high, low);
+}
+
+
+//! Simulates all the rows of a truth table.
+/*!
+   \param layout the initial space, the input cells are replaced by
+   the table inputs.
+   \param inputs the input coordinates of the table.
+   \param outputs the output coordinates of the table.
+   \param table the truth table, with the outputs of every row and the
+   ones that are don't-cares.
+   \return False if the rows can not be simulated symbolically, because
+   of the rules used or because the functions grow too much.
+*/
+bool BddSimulation::simulate(Grid layout, vector<coordinate> inputs, vector<coordinate> outputs, RowOutputs *table)
+{
+    delete bdd;
+    bdd = new BddManager(inputs.size());
+    enabledSteps.clear();
+    noSpaceSteps.clear();
+    firedSteps.clear();
+    stableSteps.clear();
+    forbiddenSteps.clear();
+    cycleSteps.clear();
+    outOfBoundsSteps.clear();
+    decided = BDD_FALSE;
+    verified = BDD_FALSE;
+    if (!placement.isSupported() || inputs.size() >= sizeof(int) * 8 - 1)
+    {
+        return false;
+    }
+    width = layout.getWidth();
+    height = layout.getHeight();
+    int cells = width * height;
+    placement.buildInstances(width, height);
+    vector<bitInstance> &rules = placement.getRuleInstances();
+    vector<bitInstance> &patterns = placement.getPatternInstances();
+    
+    //Initial space, the inputs are the variables
+    vector<int> enabled(cells, BDD_FALSE);
+    vector<int> noSpace(cells, BDD_FALSE);
+    for (unsigned int k = 0; k < inputs.size(); k++)
+    {
+        layout(inputs[k].x, inputs[k].y) = nDISABLED;
+    }
+    for (int x = 0; x < width; x++)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            if (layout(x, y) == nENABLED)
+            {
+                enabled[x * height + y] = BDD_TRUE;
+            }
+            else if (layout(x, y) == nNOSPACE)
+            {
+                noSpace[x * height + y] = BDD_TRUE;
+            }
+            else if (layout(x, y) != nDISABLED)
+            {
+                return false;
+            }
+        }
+    }
+    for (unsigned int k = 0; k < inputs.size(); k++)
+    {
+        enabled[inputs[k].x * height + inputs[k].y] = bdd->variable(k);
+    }
+    vector<int> expected;
+    vector<int> cared;
+    for (unsigned int o = 0; o < outputs.size(); o++)
+    {
+        expected.push_back(buildTable(table, o, false, 0, 0));
+        cared.push_back(buildTable(table, o, true, 0, 0));
+    }
+    
+    //Rows whose spaces from every step on verify the table
+    vector<int> verifiedFrom;
+    int active = BDD_TRUE;
+    for (int step = 0; active != BDD_FALSE && step < BDD_STEPS; step++)
+    {
+        enabledSteps.push_back(enabled);
+        noSpaceSteps.push_back(noSpace);
+        firedSteps.push_back(vector< pair<int, int> >());
+        
+        //Rows where the space has the outputs of the table, any value
+        //verifies a don't-care
+        int outputsOk = BDD_TRUE;
+        for (unsigned int o = 0; o < outputs.size(); o++)
+        {
+            int cell = outputs[o].x * height + outputs[o].y;
+            int value = bdd->bddAnd(bdd->bddNot(bdd->bddXor(enabled[cell], expected[o])), bdd->bddNot(noSpace[cell]));
+            outputsOk = bdd->bddAnd(outputsOk, bdd->bddOr(bdd->bddNot(cared[o]), value));
+        }
+        for (unsigned int u = 0; u < verifiedFrom.size(); u++)
+        {
+            verifiedFrom[u] = bdd->bddAnd(verifiedFrom[u], outputsOk);
+        }
+        verifiedFrom.push_back(outputsOk);
+        
+        //Find forbidden patterns
+        int found = BDD_FALSE;
+        for (unsigned int p = 0; p < patterns.size(); p++)
+        {
+            bitInstance &instance = patterns[p];
+            int match = active;
+            for (unsigned int i = 0; match != BDD_FALSE && i < instance.enabled.size(); i++)
+            {
+                match = bdd->bddAnd(match, enabled[instance.enabled[i]]);
+            }
+            for (unsigned int i = 0; match != BDD_FALSE && i < instance.disabled.size(); i++)
+            {
+                match = bdd->bddAnd(match, bdd->bddNot(enabled[instance.disabled[i]]));
+            }
+            for (unsigned int i = 0; match != BDD_FALSE && i < instance.space.size(); i++)
+            {
+                match = bdd->bddAnd(match, bdd->bddNot(noSpace[instance.space[i]]));
+            }
+            found = bdd->bddOr(found, match);
+        }
+        
+        //Find the applicable rules, counting up to two per row
+        int one = BDD_FALSE;
+        int two = BDD_FALSE;
+        int oob = BDD_FALSE;
+        vector< pair<int, int> > matched;
+        int matching = bdd->bddAnd(active, bdd->bddNot(found));
+        for (unsigned int r = 0; matching != BDD_FALSE && r < rules.size(); r++)
+        {
+            bitInstance &instance = rules[r];
+            int match = matching;
+            for (unsigned int i = 0; match != BDD_FALSE && i < instance.enabled.size(); i++)
+            {
+                match = bdd->bddAnd(match, enabled[instance.enabled[i]]);
+            }
+            for (unsigned int i = 0; match != BDD_FALSE && i < instance.disabled.size(); i++)
+            {
+                match = bdd->bddAnd(match, bdd->bddNot(enabled[instance.disabled[i]]));
+            }
+            if (match == BDD_FALSE)
+            {
+                continue;
+            }
+            two = bdd->bddOr(two, bdd->bddAnd(one, match));
+            one = bdd->bddOr(one, match);
+            if (instance.outOfBounds)
+            {
+                oob = bdd->bddOr(oob, match);
+            }
+            else
+            {
+                for (unsigned int i = 0; i < instance.bounds.size(); i++)
+                {
+                    oob = bdd->bddOr(oob, bdd->bddAnd(match, noSpace[instance.bounds[i]]));
+                }
+            }
+            matched.push_back(pair<int, int>(r, match));
+        }
+        int still = bdd->bddAnd(matching, bdd->bddNot(bdd->bddOr(oob, one)));
+        forbiddenSteps.push_back(found);
+        outOfBoundsSteps.push_back(oob);
+        stableSteps.push_back(still);
+        verified = bdd->bddOr(verified, bdd->bddAnd(still, outputsOk));
+        //Rows with more than one applicable rule are not deterministic
+        active = bdd->bddAnd(bdd->bddAnd(matching, one), bdd->bddNot(bdd->bddOr(oob, two)));
+        
+        //Apply the rules
+        vector< pair<int, int> > &fired = firedSteps.back();
+        for (unsigned int m = 0; m < matched.size(); m++)
+        {
+            int mask = bdd->bddAnd(matched[m].second, active);
+            if (mask == BDD_FALSE)
+            {
+                continue;
+            }
+            bitInstance &instance = rules[matched[m].first];
+            fired.push_back(pair<int, int>(matched[m].first, mask));
+            for (unsigned int i = 0; i < instance.writes.size(); i++)
+            {
+                int cell = instance.writes[i];
+                enabled[cell] = bdd->bddIte(mask, instance.values[i] == nENABLED ? BDD_TRUE : BDD_FALSE, enabled[cell]);
+                noSpace[cell] = bdd->bddIte(mask, instance.values[i] == nNOSPACE ? BDD_TRUE : BDD_FALSE, noSpace[cell]);
+            }
+        }
+        
+        //Find cycles, the new spaces can not be compared with the
+        //current one as it is not on the path yet
+        int cycle = BDD_FALSE;
+        for (int previous = 0; previous < step; previous++)
+        {
+            vector<int> &previousEnabled = enabledSteps[previous];
+            vector<int> &previousNoSpace = noSpaceSteps[previous];
+            int equal = bdd->bddAnd(active, bdd->bddNot(cycle));
+            for (int i = 0; equal != BDD_FALSE && i < cells; i++)
+            {
+                int differ = bdd->bddOr(bdd->bddXor(enabled[i], previousEnabled[i]), bdd->bddXor(noSpace[i], previousNoSpace[i]));
+                equal = bdd->bddAnd(equal, bdd->bddNot(differ));
+            }
+            //The cycle verifies the table if all its spaces do
+            verified = bdd->bddOr(verified, bdd->bddAnd(equal, verifiedFrom[previous]));
+            cycle = bdd->bddOr(cycle, equal);
+        }
+        cycleSteps.push_back(cycle);
+        active = bdd->bddAnd(active, bdd->bddNot(cycle));
+        if (bdd->isFull())
+        {
+            return false;
+        }
+    }
+    //Spaces reached by the cycles of the last step
+    enabledSteps.push_back(enabled);
+    noSpaceSteps.push_back(noSpace);
+    
+    for (unsigned int step = 0; step < stableSteps.size(); step++)
+    {
+        decided = bdd->bddOr(decided, stableSteps[step]);
+        decided = bdd->bddOr(decided, forbiddenSteps[step]);
+        decided = bdd->bddOr(decided, outOfBoundsSteps[step]);
+        decided = bdd->bddOr(decided, cycleSteps[step]);
+    }
+    return !bdd->isFull();
+}
+
+
+//! Tells if a row has been simulated completely.
+/*!
+   \param row the row.
+   \return True if the results of the row are known.
+*/
+bool BddSimulation::isDecided(int row)
+{
+    vector<bool> values = getValues(row);
+    return bdd->evaluate(decided, values);
+}
+
+
+//! Tells if a row verifies the truth table.
+/*!
+   \param row the row, which must have been simulated completely.
+   \return True if all the stable spaces and cycles of the row have the
+   outputs of the table and there are no forbidden patterns nor out of
+   bounds spaces.
+*/
+bool BddSimulation::verifies(int row)
+{
+    vector<bool> values = getValues(row);
+    return bdd->evaluate(verified, values);
+}
+
+
+//! Counts the rows simulated completely.
+/*!
+   \return The number of rows whose results are known.
+*/
+double BddSimulation::getDecided()
+{
+    return bdd->satCount(decided);
+}
+
+
+//! Counts the rows that verify the truth table.
+/*!
+   \return The number of rows simulated completely that verify the table.
+*/
+double BddSimulation::getVerified()
+{
+    return bdd->satCount(verified);
+}
+
+
+//! Member accessor.
+/*!
+   \return The number of BDD nodes used.
+*/
+int BddSimulation::getNodes()
+{
+    return bdd->getNodes();
+}
+
+
+//! Gets the input values of a row.
+/*!
+   \param row the row.
+   \return The value of every variable, the first input is the most
+   significant bit of the row.
+*/
+vector<bool> BddSimulation::getValues(int row)
+{
+    int variables = bdd->getVariables();
+    vector<bool> values(variables, false);
+    for (int k = 0; k < variables; k++)
+    {
+        values[k] = (row >> (variables - 1 - k)) & 1;
+    }
+    return values;
+}
+
+
+//! Finds the step where a row has an event.
+/*!
+   \param events the rows with the event at every step.
+   \param values the input values of the row.
+   \return The step, or -1 if the row does not have the event.
+*/
+int BddSimulation::findStep(vector<int> &events, vector<bool> &values)
+{
+    for (unsigned int step = 0; step < events.size(); step++)
+    {
+        if (bdd->evaluate(events[step], values))
+        {
+            return step;
+        }
+    }
+    return -1;
+}
+
+
+//! Gets the space of a row at a step.
+/*!
+   \param step the step.
+   \param values the input values of the row.
+   \return The space.
+*/
+Grid BddSimulation::getGrid(int step, vector<bool> &values)
+{
+    Grid result(width, height);
+    for (int x = 0; x < width; x++)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            if (bdd->evaluate(enabledSteps[step][x * height + y], values))
+            {
+                result(x, y) = nENABLED;
+            }
+            else if (bdd->evaluate(noSpaceSteps[step][x * height + y], values))
+            {
+                result(x, y) = nNOSPACE;
+            }
+            else
+            {
+                result(x, y) = nDISABLED;
+            }
+        }
+    }
+    return result;
+}
+
+
+//! Builds the event of a row.
+/*!
+   \param events the rows with the event at every step.
+   \param row the row.
+   \param offset 1 if the space of the event is the one after the step,
+   0 if it is the space of the step.
+   \return The event of the row as the normal simulation builds it, or an
+   empty list if the row does not have the event.
+*/
+list<simulationStep> BddSimulation::getEvent(vector<int> &events, int row, int offset)
+{
+    list<simulationStep> result;
+    vector<bool> values = getValues(row);
+    int step = findStep(events, values);
+    if (step < 0)
+    {
+        return result;
+    }
+    simulationStep event;
+    for (int i = 0; i < step + offset; i++)
+    {
+        spaceHighlighted space;
+        space.g = getGrid(i, values);
+        space.h.top = space.h.left = space.h.width = space.h.height = 0;
+        vector< pair<int, int> > &fired = firedSteps[i];
+        for (unsigned int k = 0; k < fired.size(); k++)
+        {
+            if (bdd->evaluate(fired[k].second, values))
+            {
+                bitInstance &instance = placement.getRuleInstances()[fired[k].first];
+                Rule *rule = placement.getRule(instance.index);
+                space.h.top = instance.c.y - rule->getHeight() + 1;
+                space.h.left = instance.c.x - rule->getWidth() + 1;
+                space.h.width = rule->getWidth();
+                space.h.height = rule->getHeight();
+            }
+        }
+        event.path.push_back(space);
+    }
+    event.space.g = getGrid(step + offset, values);
+    event.space.h.top = event.space.h.left = event.space.h.width = event.space.h.height = 0;
+    event.matched = false;
+    result.push_back(event);
+    return result;
+}
+
+
+//! Returns the stable spaces of a row.
+/*!
+   \param row the row.
+   \return The list of stable spaces of the row.
+*/
+list<simulationStep> BddSimulation::getStableLayouts(int row)
+{
+    return getEvent(stableSteps, row, 0);
+}
+
+
+//! Returns the forbidden spaces of a row.
+/*!
+   \param row the row.
+   \return The list of forbidden spaces of the row.
+*/
+list<simulationStep> BddSimulation::getForbiddenLayouts(int row)
+{
+    return getEvent(forbiddenSteps, row, 0);
+}
+
+
+//! Returns the cycles of a row.
+/*!
+   \param row the row.
+   \return The list of cycles of the row.
+*/
+list<simulationStep> BddSimulation::getCycles(int row)
+{
+    return getEvent(cycleSteps, row, 1);
+}
+
+
+//! Returns the out of bounds spaces of a row.
+/*!
+   \param row the row.
+   \return The list of out of bounds spaces of the row.
+*/
+list<simulationStep> BddSimulation::getOutOfBounds(int row)
+{
+    return getEvent(outOfBoundsSteps, row, 0);
+}
@@ -0,0 +1,101 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class BddSimulation
+ * \brief Symbolic simulation of all the rows of a truth table.
+ * 
+ * Instead of simulating every row of the table, the status of every cell
+ * is represented as a boolean function of the table inputs, stored as a
+ * BDD. The rules are matched and applied on those functions, so a single
+ * pass simulates all the rows whose simulation is a single path, that is,
+ * the rows where at most one rule is applicable at every step. The output
+ * cells of the stable spaces and cycles are compared with the truth table
+ * as functions too, leaving out the don't-care outputs of every row, so the rows that verify the table are known without
+ * enumerating them. The results of a single row are built on demand by
+ * evaluating the functions for its inputs.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef BDDSIMULATION_HPP_
+#define BDDSIMULATION_HPP_
+
+#include "bdd.hpp"
+#include "bitSimulation.hpp"
+#include "simulationStep.hpp"
+#include "rowOutputs.hpp"
+#include <vector>
+#include <list>
+
+//! Maximum number of steps of a symbolic simulation.
+#define BDD_STEPS 1024
+
+using namespace std;
+
+
+class BddSimulation
+{
+public:
+    BddSimulation(list<Rule> *rules, list<ForbiddenPattern> *patterns);
+    virtual ~BddSimulation();
+    bool simulate(Grid layout, vector<coordinate> inputs, vector<coordinate> outputs, RowOutputs *table);
+    bool isDecided(int row);
+    bool verifies(int row);
+    double getDecided();
+    double getVerified();
+    int getNodes();
+    list<simulationStep> getStableLayouts(int row);
+    list<simulationStep> getForbiddenLayouts(int row);
+    list<simulationStep> getCycles(int row);
+    list<simulationStep> getOutOfBounds(int row);
+
+private:
+    int buildTable(RowOutputs *table, int output, bool care, int var, int first);
+    vector<bool> getValues(int row);
+    int findStep(vector<int> &events, vector<bool> &values);
+    Grid getGrid(int step, vector<bool> &values);
+    list<simulationStep> getEvent(vector<int> &events, int row, int offset);
+    //! Rules and patterns placed at every coordinate.
+    BitSimulation placement;
+    //! Functions of the simulation.
+    BddManager *bdd;
+    //! Width of the space.
+    int width;
+    //! Height of the space.
+    int height;
+    //! Enabled cells of every step.
+    vector< vector<int> > enabledSteps;
+    //! Not available cells of every step.
+    vector< vector<int> > noSpaceSteps;
+    //! Rules fired at every step and the rows where they fired.
+    vector< vector< pair<int, int> > > firedSteps;
+    //! Rows reaching a stable space at every step.
+    vector<int> stableSteps;
+    //! Rows finding a forbidden pattern at every step.
+    vector<int> forbiddenSteps;
+    //! Rows finding a cycle at every step.
+    vector<int> cycleSteps;
+    //! Rows finding an out of bounds at every step.
+    vector<int> outOfBoundsSteps;
+    //! Rows simulated completely.
+    int decided;
+    //! Rows simulated completely that verify the table.
+    int verified;
+};
+
+#endif /*BDDSIMULATION_HPP_*/
@@ -0,0 +1,586 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "bitSimulation.hpp"
+
+using namespace std;
+
+
+//! Constructor.
+/*!
+   The rules are referenced, not copied, so the list must outlive the
+   simulation.
+   \param rules the rule list to be applied.
+   \param patterns the forbidden pattern list to be found.
+*/
+BitSimulation::BitSimulation(list<Rule> *rules, list<ForbiddenPattern> *patterns)
+{
+    supported = true;
+    width = -1;
+    height = -1;
+    for (list<Rule>::iterator i = rules->begin(); i != rules->end(); i++)
+    {
+        ruleSet.push_back(&(*i));
+        matrix cells = (*i).getFinalMatrix();
+        for (unsigned int x = 0; x < cells.size(); x++)
+        {
+            for (unsigned int y = 0; y < cells[x].size(); y++)
+            {
+                //Rules can only write statuses stored in the bit planes
+                if (cells[x][y] != nDONTCARE && cells[x][y] != nENABLED && cells[x][y] != nDISABLED && cells[x][y] != nNOSPACE)
+                {
+                    supported = false;
+                }
+            }
+        }
+    }
+    for (list<ForbiddenPattern>::iterator i = patterns->begin(); i != patterns->end(); i++)
+    {
+        patternSet.push_back((*i).getGrid());
+    }
+}
+
+
+//! Destructor.
+BitSimulation::~BitSimulation()
+{
+}
+
+
+//! Tells if the rule set can be simulated bit-sliced.
+/*!
+   \return True if all the rules write statuses the bit planes can store.
+*/
+bool BitSimulation::isSupported()
+{
+    return supported;
+}
+
+
+//! Places the rules and patterns at every coordinate of a space.
+/*!
+   The coordinates are the same findApplicable uses, relative to the space
+   surrounded by disabled cells. Placements that can never match are
+   dropped.
+   \param width the width of the space.
+   \param height the height of the space.
+*/
+void BitSimulation::buildInstances(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+    rules.clear();
+    patterns.clear();
+    for (unsigned int r = 0; r < ruleSet.size(); r++)
+    {
+        matrix initialCells = ruleSet[r]->getInitialMatrix();
+        matrix finalCells = ruleSet[r]->getFinalMatrix();
+        int w = initialCells.size();
+        int h = initialCells[0].size();
+        for (int x = 0; x < width + w - 1; x++)
+        {
+            for (int y = 0; y < height + h - 1; y++)
+            {
+                bitInstance instance;
+                instance.index = r;
+                instance.c.x = x;
+                instance.c.y = y;
+                instance.outOfBounds = false;
+                bool possible = true;
+                for (int i = 0; i < w; i++)
+                {
+                    for (int j = 0; j < h; j++)
+                    {
+                        int sx = x - w + 1 + i;
+                        int sy = y - h + 1 + j;
+                        bool inside = sx >= 0 && sx < width && sy >= 0 && sy < height;
+                        int cell = sx * height + sy;
+                        //Out of the space cells are disabled
+                        if (initialCells[i][j] == nENABLED)
+                        {
+                            if (!inside)
+                            {
+                                possible = false;
+                            }
+                            else
+                            {
+                                instance.enabled.push_back(cell);
+                            }
+                        }
+                        else if (initialCells[i][j] == nDISABLED && inside)
+                        {
+                            instance.disabled.push_back(cell);
+                        }
+                        if (finalCells[i][j] == nENABLED)
+                        {
+                            if (!inside)
+                            {
+                                instance.outOfBounds = true;
+                            }
+                            else
+                            {
+                                instance.bounds.push_back(cell);
+                            }
+                        }
+                        if (finalCells[i][j] != nDONTCARE && inside)
+                        {
+                            instance.writes.push_back(cell);
+                            instance.values.push_back(finalCells[i][j]);
+                        }
+                    }
+                }
+                if (possible)
+                {
+                    rules.push_back(instance);
+                }
+            }
+        }
+    }
+    
+    for (unsigned int p = 0; p < patternSet.size(); p++)
+    {
+        Grid &pattern = patternSet[p];
+        int w = pattern.getWidth();
+        int h = pattern.getHeight();
+        for (int x = 0; x < width + w - 1; x++)
+        {
+            for (int y = 0; y < height + h - 1; y++)
+            {
+                bitInstance instance;
+                instance.index = p;
+                instance.c.x = x;
+                instance.c.y = y;
+                instance.outOfBounds = false;
+                bool possible = true;
+                for (int i = 0; i < w; i++)
+                {
+                    for (int j = 0; j < h; j++)
+                    {
+                        int sx = x - w + 1 + i;
+                        int sy = y - h + 1 + j;
+                        bool inside = sx >= 0 && sx < width && sy >= 0 && sy < height;
+                        int cell = sx * height + sy;
+                        if (pattern(i, j) == nENABLED)
+                        {
+                            if (!inside)
+                            {
+                                possible = false;
+                            }
+                            else
+                            {
+                                instance.enabled.push_back(cell);
+                            }
+                        }
+                        else if (!inside)
+                        {
+                            //Out of the space cells are disabled
+                            continue;
+                        }
+                        else if (pattern(i, j) == nDISABLED)
+                        {
+                            instance.disabled.push_back(cell);
+                            instance.space.push_back(cell);
+                        }
+                        else
+                        {
+                            instance.space.push_back(cell);
+                        }
+                    }
+                }
+                if (possible)
+                {
+                    patterns.push_back(instance);
+                }
+            }
+        }
+    }
+}
+
+
+//! Simulates a group of rows.
+/*!
+   \param spaces the initial spaces of the rows, at most BITSLICE_LANES,
+   all of them with the same size.
+   \return A mask with the bit k set if the row of the space k has been
+   simulated completely. The results of those rows can be got with the
+   accessors.
+*/
+uint64_t BitSimulation::simulate(vector<Grid> &spaces)
+{
+    int lanes = spaces.size();
+    stable.assign(lanes, list<simulationStep>());
+    forbidden.assign(lanes, list<simulationStep>());
+    cycles.assign(lanes, list<simulationStep>());
+    outOfBounds.assign(lanes, list<simulationStep>());
+    enabledSteps.clear();
+    noSpaceSteps.clear();
+    firedSteps.clear();
+    if (!supported || lanes == 0)
+    {
+        return 0;
+    }
+    if (spaces[0].getWidth() != width || spaces[0].getHeight() != height)
+    {
+        buildInstances(spaces[0].getWidth(), spaces[0].getHeight());
+    }
+    
+    //Every cell is a word, the bit k is the status of the cell on row k
+    int cells = width * height;
+    vector<uint64_t> enabled(cells, 0);
+    vector<uint64_t> noSpace(cells, 0);
+    uint64_t active = 0;
+    for (int k = 0; k < lanes; k++)
+    {
+        uint64_t bit = (uint64_t)1 << k;
+        bool valid = true;
+        for (int x = 0; x < width; x++)
+        {
+            for (int y = 0; y < height; y++)
+            {
+                int status = spaces[k](x, y);
+                if (status == nENABLED)
+                {
+                    enabled[x * height + y] |= bit;
+                }
+                else if (status == nNOSPACE)
+                {
+                    noSpace[x * height + y] |= bit;
+                }
+                else if (status != nDISABLED)
+                {
+                    valid = false;
+                }
+            }
+        }
+        if (valid)
+        {
+            active |= bit;
+        }
+    }
+    
+    uint64_t solved = 0;
+    for (int step = 0; active != 0 && step < BITSLICE_STEPS; step++)
+    {
+        enabledSteps.push_back(enabled);
+        noSpaceSteps.push_back(noSpace);
+        firedSteps.push_back(vector< pair<int, uint64_t> >());
+        
+        //Find forbidden patterns
+        uint64_t found = 0;
+        for (unsigned int p = 0; p < patterns.size(); p++)
+        {
+            bitInstance &instance = patterns[p];
+            uint64_t match = active & ~found;
+            for (unsigned int i = 0; match != 0 && i < instance.enabled.size(); i++)
+            {
+                match &= enabled[instance.enabled[i]];
+            }
+            for (unsigned int i = 0; match != 0 && i < instance.disabled.size(); i++)
+            {
+                match &= ~enabled[instance.disabled[i]];
+            }
+            for (unsigned int i = 0; match != 0 && i < instance.space.size(); i++)
+            {
+                match &= ~noSpace[instance.space[i]];
+            }
+            found |= match;
+        }
+        
+        //Find the applicable rules, counting up to two per row
+        uint64_t one = 0;
+        uint64_t two = 0;
+        uint64_t oob = 0;
+        vector< pair<int, uint64_t> > matched;
+        uint64_t matching = active & ~found;
+        for (unsigned int r = 0; matching != 0 && r < rules.size(); r++)
+        {
+            bitInstance &instance = rules[r];
+            uint64_t match = matching;
+            for (unsigned int i = 0; match != 0 && i < instance.enabled.size(); i++)
+            {
+                match &= enabled[instance.enabled[i]];
+            }
+            for (unsigned int i = 0; match != 0 && i < instance.disabled.size(); i++)
+            {
+                match &= ~enabled[instance.disabled[i]];
+            }
+            if (match == 0)
+            {
+                continue;
+            }
+            two |= one & match;
+            one |= match;
+            if (instance.outOfBounds)
+            {
+                oob |= match;
+            }
+            else
+            {
+                for (unsigned int i = 0; i < instance.bounds.size(); i++)
+                {
+                    oob |= match & noSpace[instance.bounds[i]];
+                }
+            }
+            matched.push_back(pair<int, uint64_t>(r, match));
+        }
+        oob &= ~found;
+        uint64_t still = active & ~found & ~oob & ~one;
+        
+        //Rows ending on this step
+        for (int k = 0; k < lanes; k++)
+        {
+            uint64_t bit = (uint64_t)1 << k;
+            if ((active & bit) == 0)
+            {
+                continue;
+            }
+            if (found & bit)
+            {
+                forbidden[k].push_back(getStep(step, k, getGrid(enabled, noSpace, k)));
+            }
+            else if (oob & bit)
+            {
+                outOfBounds[k].push_back(getStep(step, k, getGrid(enabled, noSpace, k)));
+            }
+            else if (still & bit)
+            {
+                stable[k].push_back(getStep(step, k, getGrid(enabled, noSpace, k)));
+            }
+        }
+        solved |= found | oob | still;
+        //Rows with more than one applicable rule are not deterministic
+        active &= one & ~found & ~oob & ~two;
+        
+        //Apply the rules
+        vector< pair<int, uint64_t> > &fired = firedSteps.back();
+        for (unsigned int m = 0; m < matched.size(); m++)
+        {
+            uint64_t mask = matched[m].second & active;
+            if (mask == 0)
+            {
+                continue;
+            }
+            bitInstance &instance = rules[matched[m].first];
+            fired.push_back(pair<int, uint64_t>(matched[m].first, mask));
+            for (unsigned int i = 0; i < instance.writes.size(); i++)
+            {
+                int cell = instance.writes[i];
+                enabled[cell] &= ~mask;
+                noSpace[cell] &= ~mask;
+                if (instance.values[i] == nENABLED)
+                {
+                    enabled[cell] |= mask;
+                }
+                else if (instance.values[i] == nNOSPACE)
+                {
+                    noSpace[cell] |= mask;
+                }
+            }
+        }
+        
+        //Find cycles, the new spaces can not be compared with the
+        //current one as it is not on the path yet
+        uint64_t cycle = 0;
+        for (int previous = 0; active & ~cycle && previous < step; previous++)
+        {
+            vector<uint64_t> &previousEnabled = enabledSteps[previous];
+            vector<uint64_t> &previousNoSpace = noSpaceSteps[previous];
+            uint64_t equal = active & ~cycle;
+            for (int i = 0; equal != 0 && i < cells; i++)
+            {
+                equal &= ~((enabled[i] ^ previousEnabled[i]) | (noSpace[i] ^ previousNoSpace[i]));
+            }
+            cycle |= equal;
+        }
+        for (int k = 0; cycle != 0 && k < lanes; k++)
+        {
+            if (cycle & ((uint64_t)1 << k))
+            {
+                cycles[k].push_back(getStep(step + 1, k, getGrid(enabled, noSpace, k)));
+            }
+        }
+        solved |= cycle;
+        active &= ~cycle;
+    }
+    return solved;
+}
+
+
+//! Gets the grid of a row.
+/*!
+   \param enabled the enabled cells.
+   \param noSpace the not available cells.
+   \param lane the row.
+   \return The space of the row.
+*/
+Grid BitSimulation::getGrid(vector<uint64_t> &enabled, vector<uint64_t> &noSpace, int lane)
+{
+    Grid result(width, height);
+    uint64_t bit = (uint64_t)1 << lane;
+    for (int x = 0; x < width; x++)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            if (enabled[x * height + y] & bit)
+            {
+                result(x, y) = nENABLED;
+            }
+            else if (noSpace[x * height + y] & bit)
+            {
+                result(x, y) = nNOSPACE;
+            }
+            else
+            {
+                result(x, y) = nDISABLED;
+            }
+        }
+    }
+    return result;
+}
+
+
+//! Gets the path of a row.
+/*!
+   \param steps the number of steps of the path.
+   \param lane the row.
+   \return The spaces of the row for the given steps, with the zone
+   where the rule fired highlighted.
+*/
+list<spaceHighlighted> BitSimulation::getPath(int steps, int lane)
+{
+    list<spaceHighlighted> result;
+    uint64_t bit = (uint64_t)1 << lane;
+    for (int step = 0; step < steps; step++)
+    {
+        spaceHighlighted space;
+        space.g = getGrid(enabledSteps[step], noSpaceSteps[step], lane);
+        space.h.top = space.h.left = space.h.width = space.h.height = 0;
+        vector< pair<int, uint64_t> > &fired = firedSteps[step];
+        for (unsigned int i = 0; i < fired.size(); i++)
+        {
+            if (fired[i].second & bit)
+            {
+                bitInstance &instance = rules[fired[i].first];
+                Rule *rule = ruleSet[instance.index];
+                space.h.top = instance.c.y - rule->getHeight() + 1;
+                space.h.left = instance.c.x - rule->getWidth() + 1;
+                space.h.width = rule->getWidth();
+                space.h.height = rule->getHeight();
+            }
+        }
+        result.push_back(space);
+    }
+    return result;
+}
+
+
+//! Builds the simulation step of a row.
+/*!
+   \param steps the number of steps that lead to the space.
+   \param lane the row.
+   \param space the space reached.
+   \return The simulation step, as the normal simulation builds it.
+*/
+simulationStep BitSimulation::getStep(int steps, int lane, Grid space)
+{
+    simulationStep result;
+    result.path = getPath(steps, lane);
+    result.space.g = space;
+    result.space.h.top = result.space.h.left = result.space.h.width = result.space.h.height = 0;
+    result.matched = false;
+    return result;
+}
+
+
+//! Returns the stable spaces of a row.
+/*!
+   \param lane the row, as given to simulate.
+   \return The list of stable spaces of the row.
+*/
+list<simulationStep> BitSimulation::getStableLayouts(int lane)
+{
+    return stable[lane];
+}
+
+
+//! Returns the forbidden spaces of a row.
+/*!
+   \param lane the row, as given to simulate.
+   \return The list of forbidden spaces of the row.
+*/
+list<simulationStep> BitSimulation::getForbiddenLayouts(int lane)
+{
+    return forbidden[lane];
+}
+
+
+//! Returns the cycles of a row.
+/*!
+   \param lane the row, as given to simulate.
+   \return The list of cycles of the row.
+*/
+list<simulationStep> BitSimulation::getCycles(int lane)
+{
+    return cycles[lane];
+}
+
+
+//! Returns the out of bounds spaces of a row.
+/*!
+   \param lane the row, as given to simulate.
+   \return The list of out of bounds spaces of the row.
+*/
+list<simulationStep> BitSimulation::getOutOfBounds(int lane)
+{
+    return outOfBounds[lane];
+}
+
+
+//! Member accessor.
+/*!
+   \return The rules placed at every coordinate, as placed by the last
+   call to buildInstances.
+*/
+vector<bitInstance> &BitSimulation::getRuleInstances()
+{
+    return rules;
+}
+
+
+//! Member accessor.
+/*!
+   \return The forbidden patterns placed at every coordinate, as placed
+   by the last call to buildInstances.
+*/
+vector<bitInstance> &BitSimulation::getPatternInstances()
+{
+    return patterns;
+}
+
+
+//! Member accessor.
+/*!
+   \param index the rule index.
+   \return The rule.
+*/
+Rule *BitSimulation::getRule(int index)
+{
+    return ruleSet[index];
+}
@@ -0,0 +1,121 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class BitSimulation
+ * \brief Bit-sliced simulation of many rows at once.
+ * 
+ * When only one rule is applicable at every step, the simulation of a
+ * row is a single path and the rows of a truth table follow similar
+ * paths. This class simulates up to 64 rows at once: every cell is stored
+ * as a word whose bit k is the status of the cell in row k, so rules and
+ * forbidden patterns are matched and applied with bitwise operations for
+ * all the rows at the same time. A row leaves the pass as soon as it
+ * reaches a stable space, a cycle, a forbidden pattern or an out of bounds
+ * space. Rows where two rules are applicable at the same step are left
+ * for the normal simulation.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef BITSIMULATION_HPP_
+#define BITSIMULATION_HPP_
+
+#include "grid.hpp"
+#include "rule.hpp"
+#include "forbiddenPattern.hpp"
+#include "simulationStep.hpp"
+#include <stdint.h>
+#include <vector>
+#include <list>
+
+//! Number of rows simulated at once.
+#define BITSLICE_LANES 64
+//! Maximum number of steps of a bit-sliced simulation.
+#define BITSLICE_STEPS 1024
+
+using namespace std;
+
+
+//! Bit-sliced instance struct.
+/*! A rule or a forbidden pattern placed at a coordinate of a space. The
+    cells are indexes of the space cells. */
+struct bitInstance
+{
+    int index; /*!< Rule index. */
+    coordinate c; /*!< Coordinate relative to the space surrounded by disabled cells. */
+    vector<int> enabled; /*!< Cells that must be enabled. */
+    vector<int> disabled; /*!< Cells that must be disabled or not available. */
+    vector<int> space; /*!< Cells that must be available for use. */
+    vector<int> writes; /*!< Cells changed by the rule. */
+    vector<int> values; /*!< Status written on every changed cell. */
+    vector<int> bounds; /*!< Cells where the rule puts molecules. */
+    bool outOfBounds; /*!< True if the rule puts a molecule out of the space. */
+};
+
+
+class BitSimulation
+{
+public:
+    BitSimulation(list<Rule> *rules, list<ForbiddenPattern> *patterns);
+    virtual ~BitSimulation();
+    bool isSupported();
+    uint64_t simulate(vector<Grid> &spaces);
+    list<simulationStep> getStableLayouts(int lane);
+    list<simulationStep> getForbiddenLayouts(int lane);
+    list<simulationStep> getCycles(int lane);
+    list<simulationStep> getOutOfBounds(int lane);
+    void buildInstances(int width, int height);
+    vector<bitInstance> &getRuleInstances();
+    vector<bitInstance> &getPatternInstances();
+    Rule *getRule(int index);
+
+private:
+    Grid getGrid(vector<uint64_t> &enabled, vector<uint64_t> &noSpace, int lane);
+    list<spaceHighlighted> getPath(int steps, int lane);
+    simulationStep getStep(int steps, int lane, Grid space);
+    //! Rules of the set, in the list order.
+    vector<Rule*> ruleSet;
+    //! Forbidden patterns.
+    vector<Grid> patternSet;
+    //! Can the rules and patterns be simulated bit-sliced?
+    bool supported;
+    //! Width of the spaces.
+    int width;
+    //! Height of the spaces.
+    int height;
+    //! Rules placed at every coordinate of the spaces.
+    vector<bitInstance> rules;
+    //! Forbidden patterns placed at every coordinate of the spaces.
+    vector<bitInstance> patterns;
+    //! Enabled cells of every step.
+    vector< vector<uint64_t> > enabledSteps;
+    //! Not available cells of every step.
+    vector< vector<uint64_t> > noSpaceSteps;
+    //! Rules fired at every step and the rows where they fired.
+    vector< vector< pair<int, uint64_t> > > firedSteps;
+    //! Stable spaces of every row.
+    vector< list<simulationStep> > stable;
+    //! Forbidden spaces of every row.
+    vector< list<simulationStep> > forbidden;
+    //! Cycles of every row.
+    vector< list<simulationStep> > cycles;
+    //! Out of bounds spaces of every row.
+    vector< list<simulationStep> > outOfBounds;
+};
+
+#endif /*BITSIMULATION_HPP_*/
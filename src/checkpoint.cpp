@@ -0,0 +1,471 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "checkpoint.hpp"
+#include <wx/filename.h>
+#include <wx/utils.h>
+#include <fstream>
+#include <iterator>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+
+//! Constructor.
+Checkpoint::Checkpoint()
+{
+    data = CHECKPOINT_MAGIC;
+    writeInt(CHECKPOINT_VERSION);
+    position = data.size();
+}
+
+
+//! Destructor.
+Checkpoint::~Checkpoint()
+{
+}
+
+
+//! Saves the values written to a file.
+/*!
+   The values are written to a temporary file which then replaces the
+   file, so the file is never left half written. The temporary file is
+   named after the host and the process, which share the directory when
+   it is on a network file system. The temporary file is
+   synced before the rename and the directory after it, so a crash of the
+   system leaves either the old checkpoint or the new one.
+   \param fileName the file name.
+   \return True iif the file was saved.
+*/
+bool Checkpoint::save(wxString fileName)
+{
+    wxString tempName = fileName + wxT(".") + wxGetFullHostName() + wxString::Format(wxT(".%lu.tmp"), wxGetProcessId());
+    int file = open(tempName.mb_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0)
+    {
+        return false;
+    }
+    bool written = writeFile(file) && fsync(file) == 0;
+    written = close(file) == 0 && written;
+    if (!written || !wxRenameFile(tempName, fileName, true))
+    {
+        wxRemoveFile(tempName);
+        return false;
+    }
+    wxString directoryName = wxFileName(fileName).GetPath();
+    int directory = open(directoryName.IsEmpty() ? "." : (const char *)directoryName.mb_str(), O_RDONLY);
+    if (directory < 0)
+    {
+        return false;
+    }
+    written = fsync(directory) == 0;
+    close(directory);
+    return written;
+}
+
+
+//! Writes the values to a file.
+/*!
+   \param file the descriptor of the file.
+   \return True iif every value was written.
+*/
+bool Checkpoint::writeFile(int file)
+{
+    size_t written = 0;
+    while (written < data.size())
+    {
+        ssize_t bytes = write(file, data.data() + written, data.size() - written);
+        if (bytes < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (bytes <= 0)
+        {
+            return false;
+        }
+        written += bytes;
+    }
+    return true;
+}
+
+
+//! Loads the values of a file.
+/*!
+   \param fileName the file name.
+   \return True iif the file is a checkpoint of this version.
+*/
+bool Checkpoint::load(wxString fileName)
+{
+    ifstream file(fileName.mb_str(), ios::in | ios::binary);
+    if (!file)
+    {
+        return false;
+    }
+    data.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+    position = 0;
+    string magic = CHECKPOINT_MAGIC;
+    if (data.compare(0, magic.size(), magic) != 0)
+    {
+        return false;
+    }
+    position = magic.size();
+    int version;
+    return readInt(&version) && version == CHECKPOINT_VERSION;
+}
+
+
+//! Writes an integer.
+/*!
+   \param value the integer, stored in four bytes, least significant first.
+*/
+void Checkpoint::writeInt(int value)
+{
+    uint32_t bits = (uint32_t)value;
+    for (int i = 0; i < 4; i++)
+    {
+        data += (char)((bits >> (8 * i)) & 0xff);
+    }
+}
+
+
+//! Writes a hash.
+/*!
+   \param value the hash, stored in eight bytes, least significant first.
+*/
+void Checkpoint::writeHash(uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        data += (char)((value >> (8 * i)) & 0xff);
+    }
+}
+
+
+//! Writes a grid.
+/*!
+   \param grid the grid, its size followed by a byte for every cell.
+*/
+void Checkpoint::writeGrid(Grid &grid)
+{
+    writeInt(grid.getWidth());
+    writeInt(grid.getHeight());
+    for (int i = 0; i < grid.getWidth(); i++)
+    {
+        for (int j = 0; j < grid.getHeight(); j++)
+        {
+            data += (char)grid(i, j);
+        }
+    }
+}
+
+
+//! Writes a list of grids.
+/*!
+   \param grids the grids.
+*/
+void Checkpoint::writeGrids(list<Grid> &grids)
+{
+    writeInt(grids.size());
+    for (list<Grid>::iterator i = grids.begin(); i != grids.end(); i++)
+    {
+        writeGrid(*i);
+    }
+}
+
+
+//! Writes a list of simulation steps.
+/*!
+   The rule applyings are stored by the position of their rule in the list.
+   \param steps the simulation steps.
+*/
+void Checkpoint::writeSteps(list<simulationStep> &steps)
+{
+    writeInt(steps.size());
+    for (list<simulationStep>::iterator i = steps.begin(); i != steps.end(); i++)
+    {
+        writeInt((*i).path.size());
+        for (list<spaceHighlighted>::iterator j = (*i).path.begin(); j != (*i).path.end(); j++)
+        {
+            writeSpace(*j);
+        }
+        writeSpace((*i).space);
+        writeInt((*i).matched);
+        writeInt((*i).applicable.size());
+        for (list<ruleApplying>::iterator j = (*i).applicable.begin(); j != (*i).applicable.end(); j++)
+        {
+            writeInt((*j).index);
+            writeInt((*j).c.x);
+            writeInt((*j).c.y);
+        }
+    }
+}
+
+
+//! Writes a list of hashes.
+/*!
+   \param hashes the hashes.
+*/
+void Checkpoint::writeHashes(vector<unsigned long> &hashes)
+{
+    writeInt(hashes.size());
+    for (unsigned int i = 0; i < hashes.size(); i++)
+    {
+        writeHash(hashes[i]);
+    }
+}
+
+
+//! Writes a list of flags.
+/*!
+   \param values the flags, a byte each.
+*/
+void Checkpoint::writeBools(vector<bool> &values)
+{
+    writeInt(values.size());
+    for (unsigned int i = 0; i < values.size(); i++)
+    {
+        data += (char)values[i];
+    }
+}
+
+
+//! Reads an integer.
+/*!
+   \param value returns the integer.
+   \return False if the data is over.
+*/
+bool Checkpoint::readInt(int *value)
+{
+    if (position + 4 > data.size())
+    {
+        return false;
+    }
+    uint32_t bits = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        bits |= (uint32_t)(unsigned char)data[position++] << (8 * i);
+    }
+    *value = (int)bits;
+    return true;
+}
+
+
+//! Reads a hash.
+/*!
+   \param value returns the hash.
+   \return False if the data is over.
+*/
+bool Checkpoint::readHash(uint64_t *value)
+{
+    if (position + 8 > data.size())
+    {
+        return false;
+    }
+    *value = 0;
+    for (int i = 0; i < 8; i++)
+    {
+        *value |= (uint64_t)(unsigned char)data[position++] << (8 * i);
+    }
+    return true;
+}
+
+
+//! Reads a grid.
+/*!
+   \param grid returns the grid.
+   \return False if the data is over or wrong.
+*/
+bool Checkpoint::readGrid(Grid *grid)
+{
+    int width, height;
+    if (!readInt(&width) || !readInt(&height) || width <= 0 || height <= 0 || position + (unsigned int)(width * height) > data.size())
+    {
+        return false;
+    }
+    *grid = Grid(width, height);
+    for (int i = 0; i < width; i++)
+    {
+        for (int j = 0; j < height; j++)
+        {
+            (*grid)(i, j) = (unsigned char)data[position++];
+        }
+    }
+    return true;
+}
+
+
+//! Reads a list of grids.
+/*!
+   \param grids returns the grids.
+   \return False if the data is over or wrong.
+*/
+bool Checkpoint::readGrids(list<Grid> *grids)
+{
+    int count;
+    if (!readCount(&count))
+    {
+        return false;
+    }
+    grids->clear();
+    for (int i = 0; i < count; i++)
+    {
+        Grid grid;
+        if (!readGrid(&grid))
+        {
+            return false;
+        }
+        grids->push_back(grid);
+    }
+    return true;
+}
+
+
+//! Reads a list of simulation steps.
+/*!
+   \param steps returns the simulation steps.
+   \param rules the rules, in the list order, the applyings refer to.
+   \return False if the data is over or wrong.
+*/
+bool Checkpoint::readSteps(list<simulationStep> *steps, vector<Rule *> &rules)
+{
+    int count;
+    if (!readCount(&count))
+    {
+        return false;
+    }
+    steps->clear();
+    for (int i = 0; i < count; i++)
+    {
+        simulationStep step;
+        int length, matched, applicable;
+        if (!readCount(&length))
+        {
+            return false;
+        }
+        for (int j = 0; j < length; j++)
+        {
+            spaceHighlighted space;
+            if (!readSpace(&space))
+            {
+                return false;
+            }
+            step.path.push_back(space);
+        }
+        if (!readSpace(&step.space) || !readInt(&matched) || !readCount(&applicable))
+        {
+            return false;
+        }
+        step.matched = matched != 0;
+        for (int j = 0; j < applicable; j++)
+        {
+            ruleApplying applying;
+            if (!readInt(&applying.index) || !readInt(&applying.c.x) || !readInt(&applying.c.y) || applying.index < 0 || applying.index >= (int)rules.size())
+            {
+                return false;
+            }
+            applying.rule = rules[applying.index];
+            step.applicable.push_back(applying);
+        }
+        steps->push_back(step);
+    }
+    return true;
+}
+
+
+//! Reads a list of hashes.
+/*!
+   \param hashes returns the hashes.
+   \return False if the data is over or wrong.
+*/
+bool Checkpoint::readHashes(vector<unsigned long> *hashes)
+{
+    int count;
+    if (!readCount(&count))
+    {
+        return false;
+    }
+    hashes->resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        uint64_t hash;
+        if (!readHash(&hash))
+        {
+            return false;
+        }
+        (*hashes)[i] = (unsigned long)hash;
+    }
+    return true;
+}
+
+
+//! Reads a list of flags.
+/*!
+   \param values returns the flags.
+   \return False if the data is over or wrong.
+*/
+bool Checkpoint::readBools(vector<bool> *values)
+{
+    int count;
+    if (!readCount(&count) || position + count > data.size())
+    {
+        return false;
+    }
+    values->resize(count);
+    for (int i = 0; i < count; i++)
+    {
+        (*values)[i] = data[position++] != 0;
+    }
+    return true;
+}
+
+
+//! Writes a space and its highlighted zone.
+/*!
+   \param space the space.
+*/
+void Checkpoint::writeSpace(spaceHighlighted &space)
+{
+    writeGrid(space.g);
+    writeInt(space.h.top);
+    writeInt(space.h.left);
+    writeInt(space.h.width);
+    writeInt(space.h.height);
+}
+
+
+//! Reads a space and its highlighted zone.
+/*!
+   \param space returns the space.
+   \return False if the data is over or wrong.
+*/
+bool Checkpoint::readSpace(spaceHighlighted *space)
+{
+    return readGrid(&space->g) && readInt(&space->h.top) && readInt(&space->h.left) && readInt(&space->h.width) && readInt(&space->h.height);
+}
+
+
+//! Reads the number of elements of a list.
+/*!
+   \param count returns the number.
+   \return False if the data is over or the number is negative.
+*/
+bool Checkpoint::readCount(int *count)
+{
+    return readInt(count) && *count >= 0;
+}
@@ -0,0 +1,88 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class Checkpoint
+ * \brief Compact binary image of a simulation in progress.
+ * 
+ * The simulation controller and the row simulation write their state
+ * (the spaces still to simulate, the spaces reached and the events found)
+ * to a checkpoint, which is saved from time to time so a long simulation
+ * can go on after the process dies. The values are stored in a buffer
+ * with a fixed byte order and saved to a temporary file that is synced
+ * to disk and then renamed, so the file on disk is always a complete
+ * checkpoint, even after a crash of the system.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef CHECKPOINT_HPP_
+#define CHECKPOINT_HPP_
+
+#include <wx/wx.h>
+#include "grid.hpp"
+#include "rule.hpp"
+#include "simulationStep.hpp"
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <list>
+
+//! First bytes of the checkpoint files.
+#define CHECKPOINT_MAGIC "NCKP"
+//! Version of the checkpoint format.
+#define CHECKPOINT_VERSION 1
+//! Milliseconds between two checkpoints of a simulation.
+#define CHECKPOINT_INTERVAL 60000
+
+using namespace std;
+
+class Checkpoint
+{
+public:
+    Checkpoint();
+    virtual ~Checkpoint();
+    bool save(wxString fileName);
+    bool load(wxString fileName);
+    void writeInt(int value);
+    void writeHash(uint64_t value);
+    void writeGrid(Grid &grid);
+    void writeGrids(list<Grid> &grids);
+    void writeSteps(list<simulationStep> &steps);
+    void writeHashes(vector<unsigned long> &hashes);
+    void writeBools(vector<bool> &values);
+    bool readInt(int *value);
+    bool readHash(uint64_t *value);
+    bool readGrid(Grid *grid);
+    bool readGrids(list<Grid> *grids);
+    bool readSteps(list<simulationStep> *steps, vector<Rule *> &rules);
+    bool readHashes(vector<unsigned long> *hashes);
+    bool readBools(vector<bool> *values);
+
+private:
+    bool writeFile(int file);
+    void writeSpace(spaceHighlighted &space);
+    bool readSpace(spaceHighlighted *space);
+    bool readCount(int *count);
+    
+    //! Values written or loaded.
+    string data;
+    //! Position of the next value to read.
+    unsigned int position;
+};
+
+#endif /*CHECKPOINT_HPP_*/
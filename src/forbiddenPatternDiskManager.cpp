@@ -183,9 +183,33 @@ bool ForbiddenPatternDiskManager::openFPs(wxString fileName)
     if (!fb.open (fileName.mb_str(), ios::in))
     {
         cout << "Error opening file" << endl;
+        delete FPList;
         return false;
     }
     istream *is = new istream(&fb);
+    bool result = readFPs(is, FPList);
+    delete is;
+    fb.close();
+    if (result)
+    {
+        //We return the patterns read to be added to the controller
+        returnFPs(FPList);
+    }
+    delete FPList;
+    return result;
+}
+
+
+//! Reads the patterns of a forbidden patterns file from a stream.
+/*!
+   The patterns are not returned to the controller, so this can be used
+   without one.
+   \param is the input stream.
+   \param FPList list of patterns where the patterns read are appended.
+   \return True iif the stream was read correctly.
+*/
+bool ForbiddenPatternDiskManager::readFPs(istream *is, list<ForbiddenPattern *> *FPList)
+{
     //Flex result
     int result;
     //Pattern width and height
@@ -201,11 +225,7 @@ bool ForbiddenPatternDiskManager::openFPs(wxString fileName)
         if (result != NUMBER)
         {
             cout << "Number expected, file format error" << endl;
-            //Clear all dynamic memory used since we have an error
-            delete FPList;
-            delete is;
             delete lexer;
-            fb.close();
             return false;
         }
         else
@@ -215,11 +235,7 @@ bool ForbiddenPatternDiskManager::openFPs(wxString fileName)
             if (lexer->yylex() != NUMBER) //Not another number
             {
                 cout << "Number expected, file format error" << endl;
-                //Clear all dynamic memory used since we have an error
-                delete FPList;
-                delete is;
                 delete lexer;
-                fb.close();
                 return false;
             }
             else
@@ -229,11 +245,7 @@ bool ForbiddenPatternDiskManager::openFPs(wxString fileName)
                 if (lexer->yylex() != NEGATION)
                     {
                         cout << "! expected, file format error" << endl;
-                        //Clear all dynamic memory used since we have an error
-                        delete FPList;
-                        delete is;
                         delete lexer;
-                        fb.close();
                         return false;
                     }
                 else
@@ -241,11 +253,7 @@ bool ForbiddenPatternDiskManager::openFPs(wxString fileName)
                     //We try to read a grid
                     if (!readFP(width, height, FPList, lexer))//Wrong rule format
                     {
-                        //Clear all dynamic memory used since we have an error
-                        delete FPList;
-                        delete is;
                         delete lexer;
-                        fb.close();
                         return false;
                     }
                 }
@@ -253,10 +261,7 @@ bool ForbiddenPatternDiskManager::openFPs(wxString fileName)
             result = lexer->yylex();
         }
     }
-    fb.close();
-    //We return the patterns read to be added to the controller
-    returnFPs(FPList);
-    delete FPList;
+    delete lexer;
     return true;
 }
 
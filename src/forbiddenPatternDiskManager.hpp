@@ -48,6 +48,7 @@ public:
 	virtual ~ForbiddenPatternDiskManager();
     bool saveFPs(list<ForbiddenPattern*> FPs, wxString fileName);
     bool openFPs(wxString fileName);
+    bool readFPs(istream *is, list<ForbiddenPattern *> *FPList);
     
 private:
     //! Forbidden pattern controller.
@@ -227,3 +227,25 @@ bool Grid::operator ==(Grid grid)
     }
     return true;
 }
+
+
+//! Hash value.
+/*!
+   FNV-1a hash of the grid size and cell status. Equal grids have equal
+   hashes, so it can be used to index grids before comparing them.
+  \return The hash value of the grid.
+*/
+unsigned long Grid::getHash() const
+{
+    unsigned long hash = 2166136261UL;
+    hash = (hash ^ (unsigned long)width) * 16777619UL;
+    hash = (hash ^ (unsigned long)height) * 16777619UL;
+    for (int i = 0; i < width; i++)
+    {
+        for (int j = 0; j < height; j++)
+        {
+            hash = (hash ^ (unsigned long)cells[i][j]) * 16777619UL;
+        }
+    }
+    return hash;
+}
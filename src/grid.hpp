@@ -50,6 +50,14 @@ using namespace std;
 
 typedef vector< vector<int> > matrix;
 
+//! Coordinate struct.
+/*! This struct represents a 2D coordinate. */
+struct coordinate
+{
+    int x; /*!< X coordinate. */
+    int y; /*!< Y coordinate. */
+};
+
 class Grid
 {
 public:
@@ -68,6 +76,7 @@ public:
     bool isInput(int x, int y);
     bool isOutput(int x, int y);
     bool isSpace(int x, int y);
+    unsigned long getHash() const;
 	
 private:
     //! Matrix of cells.
@@ -0,0 +1,64 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "simulation.hpp"
+
+using namespace std;
+
+//! Does nothing, there is no view without wxWidgets.
+void Simulation::updateView()
+{
+}
+
+
+//! Does nothing, there is no view without wxWidgets.
+void Simulation::showStart(Grid &, bool)
+{
+}
+
+
+//! Does nothing, there is no view without wxWidgets.
+void Simulation::showSpace(Grid &)
+{
+}
+
+
+//! Does nothing, there is no view without wxWidgets.
+void Simulation::showInfo(const char *, ...)
+{
+}
+
+
+//! Does nothing, there is no view without wxWidgets.
+void Simulation::showRuleGraph(list<ruleApplying>)
+{
+}
+
+
+//! Does nothing, there is no controller without wxWidgets.
+void Simulation::notifyFinished()
+{
+}
+
+
+//! Does nothing, there is no controller without wxWidgets.
+void Simulation::notifyStep()
+{
+}
@@ -0,0 +1,501 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "incrementalSimulation.hpp"
+
+using namespace std;
+
+//! Constructor.
+/*!
+   The rules and patterns are matched with the ones of the last simulation.
+   The lists are referenced, not copied, so they must outlive the object.
+   \param last the results of the last simulation.
+   \param rules the rule list to be applied.
+   \param patterns the forbidden pattern list to be found.
+*/
+IncrementalSimulation::IncrementalSimulation(lastSimulation *last, list<Rule> *rules, list<ForbiddenPattern> *patterns)
+{
+    this->last = last;
+    lastGraph = new RuleGraph(&last->rules);
+    graph = new RuleGraph(rules);
+    
+    //Every rule is matched with an equal one of the last simulation
+    vector<Rule *> lastRules;
+    for (list<Rule>::iterator i = last->rules.begin(); i != last->rules.end(); i++)
+    {
+        lastRules.push_back(&(*i));
+    }
+    vector<bool> used(lastRules.size(), false);
+    for (list<Rule>::iterator i = rules->begin(); i != rules->end(); i++)
+    {
+        ruleSet.push_back(&(*i));
+    }
+    sameRules = (ruleSet.size() == lastRules.size());
+    for (unsigned int n = 0; n < ruleSet.size(); n++)
+    {
+        int found = -1;
+        for (unsigned int o = 0; o < lastRules.size() && found < 0; o++)
+        {
+            coordinate anchor = ruleSet[n]->getAnchor();
+            coordinate lastAnchor = lastRules[o]->getAnchor();
+            if (!used[o] && (*ruleSet[n]) == (*lastRules[o]) && anchor.x == lastAnchor.x && anchor.y == lastAnchor.y)
+            {
+                found = o;
+            }
+        }
+        if (found >= 0)
+        {
+            used[found] = true;
+            keptRules.push_back(n);
+        }
+        else
+        {
+            addedRules.push_back(n);
+        }
+        sameRules = sameRules && found == (int)n;
+    }
+    for (unsigned int o = 0; o < lastRules.size(); o++)
+    {
+        if (!used[o])
+        {
+            removedRules.push_back(o);
+        }
+    }
+    
+    //The same for the patterns
+    for (list<ForbiddenPattern>::iterator i = last->patterns.begin(); i != last->patterns.end(); i++)
+    {
+        lastPatternCells.push_back((*i).getGrid());
+    }
+    used.assign(lastPatternCells.size(), false);
+    for (list<ForbiddenPattern>::iterator i = patterns->begin(); i != patterns->end(); i++)
+    {
+        int found = -1;
+        int o = 0;
+        for (list<ForbiddenPattern>::iterator j = last->patterns.begin(); j != last->patterns.end() && found < 0; j++)
+        {
+            if (!used[o] && (*i) == (*j))
+            {
+                found = o;
+            }
+            o++;
+        }
+        if (found >= 0)
+        {
+            used[found] = true;
+            keptPatterns.push_back(patternCells.size());
+        }
+        else
+        {
+            addedPatterns.push_back(patternCells.size());
+        }
+        patternCells.push_back((*i).getGrid());
+    }
+    for (unsigned int o = 0; o < lastPatternCells.size(); o++)
+    {
+        if (!used[o])
+        {
+            removedPatterns.push_back(o);
+        }
+    }
+    
+    //The spaces reused from the cache were simulated by some row
+    for (unsigned int r = 0; r < last->processed.size(); r++)
+    {
+        for (list<Grid>::iterator i = last->processed[r].begin(); i != last->processed[r].end(); i++)
+        {
+            list<Grid *> &same = spaces[(*i).getHash()];
+            if (!contains(same, *i))
+            {
+                same.push_back(&(*i));
+            }
+        }
+    }
+}
+
+
+//! Destructor.
+IncrementalSimulation::~IncrementalSimulation()
+{
+    delete lastGraph;
+    delete graph;
+}
+
+
+//! Reuses the results of a row of the last simulation.
+/*!
+   \param row the row.
+   \param space the initial space of the row.
+   \param frozen the cells left out of the row, indexed by x * height + y.
+   \return True if the edits do not affect the row, then its results are
+   the ones of the last simulation with the edited cells replaced.
+*/
+bool IncrementalSimulation::reuse(int row, Grid space, vector<bool> frozen)
+{
+    processed.clear();
+    stable.clear();
+    cycles.clear();
+    forbidden.clear();
+    outOfBounds.clear();
+    if (row >= (int)last->simulated.size() || !last->simulated[row] || last->processed[row].empty() || last->frozen[row] != frozen)
+    {
+        return false;
+    }
+    //A failure stops the row, so the spaces explored before it depend on
+    //the order of the rules
+    if (!sameRules && (!last->forbidden[row].empty() || !last->outOfBounds[row].empty()))
+    {
+        return false;
+    }
+    Grid &initial = last->processed[row].front();
+    if (initial.getWidth() != space.getWidth() || initial.getHeight() != space.getHeight())
+    {
+        return false;
+    }
+    edited.clear();
+    status.clear();
+    for (int i = 0; i < space.getWidth(); i++)
+    {
+        for (int j = 0; j < space.getHeight(); j++)
+        {
+            if (initial(i, j) != space(i, j))
+            {
+                coordinate c;
+                c.x = i;
+                c.y = j;
+                edited.push_back(c);
+                status.push_back(space(i, j));
+            }
+        }
+    }
+    lastGraph->setFrozen(frozen);
+    graph->setFrozen(frozen);
+    
+    //Every space the row reached, simulated by it or reused from the cache
+    list<Grid *> reached;
+    map< unsigned long, list<Grid *> > rowSpaces;
+    for (list<Grid>::iterator i = last->processed[row].begin(); i != last->processed[row].end(); i++)
+    {
+        list<Grid *> &same = rowSpaces[(*i).getHash()];
+        if (!contains(same, *i))
+        {
+            same.push_back(&(*i));
+            reached.push_back(&(*i));
+        }
+    }
+    for (unsigned int i = 0; i < last->reached[row].size(); i++)
+    {
+        //The spaces reused from the cache are only known by their hash, so
+        //the row is simulated again if the hash is not of a single space
+        map< unsigned long, list<Grid *> >::iterator found = spaces.find(last->reached[row][i]);
+        if (found == spaces.end() || (*found).second.size() != 1)
+        {
+            return false;
+        }
+        Grid *space = (*found).second.front();
+        list<Grid *> &same = rowSpaces[last->reached[row][i]];
+        if (!contains(same, *space))
+        {
+            same.push_back(space);
+            reached.push_back(space);
+        }
+    }
+    
+    for (list<Grid *>::iterator i = reached.begin(); i != reached.end(); i++)
+    {
+        Grid changed = *(*i);
+        replace(changed);
+        if (affected(*(*i), changed))
+        {
+            processed.clear();
+            return false;
+        }
+        processed.push_back(changed);
+    }
+    stable = replace(last->stable[row]);
+    cycles = replace(last->cycles[row]);
+    forbidden = replace(last->forbidden[row]);
+    outOfBounds = replace(last->outOfBounds[row]);
+    return true;
+}
+
+
+//! Finds a space in a list of spaces with the same hash.
+/*!
+   \param spaces the spaces.
+   \param space the space to find.
+   \return True iif a space of the list is equal to the space.
+*/
+bool IncrementalSimulation::contains(list<Grid *> &spaces, Grid &space)
+{
+    for (list<Grid *>::iterator i = spaces.begin(); i != spaces.end(); i++)
+    {
+        if (*(*i) == space)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//! Tells if a space behaves differently after the edits.
+/*!
+   \param space the space of the last simulation.
+   \param edited the space with the edited cells replaced.
+   \return True if a removed rule or pattern matches the space, an added one
+   matches the edited space or any of them has a placement over an edited
+   cell that matches either.
+*/
+bool IncrementalSimulation::affected(Grid &space, Grid &edited)
+{
+    for (unsigned int k = 0; k < removedRules.size(); k++)
+    {
+        if (!lastGraph->findApplicable(space, removedRules[k]).empty())
+        {
+            return true;
+        }
+    }
+    for (unsigned int k = 0; k < addedRules.size(); k++)
+    {
+        if (!graph->findApplicable(edited, addedRules[k]).empty())
+        {
+            return true;
+        }
+    }
+    for (unsigned int k = 0; k < removedPatterns.size(); k++)
+    {
+        if (matchesAnywhere(space, lastPatternCells[removedPatterns[k]]))
+        {
+            return true;
+        }
+    }
+    for (unsigned int k = 0; k < addedPatterns.size(); k++)
+    {
+        if (matchesAnywhere(edited, patternCells[addedPatterns[k]]))
+        {
+            return true;
+        }
+    }
+    
+    //Only the placements over an edited cell can change
+    for (unsigned int e = 0; e < this->edited.size(); e++)
+    {
+        coordinate c = this->edited[e];
+        for (unsigned int k = 0; k < keptRules.size(); k++)
+        {
+            Rule *rule = ruleSet[keptRules[k]];
+            for (int x = c.x; x < c.x + rule->getWidth(); x++)
+            {
+                for (int y = c.y; y < c.y + rule->getHeight(); y++)
+                {
+                    if (graph->applicable(space, keptRules[k], x, y) || graph->applicable(edited, keptRules[k], x, y))
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+        for (unsigned int k = 0; k < keptPatterns.size(); k++)
+        {
+            Grid &pattern = patternCells[keptPatterns[k]];
+            for (int left = c.x - pattern.getWidth() + 1; left <= c.x; left++)
+            {
+                for (int top = c.y - pattern.getHeight() + 1; top <= c.y; top++)
+                {
+                    if (matches(space, pattern, left, top) || matches(edited, pattern, left, top))
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+
+//! Tells if a forbidden pattern matches a space at a position.
+/*!
+   The cells out of the space are disabled, as in the simulation.
+   \param space the space.
+   \param pattern the pattern cells.
+   \param left the left column of the pattern on the space.
+   \param top the top row of the pattern on the space.
+   \return True iif the pattern matches.
+*/
+bool IncrementalSimulation::matches(Grid &space, Grid &pattern, int left, int top)
+{
+    for (int i = 0; i < pattern.getWidth(); i++)
+    {
+        for (int j = 0; j < pattern.getHeight(); j++)
+        {
+            int sx = left + i;
+            int sy = top + j;
+            int cell = nDISABLED;
+            if (sx >= 0 && sx < space.getWidth() && sy >= 0 && sy < space.getHeight())
+            {
+                cell = space(sx, sy);
+            }
+            if (pattern(i, j) == nENABLED || pattern(i, j) == nDISABLED)
+            {
+                if (cell != pattern(i, j))
+                {
+                    return false;
+                }
+            }
+            else if (cell == nNOSPACE)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+//! Tells if a forbidden pattern matches a space anywhere.
+/*!
+   \param space the space.
+   \param pattern the pattern cells.
+   \return True iif the pattern matches at some position.
+*/
+bool IncrementalSimulation::matchesAnywhere(Grid &space, Grid &pattern)
+{
+    for (int left = 1 - pattern.getWidth(); left < space.getWidth(); left++)
+    {
+        for (int top = 1 - pattern.getHeight(); top < space.getHeight(); top++)
+        {
+            if (matches(space, pattern, left, top))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+//! Replaces the edited cells of a space by their new status.
+/*!
+   \param space the space.
+*/
+void IncrementalSimulation::replace(Grid &space)
+{
+    for (unsigned int k = 0; k < edited.size(); k++)
+    {
+        space(edited[k].x, edited[k].y) = status[k];
+    }
+}
+
+
+//! Replaces the edited cells of the spaces of some simulation steps.
+/*!
+   The rule applyings of the steps refer to the rules of the last
+   simulation, so they are left out.
+   \param steps the simulation steps.
+   \return The steps with the edited cells replaced.
+*/
+list<simulationStep> IncrementalSimulation::replace(list<simulationStep> &steps)
+{
+    list<simulationStep> result = steps;
+    for (list<simulationStep>::iterator i = result.begin(); i != result.end(); i++)
+    {
+        for (list<spaceHighlighted>::iterator j = (*i).path.begin(); j != (*i).path.end(); j++)
+        {
+            replace((*j).g);
+        }
+        replace((*i).space.g);
+        (*i).applicable.clear();
+        (*i).matched = false;
+    }
+    return result;
+}
+
+
+//! Returns the spaces of the row reused.
+/*!
+   They include the spaces the last simulation reused from the cache.
+   \return The spaces, with the edited cells replaced.
+*/
+list<Grid> IncrementalSimulation::getProcessedLayouts()
+{
+    return processed;
+}
+
+
+//! Returns the stable spaces of the row reused.
+/*!
+   \return The stable spaces, with the edited cells replaced.
+*/
+list<simulationStep> IncrementalSimulation::getStableLayouts()
+{
+    return stable;
+}
+
+
+//! Returns the cycles of the row reused.
+/*!
+   \return The cycles, with the edited cells replaced.
+*/
+list<simulationStep> IncrementalSimulation::getCycles()
+{
+    return cycles;
+}
+
+
+//! Returns the forbidden pattern spaces of the row reused.
+/*!
+   \return The forbidden pattern spaces, with the edited cells replaced.
+*/
+list<simulationStep> IncrementalSimulation::getForbiddenLayouts()
+{
+    return forbidden;
+}
+
+
+//! Returns the out of bounds spaces of the row reused.
+/*!
+   \return The out of bounds spaces, with the edited cells replaced.
+*/
+list<simulationStep> IncrementalSimulation::getOutOfBounds()
+{
+    return outOfBounds;
+}
+
+
+//! Returns the number of rules changed since the last simulation.
+/*!
+   \return The rules removed plus the rules added.
+*/
+int IncrementalSimulation::getChangedRules()
+{
+    return removedRules.size() + addedRules.size();
+}
+
+
+//! Returns the number of patterns changed since the last simulation.
+/*!
+   \return The patterns removed plus the patterns added.
+*/
+int IncrementalSimulation::getChangedPatterns()
+{
+    return removedPatterns.size() + addedPatterns.size();
+}
@@ -0,0 +1,130 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class IncrementalSimulation
+ * \brief Reuse of the results of the last simulation after an edit.
+ * 
+ * After changing a few cells of the space or a few rules, most rows usually
+ * explore the same spaces as before. A row keeps its last results if no
+ * space it reached has a rule or forbidden pattern placement over an edited
+ * cell, neither with the old nor with the new status of the cell, no
+ * removed rule or pattern matches any of its old spaces and no added one
+ * matches any of its new spaces. Then the edited cells never change and
+ * every space of the new simulation is the old one with the edited cells
+ * replaced, so the old results are reused with the edited cells replaced.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef INCREMENTALSIMULATION_HPP_
+#define INCREMENTALSIMULATION_HPP_
+
+#include "ruleGraph.hpp"
+#include "forbiddenPattern.hpp"
+#include "simulationStep.hpp"
+#include <vector>
+#include <list>
+#include <map>
+
+using namespace std;
+
+
+//! Last simulation struct.
+/*! Results of a simulation kept to reuse them in the next one. */
+struct lastSimulation
+{
+    list<Rule> rules; /*!< Rules simulated. */
+    list<ForbiddenPattern> patterns; /*!< Forbidden patterns simulated. */
+    int semantics; /*!< Rule placements fired by every step. */
+    vector<bool> simulated; /*!< Rows completely simulated by the normal simulation. */
+    vector< vector<bool> > frozen; /*!< Cells left out of every row. */
+    vector< list<Grid> > processed; /*!< Spaces simulated in every row. */
+    vector< vector<unsigned long> > reached; /*!< Hashes of the spaces reused by every row from the cache. */
+    vector< list<simulationStep> > stable; /*!< Stable spaces of every row. */
+    vector< list<simulationStep> > cycles; /*!< Cycles of every row. */
+    vector< list<simulationStep> > forbidden; /*!< Forbidden pattern spaces of every row. */
+    vector< list<simulationStep> > outOfBounds; /*!< Out of bounds spaces of every row. */
+};
+
+
+class IncrementalSimulation
+{
+public:
+    IncrementalSimulation(lastSimulation *last, list<Rule> *rules, list<ForbiddenPattern> *patterns);
+    virtual ~IncrementalSimulation();
+    bool reuse(int row, Grid space, vector<bool> frozen);
+    list<Grid> getProcessedLayouts();
+    list<simulationStep> getStableLayouts();
+    list<simulationStep> getCycles();
+    list<simulationStep> getForbiddenLayouts();
+    list<simulationStep> getOutOfBounds();
+    int getChangedRules();
+    int getChangedPatterns();
+
+private:
+    bool contains(list<Grid *> &spaces, Grid &space);
+    bool affected(Grid &space, Grid &edited);
+    bool matches(Grid &space, Grid &pattern, int left, int top);
+    bool matchesAnywhere(Grid &space, Grid &pattern);
+    void replace(Grid &space);
+    list<simulationStep> replace(list<simulationStep> &steps);
+    //! Results of the last simulation.
+    lastSimulation *last;
+    //! Trigger graph of the rules of the last simulation.
+    RuleGraph *lastGraph;
+    //! Trigger graph of the rules.
+    RuleGraph *graph;
+    //! Rules to simulate, in the list order.
+    vector<Rule *> ruleSet;
+    //! Cells of the forbidden patterns to simulate.
+    vector<Grid> patternCells;
+    //! Cells of the forbidden patterns of the last simulation.
+    vector<Grid> lastPatternCells;
+    //! Index of the rules of the last simulation not simulated any more.
+    vector<int> removedRules;
+    //! Index of the rules not simulated the last time.
+    vector<int> addedRules;
+    //! Index of the rules simulated both times.
+    vector<int> keptRules;
+    //! Index of the patterns of the last simulation not simulated any more.
+    vector<int> removedPatterns;
+    //! Index of the patterns not simulated the last time.
+    vector<int> addedPatterns;
+    //! Index of the patterns simulated both times.
+    vector<int> keptPatterns;
+    //! True if the rules are the same, in the same order.
+    bool sameRules;
+    //! Spaces simulated in the last simulation, by hash.
+    map< unsigned long, list<Grid *> > spaces;
+    //! Cells of the row edited since the last simulation.
+    vector<coordinate> edited;
+    //! New status of the edited cells.
+    vector<int> status;
+    //! Results of the row reused.
+    list<Grid> processed;
+    //! Stable spaces of the row reused.
+    list<simulationStep> stable;
+    //! Cycles of the row reused.
+    list<simulationStep> cycles;
+    //! Forbidden pattern spaces of the row reused.
+    list<simulationStep> forbidden;
+    //! Out of bounds spaces of the row reused.
+    list<simulationStep> outOfBounds;
+};
+
+#endif /*INCREMENTALSIMULATION_HPP_*/
@@ -35,14 +35,6 @@
 #include <vector>
 #include <list>
 
-//! Coordinate struct.
-/*! This struct represents a 2D coordinate. */
-struct coordinate
-{
-    int x; /*!< X coordinate. */
-    int y; /*!< Y coordinate. */
-};
-
 struct rectangle
 {
     coordinate topleft;
@@ -184,9 +184,33 @@ bool LayoutDiskManager::openLayout(wxString fileName)
         return false;
     }
     istream *is = new istream(&fb);
+    bool result = readLayouts(is, &layoutConfig);
+    delete is;
+    fb.close();
+    if (!result)
+    {
+        return false;
+    }
+    returnLayout(layoutConfig);
+ 
+    return true;
+}
+
+
+//! Reads the space of a space file from a stream.
+/*!
+   The space is not returned to the controller, so this can be used
+   without one.
+   \param is the input stream.
+   \param layoutConfig returns the last space of the stream.
+   \return True iif the stream was read correctly and had a space.
+*/
+bool LayoutDiskManager::readLayouts(istream *is, LayoutConfig **layoutConfig)
+{
     int result;
     int width;
     int height;
+    *layoutConfig = NULL;
     FlexLexer* lexer = new yyFlexLexer();
     lexer->switch_streams(is, NULL);
     result = lexer->yylex();
@@ -195,9 +219,7 @@ bool LayoutDiskManager::openLayout(wxString fileName)
         if (result != NUMBER)
         {
             //Number expected, error
-            delete is;
             delete lexer;
-            fb.close();
             return false;
         }
         else
@@ -206,30 +228,25 @@ bool LayoutDiskManager::openLayout(wxString fileName)
             if (lexer->yylex() != NUMBER) //Not another number
             {
                 //Number expected, error
-                delete is;
                 delete lexer;
-                fb.close();
                 return false;
             }
             else
             {
                 height = atoi(lexer->YYText());
-                layoutConfig = readLayout(width, height, lexer);
-                if (!layoutConfig)
+                delete *layoutConfig;
+                *layoutConfig = readLayout(width, height, lexer);
+                if (!*layoutConfig)
                 {
-                    delete is;
                     delete lexer;
-                    fb.close();
                     return false;
                 }
             }
         }
         result = lexer->yylex();
     }
-    fb.close();
-    returnLayout(layoutConfig);
- 
-    return true;
+    delete lexer;
+    return *layoutConfig != NULL;
 }
 
 
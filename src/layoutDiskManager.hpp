@@ -45,6 +45,7 @@ public:
     virtual ~LayoutDiskManager();
     bool saveLayout(LayoutConfig *layoutConfig, wxString fileName);
     bool openLayout(wxString fileName);
+    bool readLayouts(istream *is, LayoutConfig **layoutConfig);
     
 private:
     //! Space controller.
@@ -20,6 +20,7 @@
 
 #include "layoutManager.hpp"
 #include <wx/filename.h>
+#include <algorithm>
 
 //! Constructor.
 /*!
@@ -238,6 +239,20 @@ void LayoutManager::updateTTList(wxArrayString tables)
         }
     }
     
+    vector<subCircuit>::iterator l = subCircuits.begin();
+    while (l != subCircuits.end())
+    {
+        if (!findString(tables, (*l).table))
+        {
+            l = subCircuits.erase(l);
+        }
+        else
+        {
+            l++;
+        }
+    }
+    updateInstanceList();
+    
     //For the new ones we must disable them by default
     for (unsigned int i = 0; i < tables.size(); i++)
     {
@@ -730,8 +745,8 @@ void LayoutManager::FPsChanged()
 
 //! Checks or unchecks a truth table.
 /*!
-   Only one table can be checked, so if checked is true, all other tables
-   are unchecked.
+   Several tables can be checked when they share their input cells, then
+   every row is simulated once and verified against all of them.
    \param table truth table to be (un)checked.
    \param checked true if the table has to be checked, false if has to be
    unchecked.
@@ -743,11 +758,6 @@ bool LayoutManager::tableChecked(wxString table, bool checked)
     {
         return false;
     }
-    for (map<wxString, bool>::iterator i = tableEnabled.begin(); i != tableEnabled.end(); i++)
-    {
-        (*i).second = false;
-        view->checkTable((*i).first, false);
-    }
     tableEnabled[table] = checked;
     view->checkTable(table, checked);
     controller->elementChanged();
@@ -1140,9 +1150,12 @@ void LayoutManager::prepareSimulation()
 
 
 //! Starts the simulation.
-void LayoutManager::startSimulation()
+/*!
+   \param options the options chosen for the simulation.
+*/
+void LayoutManager::startSimulation(simulationOptions options)
 {
-    controller->startSimulation();
+    controller->startSimulation(options);
 }
 
 
@@ -1178,6 +1191,25 @@ TruthTable * LayoutManager::getTableSelected()
 }
 
 
+//! Returns the truth tables checked.
+/*!
+   \return The truth tables checked, the one returned by getTableSelected()
+   first.
+*/
+vector<TruthTable *> LayoutManager::getTablesSelected()
+{
+    vector<TruthTable *> result;
+    for (map<wxString, bool>::iterator i = tableEnabled.begin(); i != tableEnabled.end(); i++)
+    {
+        if ((*i).second)
+        {
+            result.push_back(tableManager->getTable((*i).first));
+        }
+    }
+    return result;
+}
+
+
 //! Returns the input assignation of a table.
 /*!
    \param table the truth table.
@@ -1212,39 +1244,59 @@ vector<coordinate> LayoutManager::getTableOutput(wxString table)
 
 //! Checks the validity of the space to be simulated.
 /*!
-   \return True iif the space is ready to be simulated. This is, all the inputs
-   and outputs of the truth table checked are assigned, and there is a
-   truth table checked.
+   \return True iif the space is ready to be simulated. This is, there is
+   a truth table checked, all the inputs and outputs of the truth tables
+   checked are assigned, and all of them have the same input cells.
 */
 bool LayoutManager::checkLayout()
 {
     bool result = false;
-    wxString tableChecked;
-    //Check there's a table selected
+    wxString firstTable;
     for (map<wxString, bool>::iterator i = tableEnabled.begin(); i != tableEnabled.end(); i++)
     {
-        if ((*i).second)
+        if (!(*i).second)
+        {
+            continue;
+        }
+        wxString tableChecked = (*i).first;
+        if (!result)
         {
             result = true;
-            tableChecked = (*i).first;
+            firstTable = tableChecked;
         }
-    }
-    
-    //Check the IO of the selected table
-    if (result)
-    {
-        for (unsigned int i = 0; i < tableInputs[tableChecked].size(); i++)
+        //Check the IO of the checked table
+        for (unsigned int j = 0; j < tableInputs[tableChecked].size(); j++)
         {
-            if ((tableInputs[tableChecked][i].x == -1) || (tableInputs[tableChecked][i].y == -1))
+            if ((tableInputs[tableChecked][j].x == -1) || (tableInputs[tableChecked][j].y == -1))
             {
-                result = false;
+                return false;
             }
         }
-        for (unsigned int i = 0; i < tableOutputs[tableChecked].size(); i++)
+        for (unsigned int j = 0; j < tableOutputs[tableChecked].size(); j++)
+        {
+            if ((tableOutputs[tableChecked][j].x == -1) || (tableOutputs[tableChecked][j].y == -1))
+            {
+                return false;
+            }
+        }
+        //The rows are shared, so the inputs must be the same cells
+        if (tableInputs[tableChecked].size() != tableInputs[firstTable].size())
+        {
+            return false;
+        }
+        for (unsigned int j = 0; j < tableInputs[tableChecked].size(); j++)
         {
-            if ((tableOutputs[tableChecked][i].x == -1) || (tableOutputs[tableChecked][i].y == -1))
+            bool found = false;
+            for (unsigned int k = 0; k < tableInputs[firstTable].size(); k++)
             {
-                result = false;
+                if (tableInputs[tableChecked][j].x == tableInputs[firstTable][k].x && tableInputs[tableChecked][j].y == tableInputs[firstTable][k].y)
+                {
+                    found = true;
+                }
+            }
+            if (!found)
+            {
+                return false;
             }
         }
     }
@@ -1279,4 +1331,124 @@ void LayoutManager::resetIO()
             (*i).second[j].y = -1;
         }
     }
+    subCircuits.clear();
+    updateInstanceList();
+}
+
+
+//! Tags the inputs and outputs of the current table as a sub-circuit instance.
+/*!
+   The region covered by the inputs and outputs assigned to the current table
+   is simulated by the table instead of by its cells. The assignation is
+   cleared afterwards, so the table can be assigned to the next instance.
+*/
+void LayoutManager::addInstance()
+{
+    if (currentTable == wxEmptyString)
+    {
+        return;
+    }
+    subCircuit instance;
+    instance.table = currentTable;
+    instance.inputs = tableInputs[currentTable];
+    instance.outputs = tableOutputs[currentTable];
+    vector<coordinate> pins = instance.inputs;
+    pins.insert(pins.end(), instance.outputs.begin(), instance.outputs.end());
+    bool assigned = !instance.outputs.empty();
+    for (unsigned int i = 0; i < pins.size(); i++)
+    {
+        assigned = assigned && pins[i].x != -1;
+    }
+    if (!assigned)
+    {
+        controller->setStatusMessage(_("All the inputs and outputs of the table must be assigned"));
+        return;
+    }
+    subCircuits.push_back(instance);
+    for (unsigned int i = 0; i < tableInputs[currentTable].size(); i++)
+    {
+        tableInputs[currentTable][i].x = -1;
+        tableInputs[currentTable][i].y = -1;
+    }
+    for (unsigned int i = 0; i < tableOutputs[currentTable].size(); i++)
+    {
+        tableOutputs[currentTable][i].x = -1;
+        tableOutputs[currentTable][i].y = -1;
+    }
+    layoutModified = true;
+    controller->setStatusMessage(wxString::Format(_("Instance of %s added"), currentTable.c_str()));
+    view->updateInputs(tableInputs[currentTable]);
+    view->updateOutputs(tableOutputs[currentTable]);
+    updateInstanceList();
+    view->updateCanvas();
+    controller->elementChanged();
+}
+
+
+//! Removes a sub-circuit instance.
+/*!
+   \param instance the instance position in the instance list.
+*/
+void LayoutManager::removeInstance(int instance)
+{
+    if (instance < 0 || instance >= (int)subCircuits.size())
+    {
+        return;
+    }
+    subCircuits.erase(subCircuits.begin() + instance);
+    layoutModified = true;
+    updateInstanceList();
+    controller->elementChanged();
+}
+
+
+//! Adds a sub-circuit instance.
+/*!
+   \param instance the instance.
+   \return True iif the instance matches the inputs and outputs of its table.
+*/
+bool LayoutManager::addSubCircuit(subCircuit instance)
+{
+    if (tableInputs.find(instance.table) == tableInputs.end())
+    {
+        return false;
+    }
+    if (instance.outputs.empty() || instance.inputs.size() != tableInputs[instance.table].size() || instance.outputs.size() != tableOutputs[instance.table].size())
+    {
+        return false;
+    }
+    subCircuits.push_back(instance);
+    updateInstanceList();
+    return true;
+}
+
+
+//! Member accessor.
+/*!
+   \return The sub-circuit instances of the space.
+*/
+vector<subCircuit> LayoutManager::getSubCircuits()
+{
+    return subCircuits;
+}
+
+
+//! Updates the sub-circuit instance list on the view.
+void LayoutManager::updateInstanceList()
+{
+    wxArrayString instances;
+    for (unsigned int i = 0; i < subCircuits.size(); i++)
+    {
+        //The instances are shown by the upper left corner of their region
+        vector<coordinate> pins = subCircuits[i].inputs;
+        pins.insert(pins.end(), subCircuits[i].outputs.begin(), subCircuits[i].outputs.end());
+        coordinate corner = pins[0];
+        for (unsigned int j = 0; j < pins.size(); j++)
+        {
+            corner.x = min(corner.x, pins[j].x);
+            corner.y = min(corner.y, pins[j].y);
+        }
+        instances.Add(wxString::Format(_("%s at %d, %d"), subCircuits[i].table.c_str(), corner.x, corner.y));
+    }
+    view->updateInstanceList(instances);
 }
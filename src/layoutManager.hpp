@@ -47,6 +47,15 @@ class LayoutDiskManager;
 
 using namespace std;
 
+//! Sub-circuit instance struct.
+/*! A region of the space simulated by the truth table of a verified sub-circuit. */
+struct subCircuit
+{
+    wxString table; /*!< Truth table of the sub-circuit. */
+    vector<coordinate> inputs; /*!< Coordinates of the instance inputs, in table order. */
+    vector<coordinate> outputs; /*!< Coordinates of the instance outputs, in table order. */
+};
+
 class LayoutManager
 {
 public:
@@ -90,13 +99,18 @@ public:
     int getFPs();
     void clean();
     void prepareSimulation();
-    void startSimulation();
+    void startSimulation(simulationOptions options);
     list <ForbiddenPattern> getListFPEnabled();
     list <Rule> getListRuleEnabled();
     void elementChanged();
     TruthTable *getTableSelected();
+    vector<TruthTable *> getTablesSelected();
     bool checkLayout();
     void enableSimulation();
+    void addInstance();
+    void removeInstance(int instance);
+    bool addSubCircuit(subCircuit instance);
+    vector<subCircuit> getSubCircuits();
 
 private:
     //! Presentation class.
@@ -141,6 +155,8 @@ private:
     bool assigningInput;
     //! Are we assigning an output?
     bool assigningOutput;
+    //! Sub-circuit instances of the space.
+    vector<subCircuit> subCircuits;
     void updateGrids(bool changed);
     void updateTTList(wxArrayString tables);
     void updateFPList(wxArrayString FPs);
@@ -153,6 +169,7 @@ private:
     bool findInputAssignment(vector<coordinate> list, int x, int y);
     bool findOutputAssignment(vector<coordinate> list, int x, int y);
     void resetIO();
+    void updateInstanceList();
 };
 
 #endif /*LAYOUTMANAGER_HPP_*/
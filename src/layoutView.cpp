@@ -20,6 +20,7 @@
 #include "layoutView.hpp"
 
 #include <wx/statline.h>
+#include <wx/tokenzr.h>
 #include "resources/fileopen.xpm"
 #include "resources/filesave.xpm"
 #include "resources/filesaveas.xpm"
@@ -38,11 +39,28 @@ enum
     ID_BUTTON_ASSIGNOUTPUT,
     ID_BUTTON_PREPARE,
     ID_BUTTON_START,
+    ID_CHECK_BACKWARD,
+    ID_CHECK_BIDIRECTIONAL,
+    ID_CHECK_SAMPLING,
+    ID_SPIN_TRAJECTORIES,
+    ID_TEXT_RATES,
+    ID_CHOICE_SEMANTICS,
+    ID_CHECK_INCREMENTAL,
+    ID_CHECK_RESULTCACHE,
+    ID_CHECK_CHECKPOINT,
+    ID_CHOICE_MATCHER,
+    ID_CHOICE_STRATEGY,
+    ID_SPIN_THREADS,
+    ID_CHOICE_MEMORY,
+    ID_SPIN_WORKERS,
+    ID_BUTTON_ADDINSTANCE,
+    ID_BUTTON_REMOVEINSTANCE,
     ID_LISTTABLES,
     ID_LISTRULES,
     ID_LISTFPS,
     ID_LISTINPUTS,
     ID_LISTOUTPUTS,
+    ID_LISTINSTANCES,
     ID_CANVAS
 };
 
@@ -57,6 +75,8 @@ BEGIN_EVENT_TABLE(LayoutView, wxPanel)
     EVT_BUTTON  (ID_BUTTON_ASSIGNOUTPUT, LayoutView::OnAssignOutput)
     EVT_BUTTON  (ID_BUTTON_PREPARE, LayoutView::OnPrepare)
     EVT_BUTTON  (ID_BUTTON_START, LayoutView::OnStart)
+    EVT_BUTTON  (ID_BUTTON_ADDINSTANCE, LayoutView::OnAddInstance)
+    EVT_BUTTON  (ID_BUTTON_REMOVEINSTANCE, LayoutView::OnRemoveInstance)
     EVT_LISTBOX (ID_LISTTABLES, LayoutView::OnTableSelected)
     EVT_LISTBOX (ID_LISTINPUTS, LayoutView::OnInputSelected)
     EVT_LISTBOX (ID_LISTOUTPUTS, LayoutView::OnOutputSelected)
@@ -118,6 +138,58 @@ void LayoutView::initControls()
     buttonAssignOutput->Enable(false);
     buttonPrepareSimulation = new wxButton(this, ID_BUTTON_PREPARE, _("Check simulation"));
     buttonStartSimulation = new wxButton(this, ID_BUTTON_START, _("Begin simulation"));
+    checkBackward = new wxCheckBox(this, ID_CHECK_BACKWARD, _("Backward search"));
+    checkBackward->SetToolTip(_("Search failures backward from the outputs before simulating"));
+    checkBidirectional = new wxCheckBox(this, ID_CHECK_BIDIRECTIONAL, _("Meet in the middle"));
+    checkBidirectional->SetToolTip(_("Meet the backward search with the spaces reached forward"));
+    checkSampling = new wxCheckBox(this, ID_CHECK_SAMPLING, _("Sample trajectories"));
+    checkSampling->SetToolTip(_("Estimate the probability of every outcome from random trajectories instead of simulating every one"));
+    spinTrajectories = new wxSpinCtrl(this, ID_SPIN_TRAJECTORIES, wxString::Format(wxT("%d"), MONTECARLO_TRAJECTORIES), wxDefaultPosition, wxDefaultSize, wxSP_ARROW_KEYS, 1, 1000000, MONTECARLO_TRAJECTORIES);
+    spinTrajectories->SetToolTip(_("Trajectories sampled for every row"));
+    textRates = new wxTextCtrl(this, ID_TEXT_RATES, wxEmptyString);
+    textRates->SetToolTip(_("Rates of the enabled rules separated by commas, 1 for the rules left out"));
+    choiceSemantics = new wxChoice(this, ID_CHOICE_SEMANTICS);
+    choiceSemantics->Append(_("One rule every step"));
+    choiceSemantics->Append(_("Maximal parallel steps"));
+    choiceSemantics->Append(_("Every maximal parallel step"));
+    choiceSemantics->SetSelection(STEP_INTERLEAVED);
+    choiceSemantics->SetToolTip(_("Fire at once every rule that does not overlap another one, picked in order or in every possible way"));
+    checkIncremental = new wxCheckBox(this, ID_CHECK_INCREMENTAL, _("Reuse last simulation"));
+    checkIncremental->SetValue(true);
+    checkIncremental->SetToolTip(_("Keep the results of the rows not affected by the edits since the last simulation"));
+    checkResultCache = new wxCheckBox(this, ID_CHECK_RESULTCACHE, _("Cache results on disk"));
+    checkResultCache->SetValue(true);
+    checkResultCache->SetToolTip(_("Load the rows already simulated with the same rules, patterns and space from disk, and store the new ones"));
+    checkCheckpoint = new wxCheckBox(this, ID_CHECK_CHECKPOINT, _("Checkpoint and resume"));
+    checkCheckpoint->SetToolTip(_("Save the simulation state every minute, and resume the same simulation from its last checkpoint"));
+    //The first item of the engine settings leaves them to the planner
+    choiceMatcher = new wxChoice(this, ID_CHOICE_MATCHER);
+    choiceMatcher->Append(_("Automatic matching"));
+    choiceMatcher->Append(_("Scan the whole space"));
+    choiceMatcher->Append(_("Match from the sites"));
+    choiceMatcher->SetSelection(0);
+    choiceMatcher->SetToolTip(_("Look for the rules and patterns at every coordinate, or only around the molecules"));
+    choiceStrategy = new wxChoice(this, ID_CHOICE_STRATEGY);
+    choiceStrategy->Append(_("Automatic engines"));
+    choiceStrategy->Append(_("Simulate every row"));
+    choiceStrategy->Append(_("Bit-sliced first"));
+    choiceStrategy->Append(_("Symbolic first"));
+    choiceStrategy->SetSelection(0);
+    choiceStrategy->SetToolTip(_("Engines that solve the rows they can before the exhaustive simulation"));
+    spinThreads = new wxSpinCtrl(this, ID_SPIN_THREADS, wxT("0"), wxDefaultPosition, wxDefaultSize, wxSP_ARROW_KEYS, 0, 256, 0);
+    spinThreads->SetToolTip(_("Threads sampling the trajectories, 0 to choose them automatically"));
+    choiceMemory = new wxChoice(this, ID_CHOICE_MEMORY);
+    choiceMemory->Append(_("Automatic memory"));
+    choiceMemory->Append(_("Cache the spaces"));
+    choiceMemory->Append(_("Cache no spaces"));
+    choiceMemory->SetSelection(0);
+    choiceMemory->SetToolTip(_("Keep the results of the spaces simulated for the rest of the rows"));
+    spinWorkers = new wxSpinCtrl(this, ID_SPIN_WORKERS, wxT("0"), wxDefaultPosition, wxDefaultSize, wxSP_ARROW_KEYS, 0, 256, 0);
+    spinWorkers->SetToolTip(_("Processes simulating the rows with their own memory, 0 to simulate them in this one"));
+    buttonAddInstance = new wxButton(this, ID_BUTTON_ADDINSTANCE, _("Add instance"));
+    buttonAddInstance->SetToolTip(_("Simulate the region of the table inputs and outputs by the table"));
+    buttonRemoveInstance = new wxButton(this, ID_BUTTON_REMOVEINSTANCE, _("Remove instance"));
+    buttonRemoveInstance->SetToolTip(_("Simulate the region of the selected instance by its cells"));
     
     //Other controls
     listTables = new wxCheckListBox(this, ID_LISTTABLES);
@@ -125,6 +197,7 @@ void LayoutView::initControls()
     listFPs = new wxCheckListBox(this, ID_LISTFPS);
     listInputs = new wxListBox(this, ID_LISTINPUTS);
     listOutputs = new wxListBox(this, ID_LISTOUTPUTS);
+    listInstances = new wxListBox(this, ID_LISTINSTANCES);
     canvas = new LayoutCanvas(this, ID_CANVAS, Grid());
 }
 
@@ -164,6 +237,14 @@ void LayoutView::initSizers()
             
             TTListSizer->Add(IOSizer, 1, wxEXPAND | wxALL | wxALIGN_CENTER, 1);
             
+            //Sub-circuit instances sizer
+            wxStaticBoxSizer *instanceSizer = new wxStaticBoxSizer(wxHORIZONTAL, this, _("Sub-circuit instances"));
+            instanceSizer->Add(listInstances, 1, wxEXPAND | wxALL, 1);
+            wxBoxSizer *instanceButtonSizer = new wxBoxSizer(wxVERTICAL);
+            instanceButtonSizer->Add(buttonAddInstance, 0, wxEXPAND | wxALL, 1);
+            instanceButtonSizer->Add(buttonRemoveInstance, 0, wxEXPAND | wxALL, 1);
+            instanceSizer->Add(instanceButtonSizer, 0, wxALL | wxALIGN_CENTER, 1);
+            
             wxStaticBoxSizer *RuleListSizer = new wxStaticBoxSizer(wxHORIZONTAL, this, _("Rule list"));
             RuleListSizer->Add(listRules, 1, wxEXPAND | wxALL, 1);
             
@@ -174,6 +255,7 @@ void LayoutView::initSizers()
         ruleFPSizer->Add(RuleListSizer, 1, wxEXPAND | wxALL, 1);
         ruleFPSizer->Add(FPListSizer, 1, wxEXPAND | wxALL, 1);
         listsSizer->Add(TTListSizer, 1, wxEXPAND | wxALL, 1);
+        listsSizer->Add(instanceSizer, 0, wxEXPAND | wxALL, 1);
         listsSizer->Add(ruleFPSizer, 1, wxEXPAND | wxALL, 1);
         
             //Layouts sizer
@@ -195,6 +277,32 @@ void LayoutView::initSizers()
             simulationSizer->AddStretchSpacer(1);
             simulationSizer->Add(buttonStartSimulation, 0, wxSHAPED | wxALIGN_CENTER, 1);
             simulationSizer->AddStretchSpacer(1);
+            simulationSizer->Add(checkBackward, 0, wxALIGN_LEFT | wxALL, 1);
+            simulationSizer->Add(checkBidirectional, 0, wxALIGN_LEFT | wxALL, 1);
+            wxBoxSizer *samplingSizer = new wxBoxSizer(wxHORIZONTAL);
+                samplingSizer->Add(checkSampling, 0, wxALIGN_CENTER_VERTICAL | wxALL, 1);
+                samplingSizer->Add(spinTrajectories, 0, wxALIGN_CENTER_VERTICAL | wxALL, 1);
+            simulationSizer->Add(samplingSizer, 0, wxALIGN_LEFT | wxALL, 1);
+            wxBoxSizer *ratesSizer = new wxBoxSizer(wxHORIZONTAL);
+                ratesSizer->Add(new wxStaticText(this, wxID_ANY, _("Rule rates")), 0, wxALIGN_CENTER_VERTICAL | wxALL, 1);
+                ratesSizer->Add(textRates, 1, wxALIGN_CENTER_VERTICAL | wxALL, 1);
+            simulationSizer->Add(ratesSizer, 0, wxEXPAND | wxALL, 1);
+            simulationSizer->Add(choiceSemantics, 0, wxALIGN_LEFT | wxALL, 1);
+            simulationSizer->Add(checkIncremental, 0, wxALIGN_LEFT | wxALL, 1);
+            simulationSizer->Add(checkResultCache, 0, wxALIGN_LEFT | wxALL, 1);
+            simulationSizer->Add(checkCheckpoint, 0, wxALIGN_LEFT | wxALL, 1);
+            simulationSizer->Add(choiceMatcher, 0, wxALIGN_LEFT | wxALL, 1);
+            simulationSizer->Add(choiceStrategy, 0, wxALIGN_LEFT | wxALL, 1);
+            wxBoxSizer *threadsSizer = new wxBoxSizer(wxHORIZONTAL);
+                threadsSizer->Add(new wxStaticText(this, wxID_ANY, _("Sampling threads")), 0, wxALIGN_CENTER_VERTICAL | wxALL, 1);
+                threadsSizer->Add(spinThreads, 0, wxALIGN_CENTER_VERTICAL | wxALL, 1);
+            simulationSizer->Add(threadsSizer, 0, wxALIGN_LEFT | wxALL, 1);
+            simulationSizer->Add(choiceMemory, 0, wxALIGN_LEFT | wxALL, 1);
+            wxBoxSizer *workersSizer = new wxBoxSizer(wxHORIZONTAL);
+                workersSizer->Add(new wxStaticText(this, wxID_ANY, _("Worker processes")), 0, wxALIGN_CENTER_VERTICAL | wxALL, 1);
+                workersSizer->Add(spinWorkers, 0, wxALIGN_CENTER_VERTICAL | wxALL, 1);
+            simulationSizer->Add(workersSizer, 0, wxALIGN_LEFT | wxALL, 1);
+            simulationSizer->AddStretchSpacer(1);
             
             //Right sizer
             wxBoxSizer *layoutSimulationSizer = new wxBoxSizer(wxVERTICAL);
@@ -507,6 +615,41 @@ void LayoutView::updateOutputList(wxArrayString strings)
 }
 
 
+//! Updates the sub-circuit instance listbox.
+/*!
+   \param strings the string list.
+*/
+void LayoutView::updateInstanceList(wxArrayString strings)
+{
+    listInstances->Set(strings);
+    buttonRemoveInstance->Enable(strings.size() > 0);
+    if (strings.size() > 0)
+    {
+        listInstances->SetSelection(strings.size() - 1);
+    }
+}
+
+
+//! Add instance button click event.
+/*!
+   \param event the event.
+*/
+void LayoutView::OnAddInstance(wxCommandEvent &event)
+{
+    controller->addInstance();
+}
+
+
+//! Remove instance button click event.
+/*!
+   \param event the event.
+*/
+void LayoutView::OnRemoveInstance(wxCommandEvent &event)
+{
+    controller->removeInstance(listInstances->GetSelection());
+}
+
+
 //! Assign input button click event.
 /*!
    \param event the event.
@@ -555,6 +698,9 @@ void LayoutView::onlyAssign(bool enable)
     listFPs->Enable(enable);
     listInputs->Enable(enable);
     listOutputs->Enable(enable);
+    listInstances->Enable(enable);
+    buttonAddInstance->Enable(enable);
+    buttonRemoveInstance->Enable(enable);
     
     if (enable)
     {
@@ -717,7 +863,33 @@ void LayoutView::OnPrepare(wxCommandEvent &event)
 */
 void LayoutView::OnStart(wxCommandEvent &event)
 {
-    controller->startSimulation();
+    simulationOptions options;
+    //The bidirectional mode is a backward search too
+    options.bidirectional = checkBidirectional->GetValue();
+    options.backward = checkBackward->GetValue() || options.bidirectional;
+    options.sampling = checkSampling->GetValue();
+    options.trajectories = spinTrajectories->GetValue();
+    options.semantics = choiceSemantics->GetSelection();
+    options.incremental = checkIncremental->GetValue();
+    options.resultCache = checkResultCache->GetValue();
+    options.checkpoint = checkCheckpoint->GetValue();
+    options.matcher = choiceMatcher->GetSelection() - 1;
+    options.strategy = choiceStrategy->GetSelection() - 1;
+    options.threads = spinThreads->GetValue() > 0 ? spinThreads->GetValue() : PLAN_AUTO;
+    options.memory = choiceMemory->GetSelection() - 1;
+    options.workers = spinWorkers->GetValue();
+    //Missing or wrong rates are taken as 1
+    wxStringTokenizer rates(textRates->GetValue(), wxT(","));
+    while (rates.HasMoreTokens())
+    {
+        double rate;
+        if (!rates.GetNextToken().Trim().Trim(false).ToDouble(&rate) || rate <= 0)
+        {
+            rate = 1;
+        }
+        options.rates.push_back(rate);
+    }
+    controller->startSimulation(options);
 }
 
 
@@ -31,10 +31,13 @@
 #define LAYOUTVIEW_HPP_
 
 #include <wx/wx.h>
+#include <wx/spinctrl.h>
 
 #include "layoutCanvas.hpp"
 #include "layoutManager.hpp"
 #include "truthTableCanvas.hpp"
+#include "simulationOptions.hpp"
+#include "monteCarloSimulation.hpp"
 #include <map>
 
 using namespace std;
@@ -57,6 +60,7 @@ public:
     void updateRuleList(map<unsigned int, bool> rules);
     void updateInputList(wxArrayString strings);
     void updateOutputList(wxArrayString strings);
+    void updateInstanceList(wxArrayString strings);
     void selectTable(wxString table);
     void errorMsg(wxString message);
     bool msgYesNo(wxString message);
@@ -70,6 +74,8 @@ public:
     void OnAssignOutput(wxCommandEvent &event);
     void OnPrepare(wxCommandEvent &event);
     void OnStart(wxCommandEvent &event);
+    void OnAddInstance(wxCommandEvent &event);
+    void OnRemoveInstance(wxCommandEvent &event);
     void onlyAssign(bool enable);
     void OnKeyPressed(wxKeyEvent &event);
     void updateCanvas();
@@ -100,6 +106,24 @@ private:
     wxBitmapButton *buttonAssignOutput;
     wxButton *buttonPrepareSimulation;
     wxButton *buttonStartSimulation;
+    wxButton *buttonAddInstance;
+    wxButton *buttonRemoveInstance;
+    
+    //Simulation options
+    wxCheckBox *checkBackward;
+    wxCheckBox *checkBidirectional;
+    wxCheckBox *checkSampling;
+    wxSpinCtrl *spinTrajectories;
+    wxTextCtrl *textRates;
+    wxChoice *choiceSemantics;
+    wxCheckBox *checkIncremental;
+    wxCheckBox *checkResultCache;
+    wxCheckBox *checkCheckpoint;
+    wxChoice *choiceMatcher;
+    wxChoice *choiceStrategy;
+    wxSpinCtrl *spinThreads;
+    wxChoice *choiceMemory;
+    wxSpinCtrl *spinWorkers;
     
     //Other controls
     wxCheckListBox *listTables;
@@ -107,6 +131,7 @@ private:
     wxCheckListBox *listFPs;
     wxListBox *listInputs;
     wxListBox *listOutputs;
+    wxListBox *listInstances;
     LayoutCanvas *canvas;
 };
 
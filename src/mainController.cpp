@@ -243,6 +243,7 @@ void MainController::save()
         saveTables(outStream);
         saveRules(outStream);
         savePatterns(outStream);
+        saveSubCircuits(outStream);
         delete outStream;
         frame->setTitleBar(fileName);
     }
@@ -300,6 +301,7 @@ if (rules->saveFile() && forbiddenPatterns->saveFile() && truthTables->saveFile(
     saveTables(outStream);
     saveRules(outStream);
     savePatterns(outStream);
+    saveSubCircuits(outStream);
     delete outStream;
     frame->setTitleBar(fileName);
 }
@@ -455,6 +457,30 @@ void MainController::savePatterns(wxTextOutputStream *stream)
 }
 
 
+//! Saves the sub-circuit instances to a stream.
+/*!
+   \param stream the stream to write.
+*/
+void MainController::saveSubCircuits(wxTextOutputStream *stream)
+{
+    vector<subCircuit> instances = layouts->getSubCircuits();
+    *stream << instances.size() << endl;
+    for (unsigned int i = 0; i < instances.size(); i++)
+    {
+        //Table name, then inputs and outputs
+        *stream << instances[i].table << endl;
+        for (unsigned int j = 0; j < instances[i].inputs.size(); j++)
+        {
+            *stream << instances[i].inputs[j].x << endl << instances[i].inputs[j].y << endl;
+        }
+        for (unsigned int j = 0; j < instances[i].outputs.size(); j++)
+        {
+            *stream << instances[i].outputs[j].x << endl << instances[i].outputs[j].y << endl;
+        }
+    }
+}
+
+
 //! Opens a project file.
 /*!
    \param file the file to open.
@@ -620,6 +646,12 @@ bool MainController::openFile(wxString file)
     {
         result = result && true;
     }
+    //Sub-circuit instances
+    if (!openSubCircuits(fileStream, inStream))
+    {
+        frame->errorMsg(_("Error mapping sub-circuit instances."));
+        result = false;
+    }
     
     return result;
 }
@@ -834,11 +866,98 @@ bool MainController::openFPs(wxFileInputStream *fileStream, wxTextInputStream *i
 }
 
 
+//! Opens the sub-circuit instances from a stream.
+/*!
+   The projects saved before the sub-circuit instances existed end before
+   them and have no instances.
+   \param fileStream file stream.
+   \param inStream the text input stream.
+   \return True if the sub-circuit instances were correctly opened.
+*/
+bool MainController::openSubCircuits(wxFileInputStream *fileStream, wxTextInputStream *inStream)
+{
+    wxString temp;
+    long int instances;
+    
+    temp = inStream->ReadLine();
+    if (fileStream->LastRead() == 0 || temp.IsEmpty())
+    {
+        return true;
+    }
+    if (!temp.ToLong(&instances))
+    {
+        return false;
+    }
+    for (int i = 0; i < instances; i++)
+    {
+        subCircuit instance;
+        instance.table = inStream->ReadLine();
+        if (fileStream->LastRead() == 0 || fileStream->Eof())
+        {
+            return false;
+        }
+        instance.inputs.resize(truthTables->getInputs(instance.table));
+        for (unsigned int j = 0; j < instance.inputs.size(); j++)
+        {
+            if (!openCoordinate(fileStream, inStream, &instance.inputs[j]))
+            {
+                return false;
+            }
+        }
+        instance.outputs.resize(truthTables->getOutputs(instance.table));
+        for (unsigned int j = 0; j < instance.outputs.size(); j++)
+        {
+            if (!openCoordinate(fileStream, inStream, &instance.outputs[j]))
+            {
+                return false;
+            }
+        }
+        if (!layouts->addSubCircuit(instance))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//! Opens a coordinate from a stream.
+/*!
+   \param fileStream file stream.
+   \param inStream the text input stream.
+   \param c the coordinate read.
+   \return True if the coordinate was correctly opened.
+*/
+bool MainController::openCoordinate(wxFileInputStream *fileStream, wxTextInputStream *inStream, coordinate *c)
+{
+    wxString temp;
+    long int value;
+    
+    temp = inStream->ReadLine();
+    if (fileStream->LastRead() == 0 || !temp.ToLong(&value))
+    {
+        return false;
+    }
+    c->x = value;
+    temp = inStream->ReadLine();
+    if (fileStream->LastRead() == 0 || !temp.ToLong(&value))
+    {
+        return false;
+    }
+    c->y = value;
+    return true;
+}
+
+
 //! Starts the simulation.
-void MainController::startSimulation()
+/*!
+   \param options the options chosen for the simulation.
+*/
+void MainController::startSimulation(simulationOptions options)
 {
     if (!simulating)
     {
+        simulation->setOptions(options);
         simulation->prepareSimulation();
         setStatusMessage(_("Simulation in progress"));
         simulating = true;
@@ -864,8 +983,8 @@ void MainController::prepareSimulation()
     }
     else if (!layouts->checkLayout())
     {
-        frame->errorMsg(_("Check there is a truth table checked and it has its inputs and outputs assigned"));
-        setStatusMessage(_("Check there is a truth table checked and it has its inputs and outputs assigned"));
+        frame->errorMsg(_("Check there is a truth table checked, the checked tables have their inputs and outputs assigned and share their input cells"));
+        setStatusMessage(_("Check there is a truth table checked, the checked tables have their inputs and outputs assigned and share their input cells"));
     }
     else
     {
@@ -71,7 +71,7 @@ public:
     void saveAs();
     void open();
     void newFile();
-    void startSimulation();
+    void startSimulation(simulationOptions options);
     void prepareSimulation();
     void elementChanged();
     NanoFrame* getNanoFrame();
@@ -100,10 +100,13 @@ private:
      void saveTables(wxTextOutputStream *stream);
      void saveRules(wxTextOutputStream *stream);
      void savePatterns(wxTextOutputStream *stream);
+     void saveSubCircuits(wxTextOutputStream *stream);
      bool openFile(wxString file);
      bool openTables(wxFileInputStream *fileStream, wxTextInputStream *inStream);
      bool openRules(wxFileInputStream *fileStream, wxTextInputStream *inStream);
      bool openFPs(wxFileInputStream *fileStream, wxTextInputStream *inStream);
+     bool openSubCircuits(wxFileInputStream *fileStream, wxTextInputStream *inStream);
+     bool openCoordinate(wxFileInputStream *fileStream, wxTextInputStream *inStream, coordinate *c);
 };
 #endif //MAINCONTROLLER_H
 
@@ -0,0 +1,606 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "monteCarloSimulation.hpp"
+#include <cmath>
+#include <ctime>
+#include <algorithm>
+#include <set>
+
+using namespace std;
+
+
+//! Constructor.
+/*!
+   The rules are referenced, not copied, so the list must outlive the
+   simulation. Every rule has rate 1 until the rates are set.
+   \param rules the rule list to be applied.
+   \param patterns the forbidden pattern list to be found.
+*/
+MonteCarloSimulation::MonteCarloSimulation(list<Rule> *rules, list<ForbiddenPattern> *patterns) : graph(rules), placement(rules, patterns)
+{
+    this->rules = rules;
+    rates.assign(rules->size(), 1);
+    width = -1;
+    height = -1;
+    check = 0;
+    deadline = 0;
+    state = 1;
+    counts.trajectories = 0;
+    counts.unfinished = 0;
+}
+
+
+//! Destructor.
+MonteCarloSimulation::~MonteCarloSimulation()
+{
+}
+
+
+//! Sets the rates of the rules.
+/*!
+   \param rates the rate of every rule, in the list order. The rules
+   without rate keep rate 1.
+*/
+void MonteCarloSimulation::setRates(vector<double> rates)
+{
+    for (unsigned int i = 0; i < rates.size() && i < this->rates.size(); i++)
+    {
+        this->rates[i] = rates[i];
+    }
+}
+
+
+//! Sets the cells the rules must not touch.
+/*!
+   \param frozen the cells, indexed by x * height + y. Empty if none.
+*/
+void MonteCarloSimulation::setFrozen(vector<bool> frozen)
+{
+    graph.setFrozen(frozen);
+}
+
+
+//! Samples random trajectories of a row.
+/*!
+   The counts and witnesses of the previous row are discarded.
+   \param space the initial space of the row.
+   \param trajectories the number of trajectories to sample.
+   \param seed the seed of the random stream.
+*/
+void MonteCarloSimulation::sample(Grid space, int trajectories, unsigned long seed)
+{
+    setSpace(space, seed);
+    counts.trajectories = 0;
+    counts.unfinished = 0;
+    counts.stable.clear();
+    counts.forbidden.clear();
+    counts.outOfBounds.clear();
+    stable.clear();
+    forbiddenFound.clear();
+    outOfBounds.clear();
+    stableFound.clear();
+    forbiddenSpaces.clear();
+    outOfBoundsFound.clear();
+    for (int i = 0; i < trajectories; i++)
+    {
+        trajectory(space);
+    }
+    counts.trajectories = trajectories;
+}
+
+
+//! Estimates the size of the exhaustive simulation of a row.
+/*!
+   Every probe walks from the initial space to a final space, picking one
+   of the next spaces at random. Each level it goes down counts
+   as many spaces as the product of the branching factors above it, and
+   the mean of the probes is an unbiased estimate of the spaces of the
+   search tree. The cache reuses the results of the spaces reached by
+   other branches, so with it the estimate is an upper bound. The probing
+   stops when the budget runs out, after the first probe.
+   \param space the initial space of the row.
+   \param probes the number of probes.
+   \param seed the seed of the random stream.
+   \param budget the seconds the probes may take.
+   \return The estimate.
+*/
+searchEstimate MonteCarloSimulation::estimate(Grid space, int probes, unsigned long seed, double budget)
+{
+    setSpace(space, seed);
+    searchEstimate result;
+    result.spaces = 0;
+    result.depth = 0;
+    result.maxDepth = 0;
+    result.seconds = 0;
+    result.probes = 0;
+    result.truncated = 0;
+    if (probes <= 0)
+    {
+        return result;
+    }
+    int expanded = 0;
+    clock_t start = clock();
+    deadline = start + (clock_t)(budget * CLOCKS_PER_SEC);
+    while (result.probes < probes && (result.probes == 0 || clock() < deadline))
+    {
+        int depth = 0;
+        bool truncated = false;
+        result.spaces += probe(space, &depth, &truncated);
+        result.depth += depth;
+        result.maxDepth = max(result.maxDepth, depth);
+        if (truncated)
+        {
+            result.truncated++;
+        }
+        expanded += depth + 1;
+        result.probes++;
+    }
+    double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+    result.spaces /= result.probes;
+    result.depth /= result.probes;
+    result.seconds = result.spaces * elapsed / expanded;
+    return result;
+}
+
+
+//! Adds the counts and witnesses of another sample of the same row.
+/*!
+   \param other the other sample.
+*/
+void MonteCarloSimulation::merge(MonteCarloSimulation &other)
+{
+    list<simulationStep>::iterator s = other.stable.begin();
+    for (unsigned int i = 0; i < other.counts.stable.size(); i++, s++)
+    {
+        if (addOutcome(counts.stable, stableFound, (*s).space.g, other.counts.stable[i]))
+        {
+            stable.push_back(*s);
+        }
+    }
+    s = other.forbiddenFound.begin();
+    for (unsigned int i = 0; i < other.counts.forbidden.size(); i++, s++)
+    {
+        if (addOutcome(counts.forbidden, forbiddenSpaces, (*s).space.g, other.counts.forbidden[i]))
+        {
+            forbiddenFound.push_back(*s);
+        }
+    }
+    s = other.outOfBounds.begin();
+    for (unsigned int i = 0; i < other.counts.outOfBounds.size(); i++, s++)
+    {
+        if (addOutcome(counts.outOfBounds, outOfBoundsFound, (*s).space.g, other.counts.outOfBounds[i]))
+        {
+            outOfBounds.push_back(*s);
+        }
+    }
+    counts.trajectories += other.counts.trajectories;
+    counts.unfinished += other.counts.unfinished;
+}
+
+
+//! Member accessor.
+/*!
+   \return The outcome counts of the row.
+*/
+sampleCounts MonteCarloSimulation::getCounts()
+{
+    return counts;
+}
+
+
+//! Member accessor.
+/*!
+   \return A witness of every stable space reached, in the order of the
+   counts.
+*/
+list<simulationStep> MonteCarloSimulation::getStableLayouts()
+{
+    return stable;
+}
+
+
+//! Member accessor.
+/*!
+   \return A witness of every forbidden space reached, in the order of the
+   counts.
+*/
+list<simulationStep> MonteCarloSimulation::getForbiddenLayouts()
+{
+    return forbiddenFound;
+}
+
+
+//! Member accessor.
+/*!
+   \return A witness of every out of bounds space reached, in the order of
+   the counts.
+*/
+list<simulationStep> MonteCarloSimulation::getOutOfBounds()
+{
+    return outOfBounds;
+}
+
+
+//! Confidence interval of a probability.
+/*!
+   Wilson score interval, which stays inside [0, 1] and is still useful
+   when no trajectory or every trajectory hits the outcome.
+   \param hits the trajectories ending on the outcome.
+   \param trials the trajectories sampled.
+   \param low the lower bound of the probability.
+   \param high the upper bound of the probability.
+*/
+void MonteCarloSimulation::interval(int hits, int trials, double *low, double *high)
+{
+    if (trials == 0)
+    {
+        *low = 0;
+        *high = 1;
+        return;
+    }
+    double n = trials;
+    double p = hits / n;
+    double z2 = MONTECARLO_Z * MONTECARLO_Z;
+    double denominator = 1 + z2 / n;
+    double center = (p + z2 / (2 * n)) / denominator;
+    double half = MONTECARLO_Z * sqrt(p * (1 - p) / n + z2 / (4 * n * n)) / denominator;
+    *low = max(0.0, center - half);
+    *high = min(1.0, center + half);
+}
+
+
+//! Follows a random trajectory and counts its outcome.
+/*!
+   The events are checked in the order of the normal simulation: forbidden
+   patterns first, then out of bounds placements, then stability.
+   \param space the initial space.
+*/
+void MonteCarloSimulation::trajectory(Grid space)
+{
+    moves.clear();
+    list<ruleApplying> applicable = graph.findApplicable(space);
+    bool found = forbidden(space);
+    for (int step = 0; step < MONTECARLO_STEPS; step++)
+    {
+        if (found)
+        {
+            if (addOutcome(counts.forbidden, forbiddenSpaces, space, 1))
+            {
+                forbiddenFound.push_back(getStep(space));
+            }
+            return;
+        }
+        double total = 0;
+        for (list<ruleApplying>::iterator i = applicable.begin(); i != applicable.end(); i++)
+        {
+            if (graph.outOfBounds(space, (*i)))
+            {
+                if (addOutcome(counts.outOfBounds, outOfBoundsFound, space, 1))
+                {
+                    outOfBounds.push_back(getStep(space));
+                }
+                return;
+            }
+            total += rates[(*i).index];
+        }
+        if (applicable.empty())
+        {
+            if (addOutcome(counts.stable, stableFound, space, 1))
+            {
+                stable.push_back(getStep(space));
+            }
+            return;
+        }
+        
+        //Pick a placement with probability proportional to its rate
+        double pick = random() * total;
+        list<ruleApplying>::iterator chosen = applicable.begin();
+        for (list<ruleApplying>::iterator i = applicable.begin(); i != applicable.end(); i++)
+        {
+            chosen = i;
+            pick -= rates[(*i).index];
+            if (pick < 0)
+            {
+                break;
+            }
+        }
+        ruleApplying fired = *chosen;
+        moves.push_back(fired);
+        space = graph.applyRule(space, fired);
+        applicable = graph.updateApplicable(space, applicable, fired);
+        found = forbidden(space, fired);
+    }
+    counts.unfinished++;
+}
+
+
+//! Follows a random probe down the search of a row.
+/*!
+   As in Simulation::nextStep, every applicable placement gives a next
+   space, except the ones going back to a space above on the probe, which
+   the simulation reports as cycles. The estimate is clamped to
+   ESTIMATE_SPACES.
+   \param space the initial space.
+   \param depth the number of levels gone down.
+   \param truncated set to true if the probe is cut at ESTIMATE_DEPTH or
+   at the deadline of the estimate.
+   \return The spaces of the search tree estimated by the probe.
+*/
+double MonteCarloSimulation::probe(Grid space, int *depth, bool *truncated)
+{
+    double spaces = 1;
+    double weight = 1;
+    set<unsigned long> path;
+    list<ruleApplying> applicable = graph.findApplicable(space);
+    bool found = forbidden(space);
+    *truncated = true;
+    for (*depth = 0; *depth < ESTIMATE_DEPTH && clock() < deadline; (*depth)++)
+    {
+        if (applicable.empty() || found)
+        {
+            *truncated = false;
+            return spaces;
+        }
+        vector<ruleApplying> next;
+        vector<Grid> nextSpaces;
+        for (list<ruleApplying>::iterator i = applicable.begin(); i != applicable.end(); i++)
+        {
+            if (graph.outOfBounds(space, (*i)))
+            {
+                *truncated = false;
+                return spaces;
+            }
+            Grid reached = graph.applyRule(space, (*i));
+            if (path.count(reached.getHash()) == 0)
+            {
+                next.push_back(*i);
+                nextSpaces.push_back(reached);
+            }
+        }
+        if (next.empty())
+        {
+            *truncated = false;
+            return spaces;
+        }
+        path.insert(space.getHash());
+        weight = min(weight * next.size(), ESTIMATE_SPACES);
+        spaces = min(spaces + weight, ESTIMATE_SPACES);
+        int pick = min((int)(random() * next.size()), (int)next.size() - 1);
+        space = nextSpaces[pick];
+        applicable = graph.updateApplicable(space, applicable, next[pick]);
+        found = forbidden(space, next[pick]);
+    }
+    return spaces;
+}
+
+
+//! Prepares the simulation for a new row.
+/*!
+   \param space the initial space of the row.
+   \param seed the seed of the random stream.
+*/
+void MonteCarloSimulation::setSpace(Grid &space, unsigned long seed)
+{
+    if (space.getWidth() != width || space.getHeight() != height)
+    {
+        width = space.getWidth();
+        height = space.getHeight();
+        placement.buildInstances(width, height);
+        //Every placement is listed on the cells it looks at
+        vector<bitInstance> &patterns = placement.getPatternInstances();
+        cellPatterns.assign(width * height, vector<int>());
+        for (unsigned int p = 0; p < patterns.size(); p++)
+        {
+            vector<int> cells = patterns[p].enabled;
+            cells.insert(cells.end(), patterns[p].disabled.begin(), patterns[p].disabled.end());
+            cells.insert(cells.end(), patterns[p].space.begin(), patterns[p].space.end());
+            for (unsigned int i = 0; i < cells.size(); i++)
+            {
+                cellPatterns[cells[i]].push_back(p);
+            }
+        }
+        checked.assign(patterns.size(), 0);
+        check = 0;
+    }
+    //Spread the seed so near seeds give unrelated streams
+    state = (uint32_t)(seed * 2654435761UL) ^ 0x9E3779B9U;
+    if (state == 0)
+    {
+        state = 1;
+    }
+    initial = space;
+}
+
+
+//! Finds if a space holds a forbidden pattern.
+/*!
+   \param space the space.
+   \return True iif a forbidden pattern matches somewhere.
+*/
+bool MonteCarloSimulation::forbidden(Grid &space)
+{
+    vector<bitInstance> &patterns = placement.getPatternInstances();
+    for (unsigned int p = 0; p < patterns.size(); p++)
+    {
+        if (matches(space, patterns[p]))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//! Finds if a rule placement made a forbidden pattern appear.
+/*!
+   The space before the placement held no forbidden pattern, so only the
+   pattern placements looking at the cells of the rule can match now.
+   \param space the space after the rule placement.
+   \param fired the rule placement.
+   \return True iif a forbidden pattern matches somewhere.
+*/
+bool MonteCarloSimulation::forbidden(Grid &space, ruleApplying &fired)
+{
+    vector<bitInstance> &patterns = placement.getPatternInstances();
+    check++;
+    if (check == 0)
+    {
+        checked.assign(patterns.size(), 0);
+        check = 1;
+    }
+    int left = max(fired.c.x - fired.rule->getWidth() + 1, 0);
+    int top = max(fired.c.y - fired.rule->getHeight() + 1, 0);
+    for (int x = left; x <= fired.c.x && x < width; x++)
+    {
+        for (int y = top; y <= fired.c.y && y < height; y++)
+        {
+            vector<int> &cell = cellPatterns[x * height + y];
+            for (unsigned int i = 0; i < cell.size(); i++)
+            {
+                if (checked[cell[i]] != check)
+                {
+                    checked[cell[i]] = check;
+                    if (matches(space, patterns[cell[i]]))
+                    {
+                        return true;
+                    }
+                }
+            }
+        }
+    }
+    return false;
+}
+
+
+//! Finds if a forbidden pattern placement matches a space.
+/*!
+   \param space the space.
+   \param pattern the pattern placement.
+   \return True iif every cell of the placement matches.
+*/
+bool MonteCarloSimulation::matches(Grid &space, bitInstance &pattern)
+{
+    for (unsigned int i = 0; i < pattern.enabled.size(); i++)
+    {
+        int cell = pattern.enabled[i];
+        if (space(cell / height, cell % height) != nENABLED)
+        {
+            return false;
+        }
+    }
+    for (unsigned int i = 0; i < pattern.disabled.size(); i++)
+    {
+        int cell = pattern.disabled[i];
+        if (space(cell / height, cell % height) != nDISABLED)
+        {
+            return false;
+        }
+    }
+    for (unsigned int i = 0; i < pattern.space.size(); i++)
+    {
+        int cell = pattern.space[i];
+        if (space(cell / height, cell % height) == nNOSPACE)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//! Counts an outcome.
+/*!
+   Spaces with the same hash are compared, so a collision does not merge
+   two different spaces and drop the witness of the second one.
+   \param hits the counts of the outcome.
+   \param found the spaces of the outcome and their positions, by hash.
+   \param space the space reached.
+   \param count the number of trajectories reaching it.
+   \return True if the space had not been reached yet, so it needs a
+   witness.
+*/
+bool MonteCarloSimulation::addOutcome(vector<int> &hits, map< unsigned long, list< pair<Grid, int> > > &found, Grid &space, int count)
+{
+    list< pair<Grid, int> > &spaces = found[space.getHash()];
+    for (list< pair<Grid, int> >::iterator i = spaces.begin(); i != spaces.end(); i++)
+    {
+        if ((*i).first == space)
+        {
+            hits[(*i).second] += count;
+            return false;
+        }
+    }
+    spaces.push_back(pair<Grid, int>(space, hits.size()));
+    hits.push_back(count);
+    return true;
+}
+
+
+//! Builds the witness of the current trajectory.
+/*!
+   The trajectory is replayed from the initial space. The simulation does
+   not follow cycles, so they are cut off.
+   \param space the space where the trajectory ends.
+   \return The simulation step, as the normal simulation builds it.
+*/
+simulationStep MonteCarloSimulation::getStep(Grid &space)
+{
+    simulationStep result;
+    Grid current = initial;
+    for (unsigned int k = 0; k < moves.size(); k++)
+    {
+        spaceHighlighted step;
+        step.g = current;
+        step.h.top = moves[k].c.y - moves[k].rule->getHeight() + 1;
+        step.h.left = moves[k].c.x - moves[k].rule->getWidth() + 1;
+        step.h.width = moves[k].rule->getWidth();
+        step.h.height = moves[k].rule->getHeight();
+        result.path.push_back(step);
+        current = graph.applyRule(current, moves[k]);
+        for (list<spaceHighlighted>::iterator i = result.path.begin(); i != result.path.end(); i++)
+        {
+            if ((*i).g == current)
+            {
+                result.path.erase(i, result.path.end());
+                break;
+            }
+        }
+    }
+    result.space.g = space;
+    result.space.h.top = result.space.h.left = result.space.h.width = result.space.h.height = 0;
+    result.matched = false;
+    return result;
+}
+
+
+//! Draws a random number.
+/*!
+   Xorshift generator, private to the object so the samples running at the
+   same time do not share their stream.
+   \return A number in [0, 1).
+*/
+double MonteCarloSimulation::random()
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state / 4294967296.0;
+}
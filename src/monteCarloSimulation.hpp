@@ -0,0 +1,165 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class MonteCarloSimulation
+ * \brief Stochastic simulation of random trajectories of a row.
+ * 
+ * Instead of exploring every interleaving of the rules, this class follows
+ * random trajectories from the initial space of a row: at every step one
+ * of the applicable rule placements is picked at random, weighted by the
+ * rate of its rule, as in the Gillespie algorithm. A trajectory ends on a
+ * stable space, a forbidden pattern, an out of bounds space or after
+ * MONTECARLO_STEPS steps. The outcomes are counted so their probabilities
+ * can be estimated, and the first trajectory reaching every outcome is
+ * kept as its witness. Every object has its own random stream, so several
+ * of them can sample the same row at the same time and be merged later.
+ * 
+ * The same random walks, picking the next space uniformly, estimate the
+ * size of the search of a row as Knuth did for backtracking trees: the
+ * product of the branching factors met by a probe weighs every level.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef MONTECARLOSIMULATION_HPP_
+#define MONTECARLOSIMULATION_HPP_
+
+#include "bitSimulation.hpp"
+#include "ruleGraph.hpp"
+#include <stdint.h>
+#include <ctime>
+#include <vector>
+#include <list>
+#include <map>
+
+//! Maximum number of steps of a trajectory.
+#define MONTECARLO_STEPS 10000
+//! Default number of trajectories sampled for every row.
+#define MONTECARLO_TRAJECTORIES 1000
+//! Normal quantile of the confidence intervals, 95%.
+#define MONTECARLO_Z 1.96
+//! Number of probes estimating the search of a row.
+#define ESTIMATE_PROBES 64
+//! Maximum depth of a probe.
+#define ESTIMATE_DEPTH 1000
+//! Maximum number of rows estimated, the rest are extrapolated.
+#define ESTIMATE_ROWS 16
+//! Estimated seconds above which sampling is suggested.
+#define ESTIMATE_SECONDS 60
+//! Seconds the estimate of all the rows may take.
+#define ESTIMATE_BUDGET 2
+//! Largest estimate of the spaces of a row, larger searches are clamped.
+#define ESTIMATE_SPACES 1e30
+
+using namespace std;
+
+
+//! Sample counts struct.
+/*! The number of trajectories of a row ending on every outcome. */
+struct sampleCounts
+{
+    int trajectories; /*!< Number of trajectories sampled. */
+    int unfinished; /*!< Trajectories still running after MONTECARLO_STEPS steps. */
+    vector<int> stable; /*!< Trajectories ending on every stable space found. */
+    vector<int> forbidden; /*!< Trajectories ending on every forbidden space found. */
+    vector<int> outOfBounds; /*!< Trajectories ending on every out of bounds space found. */
+};
+
+
+//! Search estimate struct.
+/*! Estimated size of the exhaustive simulation of a row. */
+struct searchEstimate
+{
+    double spaces; /*!< Spaces the search simulates, an upper bound if branches meet again. */
+    double depth; /*!< Mean depth of the probes. */
+    int maxDepth; /*!< Deepest probe. */
+    double seconds; /*!< Time of the search at the speed of the probes. */
+    int probes; /*!< Probes done before the time ran out. */
+    int truncated; /*!< Probes cut at ESTIMATE_DEPTH or when the time ran out. */
+};
+
+
+class MonteCarloSimulation
+{
+public:
+    MonteCarloSimulation(list<Rule> *rules, list<ForbiddenPattern> *patterns);
+    virtual ~MonteCarloSimulation();
+    void setRates(vector<double> rates);
+    void setFrozen(vector<bool> frozen);
+    void sample(Grid space, int trajectories, unsigned long seed);
+    searchEstimate estimate(Grid space, int probes, unsigned long seed, double budget);
+    void merge(MonteCarloSimulation &other);
+    sampleCounts getCounts();
+    list<simulationStep> getStableLayouts();
+    list<simulationStep> getForbiddenLayouts();
+    list<simulationStep> getOutOfBounds();
+    static void interval(int hits, int trials, double *low, double *high);
+
+private:
+    void trajectory(Grid space);
+    double probe(Grid space, int *depth, bool *truncated);
+    void setSpace(Grid &space, unsigned long seed);
+    bool forbidden(Grid &space);
+    bool forbidden(Grid &space, ruleApplying &fired);
+    bool matches(Grid &space, bitInstance &pattern);
+    bool addOutcome(vector<int> &hits, map< unsigned long, list< pair<Grid, int> > > &found, Grid &space, int count);
+    simulationStep getStep(Grid &space);
+    double random();
+    //! Rules of the set, in the list order.
+    list<Rule> *rules;
+    //! Trigger dependency graph of the rules.
+    RuleGraph graph;
+    //! Forbidden patterns placed at every coordinate.
+    BitSimulation placement;
+    //! Pattern placements holding every cell, indexed by x * height + y.
+    vector< vector<int> > cellPatterns;
+    //! Pattern placements already checked since the last space, by the check.
+    vector<unsigned int> checked;
+    //! Number of the current check of the pattern placements.
+    unsigned int check;
+    //! Clock at which the estimate stops probing.
+    clock_t deadline;
+    //! Width of the spaces the patterns are placed on.
+    int width;
+    //! Height of the spaces the patterns are placed on.
+    int height;
+    //! Rate of every rule.
+    vector<double> rates;
+    //! Random stream state.
+    uint32_t state;
+    //! Initial space of the row.
+    Grid initial;
+    //! Rule placements fired by the current trajectory.
+    vector<ruleApplying> moves;
+    //! Outcome counts.
+    sampleCounts counts;
+    //! Witnesses of the stable spaces.
+    list<simulationStep> stable;
+    //! Witnesses of the forbidden spaces.
+    list<simulationStep> forbiddenFound;
+    //! Witnesses of the out of bounds spaces.
+    list<simulationStep> outOfBounds;
+    //! Stable spaces found and their positions, by hash.
+    map< unsigned long, list< pair<Grid, int> > > stableFound;
+    //! Forbidden spaces found and their positions, by hash.
+    map< unsigned long, list< pair<Grid, int> > > forbiddenSpaces;
+    //! Out of bounds spaces found and their positions, by hash.
+    map< unsigned long, list< pair<Grid, int> > > outOfBoundsFound;
+};
+
+#endif /*MONTECARLOSIMULATION_HPP_*/
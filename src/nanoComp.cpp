@@ -18,10 +18,40 @@
 // $Revision: 1.11 $
 
 #include "nanoComp.hpp"
+#include "simulationDaemon.hpp"
+#include <string>
+#include <iostream>
 
 using namespace std;
 
-IMPLEMENT_APP(NanoComp)
+IMPLEMENT_APP_NO_MAIN(NanoComp)
+
+//! Program entry point.
+/*!
+   With "--daemon <socket>" the simulation daemon serves the jobs sent to
+   the socket until it is shut down. The daemon only uses the wxWidgets
+   strings and files, so it runs before wxEntry and the GUI toolkit is
+   never started: it needs no display.
+   \param argc number of arguments.
+   \param argv the arguments.
+   \return Exit status.
+*/
+int main(int argc, char **argv)
+{
+    if (argc == 3 && string(argv[1]) == "--daemon")
+    {
+        SimulationDaemon daemon;
+        if (!daemon.listen(wxString(argv[2], wxConvUTF8)))
+        {
+            cerr << daemon.getError().mb_str() << endl;
+            return 1;
+        }
+        daemon.serve();
+        return 0;
+    }
+    return wxEntry(argc, argv);
+}
+
 
 //! Application initialization method.
 /*!
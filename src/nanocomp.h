@@ -0,0 +1,117 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \file nanocomp.h
+ * \brief C interface of the simulation engine.
+ * 
+ * libnanocomp simulates designs without wxWidgets, for programs that
+ * embed the engine. A design is a space, its rules and forbidden patterns
+ * and the input and output cells of a truth table. Every row of the
+ * table is simulated as the GUI simulates it, with the rotations of the
+ * rules and patterns, the rules that can never match the space left out
+ * and, when there are outputs, the cells that can not affect them left
+ * on their initial status.
+ * 
+ * Designs and results are opaque handles. Spaces are arrays of width *
+ * height cells, the cell (x, y) at index y * width + x. The spaces of a
+ * result are stored one after another in a single buffer owned by the
+ * result, so they are read in place until the result is freed. A NULL
+ * handle is not valid: the calls given one fail with NANOCOMP_EINVAL or
+ * return NULL, and no call lets an exception out of the library.
+ * 
+ * Only functions are added to this interface, so programs built against
+ * an older version keep working with a newer library.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef NANOCOMP_H_
+#define NANOCOMP_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The library is built with hidden symbols, only these are exported */
+#if defined(__GNUC__) && __GNUC__ >= 4
+#define NANOCOMP_API __attribute__((visibility("default")))
+#else
+#define NANOCOMP_API
+#endif
+
+/*! Version of the interface, returned by nanocomp_version. */
+#define NANOCOMP_VERSION 1
+
+/*! The cell may hold a molecule or not. */
+#define NANOCOMP_DONTCARE 0
+/*! The cell is not available for use. */
+#define NANOCOMP_NOSPACE 1
+/*! The cell holds a molecule. */
+#define NANOCOMP_ENABLED 2
+/*! The cell does not hold a molecule. */
+#define NANOCOMP_DISABLED 3
+
+/*! Stable spaces reached by a row. */
+#define NANOCOMP_STABLE 0
+/*! Spaces repeated in a branch of a row. */
+#define NANOCOMP_CYCLE 1
+/*! Spaces of a row with a forbidden pattern. */
+#define NANOCOMP_FORBIDDEN 2
+/*! Spaces of a row that push molecules out of the space. */
+#define NANOCOMP_OUTOFBOUNDS 3
+
+/*! Don't-care value of an expected output. */
+#define NANOCOMP_ANY -1
+
+/*! The call succeeded. */
+#define NANOCOMP_OK 0
+/*! An argument is not valid, see nanocomp_error. */
+#define NANOCOMP_EINVAL -1
+/*! The memory ran out, see nanocomp_error. */
+#define NANOCOMP_ENOMEM -2
+
+typedef struct nanocomp_design nanocomp_design;
+typedef struct nanocomp_results nanocomp_results;
+
+NANOCOMP_API int nanocomp_version(void);
+
+NANOCOMP_API nanocomp_design *nanocomp_design_new(int width, int height);
+NANOCOMP_API void nanocomp_design_free(nanocomp_design *design);
+NANOCOMP_API const char *nanocomp_error(const nanocomp_design *design);
+
+NANOCOMP_API int nanocomp_set_cells(nanocomp_design *design, const int *cells);
+NANOCOMP_API int nanocomp_add_rule(nanocomp_design *design, int width, int height, const int *initial, const int *final);
+NANOCOMP_API int nanocomp_add_pattern(nanocomp_design *design, int width, int height, const int *cells);
+NANOCOMP_API int nanocomp_set_io(nanocomp_design *design, int inputs, const int *inputCells, int outputs, const int *outputCells);
+NANOCOMP_API int nanocomp_set_expected(nanocomp_design *design, const int *expected, size_t count);
+NANOCOMP_API int nanocomp_rows(const nanocomp_design *design);
+
+NANOCOMP_API nanocomp_results *nanocomp_run_row(nanocomp_design *design, int row);
+NANOCOMP_API int nanocomp_results_count(const nanocomp_results *results, int kind);
+NANOCOMP_API const int *nanocomp_results_space(const nanocomp_results *results, int kind, int index);
+NANOCOMP_API int nanocomp_results_verified(const nanocomp_results *results);
+NANOCOMP_API int nanocomp_results_simulated(const nanocomp_results *results);
+NANOCOMP_API void nanocomp_results_free(nanocomp_results *results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /*NANOCOMP_H_*/
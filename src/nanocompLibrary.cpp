@@ -0,0 +1,741 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "nanocompLibrary.hpp"
+#include "ruleRotation.hpp"
+#include "staticPruning.hpp"
+#include <new>
+
+using namespace std;
+
+//! Builds a space from the cells of the C interface.
+/*!
+   \param width the width of the space.
+   \param height the height of the space.
+   \param cells the cells, the cell (x, y) at index y * width + x.
+   \param space the space built.
+   \return True iif every cell has a valid status.
+*/
+static bool readCells(int width, int height, const int *cells, matrix *space)
+{
+    if (cells == NULL)
+    {
+        return false;
+    }
+    space->assign(width, vector<int>(height, nDONTCARE));
+    for (int x = 0; x < width; x++)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            int status = cells[y * width + x];
+            if (status < NANOCOMP_DONTCARE || status > NANOCOMP_DISABLED)
+            {
+                return false;
+            }
+            (*space)[x][y] = status;
+        }
+    }
+    return true;
+}
+
+
+//! Reads cell coordinates of the C interface.
+/*!
+   \param design the design whose space holds the cells.
+   \param count the number of cells.
+   \param cells the x and y coordinates of every cell.
+   \param coordinates the coordinates read.
+   \return True iif every cell is inside the space.
+*/
+static bool readCoordinates(nanocomp_design *design, int count, const int *cells, vector<coordinate> *coordinates)
+{
+    if (count < 0 || (count > 0 && cells == NULL))
+    {
+        return false;
+    }
+    coordinates->clear();
+    for (int i = 0; i < count; i++)
+    {
+        coordinate c;
+        c.x = cells[2 * i];
+        c.y = cells[2 * i + 1];
+        if (c.x < 0 || c.x >= design->width || c.y < 0 || c.y >= design->height)
+        {
+            return false;
+        }
+        coordinates->push_back(c);
+    }
+    return true;
+}
+
+
+//! Constructor.
+ExpectedOutputs::ExpectedOutputs()
+{
+    values = NULL;
+    outputs = 0;
+}
+
+
+//! Sets the values read.
+/*!
+   \param values the outputs of every row one after another, 0, 1 or
+   NANOCOMP_ANY. They are read in place.
+   \param outputs the outputs of every row.
+*/
+void ExpectedOutputs::setValues(vector<int> *values, int outputs)
+{
+    this->values = values;
+    this->outputs = outputs;
+}
+
+
+//! Returns the expected outputs of a row.
+/*!
+   \param row the row.
+   \return The outputs, false for the don't-cares.
+*/
+vector<bool> ExpectedOutputs::getOutput(int row)
+{
+    vector<bool> result(outputs);
+    for (int i = 0; i < outputs; i++)
+    {
+        result[i] = (*values)[row * outputs + i] == 1;
+    }
+    return result;
+}
+
+
+//! Returns the expected outputs of a row that must have their value.
+/*!
+   \param row the row.
+   \return False for the outputs that are NANOCOMP_ANY.
+*/
+vector<bool> ExpectedOutputs::getCare(int row)
+{
+    vector<bool> result(outputs);
+    for (int i = 0; i < outputs; i++)
+    {
+        result[i] = (*values)[row * outputs + i] != NANOCOMP_ANY;
+    }
+    return result;
+}
+
+
+//! Sets the rows of a design to verify.
+/*!
+   Without expected outputs, the output cells are only emptied.
+   \param design the design.
+*/
+static void setVerifier(nanocomp_design *design)
+{
+    design->expectedOutputs.setValues(&design->expected, design->outputs.size());
+    design->verifier.setSpace(design->layout, design->inputs, vector<coordinate>());
+    design->verifier.addTable(design->inputs, design->outputs, design->expected.empty() ? NULL : &design->expectedOutputs);
+}
+
+
+//! Frees the engine compiled for a design.
+/*!
+   \param design the design.
+*/
+static void clearDesign(nanocomp_design *design)
+{
+    delete design->simulation;
+    delete design->tiles;
+    delete design->cache;
+    design->simulation = NULL;
+    design->tiles = NULL;
+    design->cache = NULL;
+    design->rules.clear();
+    design->patterns.clear();
+    design->frozen.clear();
+    design->compiled = false;
+}
+
+
+//! Frees the simulation of a design after a row failed.
+/*!
+   The rules stay compiled, the next row builds a new simulation.
+   \param design the design.
+*/
+static void dropSimulation(nanocomp_design *design)
+{
+    delete design->simulation;
+    design->simulation = NULL;
+    if (design->cache != NULL)
+    {
+        design->cache->clear();
+    }
+}
+
+
+//! Compiles the rules and patterns of a design.
+/*!
+   The rules and patterns get their rotations and the ones that can never
+   match the space are left out, as the GUI simulation does.
+   \param design the design.
+*/
+static void compileDesign(nanocomp_design *design)
+{
+    clearDesign(design);
+    RuleRotation rotation(&design->rules, &design->patterns);
+    for (list<Rule>::iterator i = design->sourceRules.begin(); i != design->sourceRules.end(); i++)
+    {
+        rotation.addRule((*i));
+    }
+    for (list<ForbiddenPattern>::iterator i = design->sourcePatterns.begin(); i != design->sourcePatterns.end(); i++)
+    {
+        rotation.addPattern((*i));
+    }
+    setVerifier(design);
+    vector<double> rates(design->rules.size(), 1);
+    StaticPruning pruning(&design->rules, &design->patterns);
+    pruning.prune(Grid(design->verifier.getRowLayout(0)), design->inputs, rates);
+    design->tiles = new TileSimulation(&design->rules, &design->patterns);
+    design->cache = new SpaceCache();
+    design->compiled = true;
+}
+
+
+//! Copies spaces to the buffer of a kind of results.
+/*!
+   \param steps the steps whose spaces are copied.
+   \param buffer the buffer, with the cell (x, y) of every space at index
+   y * width + x.
+*/
+static void copySpaces(list<simulationStep> &steps, vector<int> &buffer)
+{
+    for (list<simulationStep>::iterator i = steps.begin(); i != steps.end(); i++)
+    {
+        Grid &g = (*i).space.g;
+        int width = g.getWidth();
+        int height = g.getHeight();
+        unsigned int first = buffer.size();
+        buffer.resize(first + width * height);
+        for (int x = 0; x < width; x++)
+        {
+            for (int y = 0; y < height; y++)
+            {
+                buffer[first + y * width + x] = g(x, y);
+            }
+        }
+    }
+}
+
+
+//! Returns the version of the interface.
+/*!
+   \return NANOCOMP_VERSION of the library, not of the header used.
+*/
+int nanocomp_version(void)
+{
+    return NANOCOMP_VERSION;
+}
+
+
+//! Creates a design.
+/*!
+   The space starts with all its cells don't-care, without rules,
+   patterns, inputs or outputs.
+   \param width the width of the space.
+   \param height the height of the space.
+   \return The design, NULL if the size is not valid or the memory ran out.
+*/
+nanocomp_design *nanocomp_design_new(int width, int height)
+{
+    if (width <= 0 || height <= 0)
+    {
+        return NULL;
+    }
+    nanocomp_design *design = NULL;
+    try
+    {
+        design = new nanocomp_design;
+        design->width = width;
+        design->height = height;
+        design->layout.assign(width, vector<int>(height, nDONTCARE));
+    }
+    catch (bad_alloc &)
+    {
+        delete design;
+        return NULL;
+    }
+    design->compiled = false;
+    design->simulation = NULL;
+    design->tiles = NULL;
+    design->cache = NULL;
+    return design;
+}
+
+
+//! Frees a design.
+/*!
+   The results of its rows stay valid.
+   \param design the design, may be NULL.
+*/
+void nanocomp_design_free(nanocomp_design *design)
+{
+    if (design != NULL)
+    {
+        clearDesign(design);
+        delete design;
+    }
+}
+
+
+//! Returns the error of the last call that failed on a design.
+/*!
+   \param design the design.
+   \return The message, empty if the last call succeeded. It is valid
+   until the next call on the design.
+*/
+const char *nanocomp_error(const nanocomp_design *design)
+{
+    if (design == NULL)
+    {
+        return "invalid design";
+    }
+    return design->error.c_str();
+}
+
+
+//! Sets the cells of the space of a design.
+/*!
+   \param design the design.
+   \param cells width * height cells, the cell (x, y) at index y * width + x.
+   \return NANOCOMP_OK, NANOCOMP_EINVAL if the design is NULL or a cell is
+   not a valid status, or NANOCOMP_ENOMEM if the memory ran out.
+*/
+int nanocomp_set_cells(nanocomp_design *design, const int *cells)
+{
+    if (design == NULL)
+    {
+        return NANOCOMP_EINVAL;
+    }
+    try
+    {
+        matrix space;
+        if (!readCells(design->width, design->height, cells, &space))
+        {
+            design->error = "invalid cells";
+            return NANOCOMP_EINVAL;
+        }
+        design->layout = space;
+    }
+    catch (bad_alloc &)
+    {
+        design->error = "out of memory";
+        return NANOCOMP_ENOMEM;
+    }
+    design->compiled = false;
+    design->error.clear();
+    return NANOCOMP_OK;
+}
+
+
+//! Adds a rule to a design.
+/*!
+   The rotations of the rule are added when it is compiled.
+   \param design the design.
+   \param width the width of the rule.
+   \param height the height of the rule.
+   \param initial the initial cells of the rule, the cell (x, y) at index
+   y * width + x.
+   \param final the final cells of the rule, as the initial ones.
+   \return NANOCOMP_OK, NANOCOMP_EINVAL if the design is NULL, the size or
+   a cell is not valid or a rotation moves a site out of the rule, or
+   NANOCOMP_ENOMEM if the memory ran out.
+*/
+int nanocomp_add_rule(nanocomp_design *design, int width, int height, const int *initial, const int *final)
+{
+    if (design == NULL)
+    {
+        return NANOCOMP_EINVAL;
+    }
+    try
+    {
+        matrix initialCells, finalCells;
+        if (width <= 0 || height <= 0 || !readCells(width, height, initial, &initialCells) || !readCells(width, height, final, &finalCells))
+        {
+            design->error = "invalid rule";
+            return NANOCOMP_EINVAL;
+        }
+        Rule rule(width, height);
+        rule.setInitialGrid(Grid(initialCells));
+        rule.setFinalGrid(Grid(finalCells));
+        //The rotations are only checked here, they are added when compiled
+        list<Rule> rotatedRules;
+        list<ForbiddenPattern> rotatedPatterns;
+        if (!RuleRotation(&rotatedRules, &rotatedPatterns).addRule(rule))
+        {
+            design->error = "a rotation of the rule moves a site out of it";
+            return NANOCOMP_EINVAL;
+        }
+        design->sourceRules.push_back(rule);
+    }
+    catch (bad_alloc &)
+    {
+        design->error = "out of memory";
+        return NANOCOMP_ENOMEM;
+    }
+    design->compiled = false;
+    design->error.clear();
+    return NANOCOMP_OK;
+}
+
+
+//! Adds a forbidden pattern to a design.
+/*!
+   The rotations of the pattern are added when it is compiled.
+   \param design the design.
+   \param width the width of the pattern.
+   \param height the height of the pattern.
+   \param cells the cells of the pattern, the cell (x, y) at index
+   y * width + x.
+   \return NANOCOMP_OK, NANOCOMP_EINVAL if the design is NULL, the size or
+   a cell is not valid or a rotation moves a site out of the pattern, or
+   NANOCOMP_ENOMEM if the memory ran out.
+*/
+int nanocomp_add_pattern(nanocomp_design *design, int width, int height, const int *cells)
+{
+    if (design == NULL)
+    {
+        return NANOCOMP_EINVAL;
+    }
+    try
+    {
+        matrix patternCells;
+        if (width <= 0 || height <= 0 || !readCells(width, height, cells, &patternCells))
+        {
+            design->error = "invalid pattern";
+            return NANOCOMP_EINVAL;
+        }
+        ForbiddenPattern pattern(width, height);
+        pattern.setGrid(Grid(patternCells));
+        list<Rule> rotatedRules;
+        list<ForbiddenPattern> rotatedPatterns;
+        if (!RuleRotation(&rotatedRules, &rotatedPatterns).addPattern(pattern))
+        {
+            design->error = "a rotation of the pattern moves a site out of it";
+            return NANOCOMP_EINVAL;
+        }
+        design->sourcePatterns.push_back(pattern);
+    }
+    catch (bad_alloc &)
+    {
+        design->error = "out of memory";
+        return NANOCOMP_ENOMEM;
+    }
+    design->compiled = false;
+    design->error.clear();
+    return NANOCOMP_OK;
+}
+
+
+//! Sets the inputs and outputs of a design.
+/*!
+   The expected outputs are cleared.
+   \param design the design.
+   \param inputs the number of inputs, at most LIBRARY_INPUTS.
+   \param inputCells the x and y coordinates of every input, the first one
+   the most significant bit of the row.
+   \param outputs the number of outputs.
+   \param outputCells the x and y coordinates of every output.
+   \return NANOCOMP_OK, NANOCOMP_EINVAL if the design is NULL, there are too
+   many inputs or a cell is out of the space, or NANOCOMP_ENOMEM if the
+   memory ran out.
+*/
+int nanocomp_set_io(nanocomp_design *design, int inputs, const int *inputCells, int outputs, const int *outputCells)
+{
+    if (design == NULL)
+    {
+        return NANOCOMP_EINVAL;
+    }
+    try
+    {
+        vector<coordinate> newInputs, newOutputs;
+        if (inputs > LIBRARY_INPUTS || !readCoordinates(design, inputs, inputCells, &newInputs) || !readCoordinates(design, outputs, outputCells, &newOutputs))
+        {
+            design->error = "invalid inputs or outputs";
+            return NANOCOMP_EINVAL;
+        }
+        design->inputs = newInputs;
+        design->outputs = newOutputs;
+    }
+    catch (bad_alloc &)
+    {
+        design->error = "out of memory";
+        return NANOCOMP_ENOMEM;
+    }
+    design->expected.clear();
+    design->compiled = false;
+    design->error.clear();
+    return NANOCOMP_OK;
+}
+
+
+//! Sets the expected outputs of every row of a design.
+/*!
+   Without expected outputs, a row verifies if it reaches no forbidden
+   pattern and pushes no molecule out of the space.
+   \param design the design.
+   \param expected the outputs of every row one after another, 0, 1 or
+   NANOCOMP_ANY, or NULL to clear them.
+   \param count the number of values, nanocomp_rows times the number of
+   outputs, or 0 to clear them.
+   \return NANOCOMP_OK, NANOCOMP_EINVAL if the design is NULL, the count
+   does not match the rows and outputs of the design or a value is not
+   valid, or NANOCOMP_ENOMEM if the memory ran out.
+*/
+int nanocomp_set_expected(nanocomp_design *design, const int *expected, size_t count)
+{
+    if (design == NULL)
+    {
+        return NANOCOMP_EINVAL;
+    }
+    size_t size = (size_t)nanocomp_rows(design) * design->outputs.size();
+    if ((expected == NULL && count != 0) || (expected != NULL && count != size))
+    {
+        design->error = "the expected outputs do not match the rows and outputs";
+        return NANOCOMP_EINVAL;
+    }
+    for (size_t i = 0; expected != NULL && i < count; i++)
+    {
+        if (expected[i] != 0 && expected[i] != 1 && expected[i] != NANOCOMP_ANY)
+        {
+            design->error = "invalid expected outputs";
+            return NANOCOMP_EINVAL;
+        }
+    }
+    try
+    {
+        if (expected != NULL)
+        {
+            design->expected.assign(expected, expected + count);
+        }
+        else
+        {
+            design->expected.clear();
+        }
+        //A design compiled keeps its rules, only the verdicts change
+        if (design->compiled)
+        {
+            setVerifier(design);
+        }
+    }
+    catch (bad_alloc &)
+    {
+        //The verdicts are set again when the design is compiled
+        design->expected.clear();
+        design->compiled = false;
+        design->error = "out of memory";
+        return NANOCOMP_ENOMEM;
+    }
+    design->error.clear();
+    return NANOCOMP_OK;
+}
+
+
+//! Returns the number of rows of a design.
+/*!
+   \param design the design.
+   \return Two to the number of inputs, NANOCOMP_EINVAL if the design is
+   NULL.
+*/
+int nanocomp_rows(const nanocomp_design *design)
+{
+    if (design == NULL)
+    {
+        return NANOCOMP_EINVAL;
+    }
+    return 1 << design->inputs.size();
+}
+
+
+//! Simulates a row of a design.
+/*!
+   The design is compiled first if it changed. When it has outputs, the
+   cells that can not affect them are left on their initial status, so
+   they keep it in the spaces of the results.
+   \param design the design.
+   \param row the row, from 0 to nanocomp_rows - 1.
+   \return The results of the row, NULL if the design is NULL, the row is
+   not valid, the memory ran out or the simulation failed.
+*/
+nanocomp_results *nanocomp_run_row(nanocomp_design *design, int row)
+{
+    if (design == NULL)
+    {
+        return NULL;
+    }
+    if (row < 0 || row >= nanocomp_rows(design))
+    {
+        design->error = "invalid row";
+        return NULL;
+    }
+    nanocomp_results *results = NULL;
+    try
+    {
+        if (!design->compiled)
+        {
+            compileDesign(design);
+        }
+        matrix rowLayout = design->verifier.getRowLayout(row);
+        //The simulation is reset with the same rules, so it keeps its rule index
+        Simulation *simulation = design->simulation;
+        if (simulation == NULL)
+        {
+            simulation = new Simulation(NULL, NULL, Grid(rowLayout), &design->rules, &design->patterns);
+            simulation->setCache(design->cache);
+            design->simulation = simulation;
+        }
+        else
+        {
+            simulation->resetSimulation(NULL, NULL, Grid(rowLayout), &design->rules, &design->patterns);
+        }
+        //Only the cells that can affect the outputs are simulated
+        vector<bool> rowFrozen;
+        if (!design->outputs.empty())
+        {
+            design->tiles->slice(Grid(rowLayout), design->outputs, rowFrozen);
+        }
+        if (rowFrozen != design->frozen)
+        {
+            //The spaces simulated with other cells left out have other results
+            design->cache->clear();
+            design->frozen = rowFrozen;
+        }
+        simulation->setFrozen(design->frozen);
+        while (!simulation->isFinished())
+        {
+            simulation->nextStep(false);
+        }
+        
+        list<simulationStep> stable = simulation->getStableLayouts();
+        list<simulationStep> cycles = simulation->getCycles();
+        list<simulationStep> forbidden = simulation->getForbiddenLayouts();
+        list<simulationStep> outOfBounds = simulation->getOutOfBounds();
+        results = new nanocomp_results;
+        results->cells = design->width * design->height;
+        copySpaces(stable, results->spaces[NANOCOMP_STABLE]);
+        copySpaces(cycles, results->spaces[NANOCOMP_CYCLE]);
+        copySpaces(forbidden, results->spaces[NANOCOMP_FORBIDDEN]);
+        copySpaces(outOfBounds, results->spaces[NANOCOMP_OUTOFBOUNDS]);
+        results->simulated = simulation->getProcessedLayouts().size();
+        results->verified = design->verifier.verifyRow(row, stable, cycles, forbidden, outOfBounds, ALL_TABLES);
+    }
+    catch (bad_alloc &)
+    {
+        delete results;
+        dropSimulation(design);
+        design->error = "out of memory";
+        return NULL;
+    }
+    catch (...)
+    {
+        delete results;
+        dropSimulation(design);
+        design->error = "simulation failed";
+        return NULL;
+    }
+    design->error.clear();
+    return results;
+}
+
+
+//! Returns the number of spaces of a kind in the results of a row.
+/*!
+   \param results the results.
+   \param kind NANOCOMP_STABLE, NANOCOMP_CYCLE, NANOCOMP_FORBIDDEN or
+   NANOCOMP_OUTOFBOUNDS.
+   \return The number of spaces, NANOCOMP_EINVAL if the results are NULL or
+   the kind is not valid.
+*/
+int nanocomp_results_count(const nanocomp_results *results, int kind)
+{
+    if (results == NULL || kind < 0 || kind >= LIBRARY_KINDS)
+    {
+        return NANOCOMP_EINVAL;
+    }
+    return results->spaces[kind].size() / results->cells;
+}
+
+
+//! Returns a space of the results of a row.
+/*!
+   \param results the results.
+   \param kind the kind of the space, as in nanocomp_results_count.
+   \param index the space, from 0 to its count - 1.
+   \return The cells of the space, the cell (x, y) at index y * width + x,
+   valid until the results are freed. NULL if the results are NULL or the
+   space does not exist.
+*/
+const int *nanocomp_results_space(const nanocomp_results *results, int kind, int index)
+{
+    if (results == NULL || index < 0 || index >= nanocomp_results_count(results, kind))
+    {
+        return NULL;
+    }
+    return &results->spaces[kind][index * results->cells];
+}
+
+
+//! Returns if a row verifies its expected outputs.
+/*!
+   \param results the results of the row.
+   \return 1 if no forbidden pattern or out of bounds was found and every
+   stable space and every space of a cycle has the expected outputs,
+   otherwise 0. NANOCOMP_EINVAL if the results are NULL.
+*/
+int nanocomp_results_verified(const nanocomp_results *results)
+{
+    if (results == NULL)
+    {
+        return NANOCOMP_EINVAL;
+    }
+    return results->verified ? 1 : 0;
+}
+
+
+//! Returns the number of spaces a row simulated.
+/*!
+   The spaces whose results were reused from earlier rows are not counted.
+   \param results the results of the row.
+   \return The number of spaces, NANOCOMP_EINVAL if the results are NULL.
+*/
+int nanocomp_results_simulated(const nanocomp_results *results)
+{
+    if (results == NULL)
+    {
+        return NANOCOMP_EINVAL;
+    }
+    return results->simulated;
+}
+
+
+//! Frees the results of a row.
+/*!
+   \param results the results, may be NULL.
+*/
+void nanocomp_results_free(nanocomp_results *results)
+{
+    delete results;
+}
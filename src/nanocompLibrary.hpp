@@ -0,0 +1,98 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \file nanocompLibrary.hpp
+ * \brief Structs behind the handles of the C interface.
+ * 
+ * A design keeps its rules and patterns as added, and compiles them the
+ * first time a row is simulated after a change. The simulation, its rule
+ * index and its cache of spaces are kept between rows.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef NANOCOMPLIBRARY_HPP_
+#define NANOCOMPLIBRARY_HPP_
+
+#include "nanocomp.h"
+#include "simulation.hpp"
+#include "spaceCache.hpp"
+#include "tileSimulation.hpp"
+#include "rowVerifier.hpp"
+#include <string>
+#include <vector>
+#include <list>
+
+using namespace std;
+
+//! Inputs of the largest truth table of a design.
+#define LIBRARY_INPUTS 30
+//! Kinds of spaces in the results of a row.
+#define LIBRARY_KINDS (NANOCOMP_OUTOFBOUNDS + 1)
+
+//! Expected outputs of a design, read by its row verifier.
+class ExpectedOutputs : public RowOutputs
+{
+public:
+    ExpectedOutputs();
+    void setValues(vector<int> *values, int outputs);
+    vector<bool> getOutput(int row);
+    vector<bool> getCare(int row);
+
+private:
+    //! Outputs of every row one after another, 0, 1 or NANOCOMP_ANY.
+    vector<int> *values;
+    //! Outputs of every row.
+    int outputs;
+};
+
+//! Design struct.
+/*! A design of the C interface and the engine compiled for it. */
+struct nanocomp_design
+{
+    int width; /*!< Width of the space. */
+    int height; /*!< Height of the space. */
+    matrix layout; /*!< Space. */
+    list<Rule> sourceRules; /*!< Rules as added. */
+    list<ForbiddenPattern> sourcePatterns; /*!< Forbidden patterns as added. */
+    vector<coordinate> inputs; /*!< Input coordinates, the first one the most significant bit of the row. */
+    vector<coordinate> outputs; /*!< Output coordinates. */
+    vector<int> expected; /*!< Expected outputs of every row, empty if not set. */
+    bool compiled; /*!< True if the rules and patterns below are up to date. */
+    list<Rule> rules; /*!< Rules with their rotations, without the ones that can never match. */
+    list<ForbiddenPattern> patterns; /*!< Forbidden patterns with their rotations, without the ones that can never match. */
+    ExpectedOutputs expectedOutputs; /*!< Expected outputs read by the verifier. */
+    RowVerifier verifier; /*!< Initial spaces and verdicts of the rows. */
+    Simulation *simulation; /*!< Simulation of the rows, NULL before the first one. */
+    TileSimulation *tiles; /*!< Slicing of the rows, NULL if not compiled. */
+    SpaceCache *cache; /*!< Results of the spaces simulated, shared by the rows. */
+    vector<bool> frozen; /*!< Cells left out of the simulation of the last row. */
+    string error; /*!< Error of the last call, empty if none. */
+};
+
+//! Results struct.
+/*! The spaces reached by a row, every kind in a single buffer. */
+struct nanocomp_results
+{
+    int cells; /*!< Cells of every space. */
+    vector<int> spaces[LIBRARY_KINDS]; /*!< Spaces of every kind, one after another. */
+    bool verified; /*!< True if the row verifies the expected outputs. */
+    int simulated; /*!< Spaces simulated by the row. */
+};
+
+#endif /*NANOCOMPLIBRARY_HPP_*/
@@ -0,0 +1,422 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "projectReader.hpp"
+#include "ruleDiskManager.hpp"
+#include "forbiddenPatternDiskManager.hpp"
+#include "truthTableDiskManager.hpp"
+#include "layoutDiskManager.hpp"
+#include "layoutConfig.hpp"
+#include <wx/filename.h>
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <cstdlib>
+
+using namespace std;
+
+//! Constructor.
+ProjectReader::ProjectReader()
+{
+    error = wxEmptyString;
+}
+
+
+//! Destructor.
+ProjectReader::~ProjectReader()
+{
+}
+
+
+//! Reads a project file and the files it names.
+/*!
+   \param fileName the project file.
+   \param result where to store the design read.
+   \return True iif the project was read correctly.
+*/
+bool ProjectReader::openProject(wxString fileName, design *result)
+{
+    vector<wxString> files;
+    if (!getFiles(fileName, &files))
+    {
+        return false;
+    }
+    //A project may have no rules or no patterns, they read as empty files
+    vector<istream *> streams;
+    for (unsigned int i = 0; i < files.size(); i++)
+    {
+        if (files[i].IsEmpty())
+        {
+            streams.push_back(new istringstream(""));
+        }
+        else
+        {
+            streams.push_back(new ifstream(files[i].mb_str()));
+        }
+    }
+    ifstream project(fileName.mb_str());
+    bool read = true;
+    for (unsigned int i = 0; i < streams.size(); i++)
+    {
+        if (streams[i]->fail())
+        {
+            error = _("Can not open ") + files[i];
+            read = false;
+        }
+    }
+    read = read && readProject(&project, streams[0], streams[1], streams[2], streams[3], result);
+    for (unsigned int i = 0; i < streams.size(); i++)
+    {
+        delete streams[i];
+    }
+    return read;
+}
+
+
+//! Returns the files named by a project file.
+/*!
+   \param fileName the project file.
+   \param files returns the rules, patterns, tables and space files, with
+   the path of the project, or empty if the project has none.
+   \return True iif the project file names its files.
+*/
+bool ProjectReader::getFiles(wxString fileName, vector<wxString> *files)
+{
+    ifstream project(fileName.mb_str());
+    if (project.fail())
+    {
+        error = _("Can not open ") + fileName;
+        return false;
+    }
+    wxString path = wxFileName(fileName).GetPath(wxPATH_GET_VOLUME | wxPATH_GET_SEPARATOR);
+    const char *keys[] = {"rules=", "fps=", "tables=", "layout="};
+    files->clear();
+    for (int i = 0; i < 4; i++)
+    {
+        string line;
+        wxString name;
+        if (!readLine(&project, &line) || !wxString(line.c_str(), wxConvUTF8).StartsWith(wxString(keys[i], wxConvUTF8), &name))
+        {
+            error = _("Project file format error");
+            return false;
+        }
+        if (name.IsEmpty())
+        {
+            files->push_back(wxEmptyString);
+        }
+        else
+        {
+            files->push_back(path + name);
+        }
+    }
+    return true;
+}
+
+
+//! Reads a project from the contents of its files.
+/*!
+   The project file is read as saved: the file names it starts with are
+   skipped, the files are the streams given.
+   \param project the project file.
+   \param rules the rules file.
+   \param patterns the forbidden patterns file.
+   \param tables the truth tables file.
+   \param layout the space file.
+   \param result where to store the design read.
+   \return True iif the project was read correctly.
+*/
+bool ProjectReader::readProject(istream *project, istream *rules, istream *patterns, istream *tables, istream *layout, design *result)
+{
+    //The readers are only used to parse, they have no controllers
+    list<Rule *> ruleList;
+    list<ForbiddenPattern *> patternList;
+    list<TruthTable *> tableList;
+    LayoutConfig *layoutConfig = NULL;
+    RuleDiskManager ruleReader(NULL);
+    ForbiddenPatternDiskManager patternReader(NULL);
+    TruthTableDiskManager tableReader(NULL);
+    LayoutDiskManager layoutReader(NULL);
+    bool read = true;
+    if (!ruleReader.readRules(rules, &ruleList))
+    {
+        error = _("Rule file format error");
+        read = false;
+    }
+    else if (!patternReader.readFPs(patterns, &patternList))
+    {
+        error = _("Forbidden pattern file format error");
+        read = false;
+    }
+    else if (!tableReader.readTables(tables, &tableList))
+    {
+        error = _("Truth table file format error");
+        read = false;
+    }
+    else if (!layoutReader.readLayouts(layout, &layoutConfig))
+    {
+        error = _("Space file format error");
+        read = false;
+    }
+    
+    //The tables that fit the space are listed by name
+    map<wxString, TruthTable *> valid;
+    map<wxString, TruthTable *> named;
+    for (list<TruthTable *>::iterator i = tableList.begin(); read && i != tableList.end(); i++)
+    {
+        named[(*i)->getName()] = *i;
+        if ((*i)->getInputs() <= layoutConfig->getInputs() && (*i)->getOutputs() <= layoutConfig->getOutputs())
+        {
+            valid[(*i)->getName()] = *i;
+        }
+    }
+    
+    //The file names were given as streams
+    string line;
+    for (int i = 0; read && i < 4; i++)
+    {
+        if (!readLine(project, &line))
+        {
+            error = _("Project file format error");
+            read = false;
+        }
+    }
+    
+    //Tables, the first one checked is simulated and the rest verified
+    TruthTable *selected = NULL;
+    vector<TruthTable *> checked;
+    vector< vector<coordinate> > checkedInputs, checkedOutputs;
+    for (unsigned int i = 0; read && i < valid.size(); i++)
+    {
+        long enabled;
+        if (!readLine(project, &line) || valid.find(wxString(line.c_str(), wxConvUTF8)) == valid.end() || !readNumber(project, &enabled))
+        {
+            error = _("Error mapping tables");
+            read = false;
+            break;
+        }
+        TruthTable *table = valid[wxString(line.c_str(), wxConvUTF8)];
+        vector<coordinate> inputs(table->getInputs());
+        vector<coordinate> outputs(table->getOutputs());
+        for (unsigned int j = 0; read && j < inputs.size(); j++)
+        {
+            read = readCoordinate(project, &inputs[j]);
+        }
+        for (unsigned int j = 0; read && j < outputs.size(); j++)
+        {
+            read = readCoordinate(project, &outputs[j]);
+        }
+        if (!read)
+        {
+            error = _("Error mapping tables");
+        }
+        else if (enabled == 1)
+        {
+            checked.push_back(table);
+            checkedInputs.push_back(inputs);
+            checkedOutputs.push_back(outputs);
+            if (selected == NULL || table->getName() < selected->getName())
+            {
+                selected = table;
+                result->inputs = inputs;
+                result->outputs = outputs;
+            }
+        }
+    }
+    if (read && selected == NULL)
+    {
+        error = _("No truth table checked");
+        read = false;
+    }
+    
+    //Rules and patterns, enabled unless the project says otherwise
+    vector<bool> ruleEnabled(ruleList.size(), true);
+    vector<bool> patternEnabled(patternList.size(), true);
+    for (unsigned int i = 0; read && i < ruleEnabled.size() + patternEnabled.size(); i++)
+    {
+        vector<bool> &enabled = i < ruleEnabled.size() ? ruleEnabled : patternEnabled;
+        long id;
+        long checked;
+        if (!readNumber(project, &id) || !readNumber(project, &checked) || (checked != 0 && checked != 1))
+        {
+            error = i < ruleEnabled.size() ? _("Error mapping rules") : _("Error mapping patterns");
+            read = false;
+        }
+        else if (id >= 1 && id <= (long)enabled.size())
+        {
+            enabled[id - 1] = checked == 1;
+        }
+    }
+    
+    //Sub-circuit instances, the projects saved before them have none
+    long instances = 0;
+    if (read && readLine(project, &line) && !line.empty())
+    {
+        char *end;
+        instances = strtol(line.c_str(), &end, 10);
+        if (*end != '\0' || instances < 0)
+        {
+            error = _("Error mapping sub-circuit instances");
+            read = false;
+        }
+    }
+    for (long i = 0; read && i < instances; i++)
+    {
+        subCircuit instance;
+        if (!readLine(project, &line) || named.find(wxString(line.c_str(), wxConvUTF8)) == named.end())
+        {
+            error = _("Error mapping sub-circuit instances");
+            read = false;
+            break;
+        }
+        instance.table = wxString(line.c_str(), wxConvUTF8);
+        TruthTable *table = named[instance.table];
+        instance.inputs.resize(table->getInputs());
+        instance.outputs.resize(table->getOutputs());
+        for (unsigned int j = 0; read && j < instance.inputs.size(); j++)
+        {
+            read = readCoordinate(project, &instance.inputs[j]);
+        }
+        for (unsigned int j = 0; read && j < instance.outputs.size(); j++)
+        {
+            read = readCoordinate(project, &instance.outputs[j]);
+        }
+        if (!read)
+        {
+            error = _("Error mapping sub-circuit instances");
+        }
+        result->instances.push_back(instance);
+        result->instanceTables.push_back(table->getTable());
+    }
+    
+    if (read)
+    {
+        int k = 0;
+        for (list<Rule *>::iterator i = ruleList.begin(); i != ruleList.end(); i++, k++)
+        {
+            if (ruleEnabled[k])
+            {
+                result->rules.push_back(**i);
+            }
+        }
+        k = 0;
+        for (list<ForbiddenPattern *>::iterator i = patternList.begin(); i != patternList.end(); i++, k++)
+        {
+            if (patternEnabled[k])
+            {
+                result->patterns.push_back(**i);
+            }
+        }
+        result->table = *selected;
+        for (unsigned int t = 0; t < checked.size(); t++)
+        {
+            if (checked[t] != selected)
+            {
+                result->otherTables.push_back(*checked[t]);
+                result->otherInputs.push_back(checkedInputs[t]);
+                result->otherOutputs.push_back(checkedOutputs[t]);
+            }
+        }
+        result->layout = layoutConfig->getMatrix();
+        error = wxEmptyString;
+    }
+    for (list<Rule *>::iterator i = ruleList.begin(); i != ruleList.end(); i++)
+    {
+        delete *i;
+    }
+    for (list<ForbiddenPattern *>::iterator i = patternList.begin(); i != patternList.end(); i++)
+    {
+        delete *i;
+    }
+    for (list<TruthTable *>::iterator i = tableList.begin(); i != tableList.end(); i++)
+    {
+        delete *i;
+    }
+    delete layoutConfig;
+    return read;
+}
+
+
+//! Member accessor.
+/*!
+   \return The error of the last project read, empty if it was read.
+*/
+wxString ProjectReader::getError()
+{
+    return error;
+}
+
+
+//! Reads a line from a stream.
+/*!
+   \param is the input stream.
+   \param line returns the line, without its end.
+   \return False at the end of the stream.
+*/
+bool ProjectReader::readLine(istream *is, string *line)
+{
+    if (!getline(*is, *line))
+    {
+        return false;
+    }
+    if (!line->empty() && (*line)[line->size() - 1] == '\r')
+    {
+        line->erase(line->size() - 1);
+    }
+    return true;
+}
+
+
+//! Reads a line with a number from a stream.
+/*!
+   \param is the input stream.
+   \param value returns the number.
+   \return True iif the line was a number.
+*/
+bool ProjectReader::readNumber(istream *is, long *value)
+{
+    string line;
+    if (!readLine(is, &line) || line.empty())
+    {
+        return false;
+    }
+    char *end;
+    *value = strtol(line.c_str(), &end, 10);
+    return *end == '\0';
+}
+
+
+//! Reads the two lines of a coordinate from a stream.
+/*!
+   \param is the input stream.
+   \param c returns the coordinate.
+   \return True iif the coordinate was read.
+*/
+bool ProjectReader::readCoordinate(istream *is, coordinate *c)
+{
+    long x;
+    long y;
+    if (!readNumber(is, &x) || !readNumber(is, &y))
+    {
+        return false;
+    }
+    c->x = x;
+    c->y = y;
+    return true;
+}
@@ -0,0 +1,85 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class ProjectReader
+ * \brief Reads a project without the GUI.
+ * 
+ * The rules, forbidden patterns, truth tables and space of a project are
+ * read with the same readers the GUI uses, but they are not handed to the
+ * controllers: the result is a design ready to be simulated, with the
+ * rules and patterns enabled by the project, the input and output cells
+ * of the first truth table checked and the rest of tables checked, which
+ * are verified on the same rows. A project is read from its
+ * file or from the contents of its files, so designs that are not saved
+ * anywhere can be simulated too.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef PROJECTREADER_HPP_
+#define PROJECTREADER_HPP_
+
+#include "rule.hpp"
+#include "forbiddenPattern.hpp"
+#include "truthTable.hpp"
+#include "layoutManager.hpp"
+#include <wx/wx.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <list>
+
+using namespace std;
+
+//! Design struct.
+/*! A design read from a project, ready to be simulated. */
+struct design
+{
+    list<Rule> rules; /*!< Rules enabled, in file order. */
+    list<ForbiddenPattern> patterns; /*!< Forbidden patterns enabled, in file order. */
+    TruthTable table; /*!< First truth table checked. */
+    vector<coordinate> inputs; /*!< Input coordinates of the table. */
+    vector<coordinate> outputs; /*!< Output coordinates of the table. */
+    vector<TruthTable> otherTables; /*!< Rest of truth tables checked, in file order. */
+    vector< vector<coordinate> > otherInputs; /*!< Input coordinates of the rest of tables. */
+    vector< vector<coordinate> > otherOutputs; /*!< Output coordinates of the rest of tables. */
+    matrix layout; /*!< Space. */
+    vector<subCircuit> instances; /*!< Sub-circuit instances. */
+    vector< vector< vector<bool> > > instanceTables; /*!< Truth table of every sub-circuit instance. */
+};
+
+class ProjectReader
+{
+public:
+    ProjectReader();
+    virtual ~ProjectReader();
+    bool openProject(wxString fileName, design *result);
+    bool readProject(istream *project, istream *rules, istream *patterns, istream *tables, istream *layout, design *result);
+    bool getFiles(wxString fileName, vector<wxString> *files);
+    wxString getError();
+
+private:
+    bool readLine(istream *is, string *line);
+    bool readNumber(istream *is, long *value);
+    bool readCoordinate(istream *is, coordinate *c);
+    
+    //! Error of the last project read.
+    wxString error;
+};
+
+#endif /*PROJECTREADER_HPP_*/
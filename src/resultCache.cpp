@@ -0,0 +1,424 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "resultCache.hpp"
+#include <wx/filename.h>
+#include <wx/utils.h>
+#include <fstream>
+#include <sstream>
+
+//! Constructor.
+ResultCache::ResultCache()
+{
+}
+
+
+//! Destructor.
+ResultCache::~ResultCache()
+{
+}
+
+
+//! Finds or creates the cache directory.
+/*!
+   \return True iif the directory can be used.
+*/
+bool ResultCache::open()
+{
+    if (!wxGetEnv(wxT("NANOCOMP_CACHE"), &directory) || directory.IsEmpty())
+    {
+        directory = wxGetHomeDir() + wxFILE_SEP_PATH + wxT(RESULTCACHE_DIR);
+    }
+    if (!wxDirExists(directory) && !wxFileName::Mkdir(directory, 0777, wxPATH_MKDIR_FULL))
+    {
+        directory = wxEmptyString;
+        return false;
+    }
+    return true;
+}
+
+
+//! Sets what the results of every row of the simulation depend on.
+/*!
+   \param rules the rule list to be applied.
+   \param patterns the forbidden pattern list to be found.
+   \param semantics the rule placements fired by every step.
+   \param inputs the input cells.
+   \param outputs the output cells of all the tables checked.
+*/
+void ResultCache::setContext(list<Rule> *rules, list<ForbiddenPattern> *patterns, int semantics, vector<coordinate> &inputs, vector<coordinate> &outputs)
+{
+    ostringstream key;
+    key << "S" << semantics << "R" << rules->size();
+    context = key.str();
+    for (list<Rule>::iterator i = rules->begin(); i != rules->end(); i++)
+    {
+        coordinate anchor = (*i).getAnchor();
+        key.str("");
+        key << "A" << anchor.x << "," << anchor.y;
+        context += key.str();
+        addGrid(context, (*i).getInitialGrid());
+        addGrid(context, (*i).getFinalGrid());
+    }
+    key.str("");
+    key << "P" << patterns->size();
+    context += key.str();
+    for (list<ForbiddenPattern>::iterator i = patterns->begin(); i != patterns->end(); i++)
+    {
+        addGrid(context, (*i).getGrid());
+    }
+    key.str("");
+    key << "I";
+    for (unsigned int i = 0; i < inputs.size(); i++)
+    {
+        key << inputs[i].x << "," << inputs[i].y << ";";
+    }
+    key << "O";
+    for (unsigned int i = 0; i < outputs.size(); i++)
+    {
+        key << outputs[i].x << "," << outputs[i].y << ";";
+    }
+    context += key.str();
+}
+
+
+//! Finds the results of a row.
+/*!
+   \param space the initial space of the row, with its inputs set.
+   \param frozen the cells left out of the row.
+   \param expected the outputs the row must have.
+   \param row returns the results found.
+   \return True iif the results of the row were stored.
+*/
+bool ResultCache::find(Grid space, vector<bool> &frozen, wxString expected, cachedRow *row)
+{
+    if (directory.IsEmpty())
+    {
+        return false;
+    }
+    string key = getKey(space, frozen, expected);
+    wxString fileName = getFileName(key, wxT(".nrc"));
+    ifstream file(fileName.mb_str());
+    if (!file)
+    {
+        return false;
+    }
+    //A different key with the same hash has another check
+    string header;
+    getline(file, header);
+    uint64_t check;
+    int width, height;
+    if (header != RESULTCACHE_HEADER || !(file >> hex >> check >> dec) || check != getCheck(key))
+    {
+        return false;
+    }
+    if (!(file >> row->verified >> width >> height) || width != space.getWidth() || height != space.getHeight())
+    {
+        return false;
+    }
+    row->stable.clear();
+    row->cycles.clear();
+    row->forbidden.clear();
+    row->outOfBounds.clear();
+    return readEvents(file, width, height, false, &row->stable) && readEvents(file, width, height, true, &row->cycles) && readEvents(file, width, height, false, &row->forbidden) && readEvents(file, width, height, false, &row->outOfBounds);
+}
+
+
+//! Stores the results of a row.
+/*!
+   The file is written under a temporary name and then renamed, so other
+   processes never read it half written. The temporary name has the host
+   and the process, since the cache may be shared over a network file
+   system.
+   \param space the initial space of the row, with its inputs set.
+   \param frozen the cells left out of the row.
+   \param expected the outputs the row must have.
+   \param row the results of the row.
+   \return True iif the results were stored.
+*/
+bool ResultCache::store(Grid space, vector<bool> &frozen, wxString expected, cachedRow &row)
+{
+    if (directory.IsEmpty())
+    {
+        return false;
+    }
+    unsigned int spaces = row.stable.size() + row.forbidden.size() + row.outOfBounds.size();
+    for (list<simulationStep>::iterator i = row.cycles.begin(); i != row.cycles.end(); i++)
+    {
+        spaces += (*i).path.size();
+    }
+    if (spaces > RESULTCACHE_SPACES)
+    {
+        return false;
+    }
+    string key = getKey(space, frozen, expected);
+    wxString fileName = getFileName(key, wxT(".nrc"));
+    wxString tempName = fileName + wxT(".") + wxGetFullHostName() + wxString::Format(wxT(".%lu.tmp"), wxGetProcessId());
+    ofstream file(tempName.mb_str());
+    if (!file)
+    {
+        return false;
+    }
+    file << RESULTCACHE_HEADER << endl;
+    file << hex << getCheck(key) << dec << endl;
+    file << row.verified << endl;
+    file << space.getWidth() << " " << space.getHeight() << endl;
+    file << row.stable.size() << endl;
+    for (list<simulationStep>::iterator i = row.stable.begin(); i != row.stable.end(); i++)
+    {
+        writeSpace(file, (*i).space.g);
+    }
+    //Only the spaces of the cycle are kept from its path
+    file << row.cycles.size() << endl;
+    for (list<simulationStep>::iterator i = row.cycles.begin(); i != row.cycles.end(); i++)
+    {
+        list<spaceHighlighted>::iterator start = (*i).path.begin();
+        while (start != (*i).path.end() && !((*start).g == (*i).space.g))
+        {
+            start++;
+        }
+        int length = 0;
+        for (list<spaceHighlighted>::iterator j = start; j != (*i).path.end(); j++)
+        {
+            length++;
+        }
+        file << length << endl;
+        for (list<spaceHighlighted>::iterator j = start; j != (*i).path.end(); j++)
+        {
+            writeSpace(file, (*j).g);
+        }
+    }
+    file << row.forbidden.size() << endl;
+    for (list<simulationStep>::iterator i = row.forbidden.begin(); i != row.forbidden.end(); i++)
+    {
+        writeSpace(file, (*i).space.g);
+    }
+    file << row.outOfBounds.size() << endl;
+    for (list<simulationStep>::iterator i = row.outOfBounds.begin(); i != row.outOfBounds.end(); i++)
+    {
+        writeSpace(file, (*i).space.g);
+    }
+    file.close();
+    if (file.fail() || !wxRenameFile(tempName, fileName, true))
+    {
+        wxRemoveFile(tempName);
+        return false;
+    }
+    return true;
+}
+
+
+//! Returns the directory of the cache files.
+/*!
+   \return The directory, empty if the cache can not be used.
+*/
+wxString ResultCache::getDirectory()
+{
+    return directory;
+}
+
+
+//! Returns the key of a row.
+/*!
+   \param space the initial space of the row.
+   \param frozen the cells left out of the row.
+   \param expected the outputs the row must have.
+   \return The context followed by the row data.
+*/
+string ResultCache::getKey(Grid &space, vector<bool> &frozen, wxString expected)
+{
+    string key = context + "G";
+    addGrid(key, space);
+    key += "F";
+    for (unsigned int i = 0; i < frozen.size(); i++)
+    {
+        key += frozen[i] ? '1' : '0';
+    }
+    key += "E";
+    key += string(expected.mb_str());
+    return key;
+}
+
+
+//! Returns the file name of a key.
+/*!
+   \param key the key.
+   \param extension the extension of the file.
+   \return The path of the file, named after the FNV-1a hash of the key.
+*/
+wxString ResultCache::getFileName(string &key, wxString extension)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (unsigned int i = 0; i < key.size(); i++)
+    {
+        hash = (hash ^ (unsigned char)key[i]) * 1099511628211ULL;
+    }
+    ostringstream name;
+    name.width(16);
+    name.fill('0');
+    name << hex << hash;
+    return directory + wxFILE_SEP_PATH + wxString(name.str().c_str(), wxConvUTF8) + extension;
+}
+
+
+//! Returns the check of a key.
+/*!
+   A second hash, independent of the file name, to tell apart the keys
+   whose files have the same name.
+   \param key the key.
+   \return The sdbm hash of the key.
+*/
+uint64_t ResultCache::getCheck(string &key)
+{
+    uint64_t hash = 0;
+    for (unsigned int i = 0; i < key.size(); i++)
+    {
+        hash = (unsigned char)key[i] + (hash << 6) + (hash << 16) - hash;
+    }
+    return hash;
+}
+
+
+//! Appends a grid to a key.
+/*!
+   \param key the key.
+   \param grid the grid.
+*/
+void ResultCache::addGrid(string &key, Grid grid)
+{
+    ostringstream size;
+    size << grid.getWidth() << "x" << grid.getHeight() << ":";
+    key += size.str();
+    for (int i = 0; i < grid.getWidth(); i++)
+    {
+        for (int j = 0; j < grid.getHeight(); j++)
+        {
+            key += (char)('0' + grid(i, j));
+        }
+    }
+}
+
+
+//! Writes a space as a line of cell status.
+/*!
+   \param file the file.
+   \param space the space.
+*/
+void ResultCache::writeSpace(ostream &file, Grid &space)
+{
+    string line;
+    for (int i = 0; i < space.getWidth(); i++)
+    {
+        for (int j = 0; j < space.getHeight(); j++)
+        {
+            line += (char)('0' + space(i, j));
+        }
+    }
+    file << line << endl;
+}
+
+
+//! Reads a space written by writeSpace.
+/*!
+   \param file the file.
+   \param width the width of the space.
+   \param height the height of the space.
+   \param space returns the space.
+   \return True iif the space was read.
+*/
+bool ResultCache::readSpace(istream &file, int width, int height, Grid *space)
+{
+    string line;
+    if (!(file >> line) || (int)line.size() != width * height)
+    {
+        return false;
+    }
+    *space = Grid(width, height);
+    for (int i = 0; i < width; i++)
+    {
+        for (int j = 0; j < height; j++)
+        {
+            (*space)(i, j) = line[i * height + j] - '0';
+        }
+    }
+    return true;
+}
+
+
+//! Reads a list of events.
+/*!
+   \param file the file.
+   \param width the width of the spaces.
+   \param height the height of the spaces.
+   \param paths true if every event is a list of spaces, the cycles.
+   \param events returns the events read.
+   \return True iif the events were read.
+*/
+bool ResultCache::readEvents(istream &file, int width, int height, bool paths, list<simulationStep> *events)
+{
+    int count;
+    if (!(file >> count))
+    {
+        return false;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        int length = 1;
+        if (paths && (!(file >> length) || length < 1))
+        {
+            return false;
+        }
+        list<spaceHighlighted> path;
+        Grid space;
+        for (int j = 0; j < length; j++)
+        {
+            if (!readSpace(file, width, height, &space))
+            {
+                return false;
+            }
+            path.push_back(getStep(space).space);
+        }
+        simulationStep step = getStep(path.front().g);
+        if (paths)
+        {
+            step.path = path;
+        }
+        events->push_back(step);
+    }
+    return true;
+}
+
+
+//! Returns an event with only its last space.
+/*!
+   \param space the space.
+   \return The event, without path nor highlight.
+*/
+simulationStep ResultCache::getStep(Grid &space)
+{
+    simulationStep step;
+    step.space.g = space;
+    step.space.h.top = 0;
+    step.space.h.left = 0;
+    step.space.h.width = 0;
+    step.space.h.height = 0;
+    step.matched = false;
+    return step;
+}
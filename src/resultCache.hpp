@@ -0,0 +1,100 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class ResultCache
+ * \brief Results of simulated rows stored on disk.
+ * 
+ * The same row of the same space is often simulated again with the same
+ * rules and patterns, in another session or on another machine sharing
+ * the directory. This class stores the verdict and the events of every row
+ * simulated in a file named after a hash of everything the results depend
+ * on: the rules, the patterns, the step semantics, the input and output
+ * cells, the row space with its inputs set, the cells left out and the
+ * expected outputs. Only the spaces of the events are stored, not their
+ * paths, except the spaces of the cycles. The files are written to a
+ * temporary file first and then renamed, so a reader never sees half a
+ * file. The directory is taken from the NANOCOMP_CACHE environment
+ * variable or RESULTCACHE_DIR in the home directory.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef RESULTCACHE_HPP_
+#define RESULTCACHE_HPP_
+
+#include <wx/wx.h>
+#include "grid.hpp"
+#include "rule.hpp"
+#include "forbiddenPattern.hpp"
+#include "simulationStep.hpp"
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <list>
+
+//! Directory of the cache, relative to the home directory.
+#define RESULTCACHE_DIR ".nanocomp/results"
+//! First line of the cache files.
+#define RESULTCACHE_HEADER "nanocomp results 1"
+//! Maximum number of spaces stored for a row, larger rows are not stored.
+#define RESULTCACHE_SPACES 100000
+
+using namespace std;
+
+
+//! Cached row struct.
+/*! Verdict and events of a row. The events only have their last space,
+    and the cycles the spaces of the cycle as their path. */
+struct cachedRow
+{
+    bool verified; /*!< True if the row verified the tables. */
+    list<simulationStep> stable; /*!< Stable spaces reached. */
+    list<simulationStep> cycles; /*!< Cycles found. */
+    list<simulationStep> forbidden; /*!< Forbidden pattern spaces found. */
+    list<simulationStep> outOfBounds; /*!< Out of bounds spaces found. */
+};
+
+
+class ResultCache
+{
+public:
+    ResultCache();
+    virtual ~ResultCache();
+    bool open();
+    void setContext(list<Rule> *rules, list<ForbiddenPattern> *patterns, int semantics, vector<coordinate> &inputs, vector<coordinate> &outputs);
+    bool find(Grid space, vector<bool> &frozen, wxString expected, cachedRow *row);
+    bool store(Grid space, vector<bool> &frozen, wxString expected, cachedRow &row);
+    wxString getDirectory();
+    string getKey(Grid &space, vector<bool> &frozen, wxString expected);
+    wxString getFileName(string &key, wxString extension);
+    uint64_t getCheck(string &key);
+
+private:
+    void addGrid(string &key, Grid grid);
+    void writeSpace(ostream &file, Grid &space);
+    bool readSpace(istream &file, int width, int height, Grid *space);
+    bool readEvents(istream &file, int width, int height, bool paths, list<simulationStep> *events);
+    simulationStep getStep(Grid &space);
+    
+    //! Directory of the cache files, empty if it can not be used.
+    wxString directory;
+    //! Serialized rules, patterns, semantics and input and output cells.
+    string context;
+};
+
+#endif /*RESULTCACHE_HPP_*/
@@ -0,0 +1,49 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class RowOutputs
+ * \brief Outputs a truth table expects on every row.
+ * 
+ * RowVerifier reads the outputs of the tables it verifies through this
+ * interface, one row at a time, so it neither copies the tables nor
+ * depends on wxWidgets. TruthTable implements it for the GUI and the
+ * daemon, and the library for the expected outputs set through its C
+ * interface.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef ROWOUTPUTS_HPP_
+#define ROWOUTPUTS_HPP_
+
+#include <vector>
+
+using namespace std;
+
+class RowOutputs
+{
+public:
+    //! Destructor.
+    virtual ~RowOutputs() {}
+    //! Returns the outputs of a row.
+    virtual vector<bool> getOutput(int row) = 0;
+    //! Returns the outputs of a row that must have their value, false for the don't-cares.
+    virtual vector<bool> getCare(int row) = 0;
+};
+
+#endif /*ROWOUTPUTS_HPP_*/
@@ -0,0 +1,315 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "rowVerifier.hpp"
+#include <cstddef>
+
+using namespace std;
+
+
+//! Constructor.
+RowVerifier::RowVerifier()
+{
+}
+
+
+//! Destructor.
+RowVerifier::~RowVerifier()
+{
+}
+
+
+//! Sets the space of the rows.
+/*!
+   The tables are cleared.
+   \param layout the space.
+   \param inputs the input coordinates of the rows, the first one the most
+   significant bit.
+   \param pins the inputs and outputs of the sub-circuit instances.
+*/
+void RowVerifier::setSpace(matrix layout, vector<coordinate> inputs, vector<coordinate> pins)
+{
+    this->layout = layout;
+    this->inputs = inputs;
+    this->pins = pins;
+    tables.clear();
+}
+
+
+//! Adds a table to verify on the rows.
+/*!
+   The inputs of the table that are not inputs of the rows are left out.
+   \param inputs the input coordinates of the table.
+   \param outputs the output coordinates of the table.
+   \param values the outputs of the rows of the table, NULL if any output
+   verifies the rows. It must live while the table is verified.
+*/
+void RowVerifier::addTable(vector<coordinate> inputs, vector<coordinate> outputs, RowOutputs *values)
+{
+    verifiedTable table;
+    for (unsigned int i = 0; i < inputs.size(); i++)
+    {
+        for (unsigned int k = 0; k < this->inputs.size(); k++)
+        {
+            if (inputs[i].x == this->inputs[k].x && inputs[i].y == this->inputs[k].y)
+            {
+                table.inputs.push_back(k);
+            }
+        }
+    }
+    table.outputs = outputs;
+    table.values = values;
+    tables.push_back(table);
+}
+
+
+//! Member accessor.
+/*!
+   \return The number of tables verified.
+*/
+int RowVerifier::getTables()
+{
+    return tables.size();
+}
+
+
+//! Returns the output cells of every table.
+/*!
+   \return The output coordinates of the tables, one table after another.
+*/
+vector<coordinate> RowVerifier::getOutputs()
+{
+    vector<coordinate> result;
+    for (unsigned int t = 0; t < tables.size(); t++)
+    {
+        result.insert(result.end(), tables[t].outputs.begin(), tables[t].outputs.end());
+    }
+    return result;
+}
+
+
+//! Returns the outputs a table has on a row.
+/*!
+   \param row the row.
+   \param table the table.
+   \return The outputs of the table, empty if they are not verified.
+*/
+vector<bool> RowVerifier::getOutput(int row, int table)
+{
+    if (tables[table].values == NULL)
+    {
+        return vector<bool>();
+    }
+    return tables[table].values->getOutput(getTableRow(row, table));
+}
+
+
+//! Returns the outputs of a table that must have their value on a row.
+/*!
+   \param row the row.
+   \param table the table.
+   \return True for the outputs with a value, false for the don't-cares,
+   empty if the outputs are not verified.
+*/
+vector<bool> RowVerifier::getCare(int row, int table)
+{
+    if (tables[table].values == NULL)
+    {
+        return vector<bool>();
+    }
+    return tables[table].values->getCare(getTableRow(row, table));
+}
+
+
+//! Builds the initial space of a row.
+/*!
+   \param row the row.
+   \return The space with the inputs set to the row values, the outputs,
+   the sub-circuit inputs and outputs and the don't-care cells empty.
+*/
+matrix RowVerifier::getRowLayout(int row)
+{
+    matrix newLayout = layout;
+    //The sub-circuit inputs and outputs start empty
+    for (unsigned int k = 0; k < pins.size(); k++)
+    {
+        newLayout[pins[k].x][pins[k].y] = nDISABLED;
+    }
+    //The first input is the most significant bit of the row
+    int count = inputs.size();
+    for (int k = 0; k < count; k++)
+    {
+        newLayout[inputs[k].x][inputs[k].y] = ((row >> (count - 1 - k)) & 1) ? nENABLED : nDISABLED;
+    }
+    vector<coordinate> outputs = getOutputs();
+    for (unsigned int k = 0; k < outputs.size(); k++)
+    {
+        newLayout[outputs[k].x][outputs[k].y] = nDISABLED;
+    }
+    for (unsigned int i = 0; i < newLayout.size(); i++)
+    {
+        for (unsigned int j = 0; j < newLayout[i].size(); j++)
+        {
+            if (newLayout[i][j] == nDONTCARE)
+            {
+                newLayout[i][j] = nDISABLED;
+            }
+        }
+    }
+    return newLayout;
+}
+
+
+//! Tells if a row has to be simulated.
+/*!
+   \param row the row.
+   \return False iif every output of every table is a don't-care in the
+   row.
+*/
+bool RowVerifier::isRelevant(int row)
+{
+    for (unsigned int t = 0; t < tables.size(); t++)
+    {
+        if (tables[t].values == NULL)
+        {
+            return true;
+        }
+        vector<bool> care = tables[t].values->getCare(getTableRow(row, t));
+        for (unsigned int i = 0; i < care.size(); i++)
+        {
+            if (care[i])
+            {
+                return true;
+            }
+        }
+        if (care.empty())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//! Checks if the events of a row verify the tables.
+/*!
+   \param row the row.
+   \param stable the stable spaces the row reached.
+   \param cycles the cycles the row found.
+   \param forbidden the spaces with a forbidden pattern the row reached.
+   \param outOfBounds the out of bounds spaces the row reached.
+   \param checked the table to verify, or ALL_TABLES.
+   \return True iif there is no forbidden or out of bounds space and every
+   stable space and every space of a cycle verifies the row.
+*/
+bool RowVerifier::verifyRow(int row, list<simulationStep> &stable, list<simulationStep> &cycles, list<simulationStep> &forbidden, list<simulationStep> &outOfBounds, int checked)
+{
+    if (!forbidden.empty() || !outOfBounds.empty())
+    {
+        return false;
+    }
+    for (list<simulationStep>::iterator i = stable.begin(); i != stable.end(); i++)
+    {
+        if (!verifyGrid(row, (*i).space.g, checked))
+        {
+            return false;
+        }
+    }
+    for (list<simulationStep>::iterator i = cycles.begin(); i != cycles.end(); i++)
+    {
+        if (!verifyCycle(row, (*i), checked))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//! Verifies if a space has the outputs of a row.
+/*!
+   \param row the row.
+   \param g the space.
+   \param checked the table to verify, or ALL_TABLES.
+   \return True iif every output that is not a don't-care has its value.
+*/
+bool RowVerifier::verifyGrid(int row, Grid &g, int checked)
+{
+    for (unsigned int t = 0; t < tables.size(); t++)
+    {
+        if ((checked != ALL_TABLES && checked != (int)t) || tables[t].values == NULL)
+        {
+            continue;
+        }
+        int tableRow = getTableRow(row, t);
+        vector<bool> values = tables[t].values->getOutput(tableRow);
+        vector<bool> care = tables[t].values->getCare(tableRow);
+        vector<coordinate> &outputs = tables[t].outputs;
+        for (unsigned int i = 0; i < outputs.size(); i++)
+        {
+            if (care[i] && g(outputs[i].x, outputs[i].y) != (values[i] ? nENABLED : nDISABLED))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+//! Verifies if a cycle has the outputs of a row.
+/*!
+   \param row the row.
+   \param cycle the cycle, its space is the one repeated on its path.
+   \param checked the table to verify, or ALL_TABLES.
+   \return True iif every space of the cycle, from where it starts,
+   verifies the row.
+*/
+bool RowVerifier::verifyCycle(int row, simulationStep &cycle, int checked)
+{
+    bool layoutFound = false;
+    for (list<spaceHighlighted>::iterator i = cycle.path.begin(); i != cycle.path.end(); i++)
+    {
+        layoutFound = layoutFound || (*i).g == cycle.space.g;
+        if (layoutFound && !verifyGrid(row, (*i).g, checked))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//! Returns the row of a table that corresponds to a row.
+/*!
+   \param row the row.
+   \param table the table.
+   \return The row of the table with the values its inputs have in the row.
+*/
+int RowVerifier::getTableRow(int row, int table)
+{
+    int count = inputs.size();
+    int result = 0;
+    for (unsigned int i = 0; i < tables[table].inputs.size(); i++)
+    {
+        result = (result << 1) | ((row >> (count - 1 - tables[table].inputs[i])) & 1);
+    }
+    return result;
+}
@@ -0,0 +1,89 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class RowVerifier
+ * \brief Initial spaces and verdicts of the rows of the truth tables.
+ * 
+ * The GUI simulation, the daemon and the library simulate the rows of
+ * one or more truth tables that share their inputs. This class builds
+ * the initial space of every row and tells if the events a row reached
+ * verify the outputs of every table, without wxWidgets so every front
+ * end uses the same rules. The outputs of a table are read row by row
+ * through RowOutputs, never copied, and a table without them only has
+ * its output cells emptied; the inputs of every table are mapped to the
+ * inputs of the rows.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef ROWVERIFIER_HPP_
+#define ROWVERIFIER_HPP_
+
+#include "grid.hpp"
+#include "simulationStep.hpp"
+#include "rowOutputs.hpp"
+#include <vector>
+#include <list>
+
+//! Verify a row against all the truth tables checked.
+#define ALL_TABLES -1
+
+using namespace std;
+
+
+//! Verified table struct.
+/*! A truth table whose outputs are verified on the rows. */
+struct verifiedTable
+{
+    vector<int> inputs; /*!< Position among the row inputs of every input of the table, the first one the most significant bit. */
+    vector<coordinate> outputs; /*!< Output coordinates of the table. */
+    RowOutputs *values; /*!< Outputs of the rows of the table, NULL if they are not verified. */
+};
+
+
+class RowVerifier
+{
+public:
+    RowVerifier();
+    virtual ~RowVerifier();
+    void setSpace(matrix layout, vector<coordinate> inputs, vector<coordinate> pins);
+    void addTable(vector<coordinate> inputs, vector<coordinate> outputs, RowOutputs *values);
+    int getTables();
+    vector<coordinate> getOutputs();
+    vector<bool> getOutput(int row, int table);
+    vector<bool> getCare(int row, int table);
+    matrix getRowLayout(int row);
+    bool isRelevant(int row);
+    bool verifyRow(int row, list<simulationStep> &stable, list<simulationStep> &cycles, list<simulationStep> &forbidden, list<simulationStep> &outOfBounds, int checked);
+    bool verifyGrid(int row, Grid &g, int checked);
+    bool verifyCycle(int row, simulationStep &cycle, int checked);
+
+private:
+    int getTableRow(int row, int table);
+    
+    //! Space, without the row inputs set.
+    matrix layout;
+    //! Input coordinates of the rows, the first one the most significant bit.
+    vector<coordinate> inputs;
+    //! Inputs and outputs of the sub-circuit instances.
+    vector<coordinate> pins;
+    //! Tables verified, the first one the one simulated.
+    vector<verifiedTable> tables;
+};
+
+#endif /*ROWVERIFIER_HPP_*/
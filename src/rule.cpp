@@ -35,6 +35,8 @@ Rule::Rule(int width, int height)
 {
     this->height = height;
     this->width = width;
+    anchor.x = -1;
+    anchor.y = -1;
 }
 
 
@@ -292,3 +294,34 @@ bool Rule::operator ==(Rule rule)
             (initialGrid == rule.getInitialGrid()) && 
             (finalGrid == rule.getFinalGrid()));
 }
+
+
+//! Pins the rule to a position of the space.
+/*!
+   An anchored rule only applies with its upper left corner on the anchor.
+   \param anchor the upper left corner, x = -1 to let the rule apply anywhere.
+*/
+void Rule::setAnchor(coordinate anchor)
+{
+    this->anchor = anchor;
+}
+
+
+//! Member accessor.
+/*!
+   \return The upper left corner where the rule applies, x = -1 if anywhere.
+*/
+coordinate Rule::getAnchor()
+{
+    return anchor;
+}
+
+
+//! Finds if the rule is pinned to a position of the space.
+/*!
+   \return True iif the rule only applies on its anchor.
+*/
+bool Rule::isAnchored()
+{
+    return anchor.x >= 0;
+}
@@ -63,6 +63,9 @@ public:
     void print();
     matrix getInitialMatrix();
     matrix getFinalMatrix();
+    void setAnchor(coordinate anchor);
+    coordinate getAnchor();
+    bool isAnchored();
     
 private:
     //! Rule width.
@@ -73,6 +76,8 @@ private:
     Grid initialGrid;
     //! Rule final configuration.
     Grid finalGrid;
+    //! Only space position where the rule applies, x = -1 if anywhere.
+    coordinate anchor;
 };
 
 #endif /*RULE_HPP_*/
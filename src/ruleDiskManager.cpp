@@ -179,9 +179,32 @@ bool RuleDiskManager::openRules(wxString fileName)
     if (!fb.open (fileName.mb_str(), ios::in))
     {
         //cout << "Error opening the file" << endl;
+        delete ruleList;
         return false;
     }
     istream *is = new istream(&fb);
+    bool result = readRules(is, ruleList);
+    delete is;
+    fb.close();
+    if (result)
+    {
+        returnRules(ruleList);
+    }
+    delete ruleList;
+    return result;
+}
+
+
+//! Reads the rules of a rules file from a stream.
+/*!
+   The rules are not returned to the controller, so this can be used
+   without one.
+   \param is the input stream.
+   \param ruleList rule list where the rules read are appended.
+   \return True iif the stream was read correctly.
+*/
+bool RuleDiskManager::readRules(istream *is, list<Rule *> *ruleList)
+{
     int result;
     int width;
     int height;
@@ -193,10 +216,7 @@ bool RuleDiskManager::openRules(wxString fileName)
         if (result != NUMBER)
         {
             //cout << "Number expected, file format error" << endl;
-            delete ruleList;
-            delete is;
             delete lexer;
-            fb.close();
             return false;
         }
         else
@@ -205,10 +225,7 @@ bool RuleDiskManager::openRules(wxString fileName)
             if (lexer->yylex() != NUMBER) //Not another number
             {
                 //cout << "Number expected, file format error" << endl;
-                delete ruleList;
-                delete is;
                 delete lexer;
-                fb.close();
                 return false;
             }
             else
@@ -216,19 +233,14 @@ bool RuleDiskManager::openRules(wxString fileName)
                 height = atoi(lexer->YYText());
                 if (!readRule(width, height, ruleList, lexer))//Wrong rule format
                 {
-                    delete ruleList;
-                    delete is;
                     delete lexer;
-                    fb.close();
                     return false;
                 }
             }
             result = lexer->yylex();
         }
     }
-    fb.close();
-    returnRules(ruleList);
-    delete ruleList;
+    delete lexer;
     return true;
 }
 
@@ -47,6 +47,7 @@ public:
 	virtual ~RuleDiskManager();
     bool saveRules(list<Rule*> rules, wxString fileName);
     bool openRules(wxString fileName);
+    bool readRules(istream *is, list<Rule *> *ruleList);
     
 private:
     //! Rule controller.
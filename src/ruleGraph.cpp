@@ -0,0 +1,693 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "ruleGraph.hpp"
+#include <algorithm>
+
+using namespace std;
+
+//! Rule applying order.
+/*!
+   Orders rule applyings the same way a full scan of the space finds them:
+   by rule, then by x coordinate and then by y coordinate.
+   \param a the first rule applying.
+   \param b the second rule applying.
+   \return True iif a goes before b.
+*/
+static bool applyingOrder(const ruleApplying &a, const ruleApplying &b)
+{
+    if (a.index != b.index)
+    {
+        return a.index < b.index;
+    }
+    if (a.c.x != b.c.x)
+    {
+        return a.c.x < b.c.x;
+    }
+    return a.c.y < b.c.y;
+}
+
+
+//! Constructor.
+/*!
+   Builds the graph of the rule set. The rules are referenced, not copied,
+   so the list must outlive the graph.
+   \param rules the rule list to analyze.
+*/
+RuleGraph::RuleGraph(list<Rule> *rules)
+{
+    for (list<Rule>::iterator i = rules->begin(); i != rules->end(); i++)
+    {
+        ruleSet.push_back(&(*i));
+        initialCells.push_back((*i).getInitialMatrix());
+        finalCells.push_back((*i).getFinalMatrix());
+        anchors.push_back((*i).getAnchor());
+    }
+    SiteIndex index;
+    for (unsigned int i = 0; i < initialCells.size(); i++)
+    {
+        pivots.push_back(index.getPivot(initialCells[i]));
+    }
+    sites = NULL;
+    
+    edges = 0;
+    confluent = true;
+    successors.resize(ruleSet.size());
+    disabling.resize(ruleSet.size());
+    for (unsigned int i = 0; i < ruleSet.size(); i++)
+    {
+        disabling[i].resize(ruleSet.size(), false);
+        for (unsigned int j = 0; j < ruleSet.size(); j++)
+        {
+            if (enables(i, j))
+            {
+                successors[i].push_back(j);
+                edges++;
+            }
+            disabling[i][j] = disables(i, j, true);
+            if (i != j ? disabling[i][j] : disables(i, j, false))
+            {
+                confluent = false;
+            }
+        }
+    }
+}
+
+
+//! Destructor.
+RuleGraph::~RuleGraph()
+{
+}
+
+
+//! Member accessor.
+/*!
+   \return The number of rules of the graph.
+*/
+int RuleGraph::getRules()
+{
+    return ruleSet.size();
+}
+
+
+//! Member accessor.
+/*!
+   \return The number of enabling edges of the graph.
+*/
+int RuleGraph::getEdges()
+{
+    return edges;
+}
+
+
+//! Member accessor.
+/*!
+   \param rule the rule index.
+   \return The indexes of the rules a firing of the rule can enable.
+*/
+vector<int> RuleGraph::getSuccessors(int rule)
+{
+    return successors[rule];
+}
+
+
+//! Tells if a rule can enable another one.
+/*!
+   \param rule the rule index.
+   \param successor the index of the rule that could be enabled.
+   \return True iif a firing of rule can make successor applicable.
+*/
+bool RuleGraph::canEnable(int rule, int successor)
+{
+    for (unsigned int i = 0; i < successors[rule].size(); i++)
+    {
+        if (successors[rule][i] == successor)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//! Tells if the rules are confluent.
+/*!
+   \return True if no firing can disable another rule applying, so every
+   applicable rule stays applicable until it fires.
+*/
+bool RuleGraph::isConfluent()
+{
+    return confluent;
+}
+
+
+//! Computes if a rule can enable another one.
+/*!
+   The rule can enable the successor if, at some offset where both rules
+   overlap, the rule changes a cell to the state the successor reads there
+   and the rest of the overlapping cells do not contradict the successor.
+   \param rule the rule index.
+   \param successor the successor index.
+   \return True if a firing of the rule can make the successor applicable.
+*/
+bool RuleGraph::enables(int rule, int successor)
+{
+    int rw = initialCells[rule].size();
+    int rh = initialCells[rule][0].size();
+    int sw = initialCells[successor].size();
+    int sh = initialCells[successor][0].size();
+    
+    //Offsets of the successor respect to the rule
+    for (int dx = -(sw - 1); dx < rw; dx++)
+    {
+        for (int dy = -(sh - 1); dy < rh; dy++)
+        {
+            bool writes = false;
+            bool consistent = true;
+            for (int i = 0; i < sw && consistent; i++)
+            {
+                for (int j = 0; j < sh && consistent; j++)
+                {
+                    int ri = dx + i;
+                    int rj = dy + j;
+                    int need = initialCells[successor][i][j];
+                    if (ri < 0 || ri >= rw || rj < 0 || rj >= rh)
+                    {
+                        continue;
+                    }
+                    if (need != nENABLED && need != nDISABLED)
+                    {
+                        continue;
+                    }
+                    int before = initialCells[rule][ri][rj];
+                    int after = finalCells[rule][ri][rj];
+                    if (after == nENABLED || after == nDISABLED)
+                    {
+                        if (after != need)
+                        {
+                            consistent = false;
+                        }
+                        else if (before != after)
+                        {
+                            writes = true;
+                        }
+                    }
+                    else if ((before == nENABLED || before == nDISABLED) && before != need)
+                    {
+                        //The cell is not changed by the rule and it
+                        //does not have the state the successor needs
+                        consistent = false;
+                    }
+                }
+            }
+            if (writes && consistent)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+//! Computes if a rule can disable another one.
+/*!
+   The rule can disable the successor if both can be applicable at the same
+   time at an overlapping offset and the rule changes a cell the successor
+   reads.
+   \param rule the rule index.
+   \param successor the successor index.
+   \param same false to leave out the applying of the rule itself, when
+   the successor is the rule.
+   \return True if a firing of the rule can make a successor applying
+   not applicable anymore.
+*/
+bool RuleGraph::disables(int rule, int successor, bool same)
+{
+    int rw = initialCells[rule].size();
+    int rh = initialCells[rule][0].size();
+    int sw = initialCells[successor].size();
+    int sh = initialCells[successor][0].size();
+    
+    for (int dx = -(sw - 1); dx < rw; dx++)
+    {
+        for (int dy = -(sh - 1); dy < rh; dy++)
+        {
+            if (!same && rule == successor && dx == 0 && dy == 0)
+            {
+                continue;
+            }
+            bool changes = false;
+            bool consistent = true;
+            for (int i = 0; i < sw && consistent; i++)
+            {
+                for (int j = 0; j < sh && consistent; j++)
+                {
+                    int ri = dx + i;
+                    int rj = dy + j;
+                    int need = initialCells[successor][i][j];
+                    if (ri < 0 || ri >= rw || rj < 0 || rj >= rh)
+                    {
+                        continue;
+                    }
+                    if (need != nENABLED && need != nDISABLED)
+                    {
+                        continue;
+                    }
+                    int before = initialCells[rule][ri][rj];
+                    int after = finalCells[rule][ri][rj];
+                    if ((before == nENABLED || before == nDISABLED) && before != need)
+                    {
+                        //Both rules can not be applicable at this offset
+                        consistent = false;
+                    }
+                    else if ((after == nENABLED || after == nDISABLED) && after != need)
+                    {
+                        changes = true;
+                    }
+                }
+            }
+            if (changes && consistent)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+//! Finds the rules that can never fire.
+/*!
+   A rule can only fire if it is applicable from the beginning or if a 
+   rule that can fire enables it, so every rule not reachable in the graph
+   from the initially applicable rules can never fire.
+   \param applicable the rule applyings found on the initial space.
+   \return The indexes of the rules that can never fire.
+*/
+list<int> RuleGraph::getNeverFiring(list<ruleApplying> applicable)
+{
+    vector<bool> reached(ruleSet.size(), false);
+    list<int> pending;
+    for (list<ruleApplying>::iterator i = applicable.begin(); i != applicable.end(); i++)
+    {
+        if (!reached[(*i).index])
+        {
+            reached[(*i).index] = true;
+            pending.push_back((*i).index);
+        }
+    }
+    while (!pending.empty())
+    {
+        int rule = pending.front();
+        pending.pop_front();
+        for (unsigned int i = 0; i < successors[rule].size(); i++)
+        {
+            if (!reached[successors[rule][i]])
+            {
+                reached[successors[rule][i]] = true;
+                pending.push_back(successors[rule][i]);
+            }
+        }
+    }
+    
+    list<int> result;
+    for (unsigned int i = 0; i < reached.size(); i++)
+    {
+        if (!reached[i])
+        {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+
+//! Finds all the applicable rules of a space.
+/*!
+   \param layout the space.
+   \return All the rule applyings of the space, in rule order.
+*/
+list<ruleApplying> RuleGraph::findApplicable(Grid &layout)
+{
+    list<ruleApplying> result;
+    for (unsigned int i = 0; i < ruleSet.size(); i++)
+    {
+        list<ruleApplying> found = findApplicable(layout, i);
+        result.splice(result.end(), found);
+    }
+    return result;
+}
+
+
+//! Finds where a rule is applicable in a space.
+/*!
+   The rule is looked for out of the bounds of the space too, as if the
+   space was surrounded by rule width - 1 and rule height - 1 disabled
+   cells. The coordinates returned are relative to this bigger space.
+   If the sites of the space are known, a rule needing a molecule is only
+   looked for with its pivot on the enabled sites.
+   \param layout the space.
+   \param rule the rule index.
+   \return The rule applyings of the rule in the space.
+*/
+list<ruleApplying> RuleGraph::findApplicable(Grid &layout, int rule)
+{
+    list<ruleApplying> result;
+    if (sites != NULL && anchors[rule].x < 0 && pivots[rule].x >= 0)
+    {
+        //The pivot of every applying is on an enabled site
+        vector<coordinate> enabled;
+        sites->getEnabled(layout, &enabled);
+        for (unsigned int k = 0; k < enabled.size(); k++)
+        {
+            int i = enabled[k].x - pivots[rule].x + initialCells[rule].size() - 1;
+            int j = enabled[k].y - pivots[rule].y + initialCells[rule][0].size() - 1;
+            if (applicable(layout, rule, i, j))
+            {
+                ruleApplying found;
+                found.rule = ruleSet[rule];
+                found.index = rule;
+                found.c.x = i;
+                found.c.y = j;
+                result.push_back(found);
+            }
+        }
+        return result;
+    }
+    int width = layout.getWidth() + initialCells[rule].size() - 1;
+    int height = layout.getHeight() + initialCells[rule][0].size() - 1;
+    int first = 0;
+    if (anchors[rule].x >= 0)
+    {
+        //Only the anchor position has to be checked
+        first = anchors[rule].x + initialCells[rule].size() - 1;
+        width = first + 1;
+    }
+    for (int i = first; i < width; i++)
+    {
+        for (int j = 0; j < height; j++)
+        {
+            if (applicable(layout, rule, i, j))
+            {
+                ruleApplying found;
+                found.rule = ruleSet[rule];
+                found.index = rule;
+                found.c.x = i;
+                found.c.y = j;
+                result.push_back(found);
+            }
+        }
+    }
+    return result;
+}
+
+
+//! Updates the applicable rules of a space after a rule firing.
+/*!
+   Only the cells of the zone where the fired rule applied have changed, so
+   the applyings that do not overlap it are still valid. The applyings that 
+   overlap it are only re-checked if the fired rule can disable them, and only
+   the successors of the fired rule are looked for around the zone.
+   \param layout the space after the firing.
+   \param previous the applicable rules of the space before the firing.
+   \param fired the fired rule applying.
+   \return All the rule applyings of the new space, in rule order.
+*/
+list<ruleApplying> RuleGraph::updateApplicable(Grid &layout, list<ruleApplying> &previous, ruleApplying fired)
+{
+    list<ruleApplying> result;
+    int rule = fired.index;
+    int width = initialCells[rule].size();
+    int height = initialCells[rule][0].size();
+    int left = fired.c.x - width + 1;
+    int top = fired.c.y - height + 1;
+    
+    vector<bool> rescan(ruleSet.size(), false);
+    for (unsigned int i = 0; i < successors[rule].size(); i++)
+    {
+        rescan[successors[rule][i]] = true;
+    }
+    
+    for (list<ruleApplying>::iterator i = previous.begin(); i != previous.end(); i++)
+    {
+        if (!overlaps((*i), left, top, width, height))
+        {
+            result.push_back((*i));
+        }
+        else if (rescan[(*i).index])
+        {
+            //It will be found again when looking for the successors
+        }
+        else if (!disabling[rule][(*i).index] || applicable(layout, (*i).index, (*i).c.x, (*i).c.y))
+        {
+            result.push_back((*i));
+        }
+    }
+    
+    //Look for the successors on every position overlapping the zone
+    for (unsigned int k = 0; k < successors[rule].size(); k++)
+    {
+        int s = successors[rule][k];
+        int sw = initialCells[s].size();
+        int sh = initialCells[s][0].size();
+        int minX = max(0, left);
+        int maxX = min(layout.getWidth() + sw - 2, left + width + sw - 2);
+        int minY = max(0, top);
+        int maxY = min(layout.getHeight() + sh - 2, top + height + sh - 2);
+        for (int i = minX; i <= maxX; i++)
+        {
+            for (int j = minY; j <= maxY; j++)
+            {
+                if (applicable(layout, s, i, j))
+                {
+                    ruleApplying found;
+                    found.rule = ruleSet[s];
+                    found.index = s;
+                    found.c.x = i;
+                    found.c.y = j;
+                    result.push_back(found);
+                }
+            }
+        }
+    }
+    
+    result.sort(applyingOrder);
+    return result;
+}
+
+
+//! Finds if a rule is applicable at a certain coordinate of a space.
+/*!
+   \param layout the space.
+   \param rule the rule index.
+   \param x the x coordinate, relative to the space surrounded by disabled cells.
+   \param y the y coordinate, relative to the space surrounded by disabled cells.
+   \return True if the initial configuration of the rule matches the space 
+   at the given coordinate.
+*/
+bool RuleGraph::applicable(Grid &layout, int rule, int x, int y)
+{
+    matrix &cells = initialCells[rule];
+    int left = x - cells.size() + 1;
+    int top = y - cells[0].size() + 1;
+    if (anchors[rule].x >= 0 && (anchors[rule].x != left || anchors[rule].y != top))
+    {
+        return false;
+    }
+    if (!frozen.empty() && touchesFrozen(layout, rule, left, top))
+    {
+        return false;
+    }
+    for (unsigned int i = 0; i < cells.size(); i++)
+    {
+        for (unsigned int j = 0; j < cells[i].size(); j++)
+        {
+            if (cells[i][j] != nENABLED && cells[i][j] != nDISABLED)
+            {
+                continue;
+            }
+            int status = nDISABLED;
+            int sx = left + i;
+            int sy = top + j;
+            if (sx >= 0 && sx < layout.getWidth() && sy >= 0 && sy < layout.getHeight())
+            {
+                status = layout(sx, sy);
+            }
+            if (cells[i][j] == nENABLED)
+            {
+                if (status != nENABLED)
+                {
+                    return false;
+                }
+            }
+            else if (status != nDISABLED && status != nNOSPACE)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+//! Finds if a rule applying pushes molecules out of the space bounds.
+/*!
+   \param layout the space.
+   \param applying the rule applying.
+   \return True iif the rule puts a molecule out of the space or on a cell
+   that is not available for use.
+*/
+bool RuleGraph::outOfBounds(Grid &layout, ruleApplying applying)
+{
+    matrix &cells = finalCells[applying.index];
+    int left = applying.c.x - cells.size() + 1;
+    int top = applying.c.y - cells[0].size() + 1;
+    for (unsigned int i = 0; i < cells.size(); i++)
+    {
+        for (unsigned int j = 0; j < cells[i].size(); j++)
+        {
+            if (cells[i][j] == nENABLED)
+            {
+                int sx = left + i;
+                int sy = top + j;
+                if (sx < 0 || sx >= layout.getWidth() || sy < 0 || sy >= layout.getHeight())
+                {
+                    return true;
+                }
+                if (layout(sx, sy) == nNOSPACE)
+                {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+
+//! Applies a rule to a space.
+/*!
+   \param layout the space where to apply the rule.
+   \param applying the rule applying.
+   \return A new grid with the rule applied. The cells of the rule
+   out of the space are ignored. The unavailable cells written become sites.
+*/
+Grid RuleGraph::applyRule(Grid &layout, ruleApplying applying)
+{
+    Grid result(layout);
+    matrix &cells = finalCells[applying.index];
+    int left = applying.c.x - cells.size() + 1;
+    int top = applying.c.y - cells[0].size() + 1;
+    for (unsigned int i = 0; i < cells.size(); i++)
+    {
+        for (unsigned int j = 0; j < cells[i].size(); j++)
+        {
+            int sx = left + i;
+            int sy = top + j;
+            //if it's don't care the actual value should stay unchanged
+            if (cells[i][j] != nDONTCARE && sx >= 0 && sx < layout.getWidth() && sy >= 0 && sy < layout.getHeight())
+            {
+                if (sites != NULL && layout(sx, sy) == nNOSPACE)
+                {
+                    sites->addSite(sx, sy);
+                }
+                result(sx, sy) = cells[i][j];
+            }
+        }
+    }
+    return result;
+}
+
+
+//! Tells if a rule applying overlaps a zone of the space.
+/*!
+   \param a the rule applying.
+   \param left the left coordinate of the zone.
+   \param top the top coordinate of the zone.
+   \param width the width of the zone.
+   \param height the height of the zone.
+   \return True iif any cell of the rule applying is inside the zone.
+*/
+bool RuleGraph::overlaps(ruleApplying a, int left, int top, int width, int height)
+{
+    int aw = initialCells[a.index].size();
+    int ah = initialCells[a.index][0].size();
+    int aLeft = a.c.x - aw + 1;
+    int aTop = a.c.y - ah + 1;
+    return (aLeft < left + width) && (left < aLeft + aw) && (aTop < top + height) && (top < aTop + ah);
+}
+
+
+//! Sets the cells the rules must not touch.
+/*!
+   The rules reading or writing any of these cells are never applicable,
+   so the cells keep their status during the simulation.
+   \param frozen tells for every cell of the space, indexed by
+   x * height + y, if it must not be touched. Empty to allow all the cells.
+*/
+void RuleGraph::setFrozen(vector<bool> frozen)
+{
+    this->frozen = frozen;
+}
+
+
+//! Tells if a rule placement reads or writes a frozen cell.
+/*!
+   \param layout the space.
+   \param rule the rule index.
+   \param left the left column of the rule on the space.
+   \param top the top row of the rule on the space.
+   \return True if the rule touches a frozen cell.
+*/
+bool RuleGraph::touchesFrozen(Grid &layout, int rule, int left, int top)
+{
+    matrix &before = initialCells[rule];
+    matrix &after = finalCells[rule];
+    for (unsigned int i = 0; i < before.size(); i++)
+    {
+        for (unsigned int j = 0; j < before[i].size(); j++)
+        {
+            int sx = left + i;
+            int sy = top + j;
+            if (sx < 0 || sx >= layout.getWidth() || sy < 0 || sy >= layout.getHeight())
+            {
+                continue;
+            }
+            bool touched = before[i][j] == nENABLED || before[i][j] == nDISABLED || after[i][j] != nDONTCARE;
+            if (touched && frozen[sx * layout.getHeight() + sy])
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+//! Sets the sites of the spaces to simulate.
+/*!
+   \param sites the sites, NULL to scan the whole spaces. They are
+   referenced, not copied, and grow with the cells the rules make available.
+*/
+void RuleGraph::setSites(SiteIndex *sites)
+{
+    this->sites = sites;
+}
@@ -0,0 +1,101 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class RuleGraph
+ * \brief Trigger dependency graph of a rule set.
+ * 
+ * This class analyzes a rule set before simulating. For every rule it
+ * computes which rules a firing of it can enable or disable, that is,
+ * which rules read in their initial configuration a state the rule writes
+ * in its final configuration at an overlapping offset. The simulation uses
+ * the graph to re-check only the successors of a fired rule around the
+ * changed zone instead of scanning the whole space with every rule.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef RULEGRAPH_HPP_
+#define RULEGRAPH_HPP_
+
+#include "grid.hpp"
+#include "rule.hpp"
+#include "siteIndex.hpp"
+#include <vector>
+#include <list>
+
+using namespace std;
+
+//! Rule applying struct.
+/*! Struct used to store information about a rule application. */
+struct ruleApplying
+{
+    Rule *rule; /*!< The rule which applies. */
+    coordinate c; /*!< The coordinate in which the rule applies.. */
+    int index; /*!< The position of the rule in the rule list. */
+};
+
+class RuleGraph
+{
+public:
+	RuleGraph(list<Rule> *rules);
+	virtual ~RuleGraph();
+    int getRules();
+    int getEdges();
+    vector<int> getSuccessors(int rule);
+    bool canEnable(int rule, int successor);
+    bool isConfluent();
+    list<int> getNeverFiring(list<ruleApplying> applicable);
+    list<ruleApplying> findApplicable(Grid &layout);
+    list<ruleApplying> findApplicable(Grid &layout, int rule);
+    list<ruleApplying> updateApplicable(Grid &layout, list<ruleApplying> &previous, ruleApplying fired);
+    bool applicable(Grid &layout, int rule, int x, int y);
+    bool outOfBounds(Grid &layout, ruleApplying applying);
+    Grid applyRule(Grid &layout, ruleApplying applying);
+    void setFrozen(vector<bool> frozen);
+    void setSites(SiteIndex *sites);
+
+private:
+    bool enables(int rule, int successor);
+    bool disables(int rule, int successor, bool same);
+    bool overlaps(ruleApplying a, int left, int top, int width, int height);
+    bool touchesFrozen(Grid &layout, int rule, int left, int top);
+    //! Rules of the set, in the list order.
+    vector<Rule*> ruleSet;
+    //! Initial configuration of every rule.
+    vector<matrix> initialCells;
+    //! Final configuration of every rule.
+    vector<matrix> finalCells;
+    //! Anchor of every rule, x = -1 if the rule applies anywhere.
+    vector<coordinate> anchors;
+    //! First enabled cell of the initial configuration of every rule, x = -1 if none.
+    vector<coordinate> pivots;
+    //! Rules that a firing of every rule can enable.
+    vector< vector<int> > successors;
+    //! Rules that a firing of every rule can disable.
+    vector< vector<bool> > disabling;
+    //! Number of edges of the graph.
+    int edges;
+    //! True if no firing can disable another rule applying.
+    bool confluent;
+    //! Cells the rules must not touch, indexed by x * height + y. Empty if none.
+    vector<bool> frozen;
+    //! Sites of the spaces simulated, NULL to scan the whole spaces.
+    SiteIndex *sites;
+};
+
+#endif /*RULEGRAPH_HPP_*/
@@ -0,0 +1,235 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "ruleRotation.hpp"
+
+using namespace std;
+
+//! Constructor.
+/*!
+   The rules and patterns are added to the lists given.
+   \param rules the rule list to add the rules to.
+   \param patterns the forbidden pattern list to add the patterns to.
+*/
+RuleRotation::RuleRotation(list<Rule> *rules, list<ForbiddenPattern> *patterns)
+{
+    this->rules = rules;
+    this->patterns = patterns;
+}
+
+
+//! Destructor.
+RuleRotation::~RuleRotation()
+{
+}
+
+
+//! Adds a rule and its rotations to the rule list.
+/*!
+   \param newRule rule to add.
+   \return False if some rotation could not be added, because it moves a
+   site of the rule out of its grid.
+*/
+bool RuleRotation::addRule(Rule newRule)
+{
+    if (!findRule(newRule))
+    {
+        rules->push_back(newRule);
+        
+        //Rotate only if square and even size
+        if ((newRule.getWidth() == newRule.getHeight()) && (newRule.getWidth() %2 != 0))
+        {
+
+            Grid tempInitial = newRule.getInitialGrid();
+            Grid tempFinal = newRule.getFinalGrid();
+    
+            for (int i = 0; i < 5; i++)
+            {
+                Grid initialRotated(tempInitial.getWidth(), tempInitial.getHeight());
+                Grid finalRotated(tempInitial.getWidth(), tempInitial.getHeight());
+                Rule ruleRotated(newRule.getWidth(), newRule.getHeight());
+                if (rotateGrid(tempInitial, &initialRotated) && rotateGrid(tempFinal, &finalRotated))
+                {
+                    ruleRotated.setInitialGrid(initialRotated);
+                    ruleRotated.setFinalGrid(finalRotated);
+                    if (!findRule(ruleRotated))
+                    {
+                        rules->push_back(ruleRotated);
+                    }
+                }
+                else
+                {   
+                    return false;
+                }
+                tempInitial = ruleRotated.getInitialGrid();
+                tempFinal = ruleRotated.getFinalGrid();
+            }
+        }
+    }
+    return true;
+}
+
+
+//! Adds a pattern and its rotations to the pattern list.
+/*!
+   \param newPattern pattern to add.
+   \return False if some rotation could not be added, because it moves a
+   site of the pattern out of its grid.
+*/
+bool RuleRotation::addPattern(ForbiddenPattern newPattern)
+{
+    if (!findPattern(newPattern))
+    {
+        patterns->push_back(newPattern);
+        //Rotate only if square and even size
+        if ((newPattern.getWidth() == newPattern.getHeight()) && (newPattern.getWidth() %2 != 0))
+        {
+            Grid temp = newPattern.getGrid();
+    
+            for (int i = 0; i < 5; i++)
+            {
+                Grid rotatedGrid(temp.getWidth(), temp.getHeight());
+                ForbiddenPattern patternRotated(newPattern.getWidth(), newPattern.getHeight());
+                if (rotateGrid(temp, &rotatedGrid))
+                {
+                    patternRotated.setGrid(rotatedGrid);
+                    if (!findPattern(patternRotated))
+                    {
+                        patterns->push_back(patternRotated);
+                    }
+                }
+                else
+                {
+                    return false;
+                }
+                temp= patternRotated.getGrid();
+            }
+        }
+    }
+    return true;
+}
+
+
+//! Finds a rule in the collection.
+/*!
+   \param rule the rule to be found.
+   \return True if the rule was found on the collection.
+*/
+bool RuleRotation::findRule(Rule rule)
+{
+    for (list<Rule>::iterator i = rules->begin(); i != rules->end(); i++)
+    {
+        if (rule == (*i))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//! Finds a pattern in the collection.
+/*!
+   \param pattern the pattern to be found.
+   \return True if the pattern was found on the collection.
+*/
+bool RuleRotation::findPattern(ForbiddenPattern pattern)
+{
+    for (list<ForbiddenPattern>::iterator i = patterns->begin(); i != patterns->end(); i++)
+    {
+        if ((*i) == pattern)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//! Rotates a grid 60 degrees.
+/*!
+   \param originalGrid the grid to be rotated.
+   \param destGrid grid where the original rotated have to be copied.
+   \return True if the grid is rotated correctly, false if a site falls
+   out of the grid.
+*/
+bool RuleRotation::rotateGrid(Grid originalGrid, Grid *destGrid)
+{
+    int c;
+    int center;
+    int i, j;
+    int ii, jj;
+    int size = originalGrid.getWidth();
+
+    
+    center = size/2;
+
+    for (i = 0; i < size; i++) 
+    {
+        for (j = 0; j < size; j++) 
+        {
+            (*destGrid)(i, j) = nDONTCARE;
+        }
+    }
+
+    for (i = 0; i < size; i++) 
+    {
+        for (j = 0; j < size; j++) 
+        {
+            c = originalGrid(i, j);
+
+            rotateHexCoordinate(center, i, j, &ii, &jj);
+            
+            if (0 <= ii && ii < size && 0 <= jj && jj < size) 
+            {
+                (*destGrid)(ii, jj) = c;
+            }
+            else if (c == nENABLED || c == nDISABLED)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+//! Rotates a coordinate of a grid 60 degrees.
+/*!
+   \param center the central coordinate of the grid.
+   \param i the x original coordinate.
+   \param j the y original coordinate.
+   \param ii the x destination coordinate.
+   \param jj the y destination coordinate.
+*/
+void RuleRotation::rotateHexCoordinate(int center, int i, int j, int *ii, int *jj)
+{
+    int x, y;
+    int xx, yy;
+
+    x = i - center;
+    y = j - center;
+
+    xx = -y;
+    yy = x + y;
+
+    *ii = xx + center;
+    *jj = yy + center;
+}
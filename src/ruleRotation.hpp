@@ -0,0 +1,62 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class RuleRotation
+ * \brief Adds rules and forbidden patterns with their rotations.
+ * 
+ * The rules and patterns of a design are drawn once, but they apply in
+ * every direction of the hexagonal space. The square rules and patterns
+ * of odd size are added with their six rotations of 60 degrees, and the
+ * rotations already in the lists are not added again. A rotation that
+ * would move a site out of the grid stops the rotations of that rule or
+ * pattern, and the caller is told so it can report it. The simulation of
+ * the GUI and the simulation daemon expand their rules the same way.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef RULEROTATION_HPP_
+#define RULEROTATION_HPP_
+
+#include "rule.hpp"
+#include "forbiddenPattern.hpp"
+#include <list>
+
+using namespace std;
+
+class RuleRotation
+{
+public:
+    RuleRotation(list<Rule> *rules, list<ForbiddenPattern> *patterns);
+    virtual ~RuleRotation();
+    bool addRule(Rule newRule);
+    bool addPattern(ForbiddenPattern newPattern);
+
+private:
+    bool findRule(Rule rule);
+    bool findPattern(ForbiddenPattern pattern);
+    bool rotateGrid(Grid originalGrid, Grid *destGrid);
+    void rotateHexCoordinate(int center, int i, int j, int *ii, int *jj);
+    
+    //! Rules with their rotations.
+    list<Rule> *rules;
+    //! Forbidden patterns with their rotations.
+    list<ForbiddenPattern> *patterns;
+};
+
+#endif /*RULEROTATION_HPP_*/
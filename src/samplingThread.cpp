@@ -0,0 +1,53 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+// $Revision: 1.1 $
+
+#include "samplingThread.hpp"
+
+//! Constructor.
+/*!
+   The thread is joinable, so the controller can wait for it.
+   \param engine simulation sampling the trajectories.
+   \param space initial space of the row.
+   \param trajectories number of trajectories to sample.
+   \param seed seed of the random stream.
+*/
+SamplingThread::SamplingThread(MonteCarloSimulation *engine, Grid space, int trajectories, unsigned long seed) : wxThread(wxTHREAD_JOINABLE)
+{
+    this->engine = engine;
+    this->space = space;
+    this->trajectories = trajectories;
+    this->seed = seed;
+}
+
+
+//! Destructor.
+SamplingThread::~SamplingThread()
+{
+}
+
+
+//! Samples the trajectories.
+/*!
+   \return Always 0.
+*/
+wxThread::ExitCode SamplingThread::Entry()
+{
+    engine->sample(space, trajectories, seed);
+    return 0;
+}
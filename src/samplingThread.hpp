@@ -0,0 +1,56 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class SamplingThread
+ * \brief Thread sampling trajectories of a row.
+ * 
+ * Every thread owns a MonteCarloSimulation and samples its share of the
+ * trajectories of a row with its own seed. The simulation controller
+ * joins the threads and merges their counts.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef SAMPLINGTHREAD_HPP_
+#define SAMPLINGTHREAD_HPP_
+
+#include <wx/wx.h>
+#include <wx/thread.h>
+#include "monteCarloSimulation.hpp"
+
+class SamplingThread : public wxThread
+{
+public:
+    SamplingThread(MonteCarloSimulation *engine, Grid space, int trajectories, unsigned long seed);
+    virtual ~SamplingThread();
+
+protected:
+    virtual ExitCode Entry();
+
+private:
+    //! Simulation sampling the trajectories.
+    MonteCarloSimulation *engine;
+    //! Initial space of the row.
+    Grid space;
+    //! Number of trajectories to sample.
+    int trajectories;
+    //! Seed of the random stream.
+    unsigned long seed;
+};
+
+#endif /*SAMPLINGTHREAD_HPP_*/
@@ -0,0 +1,415 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "shardedSimulation.hpp"
+#include "simulation.hpp"
+#include "spaceCache.hpp"
+#include "checkpoint.hpp"
+#include <wx/filename.h>
+#include <new>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+using namespace std;
+
+
+//! Constructor.
+/*!
+   The rules and patterns are referenced, not copied.
+   \param rules the rules to simulate, rotations included.
+   \param patterns the forbidden patterns to simulate, rotations included.
+*/
+ShardedSimulation::ShardedSimulation(list<Rule> *rules, list<ForbiddenPattern> *patterns)
+{
+    this->rules = rules;
+    this->patterns = patterns;
+    semantics = STEP_INTERLEAVED;
+    siteMatching = true;
+    cacheLimit = CACHE_SPACES;
+    workers = 0;
+    crashed = 0;
+    queue = -1;
+    queued = 0;
+}
+
+
+//! Destructor.
+ShardedSimulation::~ShardedSimulation()
+{
+    cancel();
+}
+
+
+//! Sets the rule placements fired by every step.
+/*!
+   \param semantics STEP_INTERLEAVED or a parallel mode.
+*/
+void ShardedSimulation::setSemantics(int semantics)
+{
+    this->semantics = semantics;
+}
+
+
+//! Sets how the rules and patterns are looked for.
+/*!
+   \param enabled true to look for them from the enabled sites.
+*/
+void ShardedSimulation::setSiteMatching(bool enabled)
+{
+    siteMatching = enabled;
+}
+
+
+//! Sets the size of the space cache of every worker.
+/*!
+   \param spaces the maximum number of spaces cached, 0 for none.
+*/
+void ShardedSimulation::setCacheLimit(int spaces)
+{
+    cacheLimit = spaces;
+}
+
+
+//! Starts the simulation of rows in worker processes.
+/*!
+   The workers are started before the rows are queued. The pipe of the
+   jobs does not block, the rows that do not fit in it are queued by poll
+   as the workers take the first ones.
+   \param jobs the rows to simulate.
+   \param workers the number of worker processes.
+   \return False if no worker could be started.
+*/
+bool ShardedSimulation::start(vector<rowJob> &jobs, int workers)
+{
+    cancel();
+    rowResults none;
+    none.simulated = false;
+    results.assign(jobs.size(), none);
+    finished.assign(jobs.size(), false);
+    rows.clear();
+    for (unsigned int k = 0; k < jobs.size(); k++)
+    {
+        rows.push_back(jobs[k].row);
+    }
+    this->workers = 0;
+    crashed = 0;
+    queued = 0;
+    base = wxFileName::CreateTempFileName(wxT("nanocomp"));
+    if (base.IsEmpty())
+    {
+        return false;
+    }
+    int pipes[2];
+    if (pipe(pipes) != 0)
+    {
+        wxRemoveFile(base);
+        base = wxEmptyString;
+        return false;
+    }
+    
+    for (int w = 0; w < workers; w++)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            close(pipes[1]);
+            work(pipes[0], jobs, base);
+            _exit(0);
+        }
+        if (pid > 0)
+        {
+            children.push_back(pid);
+        }
+    }
+    close(pipes[0]);
+    queue = pipes[1];
+    fcntl(queue, F_SETFL, fcntl(queue, F_GETFL) | O_NONBLOCK);
+    this->workers = children.size();
+    if (children.empty())
+    {
+        close(queue);
+        queue = -1;
+        wxRemoveFile(base);
+        base = wxEmptyString;
+        return false;
+    }
+    feed();
+    return true;
+}
+
+
+//! Checks the worker processes, without waiting for them.
+/*!
+   The rows left are queued as the pipe empties, and the workers that
+   exited are collected. When all of them are gone, the results are merged.
+   \return True iif the simulation is over and the results can be read.
+*/
+bool ShardedSimulation::poll()
+{
+    if (base.IsEmpty())
+    {
+        return true;
+    }
+    feed();
+    for (unsigned int w = 0; w < children.size(); )
+    {
+        int status;
+        pid_t exited = waitpid(children[w], &status, WNOHANG);
+        if (exited == 0)
+        {
+            w++;
+            continue;
+        }
+        if (exited != children[w] || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            crashed++;
+        }
+        children.erase(children.begin() + w);
+    }
+    if (!children.empty())
+    {
+        return false;
+    }
+    finish();
+    return true;
+}
+
+
+//! Stops the simulation.
+/*!
+   The workers are killed. The rows they finished keep their results, the
+   rest are left unsimulated.
+*/
+void ShardedSimulation::cancel()
+{
+    if (base.IsEmpty())
+    {
+        return;
+    }
+    for (unsigned int w = 0; w < children.size(); w++)
+    {
+        kill(children[w], SIGKILL);
+        int status;
+        waitpid(children[w], &status, 0);
+    }
+    children.clear();
+    finish();
+}
+
+
+//! Returns the number of rows simulated by the workers so far.
+/*!
+   \return The number of result files written.
+*/
+int ShardedSimulation::getFinished()
+{
+    int count = 0;
+    for (unsigned int k = 0; k < rows.size(); k++)
+    {
+        if (!finished[k] && !base.IsEmpty() && wxFile::Exists(getFileName(base, rows[k])))
+        {
+            finished[k] = true;
+        }
+        if (finished[k])
+        {
+            count++;
+        }
+    }
+    return count;
+}
+
+
+//! Member accessor.
+/*!
+   \param job the position of the row in the jobs of the last simulation.
+   \return The results of the row.
+*/
+rowResults &ShardedSimulation::getResults(int job)
+{
+    return results[job];
+}
+
+
+//! Member accessor.
+/*!
+   \return The number of workers started by the last simulation.
+*/
+int ShardedSimulation::getWorkers()
+{
+    return workers;
+}
+
+
+//! Member accessor.
+/*!
+   \return The number of workers of the last simulation that died.
+*/
+int ShardedSimulation::getCrashed()
+{
+    return crashed;
+}
+
+
+//! Queues the rows that fit in the pipe of the jobs.
+/*!
+   Once all the rows are queued, or no worker is left to read them, the
+   pipe is closed so the workers exit when it is empty.
+*/
+void ShardedSimulation::feed()
+{
+    if (queue < 0)
+    {
+        return;
+    }
+    //A write with no worker left fails instead of killing the process
+    void (*previous)(int) = signal(SIGPIPE, SIG_IGN);
+    while (queued < (int)rows.size())
+    {
+        if (write(queue, &queued, sizeof(queued)) != sizeof(queued))
+        {
+            break;
+        }
+        queued++;
+    }
+    signal(SIGPIPE, previous);
+    if (queued == (int)rows.size() || errno != EAGAIN)
+    {
+        close(queue);
+        queue = -1;
+    }
+}
+
+
+//! Merges the result files of the rows and removes them.
+void ShardedSimulation::finish()
+{
+    if (queue >= 0)
+    {
+        close(queue);
+        queue = -1;
+    }
+    for (unsigned int k = 0; k < rows.size(); k++)
+    {
+        wxString fileName = getFileName(base, rows[k]);
+        results[k].simulated = merge(fileName, rows[k], &results[k]);
+        finished[k] = results[k].simulated;
+        wxRemoveFile(fileName);
+    }
+    wxRemoveFile(base);
+    base = wxEmptyString;
+}
+
+
+//! Simulates the rows taken from the queue, in a worker process.
+/*!
+   A row that runs out of memory is given up and the worker goes on with
+   the next one.
+   \param queue the read end of the pipe with the positions of the jobs.
+   \param jobs the rows to simulate.
+   \param base the base name of the result files.
+*/
+void ShardedSimulation::work(int queue, vector<rowJob> &jobs, wxString base)
+{
+    SpaceCache cache;
+    cache.setLimit(cacheLimit);
+    vector<bool> frozen;
+    int job;
+    while (read(queue, &job, sizeof(job)) == sizeof(job))
+    {
+        try
+        {
+            //The spaces simulated with other cells left out have other results
+            if (jobs[job].frozen != frozen)
+            {
+                cache.clear();
+                frozen = jobs[job].frozen;
+            }
+            Simulation simulation(NULL, NULL, jobs[job].space, rules, patterns);
+            simulation.setCache(&cache);
+            simulation.setFrozen(frozen);
+            simulation.setSemantics(semantics);
+            simulation.setSiteMatching(siteMatching);
+            while (!simulation.isFinished())
+            {
+                simulation.nextStep(false);
+            }
+            list<Grid> processed = simulation.getProcessedLayouts();
+            list<simulationStep> stable = simulation.getStableLayouts();
+            list<simulationStep> forbidden = simulation.getForbiddenLayouts();
+            list<simulationStep> cycles = simulation.getCycles();
+            list<simulationStep> outOfBounds = simulation.getOutOfBounds();
+            vector<unsigned long> visited = simulation.getVisited();
+            Checkpoint file;
+            file.writeInt(jobs[job].row);
+            file.writeGrids(processed);
+            file.writeSteps(stable);
+            file.writeSteps(forbidden);
+            file.writeSteps(cycles);
+            file.writeSteps(outOfBounds);
+            file.writeHashes(visited);
+            file.save(getFileName(base, jobs[job].row));
+        }
+        catch (bad_alloc &)
+        {
+            cache.clear();
+        }
+    }
+    close(queue);
+}
+
+
+//! Reads the results a worker wrote for a row.
+/*!
+   \param fileName the result file of the row.
+   \param row the row.
+   \param results where to store the results.
+   \return True iif the file has the results of the row.
+*/
+bool ShardedSimulation::merge(wxString fileName, int row, rowResults *results)
+{
+    vector<Rule *> ruleSet;
+    for (list<Rule>::iterator i = rules->begin(); i != rules->end(); i++)
+    {
+        ruleSet.push_back(&(*i));
+    }
+    Checkpoint file;
+    int stored;
+    if (!file.load(fileName) || !file.readInt(&stored) || stored != row)
+    {
+        return false;
+    }
+    return file.readGrids(&results->processed) && file.readSteps(&results->stable, ruleSet) && file.readSteps(&results->forbidden, ruleSet) && file.readSteps(&results->cycles, ruleSet) && file.readSteps(&results->outOfBounds, ruleSet) && file.readHashes(&results->visited);
+}
+
+
+//! Returns the result file of a row.
+/*!
+   \param base the base name of the result files.
+   \param row the row.
+   \return The file name.
+*/
+wxString ShardedSimulation::getFileName(wxString base, int row)
+{
+    return base + wxString::Format(wxT(".row%d"), row);
+}
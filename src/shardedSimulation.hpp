@@ -0,0 +1,127 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class ShardedSimulation
+ * \brief Simulation of the rows in worker processes.
+ * 
+ * A simulation too big for the memory of a process is split by rows. This
+ * class forks worker processes that take the rows to simulate from a local
+ * pipe, simulate every row on its own with a Simulation without a view and
+ * write its results to a file of its own. The caller polls the workers
+ * from its event loop, and when they are done the results are merged back. Every worker has its own memory, so a row that
+ * exhausts it only loses that row: its file is missing and the row is left
+ * unsimulated, while the rest of the rows keep their results.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef SHARDEDSIMULATION_HPP_
+#define SHARDEDSIMULATION_HPP_
+
+#include <wx/wx.h>
+#include "grid.hpp"
+#include "rule.hpp"
+#include "forbiddenPattern.hpp"
+#include "simulationStep.hpp"
+#include <vector>
+#include <list>
+#include <sys/types.h>
+
+using namespace std;
+
+//! Milliseconds between two polls of the worker processes.
+#define SHARD_POLL 100
+
+
+//! Row job struct.
+/*! A row for the workers to simulate. */
+struct rowJob
+{
+    int row; /*!< Row of the table. */
+    Grid space; /*!< Initial space of the row. */
+    vector<bool> frozen; /*!< Cells left out of the simulation, indexed by x * height + y. */
+};
+
+
+//! Row results struct.
+/*! The results of a row simulated by a worker. */
+struct rowResults
+{
+    bool simulated; /*!< False if the worker could not simulate the row. */
+    list<Grid> processed; /*!< Spaces simulated. */
+    list<simulationStep> stable; /*!< Stable spaces reached. */
+    list<simulationStep> forbidden; /*!< Forbidden pattern spaces reached. */
+    list<simulationStep> cycles; /*!< Cycles found. */
+    list<simulationStep> outOfBounds; /*!< Out of bounds spaces reached. */
+    vector<unsigned long> visited; /*!< Hashes of the spaces reached. */
+};
+
+
+class ShardedSimulation
+{
+public:
+    ShardedSimulation(list<Rule> *rules, list<ForbiddenPattern> *patterns);
+    virtual ~ShardedSimulation();
+    void setSemantics(int semantics);
+    void setSiteMatching(bool enabled);
+    void setCacheLimit(int spaces);
+    bool start(vector<rowJob> &jobs, int workers);
+    bool poll();
+    void cancel();
+    int getFinished();
+    rowResults &getResults(int job);
+    int getWorkers();
+    int getCrashed();
+
+private:
+    void feed();
+    void finish();
+    void work(int queue, vector<rowJob> &jobs, wxString base);
+    bool merge(wxString fileName, int row, rowResults *results);
+    wxString getFileName(wxString base, int row);
+    //! Rules to simulate.
+    list<Rule> *rules;
+    //! Forbidden patterns to simulate.
+    list<ForbiddenPattern> *patterns;
+    //! Rule placements fired by every step.
+    int semantics;
+    //! True to look for the rules and patterns from the enabled sites.
+    bool siteMatching;
+    //! Maximum number of spaces the cache of every worker keeps.
+    int cacheLimit;
+    //! Results of every job of the last simulation.
+    vector<rowResults> results;
+    //! Number of workers started by the last simulation.
+    int workers;
+    //! Number of workers of the last simulation that did not exit normally.
+    int crashed;
+    //! Worker processes still running.
+    vector<pid_t> children;
+    //! Write end of the pipe of the jobs, -1 once closed.
+    int queue;
+    //! Next job to queue.
+    int queued;
+    //! Row of every job.
+    vector<int> rows;
+    //! Jobs whose result file has been written.
+    vector<bool> finished;
+    //! Base name of the result files, empty when no simulation runs.
+    wxString base;
+};
+
+#endif /*SHARDEDSIMULATION_HPP_*/
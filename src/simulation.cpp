@@ -21,13 +21,15 @@
 #include "simulation.hpp"
 #include <iostream>
 #include <map>
+#include <algorithm>
 
 using namespace std;
 
 //! Constructor.
 /*!
-   \param view the simulation view.
-   \param controller the simulation controller.
+   \param view the simulation view, NULL to simulate without one.
+   \param controller the simulation controller, NULL to simulate a single
+   row without one, stepping it until it is finished.
    \param initialLayout the initial space to simulate.
    \param rules the rule list to be applied.
    \param patterns the forbidden pattern list to be found.
@@ -40,15 +42,26 @@ Simulation::Simulation(SimulationView *view, SimulationManager *controller, Grid
     forbiddenPatternsFound = new list<simulationStep>;
     cycles = new list<simulationStep>;
     outOfBoundsFound = new list<simulationStep>;
+    frames = new vector<cacheFrame>;
+    visited = new vector<unsigned long>;
+    cache = NULL;
+    resumed = false;
+    semantics = STEP_INTERLEAVED;
+    cacheHits = 0;
     simulationStep s;
     s.space.g = initialLayout;
+    s.matched = false;
     patternsToSimulate->push_back(s);
     this->rules = rules;
     this->patterns = patterns;
+    graph = new RuleGraph(rules);
+    sites = new SiteIndex();
+    sites->build(initialLayout);
+    siteMatching = true;
+    graph->setSites(sites);
     this->view = view;
     this->controller = controller;
-    view->setGrid(initialLayout, true);
-    view->Show(true);
+    showStart(initialLayout, false);
     finished = false;
     simulating = false;
     stillRows = true;
@@ -64,194 +77,72 @@ Simulation::~Simulation()
     delete forbiddenPatternsFound;
     delete cycles;
     delete outOfBoundsFound;
-}
-
-
-//! Finds a rule in a space.
-/*!
-   \param layout the space.
-   \param rule the rule to be found.
-   \return A list of all the coordinates where the rule
-   has been found.
-*/
-list<coordinate> Simulation::findRule(Grid layout, Rule rule)
-{
-    list<coordinate> result;
-    
-    //We create a bigger space to find rules in it. The new space
-    //must be rule.width - 1 and rule.height - 1 more wider/heighter
-    //on every side (that's 2 for the width and 2 for the height)
-    //to be able to find the rule applicability out of the bounds
-    Grid newSpace(layout.getWidth() + (rule.getWidth() - 1) * 2, layout.getHeight() + (rule.getHeight() - 1) * 2);
-    //We set all cells to disabled
-    for (int i = 0; i < newSpace.getWidth(); i++)
-    {
-        for (int j = 0; j < newSpace.getHeight(); j++)
-        {
-            newSpace(i, j) = nDISABLED;
-        }
-    }
-    
-    //Now we copy the layout into the new grid
-    for (int i = 0; i < layout.getWidth(); i++)
-    {
-        for (int j = 0; j < layout.getHeight(); j++)
-        {
-            newSpace(i + rule.getWidth() - 1, j + rule.getWidth() - 1) = layout(i, j);
-        }
-    }
-    
-    //We try to find the rule at any coordinate
-    for (int i = 0; i < newSpace.getWidth(); i++)
-    {
-        for (int j = 0; j < newSpace.getHeight(); j++)
-        {
-            coordinate c;
-            c.x = i;
-            c.y = j;
-            if (ruleApplicable(newSpace, c, rule))
-            {
-                result.push_back(c);
-                //cout << "Applies!!!!" << endl;
-            }
-        }
-    }
-    return result;
+    delete frames;
+    delete visited;
+    delete graph;
+    delete sites;
 }
 
 
 //! Finds a forbidden in a space.
 /*!
+   The pattern is looked for out of the bounds of the space too, as if the
+   space was surrounded by pattern width - 1 and pattern height - 1
+   disabled cells. With site matching, a pattern needing a molecule is only
+   looked for with its pivot on the enabled sites of the space.
    \param layout the space.
    \param pattern the pattern to be found.
    \return A list of all the coordinates where the pattern
-   has been found.
+   has been found, relative to the space surrounded by disabled cells.
 */
-list<coordinate> Simulation::findPattern(Grid layout, ForbiddenPattern pattern)
+list<coordinate> Simulation::findPattern(Grid &layout, ForbiddenPattern &pattern)
 {
     list<coordinate> result;
+    matrix cells = pattern.getGrid().getCells();
+    int width = pattern.getWidth();
+    int height = pattern.getHeight();
+    coordinate pivot = sites->getPivot(cells);
     
-    //We create a bigger space to find rules in it. The new space
-    //must be rule.width - 1 and rule.height - 1 more wider/heighter
-    //on every side (that's 2 for the width and 2 for the height)
-    //to be able to find the rule applicability out of the bounds
-    Grid newSpace(layout.getWidth() + (pattern.getWidth() - 1) * 2, layout.getHeight() + (pattern.getHeight() - 1) * 2);
-    //We set all cells to disabled
-    for (int i = 0; i < newSpace.getWidth(); i++)
-    {
-        for (int j = 0; j < newSpace.getHeight(); j++)
-        {
-            newSpace(i, j) = nDISABLED;
-        }
-    }
-    
-    //Now we copy the layout into the new grid
-    for (int i = 0; i < layout.getWidth(); i++)
-    {
-        for (int j = 0; j < layout.getHeight(); j++)
-        {
-            newSpace(i + pattern.getWidth() - 1, j + pattern.getWidth() - 1) = layout(i, j);
-        }
-    }
-    
-    //Find the pattern at any coordinate
-    for (int i = 0; i < newSpace.getWidth(); i++)
+    vector<coordinate> placements;
+    if (pivot.x >= 0 && siteMatching)
     {
-        for (int j = 0; j < newSpace.getHeight(); j++)
+        vector<coordinate> enabled;
+        sites->getEnabled(layout, &enabled);
+        for (unsigned int k = 0; k < enabled.size(); k++)
         {
             coordinate c;
-            c.x = i;
-            c.y = j;
-            if (patternApplicable(newSpace, c, pattern))
-            {
-                result.push_back(c);
-                //cout << "Applies!!!!" << endl;
-            }
+            c.x = enabled[k].x - pivot.x;
+            c.y = enabled[k].y - pivot.y;
+            placements.push_back(c);
         }
     }
-    return result;
-}
-
-
-//! Applies a rule to a space.
-/*!
-   \param layout the space where to apply the rule.
-   \param rule the rule to be applied.
-   \param position coordinate where to apply the rule.
-   \param absolute bool false if the coordinates of applying are absolute
-   respect to the layout. True if they're relative to the
-   layout and the rule width and height.
-   \return A new grid with the rule applied.
-*/
-Grid Simulation::applyRule(Grid layout, Rule rule, coordinate position, bool absolute)
-{
-    //TODO: check the nDONTCARE match with nDISABLED thing
-    Grid result(layout);
-    
-    int widthShift = 0;
-    int heightShift = 0;
-    
-    if (absolute)
-    {
-        widthShift = rule.getWidth() - 1;
-        heightShift = rule.getHeight() - 1;
-    }
-    
-    //We must use the normalized coordinates
-    for (int i = 0; i < rule.getWidth(); i++)
+    else
     {
-        for (int j = 0; j < rule.getHeight(); j++)
+        //Without molecules the pattern can match the surrounding
+        //disabled cells, so it is looked for at any coordinate
+        for (int i = 1 - width; i < layout.getWidth(); i++)
         {
-            if (rule.getFinalGrid()(i, j) != nDONTCARE) //if it's don't care the actual value should stay unchanged
+            for (int j = 1 - height; j < layout.getHeight(); j++)
             {
-                result(position.x - widthShift + i, position.y - heightShift + j) = rule.getFinalGrid()(i, j);
+                coordinate c;
+                c.x = i;
+                c.y = j;
+                placements.push_back(c);
             }
         }
-    } 
-    return result;
-}
-
-
-//! Finds if a rule is applicable in a certain coordinate of a space.
-/*!
-   \param layout the space.
-   \param position the coordinate to find the rule applicability.
-   \param rule the rule to be found.
-   \return True if the rule is applicable at te given coordinate. That is, if the
-   initial configuration matches the sub grid at the space coordinate.
-*/
-bool Simulation::ruleApplicable(Grid layout, coordinate position, Rule rule)
-{
-    if (rule.getWidth() > layout.getWidth() - position.x)
-    {
-        return false;
     }
-    if (rule.getHeight() > layout.getHeight() - position.y)
-    {
-        return false;
-    }
-
-    for (int i = 0; i < rule.getWidth(); i++)
+    
+    for (unsigned int k = 0; k < placements.size(); k++)
     {
-        for (int j = 0; j < rule.getHeight(); j++)
+        if (patternApplicable(layout, cells, placements[k].x, placements[k].y))
         {
-            if (rule.getInitialGrid()(i, j) == nENABLED)
-            {
-                if (layout(position.x + i, position.y + j) != nENABLED)
-                {
-                    return false;
-                }
-            }
-            else if (rule.getInitialGrid()(i, j) == nDISABLED)
-            {
-                if ((layout(position.x + i, position.y + j) != nDISABLED) && (layout(position.x + i, position.y + j) != nNOSPACE))
-                {
-                    return false;
-                }
-            }
+            coordinate c;
+            c.x = placements[k].x + width - 1;
+            c.y = placements[k].y + height - 1;
+            result.push_back(c);
         }
     }
-    return true;
+    return result;
 }
 
 
@@ -334,45 +225,67 @@ bool Simulation::find(Grid initialLayout, list<Grid> processedLayouts)
 }
 
 
-//! Finds if a pattern is applicable in a certain coordinate of a space.
+//! Finds a grid on a simulation path.
 /*!
-   \param layout the space.
-   \param position the coordinate to find the pattern applicability.
-   \param pattern the pattern to be found.
-   \return True if the pattern is applicable at te given coordinate.
+   \param layout the grid to find.
+   \param path the simulation path.
+   \return The position of the grid on the path, or -1 if the grid
+   is not on the path.
 */
-bool Simulation::patternApplicable(Grid layout, coordinate position, ForbiddenPattern pattern)
+int Simulation::findInPath(Grid layout, list<spaceHighlighted> &path)
 {
-    if (pattern.getWidth() > layout.getWidth() - position.x)
-    {
-        return false;
-    }
-    if (pattern.getHeight() > layout.getHeight() - position.y)
+    int index = 0;
+    for (list<spaceHighlighted>::iterator i = path.begin(); i != path.end(); i++)
     {
-        return false;
+        if (layout == (*i).g)
+        {
+            return index;
+        }
+        index++;
     }
+    return -1;
+}
+
 
-    for (int i = 0; i < pattern.getWidth(); i++)
+//! Finds if a forbidden pattern is applicable at a certain coordinate.
+/*!
+   \param layout the space.
+   \param cells the configuration of the pattern.
+   \param left the left column of the pattern on the space.
+   \param top the top row of the pattern on the space.
+   \return True if the pattern is applicable at the given coordinate. The
+   cells out of the space are disabled.
+*/
+bool Simulation::patternApplicable(Grid &layout, matrix &cells, int left, int top)
+{
+    for (unsigned int i = 0; i < cells.size(); i++)
     {
-        for (int j = 0; j < pattern.getHeight(); j++)
+        for (unsigned int j = 0; j < cells[i].size(); j++)
         {
-            if (pattern.getGrid()(i, j) == nENABLED)
+            int status = nDISABLED;
+            int sx = left + i;
+            int sy = top + j;
+            if (sx >= 0 && sx < layout.getWidth() && sy >= 0 && sy < layout.getHeight())
             {
-                if (layout(position.x + i, position.y + j) != nENABLED)
+                status = layout(sx, sy);
+            }
+            if (cells[i][j] == nENABLED)
+            {
+                if (status != nENABLED)
                 {
                     return false;
                 }
             }
-            else if (pattern.getGrid()(i, j) == nDISABLED)
+            else if (cells[i][j] == nDISABLED)
             {
-                if (layout(position.x + i, position.y + j) != nDISABLED)
+                if (status != nDISABLED)
                 {
                     return false;
                 }
             }
             else //DON'T CARE
             {
-                if (layout(position.x + i, position.y + j) == nNOSPACE)
+                if (status == nNOSPACE)
                 {
                     return false;
                 }
@@ -393,6 +306,177 @@ bool Simulation::isFinished()
 }
 
 
+//! Finds the parallel steps of a space.
+/*!
+   \param applicable the rule placements applicable to the space.
+   \return The sets of placements fired by every step.
+*/
+list< list<ruleApplying> > Simulation::getParallelSteps(list<ruleApplying> &applicable)
+{
+    list< list<ruleApplying> > steps;
+    if (semantics == STEP_PARALLEL_ALL)
+    {
+        vector<ruleApplying> placements(applicable.begin(), applicable.end());
+        list<ruleApplying> chosen;
+        enumerateParallel(placements, 0, chosen, steps);
+        return steps;
+    }
+    //Every placement not overlapping the ones already picked is fired
+    list<ruleApplying> chosen;
+    for (list<ruleApplying>::iterator i = applicable.begin(); i != applicable.end(); i++)
+    {
+        bool free = true;
+        for (list<ruleApplying>::iterator j = chosen.begin(); free && j != chosen.end(); j++)
+        {
+            free = !overlapping((*i), (*j));
+        }
+        if (free)
+        {
+            chosen.push_back(*i);
+        }
+    }
+    steps.push_back(chosen);
+    return steps;
+}
+
+
+//! Enumerates the maximal sets of placements that do not overlap.
+/*!
+   Every placement is either fired or left out, and a set is kept only if
+   every placement left out overlaps a fired one. At most PARALLEL_CHOICES
+   sets are kept.
+   \param applicable the rule placements applicable to the space.
+   \param next the first placement not decided yet.
+   \param chosen the placements fired so far.
+   \param steps the sets found.
+*/
+void Simulation::enumerateParallel(vector<ruleApplying> &applicable, unsigned int next, list<ruleApplying> &chosen, list< list<ruleApplying> > &steps)
+{
+    if (steps.size() >= PARALLEL_CHOICES)
+    {
+        return;
+    }
+    if (next == applicable.size())
+    {
+        for (unsigned int i = 0; i < applicable.size(); i++)
+        {
+            bool blocked = false;
+            for (list<ruleApplying>::iterator j = chosen.begin(); !blocked && j != chosen.end(); j++)
+            {
+                blocked = overlapping(applicable[i], (*j));
+            }
+            if (!blocked)
+            {
+                return;
+            }
+        }
+        steps.push_back(chosen);
+        return;
+    }
+    bool free = true;
+    for (list<ruleApplying>::iterator j = chosen.begin(); free && j != chosen.end(); j++)
+    {
+        free = !overlapping(applicable[next], (*j));
+    }
+    if (free)
+    {
+        chosen.push_back(applicable[next]);
+        enumerateParallel(applicable, next + 1, chosen, steps);
+        chosen.pop_back();
+    }
+    enumerateParallel(applicable, next + 1, chosen, steps);
+}
+
+
+//! Tells if two rule placements overlap.
+/*!
+   \param a a rule placement.
+   \param b another rule placement.
+   \return True iif their zones share a cell.
+*/
+bool Simulation::overlapping(ruleApplying &a, ruleApplying &b)
+{
+    //The coordinates are the bottom right corners of the zones
+    return a.c.x - a.rule->getWidth() < b.c.x && b.c.x - b.rule->getWidth() < a.c.x && a.c.y - a.rule->getHeight() < b.c.y && b.c.y - b.rule->getHeight() < a.c.y;
+}
+
+
+//! Fires a set of placements at once and queues the space reached.
+/*!
+   The zone highlighted is the box around the placements fired.
+   \param s the simulation step of the space.
+   \param layout the space.
+   \param fired the placements, which do not overlap.
+   \param gui true if the simulation is shown step by step.
+*/
+void Simulation::addParallelStep(simulationStep &s, Grid &layout, list<ruleApplying> &fired, bool gui)
+{
+    Grid changedLayout = layout;
+    list<ruleApplying> applicable = s.applicable;
+    int left = layout.getWidth();
+    int top = layout.getHeight();
+    int right = -1;
+    int bottom = -1;
+    for (list<ruleApplying>::iterator i = fired.begin(); i != fired.end(); i++)
+    {
+        changedLayout = graph->applyRule(changedLayout, (*i));
+        left = min(left, (*i).c.x - (*i).rule->getWidth() + 1);
+        top = min(top, (*i).c.y - (*i).rule->getHeight() + 1);
+        right = max(right, (*i).c.x);
+        bottom = max(bottom, (*i).c.y);
+    }
+    //The zones do not overlap, so every update sees the final cells
+    for (list<ruleApplying>::iterator i = fired.begin(); i != fired.end(); i++)
+    {
+        applicable = graph->updateApplicable(changedLayout, applicable, (*i));
+    }
+    if (gui)
+    {
+        showInfo("Applying %d rules at once", fired.size());
+    }
+    list<spaceHighlighted> newList = s.path;
+    spaceHighlighted newSpaceHighlightedList;
+    newSpaceHighlightedList.g = layout;
+    newSpaceHighlightedList.h.top = top;
+    newSpaceHighlightedList.h.left = left;
+    newSpaceHighlightedList.h.width = right - left + 1;
+    newSpaceHighlightedList.h.height = bottom - top + 1;
+    newList.push_back(newSpaceHighlightedList);
+    simulationStep newStep;
+    newStep.path = newList;
+    newStep.space.g = changedLayout;
+    int index = findInPath(changedLayout, s.path);
+    if (index >= 0)
+    {
+        //The results of the spaces after the cycle
+        //depend on the path that leads to them
+        for (unsigned int k = index + 1; k < frames->size(); k++)
+        {
+            (*frames)[k].tainted = true;
+        }
+        newStep.matched = false;
+        cycles->push_back(newStep);
+        if (gui)
+        {
+            showInfo("Cycle found");
+        }
+    }
+    else
+    {
+        newStep.applicable = applicable;
+        newStep.matched = true;
+        patternsToSimulate->push_back(newStep);
+    }
+}
+
+
+//! Stops the row being simulated without gathering its results.
+void Simulation::stopRow()
+{
+    finished = true;
+}
+
+
 //IMPORTANT: this function must NOT BE CALLED
 //if the stack is empty
 //TODO: check cicles
@@ -415,11 +499,13 @@ bool Simulation::nextStep(bool gui)
         return true;
     }
     simulating = true;
-    wxStopWatch sw;
     bool result = true;
     bool stable = false;
     if (!finished)
     {
+        //The subtrees of the spaces above the top of the queue
+        //are completely explored
+        closeFrames(patternsToSimulate->size());
         //We take the layout we have to process from
         //the queue
         simulationStep s = patternsToSimulate->back();
@@ -430,104 +516,107 @@ bool Simulation::nextStep(bool gui)
         patternsSimulated->push_back(layout);
         if (gui)
         {
-            view->setGrid(layout, false);
+            showSpace(layout);
         }
         
-        //Time to process: find forbidden patterns
-        for (list<ForbiddenPattern>::iterator i = patterns->begin(); i != patterns->end(); i++)
+        //If the space has already been simulated in another branch
+        //or row we reuse its results
+        bool reused = false;
+        if (cache != NULL && !resumed)
         {
-            list<coordinate> tempCoordinates;
-            wxStopWatch swPattern;
-            tempCoordinates = findPattern(layout, (*i));
-            //if (gui)
-            //{
-            //   view->setInfo(wxString::Format(_("The pattern finding took %ldms to execute"), swPattern.Time()));
-            //}
-            if (tempCoordinates.size() > 0) //Found a forbidden pattern
+            unsigned long hash = layout.getHash();
+            reused = replay(s, hash);
+            if (reused)
             {
                 if (gui)
                 {
-                    view->setInfo(wxString::Format(_("Forbidden pattern found at %d, %d"), tempCoordinates.front().x, tempCoordinates.front().y));
+                    showInfo("The space has already been simulated, reusing its results");
                 }
-                finished = true;
-                result = false;
-                if (gui)
+                if (!forbiddenPatternsFound->empty() || !outOfBoundsFound->empty())
                 {
-                    updateView();
+                    finished = true;
+                    result = false;
                 }
             }
+            else
+            {
+                openFrame(layout, hash);
+            }
+        }
+        else if (cache != NULL)
+        {
+            //A resumed row only records the spaces it reaches
+            visited->push_back(layout.getHash());
         }
         
-        if (!result)
+        //Time to process: find forbidden patterns
+        if (!reused)
         {
-            forbiddenPatternsFound->push_back(s);
-            //controller->finishedRow();
+            for (list<ForbiddenPattern>::iterator i = patterns->begin(); i != patterns->end(); i++)
+            {
+                list<coordinate> tempCoordinates;
+                tempCoordinates = findPattern(layout, (*i));
+                if (tempCoordinates.size() > 0) //Found a forbidden pattern
+                {
+                    if (gui)
+                    {
+                        showInfo("Forbidden pattern found at %d, %d", tempCoordinates.front().x, tempCoordinates.front().y);
+                    }
+                    finished = true;
+                    result = false;
+                }
+            }
+        
+            if (!result)
+            {
+                forbiddenPatternsFound->push_back(s);
+            }
         }
         
         //Time to process: find out of bounds
-        if (result)
+        if (result && !reused)
         {
+            //Only the root space needs a full scan, the rest of spaces get
+            //their applicable rules updated from the parent space
+            if (!s.matched)
+            {
+                s.applicable = graph->findApplicable(layout);
+                s.matched = true;
+                if (gui && s.path.empty())
+                {
+                    showRuleGraph(s.applicable);
+                }
+            }
             bool oobFound = false;
-            for (list<Rule>::iterator i = rules->begin(); i != rules->end(); i++)
+            for (list<ruleApplying>::iterator i = s.applicable.begin(); i != s.applicable.end(); i++)
             {
-                list<coordinate> tempCoordinates;
-                wxStopWatch swPattern;
-                tempCoordinates = findOutOfBounds(layout, (*i));
-                if (tempCoordinates.size() > 0) //Found an out of bounds
+                if (graph->outOfBounds(layout, (*i))) //Found an out of bounds
                 {
                     if (gui)
                     {
-                        for (list<coordinate>::iterator j = tempCoordinates.begin(); j != tempCoordinates.end(); j++)
-                        {
-                            view->setInfo(wxString::Format(_("Out of bounds found at %d, %d"), (*j).x, (*j).y));
-                        }
+                        showInfo("Out of bounds found at %d, %d", (*i).c.x, (*i).c.y);
                     }
                     finished = true;
                     oobFound = true;
                     result = false;
                 }
             }
-            //if (gui)
-            //{
-            //    updateView();
-            //}
             //We push back the space which contains the oob
             //and proceed to simulate the next row
             if (oobFound)
             {
                 outOfBoundsFound->push_back(s);
-                //controller->finishedRow();
             }
         }
         
-        if (result)
+        if (result && !reused)
         {
             //Time to find rules to apply
-            list<ruleApplying> rulesToApply;
-            for (list<Rule>::iterator i = rules->begin(); i != rules->end(); i++)
-            {
-                list<coordinate> tempCoordinates;
-                wxStopWatch swRule;
-                tempCoordinates = findRule(layout, (*i));
-                //if (gui)
-                //{
-                //    view->setInfo(wxString::Format(_("The rule finding took %ldms to execute"), swRule.Time()));
-                //}
-                if (tempCoordinates.size() > 0)
-                {
-                    for (list<coordinate>::iterator j = tempCoordinates.begin(); j != tempCoordinates.end(); j++)
-                    {
-                        ruleApplying ruleToApply;
-                        ruleToApply.rule = &(*i);
-                        ruleToApply.c = (*j);
-                        rulesToApply.push_back(ruleToApply);
-                    }
-                }
-            }
+            list<ruleApplying> rulesToApply = s.applicable;
             
             if (gui)
             {
-                view->setInfo(wxString::Format(_("Number of applicable rules found: %d"), rulesToApply.size()));
+                showInfo("Number of applicable rules found: %d", rulesToApply.size());
             }
 
             if (rulesToApply.size() == 0)
@@ -536,11 +625,25 @@ bool Simulation::nextStep(bool gui)
                 finalLayouts->push_back(s);
                 if (gui)
                 {
-                    view->setInfo(_("Reached stable layout"));
+                    showInfo("Reached stable layout");
                 }
                 result = true;
                 stable = true;
             }
+            else if (semantics != STEP_INTERLEAVED)
+            {
+                result = true;
+                //Every step fires a set of placements at once
+                list< list<ruleApplying> > steps = getParallelSteps(rulesToApply);
+                if (gui)
+                {
+                    showInfo("Number of parallel steps found: %d", steps.size());
+                }
+                for (list< list<ruleApplying> >::iterator i = steps.begin(); i != steps.end(); i++)
+                {
+                    addParallelStep(s, layout, (*i), gui);
+                }
+            }
             else
             {
                 result = true;
@@ -551,17 +654,24 @@ bool Simulation::nextStep(bool gui)
                     //Apply the rule
                     if (gui)
                     {
-                        view->setInfo(wxString::Format(_("Applying rule at %d, %d"), (*i).c.x, (*i).c.y));
+                        showInfo("Applying rule at %d, %d", (*i).c.x, (*i).c.y);
                     }
-                    Grid changedLayout = applyRule(layout, *(*i).rule, (*i).c, true);
+                    Grid changedLayout = graph->applyRule(layout, (*i));
                     
                     //If the resulting layout is in the processed queue
                     //we don't have to simulate it again
                     //Cycles
                     //We must try to find the simulated pattern in the 
                     //current path
-                    if (find(changedLayout, getGridList(s.path)))
+                    int index = findInPath(changedLayout, s.path);
+                    if (index >= 0)
                     {
+                        //The results of the spaces after the cycle
+                        //depend on the path that leads to them
+                        for (unsigned int k = index + 1; k < frames->size(); k++)
+                        {
+                            (*frames)[k].tainted = true;
+                        }
                         list<spaceHighlighted> newList = s.path;
                         spaceHighlighted newSpaceHighlightedList;
                         newSpaceHighlightedList.g = layout;
@@ -575,10 +685,11 @@ bool Simulation::nextStep(bool gui)
                         spaceHighlighted newSpaceHighlightedStep;
                         newSpaceHighlightedStep.g = changedLayout;
                         newStep.space = newSpaceHighlightedStep;
+                        newStep.matched = false;
                         cycles->push_back(newStep);
                         if (gui)
                         {
-                            view->setInfo(_("Cycle found"));
+                            showInfo("Cycle found");
                         }
                     }
 
@@ -587,7 +698,7 @@ bool Simulation::nextStep(bool gui)
                     {
                         if (gui)
                         {
-                            view->setInfo(_("Adding the resulting space to the queue to be simulated"));
+                            showInfo("Adding the resulting space to the queue to be simulated");
                         }
                         //Here we add too the highlighted zone. This is, the
                         //coordinate where we apply the rule and
@@ -605,13 +716,15 @@ bool Simulation::nextStep(bool gui)
                         spaceHighlighted newSpaceHighlightedStep;
                         newSpaceHighlightedStep.g = changedLayout;
                         newStep.space = newSpaceHighlightedStep;
+                        newStep.applicable = graph->updateApplicable(changedLayout, s.applicable, (*i));
+                        newStep.matched = true;
                         patternsToSimulate->push_back(newStep);
                     }
                     //else
                     //{
                     //    if (gui)
                     //    {
-                    //        view->setInfo(_("The resulting space has been already simulated"));
+                    //        showInfo("The resulting space has been already simulated");
                     //    }
                     //}
                 }
@@ -624,15 +737,30 @@ bool Simulation::nextStep(bool gui)
         //per de moment per fer debugging ja va b
         //We are finished if there are no more
         //layouts to process
-        if (patternsToSimulate->empty())
+        if (finished && !result)
         {
+            //An error stops the row, we keep the data found so far
+            closeFrames(0);
+            notifyFinished();
             if (gui)
             {
-                view->setInfo(_("No more spaces to simulate"));
+                updateView();
             }
+        }
+        else if (patternsToSimulate->empty())
+        {
+            if (gui)
+            {
+                showInfo("No more spaces to simulate");
+                if (cacheHits > 0)
+                {
+                    showInfo("Reused the results of %d already simulated spaces", cacheHits);
+                }
+            }
+            closeFrames(0);
             finished = true;
             result = true;
-            controller->finishedRow();
+            notifyFinished();
             if (gui)
             {
                 updateView();
@@ -644,7 +772,7 @@ bool Simulation::nextStep(bool gui)
             {
                 if (gui)
                 {
-                    view->setInfo(_("Backtracking to a previous applied rule"));
+                    showInfo("Backtracking to a previous applied rule");
                 }
             }
         }
@@ -653,66 +781,12 @@ bool Simulation::nextStep(bool gui)
     {
         result = true;
     }
-    //if (gui)
-    //{
-    //    view->setInfo(wxString::Format(_("The simulation step took %ldms to execute"), sw.Time()));
-    //}
+    notifyStep();
     simulating = false;
     return result;
 }
 
 
-//! Updates the simulation view with flow control information.
-/*!
-   This method updates the view to allow the user simulate other
-   rows and view the simulation results when the simulation is over.
-*/
-void Simulation::updateView()
-{
-    if (finished)
-    {
-        if (controller->nextRow())
-        {
-            view->setResults(false);
-            view->setNextRow(true);
-            view->enableSimulation(false);
-        }
-        else
-        {
-            view->setResults(true);
-            view->setNextRow(false);
-            view->enableSimulation(false);
-        }
-    }
-}
-
-
-//! Asks the controller for another row to simulate.
-void Simulation::nextRow()
-{
-    if (controller->nextRow())
-    {
-        controller->simulateRow();
-        view->setResults(false);
-        view->setNextRow(false);
-        view->enableSimulation(true);
-    }
-    else
-    {
-        view->setResults(true);
-        view->setNextRow(false);
-        view->enableSimulation(true);
-    }
-}
-
-
-//! Asks the controller to show the simulation results.
-void Simulation::results()
-{
-    controller->results();
-}
-
-
 //! Returns the stable spaces.
 /*!
    \return The list of stable spaces the simulation has obtained.
@@ -745,6 +819,16 @@ list<Grid> Simulation::getProcessedLayouts()
 }
 
 
+//! Returns the spaces reached.
+/*!
+   \return The hashes of the spaces simulated or reused from the cache.
+*/
+vector<unsigned long> Simulation::getVisited()
+{
+    return *visited;
+}
+
+
 //! Returns the forbidden spaces.
 /*!
    \return The list of spaces the simulation has obtained that contain
@@ -799,8 +883,8 @@ list<simulationStep> Simulation::getOutOfBounds()
 
 //! Sets the parameters for a new simulation.
 /*!
-   \param view the simulation view.
-   \param controller the simulation controller.
+   \param view the simulation view, NULL to simulate without one.
+   \param controller the simulation controller, NULL to simulate without one.
    \param initialLayout the initial space to simulate.
    \param rules the rule list to be applied.
    \param patterns the forbidden pattern list to be found.
@@ -813,52 +897,34 @@ void Simulation::resetSimulation(SimulationView *view, SimulationManager *contro
     patternsToSimulate->clear();
     forbiddenPatternsFound->clear();
     cycles->clear();
+    outOfBoundsFound->clear();
+    frames->clear();
+    visited->clear();
+    resumed = false;
+    cacheHits = 0;
     simulationStep s;
     s.space.g = initialLayout;
+    s.matched = false;
     patternsToSimulate->push_back(s);
+    if (rules != this->rules)
+    {
+        delete graph;
+        graph = new RuleGraph(rules);
+    }
+    graph->setFrozen(vector<bool>());
+    sites->build(initialLayout);
+    graph->setSites(siteMatching ? sites : NULL);
     this->rules = rules;
     this->patterns = patterns;
     this->view = view;
     this->controller = controller;
-    view->setGrid(initialLayout, true);
-    view->Show(true);
     finished = false;
     stillRows = true;
-    view->Enable(true);
-    view->stopSimulation();
+    showStart(initialLayout, true);
 }
 
 
 
-//! Simulates all the rows of the simulation.
-/*!
-   This method simulates all the rows in a shot, without the
-   timer and user interactivity. Useful for quick simulations.
-*/
-void Simulation::simulateAll()
-{
-    view->enableSimulation(false);
-    view->setNextRow(false);
-    view->setResults(false);
-    while (stillRows)
-    {
-        while (!finished)
-        {
-            nextStep(false);
-        }
-        if (controller->nextRow())
-        {
-            controller->simulateRow();
-        }
-        else
-        {
-            stillRows = false;
-        }
-    }
-    view->setResults(true);
-}
-
-
 //! Gets the grid list of a spaceHighlighted list.
 /*!
    \param spaces the spaceHighlighted list.
@@ -875,184 +941,188 @@ list<Grid> Simulation::getGridList(list<spaceHighlighted> spaces)
 }
 
 
-//! Finds if a rule pushes molecules out of the space bounds.
+//! Sets the cache of simulated spaces.
 /*!
-   \param layout the space.
-   \param rule the rule to analyze.
-   \return A list of all the coordinates where the rule
-   pushes molecules out of the space bounds.
+   The cache is shared by all the rows of the simulation, so spaces
+   reached by different rows are only simulated once.
+   \param cache the cache to use, or NULL to simulate every space.
 */
-list<coordinate> Simulation::findOutOfBounds(Grid layout, Rule rule)
+void Simulation::setCache(SpaceCache *cache)
 {
-    list<coordinate> result;
-    //We create a bigger space to find rules in it. The new space
-    //must be rule.width - 1 and rule.height - 1 more wider/heighter
-    //on every side (that's 2 for the width and 2 for the height)
-    //to be able to find the rule applicability out of the bounds
-    Grid newSpace(layout.getWidth() + (rule.getWidth() - 1) * 2, layout.getHeight() + (rule.getHeight() - 1) * 2);
-    //We set all cells to disabled
-    for (int i = 0; i < newSpace.getWidth(); i++)
-    {
-        for (int j = 0; j < newSpace.getHeight(); j++)
-        {
-            newSpace(i, j) = nDISABLED;
-        }
-    }
-    
-    //Now we copy the layout into the new grid
-    for (int i = 0; i < layout.getWidth(); i++)
-    {
-        for (int j = 0; j < layout.getHeight(); j++)
-        {
-            newSpace(i + rule.getWidth() - 1, j + rule.getWidth() - 1) = layout(i, j);
-        }
-    }
+    this->cache = cache;
+}
 
-    //Now we simply have to find the applicability of the rule
-    //into the new space. If we found it can be applied, we will
-    //apply it and see if the resulting space violates the space
-    //interface. This is, it has a nENABLED cell on a coordinate
-    //inside the "frame" we have applied to the original space.
-    
-    //Find the applicable coordinates
-    list<coordinate> ruleApplies;
-    for (int i = 0; i < newSpace.getWidth(); i++)
+
+//! Sets the cells of the row that are not simulated.
+/*!
+   The rules touching these cells are never applied, so they keep their
+   initial status. It must be set after resetting the simulation.
+   \param frozen tells for every cell, indexed by x * height + y, if it is
+   left out of the simulation. Empty to simulate all the cells.
+*/
+void Simulation::setFrozen(vector<bool> frozen)
+{
+    graph->setFrozen(frozen);
+}
+
+
+//! Sets the rule placements fired by every step.
+/*!
+   With the interleaving semantics every applicable placement gives its
+   own step. With the parallel ones a step fires at once a maximal set of
+   placements that do not overlap, as the molecules of a cascade do, and
+   its depth counts the time of the cascade.
+   \param semantics STEP_INTERLEAVED, STEP_PARALLEL to fire the set picked
+   in scan order, or STEP_PARALLEL_ALL to try every maximal set.
+*/
+void Simulation::setSemantics(int semantics)
+{
+    this->semantics = semantics;
+}
+
+
+//! Sets how the rules and patterns are looked for.
+/*!
+   \param enabled true to look for them from the enabled sites of the
+   spaces, false to scan the whole spaces.
+*/
+void Simulation::setSiteMatching(bool enabled)
+{
+    siteMatching = enabled;
+    graph->setSites(enabled ? sites : NULL);
+}
+
+
+//! Reuses the cached results of a space.
+/*!
+   The results are reused only if no space on the path leading to the
+   space is reached from it, because then the simulation would find
+   a cycle where the cached exploration did not.
+   \param s the simulation step of the space.
+   \param hash the hash of the space.
+   \return True if the results of the space have been reused.
+*/
+bool Simulation::replay(simulationStep &s, unsigned long hash)
+{
+    cacheEntry *entry = cache->find(s.space.g, hash);
+    if (entry == NULL)
     {
-        for (int j = 0; j < newSpace.getHeight(); j++)
-        {
-            coordinate c;
-            c.x = i;
-            c.y = j;
-            if (ruleApplicable(newSpace, c, rule))
-            {
-                ruleApplies.push_back(c);
-            }
-        }
+        return false;
     }
-    
-    //Check the boundaries of the rule applying
-    for(list<coordinate>::iterator i = ruleApplies.begin(); i != ruleApplies.end(); i++)
+    for (vector<cacheFrame>::iterator i = frames->begin(); i != frames->end(); i++)
     {
-        //Apply the rule
-        Grid appliedSpace = applyRule(newSpace, rule, (*i), false);
-        //Check the boundary
-        if (checkBoundary(newSpace, appliedSpace, rule.getWidth() - 1, rule.getHeight() - 1))
+        if (cache->reaches(entry, (*i).hash))
         {
-            coordinate normalized;
-            if ((*i).x < rule.getWidth() - 1)
-            {
-                normalized.x = 0;
-            }
-            else if ((*i).x >= layout.getWidth())
-            {
-                normalized.x = layout.getWidth() - 1;
-            }
-            else
-            {
-                normalized.x = (*i).x;
-            }
-            
-            if ((*i).y < rule.getHeight() - 1)
-            {
-                normalized.y = 0;
-            }
-            else if ((*i).y >= layout.getHeight())
-            {
-                normalized.y = layout.getHeight() - 1;
-            }
-            else
-            {
-                normalized.y = (*i).y;
-            }
-            result.push_back((*i));
+            return false;
         }
     }
-    
-    return result;
+    appendEvents(finalLayouts, entry->stable, s.path);
+    appendEvents(cycles, entry->cycles, s.path);
+    appendEvents(forbiddenPatternsFound, entry->forbidden, s.path);
+    appendEvents(outOfBoundsFound, entry->outOfBounds, s.path);
+    visited->insert(visited->end(), entry->states.begin(), entry->states.end());
+    cacheHits++;
+    return true;
 }
 
 
-//! Checks if an enabled cell is out of bounds.
+//! Adds cached events to an event list.
 /*!
-   \param originalSpace original space, used to see if any
-   non space coordinate was invaded by a molecule.
-   \param layout the space.
-   \param widthMargin the with margin considered out of bounds.
-   \param heightMargin the height margin considered out of bounds.
-   \return True iif there is an enabled cell in the frame of the space
-   limited by the widthMargin and heightMargin margins.
+   \param events the event list.
+   \param cached the cached events, with their paths starting at the
+   cached space.
+   \param prefix the path leading to the cached space.
 */
-bool Simulation::checkBoundary(Grid originalSpace, Grid layout, int widthMargin, int heightMargin)
+void Simulation::appendEvents(list<simulationStep> *events, list<simulationStep> &cached, list<spaceHighlighted> &prefix)
 {
-    bool result = false;
-    
-    //cout << "Finding OOB in this space:" << endl;
-    
-    //printLayout(layout);
-    
-    //We'll check all the 4 subspaces that conform the frame
-    //From 0,0 to width, heightMargin
-    for(int i = 0; i < layout.getWidth(); i++)
+    for (list<simulationStep>::iterator i = cached.begin(); i != cached.end(); i++)
     {
-        for (int j = 0; j < heightMargin; j++)
-        {
-            if (layout(i, j) == nENABLED)
-            {
-                result = true;
-                //cout << "1 ENABLED AT " << i << ", " << j << endl;
-            }
-        }
-    }
-    
-    //From 0, height - heightMargin to width, height
-    for(int i = 0; i < layout.getWidth(); i++)
-    {
-        for (int j = layout.getHeight() - heightMargin; j < layout.getHeight(); j++)
-        {
-            if (layout(i, j) == nENABLED)
-            {
-                result = true;
-                //cout << "2 ENABLED AT " << i << ", " << j << endl;
-            }
-        }
+        simulationStep newStep = (*i);
+        newStep.path.insert(newStep.path.begin(), prefix.begin(), prefix.end());
+        events->push_back(newStep);
     }
-    
-    //From 0,0 to widthMargin, height
-    for(int i = 0; i < widthMargin; i++)
+}
+
+
+//! Starts recording the results of a space.
+/*!
+   \param layout the space being simulated.
+   \param hash the hash of the space.
+*/
+void Simulation::openFrame(Grid layout, unsigned long hash)
+{
+    cacheFrame frame;
+    frame.space = layout;
+    frame.hash = hash;
+    frame.base = patternsToSimulate->size();
+    frame.stable = finalLayouts->size();
+    frame.cycles = cycles->size();
+    frame.forbidden = forbiddenPatternsFound->size();
+    frame.outOfBounds = outOfBoundsFound->size();
+    frame.visited = visited->size();
+    frame.tainted = false;
+    visited->push_back(hash);
+    frames->push_back(frame);
+}
+
+
+//! Caches the results of the spaces whose subtree has been explored.
+/*!
+   A subtree is explored when all the spaces queued after its space
+   have been simulated.
+   \param size the number of spaces still queued.
+*/
+void Simulation::closeFrames(unsigned int size)
+{
+    while (!frames->empty() && frames->back().base >= size)
     {
-        for (int j = 0; j < layout.getHeight(); j++)
+        cacheFrame frame = frames->back();
+        frames->pop_back();
+        if (!frame.tainted)
         {
-            if (layout(i, j) == nENABLED)
-            {
-                result = true;
-                //cout << "3 ENABLED AT " << i << ", " << j << endl;
-            }
+            unsigned int depth = frames->size();
+            cacheEntry entry;
+            entry.space = frame.space;
+            entry.stable = getSuffix(finalLayouts, frame.stable, depth);
+            entry.cycles = getSuffix(cycles, frame.cycles, depth);
+            entry.forbidden = getSuffix(forbiddenPatternsFound, frame.forbidden, depth);
+            entry.outOfBounds = getSuffix(outOfBoundsFound, frame.outOfBounds, depth);
+            entry.states.assign(visited->begin() + frame.visited, visited->end());
+            sort(entry.states.begin(), entry.states.end());
+            entry.states.erase(unique(entry.states.begin(), entry.states.end()), entry.states.end());
+            cache->add(entry, frame.hash);
         }
     }
-    
-    //From width-widthMargin,0 to width, height
-    for(int i = layout.getWidth() - widthMargin; i < layout.getWidth(); i++)
+}
+
+
+//! Gets the last events of an event list relative to a space.
+/*!
+   \param events the event list.
+   \param first the number of events to skip.
+   \param depth the number of spaces of the paths to remove, that is,
+   the depth of the space on the simulation.
+   \return The events after the first ones, with their paths starting
+   at the space.
+*/
+list<simulationStep> Simulation::getSuffix(list<simulationStep> *events, unsigned int first, unsigned int depth)
+{
+    list<simulationStep> result;
+    list<simulationStep>::iterator i = events->begin();
+    for (unsigned int k = 0; k < first; k++)
     {
-        for (int j = 0; j < layout.getHeight(); j++)
-        {
-            if (layout(i, j) == nENABLED)
-            {
-                result = true;
-                //cout << "4 ENABLED AT " << i << ", " << j << endl;
-            }
-        }
+        i++;
     }
-    
-    //Now we check the noSPACE invasion
-    for (int i = 0; i < layout.getWidth(); i++)
+    for (; i != events->end(); i++)
     {
-        for (int j = 0; j < layout.getHeight(); j++)
+        simulationStep newStep = (*i);
+        list<spaceHighlighted>::iterator end = newStep.path.begin();
+        for (unsigned int k = 0; k < depth; k++)
         {
-            if ((layout(i, j) == nENABLED) && (originalSpace(i, j) == nNOSPACE))
-            {
-                result = true;
-            }
+            end++;
         }
+        newStep.path.erase(newStep.path.begin(), end);
+        result.push_back(newStep);
     }
     return result;
 }
@@ -24,6 +24,10 @@
  * It gets the initial configuration, the rules and forbidden patterns to
  * use, and it simulates step by step until all the spaces have been
  * simulated or an error occurs.
+ * 
+ * The view, the controller and the checkpoints are only used from
+ * simulationControl.cpp, so the engine itself builds without wxWidgets.
+ * headlessSimulation.cpp stands in for it in the embedding library.
  * \author Bernat Rfales Mulet <the_bell@users.sourceforge.net>
  * \version $Revision: 1.14 $
  */
@@ -31,84 +35,72 @@
 #ifndef SIMULATION_HPP_
 #define SIMULATION_HPP_
 
-#include "simulationManager.hpp"
-#include "simulationView.hpp"
+#include "forbiddenPattern.hpp"
+#include "ruleGraph.hpp"
+#include "siteIndex.hpp"
+#include "simulationStep.hpp"
+#include "spaceCache.hpp"
+#include "simulationOptions.hpp"
 #include <vector>
 #include <list>
 
-//! Rule applying struct.
-/*! Struct used to store information about a rule application. */
-struct ruleApplying
-{
-    Rule *rule; /*!< The rule which applies. */
-    coordinate c; /*!< The coordinate in which the rule applies.. */
-};
-
-
-//! Highlight information struct.
-/*! Struct used to store information about a space highlighted zone. */
-struct highlight
-{
-    int top;
-    int left;
-    int width;
-    int height;
-};
-
-
-//! Step space.
-/*! Struct used to store information about a space and it's highligted zone. */
-struct spaceHighlighted
-{
-    Grid g;
-    highlight h;
-};
-
-
-//! Siulation step struct.
-/*! This is used to represent a single simulation step. */
-struct simulationStep
-{
-    list <spaceHighlighted> path; /*!< List of spaces which lead to the current space. */
-    spaceHighlighted space; /*!< Current space of the simulation step. */
-};
-
 using namespace std;
 
 class SimulationManager;
 
 class SimulationView;
 
+class Checkpoint;
+
 class Simulation
 {
 public:
 	Simulation(SimulationView *view, SimulationManager *controller, Grid initialLayout, list<Rule> *rules, list<ForbiddenPattern> *patterns);
 	virtual ~Simulation();
     bool isFinished();
+    void stopRow();
     bool nextStep(bool gui);
     void nextRow();
     void results();
     void simulateAll();
     void resetSimulation(SimulationView *view, SimulationManager *controller, Grid initialLayout, list<Rule> *rules, list<ForbiddenPattern> *patterns);
+    void setCache(SpaceCache *cache);
+    void setFrozen(vector<bool> frozen);
+    void setSemantics(int semantics);
+    void setSiteMatching(bool enabled);
     list<simulationStep> getStableLayouts();
     list<Grid> getProcessedLayouts();
+    vector<unsigned long> getVisited();
     list<simulationStep> getForbiddenLayouts();
     list<simulationStep> getCycles();
     list<simulationStep> getOutOfBounds();
+    void saveState(Checkpoint &file);
+    bool loadState(Checkpoint &file);
 
 private:
-    list<coordinate> findRule(Grid layout, Rule rule);
-    list<coordinate> findPattern(Grid layout, ForbiddenPattern pattern);
-    Grid applyRule(Grid layout, Rule rule, coordinate position, bool absolute);
-    bool ruleApplicable(Grid layout, coordinate position, Rule rule);
+    list<coordinate> findPattern(Grid &layout, ForbiddenPattern &pattern);
     void printRule(Rule rule);
     void printLayout(Grid layout);
     bool find(Grid initialLayout, list<Grid> processedLayouts);
-    bool patternApplicable(Grid layout, coordinate position, ForbiddenPattern pattern);
-    void updateView();
+    int findInPath(Grid layout, list<spaceHighlighted> &path);
+    bool patternApplicable(Grid &layout, matrix &cells, int left, int top);
     list<Grid> getGridList(list<spaceHighlighted> spaces);
-    list<coordinate> findOutOfBounds(Grid layout, Rule rule);
-    bool checkBoundary(Grid originalSpace, Grid layout, int widthMargin, int heightMargin);
+    void updateView();
+    void showStart(Grid &initialLayout, bool reset);
+    void showSpace(Grid &layout);
+    void showInfo(const char *format, ...);
+    void showRuleGraph(list<ruleApplying> applicable);
+    void notifyFinished();
+    void notifyStep();
+    bool replay(simulationStep &s, unsigned long hash);
+    list< list<ruleApplying> > getParallelSteps(list<ruleApplying> &applicable);
+    void enumerateParallel(vector<ruleApplying> &applicable, unsigned int next, list<ruleApplying> &chosen, list< list<ruleApplying> > &steps);
+    bool overlapping(ruleApplying &a, ruleApplying &b);
+    void addParallelStep(simulationStep &s, Grid &layout, list<ruleApplying> &fired, bool gui);
+    void appendEvents(list<simulationStep> *events, list<simulationStep> &cached, list<spaceHighlighted> &prefix);
+    void openFrame(Grid layout, unsigned long hash);
+    void closeFrames(unsigned int size);
+    list<simulationStep> getSuffix(list<simulationStep> *events, unsigned int first, unsigned int depth);
     //! Simulation presentation layer.
     SimulationView *view;
     //! Simulation controller.
@@ -127,6 +119,24 @@ private:
     list<simulationStep> *outOfBoundsFound;
     //! List of rules to test.
     list<Rule> *rules;
+    //! Trigger dependency graph of the rules.
+    RuleGraph *graph;
+    //! Sites of the space simulated.
+    SiteIndex *sites;
+    //! True to look for the rules and patterns from the enabled sites.
+    bool siteMatching;
+    //! Results of the spaces already simulated, NULL if not used.
+    SpaceCache *cache;
+    //! True if the row was resumed from a checkpoint, then it only records the spaces reached.
+    bool resumed;
+    //! Spaces being simulated whose subtree is not explored yet.
+    vector<cacheFrame> *frames;
+    //! Hashes of the spaces simulated or reused from the cache.
+    vector<unsigned long> *visited;
+    //! Rule placements fired by every step, STEP_INTERLEAVED or a parallel mode.
+    int semantics;
+    //! Number of spaces whose results have been reused in the row.
+    int cacheHits;
     //! List of forbidden patterns to test.
     list<ForbiddenPattern> *patterns;
     //! Is the simulation finished?
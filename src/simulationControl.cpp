@@ -0,0 +1,249 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "simulation.hpp"
+#include "simulationManager.hpp"
+#include "simulationView.hpp"
+#include "checkpoint.hpp"
+#include <cstdarg>
+
+using namespace std;
+
+//! Shows the initial space of a row on the view.
+/*!
+   \param initialLayout the initial space of the row.
+   \param reset true if the view showed a previous row.
+*/
+void Simulation::showStart(Grid &initialLayout, bool reset)
+{
+    if (view != NULL)
+    {
+        view->setGrid(initialLayout, true);
+        view->Show(true);
+        if (reset)
+        {
+            view->Enable(true);
+            view->stopSimulation();
+        }
+    }
+}
+
+
+//! Shows the space being simulated on the view.
+/*!
+   \param layout the space.
+*/
+void Simulation::showSpace(Grid &layout)
+{
+    view->setGrid(layout, false);
+}
+
+
+//! Shows simulation information on the view.
+/*!
+   \param format the untranslated message, in printf format.
+*/
+void Simulation::showInfo(const char *format, ...)
+{
+    va_list arguments;
+    va_start(arguments, format);
+    wxString message = wxString::FormatV(wxGetTranslation(wxString(format, wxConvUTF8)), arguments);
+    va_end(arguments);
+    view->setInfo(message);
+}
+
+
+//! Tells the controller the row is finished.
+void Simulation::notifyFinished()
+{
+    if (controller != NULL)
+    {
+        controller->finishedRow();
+    }
+}
+
+
+//! Tells the controller a simulation step is done.
+void Simulation::notifyStep()
+{
+    if (controller != NULL)
+    {
+        controller->checkpoint();
+    }
+}
+
+
+//! Updates the simulation view with flow control information.
+/*!
+   This method updates the view to allow the user simulate other
+   rows and view the simulation results when the simulation is over.
+*/
+void Simulation::updateView()
+{
+    if (finished)
+    {
+        if (controller->nextRow())
+        {
+            view->setResults(false);
+            view->setNextRow(true);
+            view->enableSimulation(false);
+        }
+        else
+        {
+            view->setResults(true);
+            view->setNextRow(false);
+            view->enableSimulation(false);
+        }
+    }
+}
+
+
+//! Asks the controller for another row to simulate.
+void Simulation::nextRow()
+{
+    if (controller->nextRow())
+    {
+        controller->simulateRow();
+        view->setResults(false);
+        view->setNextRow(false);
+        view->enableSimulation(true);
+    }
+    else
+    {
+        view->setResults(true);
+        view->setNextRow(false);
+        view->enableSimulation(true);
+    }
+}
+
+
+//! Asks the controller to show the simulation results.
+void Simulation::results()
+{
+    controller->results();
+}
+
+
+//! Writes the state of the row to a checkpoint.
+/*!
+   \param file the checkpoint.
+*/
+void Simulation::saveState(Checkpoint &file)
+{
+    file.writeSteps(*patternsToSimulate);
+    file.writeGrids(*patternsSimulated);
+    file.writeSteps(*finalLayouts);
+    file.writeSteps(*forbiddenPatternsFound);
+    file.writeSteps(*cycles);
+    file.writeSteps(*outOfBoundsFound);
+    file.writeHashes(*visited);
+    file.writeInt(cacheHits);
+}
+
+
+//! Restores the state of the row from a checkpoint.
+/*!
+   The frames of the spaces open when the checkpoint was written are not
+   saved, so the cache could not tell which results depend on the spaces
+   above the queued ones. The rest of the row neither uses the cache nor
+   adds to it, it only records the spaces reached.
+   \param file the checkpoint, written by saveState for the same row.
+   \return True iif the state was restored, otherwise the row is left as
+   it was.
+*/
+bool Simulation::loadState(Checkpoint &file)
+{
+    vector<Rule *> ruleSet;
+    for (list<Rule>::iterator i = rules->begin(); i != rules->end(); i++)
+    {
+        ruleSet.push_back(&(*i));
+    }
+    list<simulationStep> toSimulate, stable, forbidden, cycleSteps, outOfBounds;
+    list<Grid> simulated;
+    vector<unsigned long> hashes;
+    int hits;
+    if (!file.readSteps(&toSimulate, ruleSet) || !file.readGrids(&simulated) || !file.readSteps(&stable, ruleSet) || !file.readSteps(&forbidden, ruleSet) || !file.readSteps(&cycleSteps, ruleSet) || !file.readSteps(&outOfBounds, ruleSet) || !file.readHashes(&hashes) || !file.readInt(&hits))
+    {
+        return false;
+    }
+    patternsToSimulate->swap(toSimulate);
+    patternsSimulated->swap(simulated);
+    finalLayouts->swap(stable);
+    forbiddenPatternsFound->swap(forbidden);
+    cycles->swap(cycleSteps);
+    outOfBoundsFound->swap(outOfBounds);
+    visited->swap(hashes);
+    //The rules may have made cells of the queued spaces available
+    for (list<simulationStep>::iterator i = patternsToSimulate->begin(); i != patternsToSimulate->end(); i++)
+    {
+        sites->addSpace((*i).space.g);
+    }
+    cacheHits = hits;
+    frames->clear();
+    resumed = true;
+    finished = patternsToSimulate->empty();
+    return true;
+}
+
+
+//! Simulates all the rows of the simulation.
+/*!
+   This method simulates all the rows in a shot, without the
+   timer and user interactivity. Useful for quick simulations.
+*/
+void Simulation::simulateAll()
+{
+    view->enableSimulation(false);
+    view->setNextRow(false);
+    view->setResults(false);
+    //The rows not started yet may be simulated at once
+    controller->presolve();
+    while (stillRows)
+    {
+        while (!finished)
+        {
+            nextStep(false);
+        }
+        if (controller->nextRow())
+        {
+            controller->simulateRow();
+        }
+        else
+        {
+            stillRows = false;
+        }
+    }
+    view->setResults(true);
+}
+
+
+//! Shows the rule dependency graph diagnostic.
+/*!
+   \param applicable the rule applyings found on the initial space.
+*/
+void Simulation::showRuleGraph(list<ruleApplying> applicable)
+{
+    showInfo("Rule dependency graph: %d rules (rotations included), %d trigger edges", graph->getRules(), graph->getEdges());
+    list<int> neverFiring = graph->getNeverFiring(applicable);
+    for (list<int>::iterator i = neverFiring.begin(); i != neverFiring.end(); i++)
+    {
+        showInfo("Rule %d can never fire on this space", (*i) + 1);
+    }
+}
@@ -0,0 +1,628 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "simulationDaemon.hpp"
+#include "ruleRotation.hpp"
+#include "subCircuitSummary.hpp"
+#include "staticPruning.hpp"
+#include <sstream>
+#include <new>
+#include <cerrno>
+#include <cmath>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace std;
+
+//! Constructor.
+SimulationDaemon::SimulationDaemon()
+{
+    server = -1;
+    socketPath = wxEmptyString;
+    jobs = 0;
+    error = wxEmptyString;
+}
+
+
+//! Destructor.
+/*!
+   The socket is closed and removed, and the designs compiled are freed.
+*/
+SimulationDaemon::~SimulationDaemon()
+{
+    if (server >= 0)
+    {
+        close(server);
+        unlink(socketPath.mb_str());
+    }
+    for (map<string, compiledDesign *>::iterator i = designs.begin(); i != designs.end(); i++)
+    {
+        deleteDesign((*i).second);
+    }
+}
+
+
+//! Starts listening on a local socket.
+/*!
+   A socket left by a daemon that did not stop is replaced, but any
+   other file at the path is left alone and the daemon does not start.
+   \param socketPath the path of the socket.
+   \return True iif the daemon is listening.
+*/
+bool SimulationDaemon::listen(wxString socketPath)
+{
+    struct sockaddr_un address;
+    string path(socketPath.mb_str());
+    if (path.empty() || path.size() >= sizeof(address.sun_path))
+    {
+        error = _("Invalid socket path");
+        return false;
+    }
+    struct stat status;
+    if (lstat(path.c_str(), &status) == 0)
+    {
+        if (!S_ISSOCK(status.st_mode))
+        {
+            error = socketPath + _(" exists and is not a socket");
+            return false;
+        }
+        unlink(path.c_str());
+    }
+    server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0)
+    {
+        error = _("Can not create the socket");
+        return false;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path.c_str());
+    if (bind(server, (struct sockaddr *)&address, sizeof(address)) != 0 || ::listen(server, DAEMON_BACKLOG) != 0)
+    {
+        error = _("Can not listen on ") + socketPath;
+        close(server);
+        server = -1;
+        return false;
+    }
+    this->socketPath = socketPath;
+    return true;
+}
+
+
+//! Serves the clients until a shutdown job.
+/*!
+   The clients are served one at a time, every one until it closes its
+   connection. A client that sends or takes nothing for DAEMON_TIMEOUT
+   seconds is disconnected, so an idle one does not keep the rest waiting.
+*/
+void SimulationDaemon::serve()
+{
+    //A client that goes away makes the writes fail instead of killing the daemon
+    void (*previous)(int) = signal(SIGPIPE, SIG_IGN);
+    bool running = server >= 0;
+    while (running)
+    {
+        int client = accept(server, NULL, NULL);
+        if (client < 0)
+        {
+            running = errno == EINTR;
+            continue;
+        }
+        struct timeval timeout;
+        timeout.tv_sec = DAEMON_TIMEOUT;
+        timeout.tv_usec = 0;
+        setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        input.clear();
+        running = serveClient(client);
+        close(client);
+    }
+    signal(SIGPIPE, previous);
+}
+
+
+//! Member accessor.
+/*!
+   \return The error of the last call, empty if none.
+*/
+wxString SimulationDaemon::getError()
+{
+    return error;
+}
+
+
+//! Serves the jobs of a client.
+/*!
+   A job that fails is answered with an error line. The connection is
+   closed after an inline job that fails, since the rest of its contents
+   can not be told from the next jobs.
+   \param client the connection of the client.
+   \return False iif the client asked the daemon to stop.
+*/
+bool SimulationDaemon::serveClient(int client)
+{
+    string line;
+    while (readLine(client, &line))
+    {
+        compiledDesign *compiled = NULL;
+        bool inlined = false;
+        jobs++;
+        error = wxEmptyString;
+        if (line == "shutdown")
+        {
+            writeLine(client, _("ok"));
+            return false;
+        }
+        else if (line.compare(0, 8, "project ") == 0)
+        {
+            compiled = getProject(wxString(line.substr(8).c_str(), wxConvUTF8));
+        }
+        else if (line == "inline")
+        {
+            inlined = true;
+            compiled = getInline(client);
+        }
+        else if (!line.empty())
+        {
+            error = _("Unknown job");
+        }
+        else
+        {
+            continue;
+        }
+        if (compiled == NULL)
+        {
+            if (!writeLine(client, _("error ") + error) || inlined)
+            {
+                return true;
+            }
+        }
+        else if (!simulate(client, compiled))
+        {
+            return true;
+        }
+    }
+    return true;
+}
+
+
+//! Reads a line from a client.
+/*!
+   \param client the connection of the client.
+   \param line returns the line, without its end.
+   \return False if the client closed the connection or timed out before
+   a full line.
+*/
+bool SimulationDaemon::readLine(int client, string *line)
+{
+    size_t end;
+    while ((end = input.find('\n')) == string::npos)
+    {
+        char buffer[4096];
+        ssize_t bytes = read(client, buffer, sizeof(buffer));
+        if (bytes < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (bytes <= 0)
+        {
+            return false;
+        }
+        input.append(buffer, bytes);
+    }
+    *line = input.substr(0, end);
+    input.erase(0, end + 1);
+    if (!line->empty() && (*line)[line->size() - 1] == '\r')
+    {
+        line->erase(line->size() - 1);
+    }
+    return true;
+}
+
+
+//! Writes a line to a client.
+/*!
+   \param client the connection of the client.
+   \param line the line, without its end.
+   \return False if the client closed the connection or timed out.
+*/
+bool SimulationDaemon::writeLine(int client, wxString line)
+{
+    string data(line.mb_str());
+    data += "\n";
+    size_t written = 0;
+    while (written < data.size())
+    {
+        ssize_t bytes = write(client, data.c_str() + written, data.size() - written);
+        if (bytes < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (bytes <= 0)
+        {
+            return false;
+        }
+        written += bytes;
+    }
+    return true;
+}
+
+
+//! Returns a project compiled.
+/*!
+   The project is read and compiled again only if any of its files
+   changed since it was compiled.
+   \param fileName the project file.
+   \return The design compiled, NULL if the project could not be read.
+*/
+compiledDesign *SimulationDaemon::getProject(wxString fileName)
+{
+    ProjectReader reader;
+    vector<wxString> files;
+    if (!reader.getFiles(fileName, &files))
+    {
+        error = reader.getError();
+        return NULL;
+    }
+    files.push_back(fileName);
+    string stamp;
+    for (unsigned int i = 0; i < files.size(); i++)
+    {
+        struct stat status;
+        if (!files[i].IsEmpty() && stat(files[i].mb_str(), &status) == 0)
+        {
+            stamp += string(wxString::Format(_("%ld.%ld;"), (long)status.st_mtime, (long)status.st_size).mb_str());
+        }
+        else
+        {
+            stamp += "-;";
+        }
+    }
+    string key = string("project ") + string(fileName.mb_str());
+    map<string, compiledDesign *>::iterator i = designs.find(key);
+    if (i != designs.end() && (*i).second->stamp == stamp)
+    {
+        (*i).second->used = jobs;
+        return (*i).second;
+    }
+    design source;
+    if (!reader.openProject(fileName, &source))
+    {
+        error = reader.getError();
+        return NULL;
+    }
+    compiledDesign *compiled = compile(source);
+    compiled->stamp = stamp;
+    keep(key, compiled);
+    return compiled;
+}
+
+
+//! Reads an inline job and returns its design compiled.
+/*!
+   The design is read and compiled only if no job had the same contents.
+   \param client the connection of the client, after the "inline" line.
+   \return The design compiled, NULL if the job could not be read.
+*/
+compiledDesign *SimulationDaemon::getInline(int client)
+{
+    map<string, string> sections;
+    sections["rules"] = "";
+    sections["fps"] = "";
+    sections["tables"] = "";
+    sections["layout"] = "";
+    sections["project"] = "";
+    string line;
+    while (true)
+    {
+        if (!readLine(client, &line))
+        {
+            error = _("Inline job not ended");
+            return NULL;
+        }
+        if (line == "end")
+        {
+            break;
+        }
+        istringstream header(line);
+        string name;
+        long lines;
+        if (!(header >> name >> lines) || sections.find(name) == sections.end() || lines < 0 || lines > DAEMON_SECTION_LINES)
+        {
+            error = _("Inline job format error");
+            return NULL;
+        }
+        string text;
+        for (long i = 0; i < lines; i++)
+        {
+            if (!readLine(client, &line))
+            {
+                error = _("Inline job not ended");
+                return NULL;
+            }
+            text += line + "\n";
+        }
+        sections[name] = text;
+    }
+    
+    string key = "inline";
+    for (map<string, string>::iterator i = sections.begin(); i != sections.end(); i++)
+    {
+        key += "\n" + (*i).first + "\n" + (*i).second;
+    }
+    map<string, compiledDesign *>::iterator i = designs.find(key);
+    if (i != designs.end())
+    {
+        (*i).second->used = jobs;
+        return (*i).second;
+    }
+    istringstream project(sections["project"]);
+    istringstream rules(sections["rules"]);
+    istringstream patterns(sections["fps"]);
+    istringstream tables(sections["tables"]);
+    istringstream layout(sections["layout"]);
+    ProjectReader reader;
+    design source;
+    if (!reader.readProject(&project, &rules, &patterns, &tables, &layout, &source))
+    {
+        error = reader.getError();
+        return NULL;
+    }
+    compiledDesign *compiled = compile(source);
+    keep(key, compiled);
+    return compiled;
+}
+
+
+//! Compiles a design.
+/*!
+   The rules and patterns get their rotations, the sub-circuit instances
+   their rules and the rules and patterns that can never match the space
+   are left out, as the GUI simulation does.
+   \param source the design.
+   \return The design compiled.
+*/
+compiledDesign *SimulationDaemon::compile(design &source)
+{
+    compiledDesign *compiled = new compiledDesign;
+    RuleRotation rotation(&compiled->rules, &compiled->patterns);
+    compiled->unrotated = 0;
+    for (list<Rule>::iterator i = source.rules.begin(); i != source.rules.end(); i++)
+    {
+        if (!rotation.addRule((*i)))
+        {
+            compiled->unrotated++;
+        }
+    }
+    for (list<ForbiddenPattern>::iterator i = source.patterns.begin(); i != source.patterns.end(); i++)
+    {
+        if (!rotation.addPattern((*i)))
+        {
+            compiled->unrotated++;
+        }
+    }
+    compiled->inputs = source.inputs;
+    compiled->outputs = source.outputs;
+    compiled->layout = source.layout;
+    
+    //The sub-circuit instances are simulated by their truth tables
+    SubCircuitSummary summary(compiled->layout.size(), compiled->layout[0].size());
+    for (unsigned int i = 0; i < source.instances.size(); i++)
+    {
+        summary.addInstance(source.instances[i].inputs, source.instances[i].outputs, source.instanceTables[i]);
+    }
+    list<Rule> summaryRules = summary.getRules();
+    compiled->rules.insert(compiled->rules.end(), summaryRules.begin(), summaryRules.end());
+    compiled->instanceCells = summary.getFrozen();
+    compiled->instancePins = summary.getPins();
+    compiled->verifier.setSpace(compiled->layout, compiled->inputs, compiled->instancePins);
+    //The verifier reads the tables kept with the design row by row
+    compiled->table = source.table;
+    compiled->otherTables = source.otherTables;
+    compiled->verifier.addTable(source.inputs, source.outputs, &compiled->table);
+    for (unsigned int t = 0; t < compiled->otherTables.size(); t++)
+    {
+        compiled->verifier.addTable(source.otherInputs[t], source.otherOutputs[t], &compiled->otherTables[t]);
+    }
+    vector<double> rates(compiled->rules.size(), 1);
+    StaticPruning pruning(&compiled->rules, &compiled->patterns);
+    pruning.prune(Grid(compiled->verifier.getRowLayout(0)), compiled->inputs, rates);
+    
+    compiled->simulation = NULL;
+    compiled->tiles = new TileSimulation(&compiled->rules, &compiled->patterns);
+    compiled->cache = new SpaceCache();
+    compiled->rows.assign((int)pow(2, (double)compiled->inputs.size()), wxEmptyString);
+    compiled->verified.assign(compiled->rows.size(), false);
+    compiled->served = 0;
+    compiled->used = jobs;
+    return compiled;
+}
+
+
+//! Frees a design compiled.
+/*!
+   \param compiled the design.
+*/
+void SimulationDaemon::deleteDesign(compiledDesign *compiled)
+{
+    delete compiled->simulation;
+    delete compiled->tiles;
+    delete compiled->cache;
+    delete compiled;
+}
+
+
+//! Keeps a design compiled for the next jobs.
+/*!
+   The design replaces the one with the same key, and when there are more
+   than DAEMON_DESIGNS the one used least recently is freed.
+   \param key the project file or the inline contents of the design.
+   \param compiled the design.
+*/
+void SimulationDaemon::keep(string key, compiledDesign *compiled)
+{
+    map<string, compiledDesign *>::iterator i = designs.find(key);
+    if (i != designs.end())
+    {
+        deleteDesign((*i).second);
+    }
+    designs[key] = compiled;
+    while (designs.size() > DAEMON_DESIGNS)
+    {
+        map<string, compiledDesign *>::iterator oldest = designs.begin();
+        for (i = designs.begin(); i != designs.end(); i++)
+        {
+            if ((*i).second->used < (*oldest).second->used)
+            {
+                oldest = i;
+            }
+        }
+        deleteDesign((*oldest).second);
+        designs.erase(oldest);
+    }
+}
+
+
+//! Simulates the rows of a design for a client.
+/*!
+   A line with the design is written first, with the number of rules and
+   patterns that miss some rotations, then the line of every row as soon
+   as it is known, and a last line with the rows that verify every table.
+   The rows simulated by earlier jobs are not simulated again.
+   \param client the connection of the client.
+   \param compiled the design.
+   \return False if the client closed the connection.
+*/
+bool SimulationDaemon::simulate(int client, compiledDesign *compiled)
+{
+    wxString state = compiled->served > 0 ? _("warm") : _("compiled");
+    compiled->served++;
+    if (!writeLine(client, wxString::Format(_("design %s rows %d rules %d patterns %d unrotated %d"), state.c_str(), (int)compiled->rows.size(), (int)compiled->rules.size(), (int)compiled->patterns.size(), compiled->unrotated)))
+    {
+        return false;
+    }
+    int verified = 0;
+    for (unsigned int row = 0; row < compiled->rows.size(); row++)
+    {
+        wxString result = compiled->rows[row];
+        if (result.IsEmpty())
+        {
+            result = simulateRow(compiled, row);
+        }
+        if (compiled->verified[row])
+        {
+            verified++;
+        }
+        if (!writeLine(client, result))
+        {
+            return false;
+        }
+    }
+    return writeLine(client, wxString::Format(_("done verified %d rows %d"), verified, (int)compiled->rows.size()));
+}
+
+
+//! Simulates a row of a design.
+/*!
+   The result is kept for the next jobs, unless the row runs out of
+   memory.
+   \param compiled the design.
+   \param row the row.
+   \return The line with the result of the row.
+*/
+wxString SimulationDaemon::simulateRow(compiledDesign *compiled, int row)
+{
+    //The rows whose outputs are all don't-cares are verified by any space
+    if (!compiled->verifier.isRelevant(row))
+    {
+        compiled->verified[row] = true;
+        compiled->rows[row] = wxString::Format(_("row %d dontcare"), row);
+        return compiled->rows[row];
+    }
+    matrix rowLayout = compiled->verifier.getRowLayout(row);
+    Simulation *simulation = compiled->simulation;
+    try
+    {
+        //The simulation is reset with the same rules, so it keeps its rule index
+        if (simulation == NULL)
+        {
+            simulation = new Simulation(NULL, NULL, Grid(rowLayout), &compiled->rules, &compiled->patterns);
+            simulation->setCache(compiled->cache);
+            compiled->simulation = simulation;
+        }
+        else
+        {
+            simulation->resetSimulation(NULL, NULL, Grid(rowLayout), &compiled->rules, &compiled->patterns);
+        }
+        //Only the cells that can affect the outputs are simulated
+        vector<bool> rowFrozen = compiled->instanceCells;
+        if (compiled->instanceCells.empty())
+        {
+            compiled->tiles->slice(Grid(rowLayout), compiled->verifier.getOutputs(), rowFrozen);
+        }
+        if (rowFrozen != compiled->frozen)
+        {
+            //The spaces simulated with other cells left out have other results
+            compiled->cache->clear();
+            compiled->frozen = rowFrozen;
+        }
+        simulation->setFrozen(compiled->frozen);
+        while (!simulation->isFinished())
+        {
+            simulation->nextStep(false);
+        }
+    }
+    catch (bad_alloc &)
+    {
+        delete compiled->simulation;
+        compiled->simulation = NULL;
+        compiled->cache->clear();
+        return wxString::Format(_("row %d outofmemory"), row);
+    }
+    
+    list<simulationStep> stable = simulation->getStableLayouts();
+    list<simulationStep> cycles = simulation->getCycles();
+    list<simulationStep> forbidden = simulation->getForbiddenLayouts();
+    list<simulationStep> outOfBounds = simulation->getOutOfBounds();
+    bool verifies = compiled->verifier.verifyRow(row, stable, cycles, forbidden, outOfBounds, ALL_TABLES);
+    wxString outputs = wxEmptyString;
+    for (list<simulationStep>::iterator i = stable.begin(); i != stable.end(); i++)
+    {
+        outputs += _(" ");
+        for (unsigned int k = 0; k < compiled->outputs.size(); k++)
+        {
+            outputs += (*i).space.g(compiled->outputs[k].x, compiled->outputs[k].y) == nENABLED ? _("1") : _("0");
+        }
+    }
+    wxString verdict = verifies ? _("verified") : _("failed");
+    compiled->verified[row] = verifies;
+    compiled->rows[row] = wxString::Format(_("row %d %s stable %d cycles %d forbidden %d outofbounds %d"), row, verdict.c_str(), (int)stable.size(), (int)cycles.size(), (int)forbidden.size(), (int)outOfBounds.size());
+    if (!outputs.IsEmpty())
+    {
+        compiled->rows[row] += _(" outputs") + outputs;
+    }
+    return compiled->rows[row];
+}
+
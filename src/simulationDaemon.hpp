@@ -0,0 +1,130 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class SimulationDaemon
+ * \brief Simulation server that keeps the designs compiled between jobs.
+ * 
+ * Tools that verify many designs, or the same design many times, pay
+ * more for reading the files, expanding the rotations and building the
+ * indices than for simulating. The daemon listens on a local socket and
+ * takes simulation jobs, one per line: "project <file>" simulates a
+ * project file, "inline" followed by the contents of the files of a
+ * project simulates a design that is not saved anywhere, and "shutdown"
+ * stops the daemon. The designs are kept compiled, with their rule
+ * indices, space caches and the results of their rows, so a job for a
+ * design already simulated only simulates the rows it has not. The
+ * result of every row is written back as soon as it is known. The clients
+ * are served in turns, and one left idle for DAEMON_TIMEOUT seconds is
+ * disconnected.
+ * 
+ * An inline job has a section for every file of the project, each one
+ * a line with the name of the file ("rules", "fps", "tables", "layout"
+ * or "project") and its number of lines followed by those lines, and
+ * ends with a line "end". The project section is the project file as
+ * saved, the file names it starts with are ignored.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef SIMULATIONDAEMON_HPP_
+#define SIMULATIONDAEMON_HPP_
+
+#include <wx/wx.h>
+#include "projectReader.hpp"
+#include "simulation.hpp"
+#include "spaceCache.hpp"
+#include "tileSimulation.hpp"
+#include "rowVerifier.hpp"
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+
+using namespace std;
+
+//! Designs kept compiled by the daemon.
+#define DAEMON_DESIGNS 16
+//! Connections waiting to be accepted by the daemon.
+#define DAEMON_BACKLOG 8
+//! Seconds a client may stay idle before it is disconnected.
+#define DAEMON_TIMEOUT 30
+//! Lines of the largest inline job section.
+#define DAEMON_SECTION_LINES 1000000
+
+//! Compiled design struct.
+/*! A design ready to simulate its rows, kept between jobs. */
+struct compiledDesign
+{
+    string stamp; /*!< Modification times of the files of a project, empty for inline designs. */
+    list<Rule> rules; /*!< Rules with their rotations and the sub-circuit rules. */
+    list<ForbiddenPattern> patterns; /*!< Forbidden patterns with their rotations. */
+    int unrotated; /*!< Rules and patterns that miss some rotations, a site of the rotation falls out of their grid. */
+    TruthTable table; /*!< First truth table checked. */
+    vector<TruthTable> otherTables; /*!< Rest of truth tables checked. */
+    RowVerifier verifier; /*!< Initial spaces and verdicts of the rows of the tables checked. */
+    vector<coordinate> inputs; /*!< Input coordinates of the first table. */
+    vector<coordinate> outputs; /*!< Output coordinates of the first table. */
+    matrix layout; /*!< Space. */
+    vector<bool> instanceCells; /*!< Cells inside the sub-circuit instances. */
+    vector<coordinate> instancePins; /*!< Inputs and outputs of the sub-circuit instances. */
+    Simulation *simulation; /*!< Simulation of the rows, NULL before the first one. */
+    TileSimulation *tiles; /*!< Slicing of the rows. */
+    SpaceCache *cache; /*!< Results of the spaces simulated, shared by the rows. */
+    vector<bool> frozen; /*!< Cells left out of the simulation of the last row. */
+    vector<wxString> rows; /*!< Result of every row, empty for the rows not simulated. */
+    vector<bool> verified; /*!< True for the rows simulated that verify every table. */
+    int served; /*!< Jobs served with the design. */
+    unsigned long used; /*!< Job that used the design last. */
+};
+
+class SimulationDaemon
+{
+public:
+    SimulationDaemon();
+    virtual ~SimulationDaemon();
+    bool listen(wxString socketPath);
+    void serve();
+    wxString getError();
+
+private:
+    bool serveClient(int client);
+    bool readLine(int client, string *line);
+    bool writeLine(int client, wxString line);
+    compiledDesign *getProject(wxString fileName);
+    compiledDesign *getInline(int client);
+    compiledDesign *compile(design &source);
+    void deleteDesign(compiledDesign *compiled);
+    void keep(string key, compiledDesign *compiled);
+    bool simulate(int client, compiledDesign *compiled);
+    wxString simulateRow(compiledDesign *compiled, int row);
+    
+    //! Listening socket, -1 if not listening.
+    int server;
+    //! Path of the listening socket.
+    wxString socketPath;
+    //! Designs compiled, by project file or by inline contents.
+    map<string, compiledDesign *> designs;
+    //! Jobs served.
+    unsigned long jobs;
+    //! Data read from the client and not used yet.
+    string input;
+    //! Error of the last call, empty if none.
+    wxString error;
+};
+
+#endif /*SIMULATIONDAEMON_HPP_*/
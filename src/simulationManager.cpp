@@ -19,6 +19,7 @@
 // $Revision: 1.21 $
 
 #include "simulationManager.hpp"
+#include <wx/progdlg.h>
 
 //! Constructor.
 /*!
@@ -35,6 +36,34 @@ SimulationManager::SimulationManager(MainController *controller, TruthTableManag
     this->ruleManager = ruleManager;
     this->controller = controller;
     this->layoutManager = layoutManager;
+    tiles = NULL;
+    symbolic = NULL;
+    subCircuits = 0;
+    options.backward = false;
+    options.bidirectional = false;
+    options.sampling = false;
+    options.trajectories = MONTECARLO_TRAJECTORIES;
+    options.semantics = STEP_INTERLEAVED;
+    options.incremental = true;
+    options.resultCache = true;
+    options.checkpoint = false;
+    options.matcher = PLAN_AUTO;
+    options.strategy = PLAN_AUTO;
+    options.threads = PLAN_AUTO;
+    options.memory = PLAN_AUTO;
+    options.workers = 0;
+    plan.matcher = MATCHER_SITES;
+    plan.strategy = STRATEGY_BITSLICED;
+    plan.threads = 1;
+    plan.memory = MEMORY_CACHED;
+    plan.cacheSpaces = CACHE_SPACES;
+    plan.spaces = 1;
+    plan.cost = 0;
+    probedSpaces = -1;
+    probedDepth = -1;
+    cacheOpen = false;
+    resumed = NULL;
+    resumeRow = -1;
 }
 
 
@@ -43,6 +72,19 @@ SimulationManager::~SimulationManager()
 {
     delete simulation;
     delete view;
+    delete tiles;
+    delete symbolic;
+    delete resumed;
+}
+
+
+//! Sets the options for the next simulations.
+/*!
+   \param options the options chosen by the user.
+*/
+void SimulationManager::setOptions(simulationOptions options)
+{
+    this->options = options;
 }
 
 
@@ -56,28 +98,84 @@ void SimulationManager::prepareSimulation()
 {
     //Get the table, rules and patterns
     rules.clear();
+    ruleRates.clear();
     patterns.clear();
     table = *(layoutManager->getTableSelected());
     tableInputs = layoutManager->getTableInput(table.getName());
     tableOutputs = layoutManager->getTableOutput(table.getName());
+    //The rest of tables checked are verified on the same rows
+    vector<TruthTable *> tablesChecked = layoutManager->getTablesSelected();
+    otherTables.clear();
+    for (unsigned int t = 0; t < tablesChecked.size(); t++)
+    {
+        if (tablesChecked[t]->getName() != table.getName())
+        {
+            otherTables.push_back(*tablesChecked[t]);
+        }
+    }
     list<Rule> ruleList = layoutManager->getListRuleEnabled();
     list<ForbiddenPattern> patternList = layoutManager->getListFPEnabled();
     //Get te initial layout
     layout = layoutManager->getLayout()->getMatrix();
     initialGrid = layoutManager->getLayout()->getGrid();
     
-    //Rotate rules
+    //Rotate rules, every rotation gets the rate of its rule
+    RuleRotation rotation(&rules, &patterns);
+    int ruleNumber = 0;
+    int unrotated = 0;
     for (list<Rule>::iterator i = ruleList.begin(); i != ruleList.end(); i++)
     {
-        addRule((*i));
+        if (!rotation.addRule((*i)))
+        {
+            unrotated++;
+        }
+        double rate = 1;
+        if (ruleNumber < (int)options.rates.size())
+        {
+            rate = options.rates[ruleNumber];
+        }
+        ruleRates.resize(rules.size(), rate);
+        ruleNumber++;
     }
     
     
     //Rotate patterns
     for (list<ForbiddenPattern>::iterator i = patternList.begin(); i != patternList.end(); i++)
     {
-        addPattern((*i));
+        if (!rotation.addPattern((*i)))
+        {
+            unrotated++;
+        }
     }
+    
+    //The sub-circuit instances are simulated by their truth tables
+    SubCircuitSummary summary(layout.size(), layout[0].size());
+    vector<subCircuit> instances = layoutManager->getSubCircuits();
+    for (unsigned int i = 0; i < instances.size(); i++)
+    {
+        TruthTable *instanceTable = tableManager->getTable(instances[i].table);
+        if (instanceTable != NULL)
+        {
+            summary.addInstance(instances[i].inputs, instances[i].outputs, instanceTable->getTable());
+        }
+    }
+    list<Rule> summaryRules = summary.getRules();
+    rules.insert(rules.end(), summaryRules.begin(), summaryRules.end());
+    ruleRates.resize(rules.size(), 1);
+    instanceCells = summary.getFrozen();
+    instancePins = summary.getPins();
+    subCircuits = summary.getInstances();
+    //The selected table first, then the rest in the order checked
+    verifier.setSpace(layout, tableInputs, instancePins);
+    verifier.addTable(tableInputs, tableOutputs, &table);
+    for (unsigned int t = 0; t < otherTables.size(); t++)
+    {
+        wxString name = otherTables[t].getName();
+        verifier.addTable(layoutManager->getTableInput(name), layoutManager->getTableOutput(name), &otherTables[t]);
+    }
+    //The rules and patterns that can not match in any row are left out
+    StaticPruning pruning(&rules, &patterns);
+    pruning.prune(Grid(verifier.getRowLayout(0)), tableInputs, ruleRates);
 
     //Initialize simulation results data structures
     row = 0;
@@ -86,134 +184,261 @@ void SimulationManager::prepareSimulation()
     forbiddenLayouts.resize((int)pow(2, (double)tableInputs.size()));
     cycles.resize((int)pow(2, (double)tableInputs.size()));
     outOfBoundsLayouts.resize((int)pow(2, (double)tableInputs.size()));
+    solvedRows.assign((int)pow(2, (double)tableInputs.size()), false);
+    //The rows whose outputs are all don't-cares are verified by any space
+    for (unsigned int r = 0; r < solvedRows.size(); r++)
+    {
+        solvedRows[r] = !verifier.isRelevant(r);
+    }
+    stableSpaces.assign((int)pow(2, (double)tableInputs.size()), 0);
+    rowTiles.assign((int)pow(2, (double)tableInputs.size()), 0);
+    sampleCounts unsampled;
+    unsampled.trajectories = 0;
+    unsampled.unfinished = 0;
+    samples.assign((int)pow(2, (double)tableInputs.size()), unsampled);
+    simulatedRows.assign((int)pow(2, (double)tableInputs.size()), false);
+    failedRows.assign((int)pow(2, (double)tableInputs.size()), false);
+    reachedStates.assign((int)pow(2, (double)tableInputs.size()), vector<unsigned long>());
+    frozenCells.assign((int)pow(2, (double)tableInputs.size()), vector<bool>());
+    delete tiles;
+    tiles = NULL;
+    delete symbolic;
+    symbolic = NULL;
+    //Rules and patterns may have changed since the last simulation
+    cache.clear();
+    frozen.clear();
     //Initializes the simulation view and starts
     //When a simulation finishes those two objects are deleted
     view = new SimulationView(controller->getNanoFrame(), wxID_ANY);
     simulation = new Simulation(view, this, layout, &rules, &patterns);
+    simulation->setCache(&cache);
+    simulation->setSemantics(options.semantics);
     view->setSimulation(simulation);
+    int skipped = 0;
+    for (unsigned int r = 0; r < solvedRows.size(); r++)
+    {
+        if (solvedRows[r])
+        {
+            skipped++;
+        }
+    }
+    if (skipped > 0)
+    {
+        view->setInfo(wxString::Format(_("%d rows only have don't-care outputs, they are not simulated"), skipped));
+    }
+    if (unrotated > 0)
+    {
+        view->setInfo(wxString::Format(_("%d rules or forbidden patterns miss some rotations, they move a site out of their grid"), unrotated));
+    }
+    if (pruning.getRulesPruned() > 0 || pruning.getPatternsPruned() > 0 || pruning.getPatternsSubsumed() > 0)
+    {
+        view->setInfo(wxString::Format(_("Left out %d rules and %d forbidden patterns that can never match the space, and %d forbidden patterns subsumed by others"), pruning.getRulesPruned(), pruning.getPatternsPruned(), pruning.getPatternsSubsumed()));
+    }
+    //The result cache directory keeps the checkpoints too
+    if ((options.resultCache || options.checkpoint) && !cacheOpen)
+    {
+        cacheOpen = resultCache.open();
+    }
+    if (cacheOpen)
+    {
+        vector<coordinate> outputs = verifier.getOutputs();
+        resultCache.setContext(&rules, &patterns, options.semantics, tableInputs, outputs);
+    }
+    delete resumed;
+    resumed = NULL;
+    resumeRow = -1;
+    checkpointFile = wxEmptyString;
+    if (options.checkpoint && !options.sampling && cacheOpen)
+    {
+        resumeCheckpoint();
+    }
+    if (options.incremental && !options.sampling)
+    {
+        reusePrevious();
+    }
+    if (options.resultCache && !options.sampling && cacheOpen)
+    {
+        loadCachedRows();
+    }
+    //The results of the last simulation are not valid for the next one
+    last.simulated.clear();
+    last.frozen.clear();
+    last.reached.clear();
+    last.processed.clear();
+    last.stable.clear();
+    last.cycles.clear();
+    last.forbidden.clear();
+    last.outOfBounds.clear();
+    estimateSearch();
+    planSimulation(ruleList.size());
     startSimulation();
 }
 
 
-//TODO: mirar qu fer si la rotaci falla
-//! Adds a rule and its rotations to the rule list.
+//! Estimates the size of the simulation of the rows.
 /*!
-   \param newRule rule to add.
+   A few random probes go down the search of every row, so the user can
+   choose to sample the rows before starting a long simulation. When the
+   table has too many rows only ESTIMATE_ROWS of them, evenly spread, are
+   probed and the total is extrapolated. The estimate only runs when the
+   planner has a setting to choose, and it takes at most ESTIMATE_BUDGET
+   seconds, shared by the rows probed.
 */
-void SimulationManager::addRule(Rule newRule)
+void SimulationManager::estimateSearch()
 {
-    if (!findRule(newRule))
+    probedSpaces = -1;
+    probedDepth = -1;
+    //The probes fire one placement every step
+    if (options.semantics != STEP_INTERLEAVED || options.sampling)
     {
-        //printRule(newRule);
-        //cout << endl;
-        rules.push_back(newRule);
-        
-        //Rotate only if square and even size
-        if ((newRule.getWidth() == newRule.getHeight()) && (newRule.getWidth() %2 != 0))
+        return;
+    }
+    if (options.matcher != PLAN_AUTO && options.strategy != PLAN_AUTO && options.threads != PLAN_AUTO && options.memory != PLAN_AUTO)
+    {
+        return;
+    }
+    MonteCarloSimulation engine(&rules, &patterns);
+    engine.setFrozen(instanceCells);
+    int rows = (int)pow(2, (double)tableInputs.size());
+    int selected = min(rows, ESTIMATE_ROWS);
+    int probed = 0;
+    double spaces = 0;
+    double depth = 0;
+    double seconds = 0;
+    int truncated = 0;
+    wxStopWatch budget;
+    for (int k = 0; k < selected; k++)
+    {
+        double left = ESTIMATE_BUDGET - budget.Time() / 1000.0;
+        if (left <= 0)
         {
-
-            Grid tempInitial = newRule.getInitialGrid();
-            Grid tempFinal = newRule.getFinalGrid();
-    
-            for (int i = 0; i < 5; i++)
-            {
-                Grid initialRotated(tempInitial.getWidth(), tempInitial.getHeight());
-                Grid finalRotated(tempInitial.getWidth(), tempInitial.getHeight());
-                Rule ruleRotated(newRule.getWidth(), newRule.getHeight());
-                if (rotateGrid(tempInitial, &initialRotated) && rotateGrid(tempFinal, &finalRotated))
-                {
-                    ruleRotated.setInitialGrid(initialRotated);
-                    ruleRotated.setFinalGrid(finalRotated);
-                    if (!findRule(ruleRotated))
-                    {
-                        //printRule(ruleRotated);
-                        //cout << endl;
-                        rules.push_back(ruleRotated);
-                    }
-                }
-                else
-                {   
-                    cout << "Error in rotation " << i << endl;
-                    break;
-                }
-                tempInitial = ruleRotated.getInitialGrid();
-                tempFinal = ruleRotated.getFinalGrid();
-            }
+            break;
         }
+        int r = (int)((double)k * rows / selected);
+        searchEstimate estimate = engine.estimate(Grid(verifier.getRowLayout(r)), ESTIMATE_PROBES, r + 1, left / (selected - k));
+        spaces += estimate.spaces;
+        depth += estimate.depth;
+        seconds += estimate.seconds;
+        truncated += estimate.truncated;
+        probed++;
+        view->setInfo(wxString::Format(_("Row %d: %s, depth %.1f (at most %d), "), r + 1, getSpaces(estimate.spaces).c_str(), estimate.depth, estimate.maxDepth) + getDuration(estimate.seconds));
+    }
+    if (probed == 0)
+    {
+        return;
+    }
+    probedSpaces = spaces / probed;
+    probedDepth = depth / probed;
+    spaces = min(spaces * rows / probed, ESTIMATE_SPACES);
+    seconds *= (double)rows / probed;
+    view->setInfo(wxString::Format(_("Estimated simulation: %s in %d rows, "), getSpaces(spaces).c_str(), rows) + getDuration(seconds));
+    if (probed < selected)
+    {
+        view->setInfo(wxString::Format(_("Only %d rows were probed in %d seconds"), probed, ESTIMATE_BUDGET));
     }
+    if (truncated > 0)
+    {
+        view->setInfo(wxString::Format(_("%d probes were cut at depth %d or by the time limit, the search may be larger"), truncated, ESTIMATE_DEPTH));
+    }
+    if (seconds > ESTIMATE_SECONDS && !options.sampling)
+    {
+        view->setInfo(_("The simulation may take long, sampling trajectories would be faster"));
+    }
+    view->setBlankLine();
 }
 
 
-//! Adds a pattern and its rotations to the pattern list.
+//! Chooses the engine settings of the simulation.
 /*!
-   \param newPattern pattern to add.
+   The settings the user left to the planner are chosen from the cost
+   model, and the plan and its predicted cost are shown.
+   \param enabledRules the number of rules enabled, without rotations.
 */
-void SimulationManager::addPattern(ForbiddenPattern newPattern)
+void SimulationManager::planSimulation(int enabledRules)
 {
-    if (!findPattern(newPattern))
+    SimulationPlanner planner(&rules, &patterns);
+    if (probedSpaces >= 0)
     {
-        patterns.push_back(newPattern);
-        //Rotate only if square and even size
-        if ((newPattern.getWidth() == newPattern.getHeight()) && (newPattern.getWidth() %2 != 0))
-        {
-            Grid temp = newPattern.getGrid();
+        planner.setEstimate(probedSpaces, probedDepth);
+    }
+    int cpus = wxThread::GetCPUCount();
+    plan = planner.plan(Grid(verifier.getRowLayout(0)), tableInputs.size(), isPresolvable(), options, max(cpus, 1));
+    simulation->setSiteMatching(plan.matcher == MATCHER_SITES);
+    cache.setLimit(plan.cacheSpaces);
     
-            for (int i = 0; i < 5; i++)
-            {
-                Grid rotatedGrid(temp.getWidth(), temp.getHeight());
-                ForbiddenPattern patternRotated(newPattern.getWidth(), newPattern.getHeight());
-                if (rotateGrid(temp, &rotatedGrid))
-                {
-                    patternRotated.setGrid(rotatedGrid);
-                    if (!findPattern(patternRotated))
-                    {
-                        patterns.push_back(patternRotated);
-                    }
-                }
-                else
-                {
-                    break;
-                }
-                temp= patternRotated.getGrid();
-            }
-        }
+    view->setInfo(wxString::Format(_("Plan for %d rules (%d with rotations), %d forbidden patterns, %d sites (%d with molecules) in %d components"), enabledRules, (int)rules.size(), (int)patterns.size(), planner.getSites(), planner.getEnabled(), planner.getComponents()));
+    if (!planner.isConfluent())
+    {
+        view->setInfo(_("Some rules can disable others, the search may branch"));
     }
+    wxString matcher = plan.matcher == MATCHER_SITES ? _("from the sites") : _("by scanning");
+    wxString memory = plan.memory == MEMORY_CACHED ? wxString::Format(_("caching up to %d spaces"), plan.cacheSpaces) : wxString(_("caching no spaces"));
+    if (options.sampling)
+    {
+        view->setInfo(wxString::Format(_("Plan: match %s, sample in %d threads, "), matcher.c_str(), plan.threads) + memory);
+    }
+    else
+    {
+        wxString strategies[3] = {_("simulate every row"), _("solve rows bit-sliced first"), _("solve rows symbolically first")};
+        view->setInfo(wxString::Format(_("Plan: match %s, %s, "), matcher.c_str(), strategies[plan.strategy].c_str()) + memory);
+    }
+    view->setInfo(wxString::Format(_("Predicted cost: %.3g cell checks, about %.3g spaces every row, "), plan.cost, plan.spaces) + getDuration(plan.cost / PLAN_CHECKS_SECOND));
+    view->setBlankLine();
 }
 
 
-//! Finds a rule in the collection.
+//! Tells if the rows can be solved by other engines before simulating them.
 /*!
-   \param rule the rule to be found.
-   \return True if the rule was found on the collection.
+   The other engines apply the anchored rules anywhere, fire one placement
+   every step and verify the selected table only, skipping its don't-care
+   outputs.
+   \return False if the rows can only be simulated exhaustively.
 */
-bool SimulationManager::findRule(Rule rule)
+bool SimulationManager::isPresolvable()
 {
-    for (list<Rule>::iterator i = rules.begin(); i != rules.end(); i++)
+    return subCircuits == 0 && options.semantics == STEP_INTERLEAVED && otherTables.empty();
+}
+
+
+//! Formats a duration.
+/*!
+   \param seconds the duration.
+   \return The duration in the largest unit that fits it.
+*/
+wxString SimulationManager::getDuration(double seconds)
+{
+    if (seconds < 60)
     {
-        if (rule == (*i))
-        {
-            return true;
-        }
+        return wxString::Format(_("%.1f seconds"), seconds);
     }
-    return false;
+    if (seconds < 3600)
+    {
+        return wxString::Format(_("%.1f minutes"), seconds / 60);
+    }
+    if (seconds < 86400)
+    {
+        return wxString::Format(_("%.1f hours"), seconds / 3600);
+    }
+    if (seconds < 31536000)
+    {
+        return wxString::Format(_("%.1f days"), seconds / 86400);
+    }
+    return wxString::Format(_("%.3g years"), seconds / 31536000);
 }
 
 
-//! Finds a pattern in the collection.
+//! Formats the estimated spaces of a search.
 /*!
-   \param pattern the pattern to be found.
-   \return True if the pattern was found on the collection.
+   \param spaces the estimate, clamped to ESTIMATE_SPACES.
+   \return The estimate to show.
 */
-bool SimulationManager::findPattern(ForbiddenPattern pattern)
+wxString SimulationManager::getSpaces(double spaces)
 {
-    for (list<ForbiddenPattern>::iterator i = patterns.begin(); i != patterns.end(); i++)
+    if (spaces >= ESTIMATE_SPACES)
     {
-        if ((*i) == pattern)
-        {
-            return true;
-        }
+        return wxString::Format(_("more than %.3g spaces"), ESTIMATE_SPACES);
     }
-    return false;
+    return wxString::Format(_("about %.3g spaces"), spaces);
 }
 
 
@@ -275,162 +500,843 @@ void SimulationManager::printPattern(Grid pattern)
 }
 
 
-//! Rotates a grid 60 degrees.
+//TODO: recorda, ha de ser tot vlid:
+//layout no null
+//taula de veritat no nula
+//inputs i outputs de la taula de veritat assignats
+//aix ho ha de controlar el check simulation i el 
+//controlador principal habilitant i deshabilitant el bot
+//que controla aquesta funci
+//A MUST: abans de cridar aquesta funci s'ha de cridar
+//prepareSimulation()
+//! Starts a simulation.
 /*!
-   \param originalGrid the grid to be rotated.
-   \param destGrid grid where the original rotated have to be copied.
-   \return True if the grid is rotated correctly.
+   This MUST NOT be called if all the simulation information
+   is prepared and valid.
 */
-bool SimulationManager::rotateGrid(Grid originalGrid, Grid *destGrid)
+void SimulationManager::startSimulation()
 {
-    int c;
-    int center;
-    int i, j;
-    int ii, jj;
-    int size = originalGrid.getWidth();
+    simulateRow();
+}
 
-    
-    center = size/2;
 
-    for (i = 0; i < size; i++) 
+//! Asks for new rows to simulate.
+/*!
+   \return True iif there are more rows to simulate. False
+   if all rows have been already simulated.
+*/
+bool SimulationManager::nextRow()
+{
+    //Rows already solved without the normal simulation are skipped
+    while (row < (int)solvedRows.size() && solvedRows[row])
+    {
+        row++;
+    }
+    return (row < pow(2, (double)tableInputs.size()));
+}
+
+
+//! Simulates the current row.
+void SimulationManager::simulateRow()
+{
+    if (nextRow())
     {
-        for (j = 0; j < size; j++) 
+        matrix newLayout = verifier.getRowLayout(row);
+        simulation->resetSimulation(view, this, newLayout, &rules, &patterns);
+        view->setBlankLine();
+        view->setInfo(wxString::Format(_("Simulating row %d"), row));
+        
+        int sliced;
+        vector<bool> rowFrozen = getRowFrozen(newLayout, &sliced);
+        if (rowFrozen != frozen)
         {
-            (*destGrid)(i, j) = nDONTCARE;
+            //The spaces simulated with other cells left out have other results
+            cache.clear();
+            frozen = rowFrozen;
+        }
+        simulation->setFrozen(frozen);
+        if (resumed != NULL && row >= resumeRow)
+        {
+            if (row == resumeRow && simulation->loadState(*resumed))
+            {
+                view->setInfo(_("Resuming the row from the checkpoint"));
+            }
+            delete resumed;
+            resumed = NULL;
         }
+        if (sliced > 0)
+        {
+            int cells = newLayout.size() * newLayout[0].size();
+            view->setInfo(wxString::Format(_("Simulating %d of %d cells, the rest can not affect the outputs"), cells - sliced, cells));
+        }
+        view->setBlankLine();
     }
+    row++;
+}
 
-    for (i = 0; i < size; i++) 
+
+//! Returns the cells left out of the simulation of a row.
+/*!
+   Only the cells that can affect the outputs are simulated, and the cells
+   inside the sub-circuit instances never are.
+   \param rowLayout the initial space of the row.
+   \param sliced returns the number of cells left out by the slicing.
+   \return The cells left out, indexed by x * height + y, or empty.
+*/
+vector<bool> SimulationManager::getRowFrozen(matrix &rowLayout, int *sliced)
+{
+    vector<bool> rowFrozen = instanceCells;
+    *sliced = 0;
+    //The parallel steps depend on every placement applicable
+    if (instanceCells.empty() && options.semantics == STEP_INTERLEAVED)
     {
-        for (j = 0; j < size; j++) 
+        if (tiles == NULL)
         {
-            c = originalGrid(i, j);
+            tiles = new TileSimulation(&rules, &patterns);
+        }
+        *sliced = tiles->slice(Grid(rowLayout), verifier.getOutputs(), rowFrozen);
+    }
+    return rowFrozen;
+}
 
-            rotateHexCoordinate(center, i, j, &ii, &jj);
-            
-            if (0 <= ii && ii < size && 0 <= jj && jj < size) 
-            {
-                (*destGrid)(ii, jj) = c;
-            }
-            else if (c == nENABLED || c == nDISABLED)
-            {
-                cout << "Warning: cannot map a transformed site" << endl;
-                return false;
-            }
+
+//! Reuses the rows of the last simulation not affected by the edits.
+/*!
+   A row is reused when no rule or pattern added, removed or placed over
+   a cell edited since the last simulation matches any space the row
+   reached. Its results are the ones of the last simulation with the
+   edited cells replaced, and the normal simulation skips it.
+*/
+void SimulationManager::reusePrevious()
+{
+    if (last.simulated.empty() || last.semantics != options.semantics)
+    {
+        return;
+    }
+    IncrementalSimulation engine(&last, &rules, &patterns);
+    int reused = 0;
+    for (unsigned int r = 0; r < solvedRows.size(); r++)
+    {
+        if (solvedRows[r])
+        {
+            continue;
         }
+        matrix rowLayout = verifier.getRowLayout(r);
+        int sliced;
+        vector<bool> rowFrozen = getRowFrozen(rowLayout, &sliced);
+        if (!engine.reuse(r, Grid(rowLayout), rowFrozen))
+        {
+            continue;
+        }
+        processedLayouts[r] = engine.getProcessedLayouts();
+        finalLayouts[r] = engine.getStableLayouts();
+        forbiddenLayouts[r] = engine.getForbiddenLayouts();
+        cycles[r] = engine.getCycles();
+        outOfBoundsLayouts[r] = engine.getOutOfBounds();
+        solvedRows[r] = true;
+        simulatedRows[r] = true;
+        frozenCells[r] = rowFrozen;
+        reused++;
+    }
+    if (reused > 0)
+    {
+        view->setInfo(wxString::Format(_("%d rows reused from the last simulation (%d rules and %d patterns changed)"), reused, engine.getChangedRules(), engine.getChangedPatterns()));
     }
-    return true;
 }
 
 
-//! Rotates a coordinate of a grid 60 degrees.
+//! Loads the rows stored in the result cache.
 /*!
-   \param center the central coordinate of the grid.
-   \param i the x original coordinate.
-   \param j the y original coordinate.
-   \param ii the x destination coordinate.
-   \param jj the y destination coordinate.
+   The rows found are skipped by the normal simulation. Their events only
+   have their last space, and the cycles the spaces of the cycle.
 */
-void SimulationManager::rotateHexCoordinate(int center, int i, int j, int *ii, int *jj)
+void SimulationManager::loadCachedRows()
 {
-    int x, y;
-    int xx, yy;
+    int loaded = 0;
+    int verified = 0;
+    for (unsigned int r = 0; r < solvedRows.size(); r++)
+    {
+        if (solvedRows[r])
+        {
+            continue;
+        }
+        matrix rowLayout = verifier.getRowLayout(r);
+        int sliced;
+        vector<bool> rowFrozen = getRowFrozen(rowLayout, &sliced);
+        cachedRow cached;
+        if (!resultCache.find(Grid(rowLayout), rowFrozen, getExpected(r), &cached))
+        {
+            continue;
+        }
+        processedLayouts[r].clear();
+        finalLayouts[r] = cached.stable;
+        forbiddenLayouts[r] = cached.forbidden;
+        cycles[r] = cached.cycles;
+        outOfBoundsLayouts[r] = cached.outOfBounds;
+        solvedRows[r] = true;
+        loaded++;
+        if (cached.verified)
+        {
+            verified++;
+        }
+    }
+    if (loaded > 0)
+    {
+        view->setInfo(wxString::Format(_("%d rows loaded from the result cache, %d of them verify the tables"), loaded, verified));
+    }
+}
 
-    x = i - center;
-    y = j - center;
 
-    xx = -y;
-    yy = x + y;
+//! Saves a checkpoint of the simulation if it is time to.
+/*!
+   This is called after every simulation step.
+*/
+void SimulationManager::checkpoint()
+{
+    if (checkpointFile.IsEmpty() || checkpointWatch.Time() < CHECKPOINT_INTERVAL)
+    {
+        return;
+    }
+    saveCheckpoint();
+    checkpointWatch.Start();
+}
+
 
-    *ii = xx + center;
-    *jj = yy + center;
+//! Saves the rows simulated and the state of the current row.
+/*!
+   The rows solved without events, by the abstract or the symbolic
+   simulations, are not saved; they are solved again on resuming.
+*/
+void SimulationManager::saveCheckpoint()
+{
+    Checkpoint file;
+    file.writeHash(checkpointCheck);
+    file.writeInt(solvedRows.size());
+    for (unsigned int r = 0; r < solvedRows.size(); r++)
+    {
+        //2 if simulated, 1 if only its events are known
+        int done = simulatedRows[r] ? 2 : hasEvents(r) ? 1 : 0;
+        file.writeInt(done);
+        if (done > 0)
+        {
+            file.writeGrids(processedLayouts[r]);
+            file.writeSteps(finalLayouts[r]);
+            file.writeSteps(forbiddenLayouts[r]);
+            file.writeSteps(cycles[r]);
+            file.writeSteps(outOfBoundsLayouts[r]);
+            file.writeHashes(reachedStates[r]);
+            file.writeBools(frozenCells[r]);
+        }
+    }
+    int current = (row > 0 && !simulation->isFinished()) ? row - 1 : -1;
+    file.writeInt(current);
+    if (current >= 0)
+    {
+        simulation->saveState(file);
+    }
+    if (!file.save(checkpointFile))
+    {
+        view->setInfo(wxString::Format(_("The checkpoint could not be saved to %s"), checkpointFile.c_str()));
+    }
 }
 
 
-//TODO: recorda, ha de ser tot vlid:
-//layout no null
-//taula de veritat no nula
-//inputs i outputs de la taula de veritat assignats
-//aix ho ha de controlar el check simulation i el 
-//controlador principal habilitant i deshabilitant el bot
-//que controla aquesta funci
-//A MUST: abans de cridar aquesta funci s'ha de cridar
-//prepareSimulation()
-//! Starts a simulation.
+//! Resumes the simulation from its last checkpoint.
 /*!
-   This MUST NOT be called if all the simulation information
-   is prepared and valid.
+   The checkpoint is named after the rules, patterns, space and cells left
+   out, so only the same simulation is resumed. The rows saved are skipped
+   and the row in progress goes on from its saved state when it is
+   simulated.
 */
-void SimulationManager::startSimulation()
+void SimulationManager::resumeCheckpoint()
 {
-    simulateRow();
+    Grid space(layout);
+    string key = resultCache.getKey(space, instanceCells, wxEmptyString);
+    checkpointFile = resultCache.getFileName(key, wxT(".ckp"));
+    checkpointCheck = resultCache.getCheck(key);
+    checkpointWatch.Start();
+    if (!wxFile::Exists(checkpointFile))
+    {
+        return;
+    }
+    Checkpoint *file = new Checkpoint();
+    uint64_t check;
+    int rows;
+    if (!file->load(checkpointFile) || !file->readHash(&check) || check != checkpointCheck || !file->readInt(&rows) || rows != (int)solvedRows.size())
+    {
+        delete file;
+        return;
+    }
+    vector<Rule *> ruleSet;
+    for (list<Rule>::iterator i = rules.begin(); i != rules.end(); i++)
+    {
+        ruleSet.push_back(&(*i));
+    }
+    int restored = 0;
+    bool valid = true;
+    for (int r = 0; r < rows && valid; r++)
+    {
+        int done;
+        valid = file->readInt(&done);
+        if (!valid || done == 0)
+        {
+            continue;
+        }
+        list<Grid> processed;
+        list<simulationStep> stable, forbidden, cycleSteps, outOfBounds;
+        vector<unsigned long> reached;
+        vector<bool> rowFrozen;
+        valid = file->readGrids(&processed) && file->readSteps(&stable, ruleSet) && file->readSteps(&forbidden, ruleSet) && file->readSteps(&cycleSteps, ruleSet) && file->readSteps(&outOfBounds, ruleSet) && file->readHashes(&reached) && file->readBools(&rowFrozen);
+        if (valid)
+        {
+            processedLayouts[r].swap(processed);
+            finalLayouts[r].swap(stable);
+            forbiddenLayouts[r].swap(forbidden);
+            cycles[r].swap(cycleSteps);
+            outOfBoundsLayouts[r].swap(outOfBounds);
+            reachedStates[r].swap(reached);
+            frozenCells[r].swap(rowFrozen);
+            simulatedRows[r] = done == 2;
+            solvedRows[r] = true;
+            restored++;
+        }
+    }
+    int current;
+    if (valid && file->readInt(&current) && current >= 0 && current < rows && !solvedRows[current])
+    {
+        resumed = file;
+        resumeRow = current;
+        view->setInfo(wxString::Format(_("Resuming from the checkpoint: %d rows restored, row %d goes on where it stopped"), restored, current));
+    }
+    else
+    {
+        delete file;
+        view->setInfo(wxString::Format(_("Resuming from the checkpoint: %d rows restored"), restored));
+    }
 }
 
 
-//! Asks for new rows to simulate.
+//! Returns the outputs a row must have.
 /*!
-   \return True iif there are more rows to simulate. False
-   if all rows have been already simulated.
+   \param row the row.
+   \return The outputs of the row in every table checked, 1, 0 or x for
+   the don't-cares, the tables separated by bars.
 */
-bool SimulationManager::nextRow()
+wxString SimulationManager::getExpected(int row)
 {
-    return (row < pow(2, (double)tableInputs.size()));
+    wxString result;
+    for (int t = 0; t < verifier.getTables(); t++)
+    {
+        vector<bool> outputs = verifier.getOutput(row, t);
+        vector<bool> care = verifier.getCare(row, t);
+        if (t > 0)
+        {
+            result += wxT("|");
+        }
+        for (unsigned int o = 0; o < outputs.size(); o++)
+        {
+            result += !care[o] ? wxT("x") : outputs[o] ? wxT("1") : wxT("0");
+        }
+    }
+    return result;
 }
 
 
-//! Simulates the current row.
-void SimulationManager::simulateRow()
+//! Solves the rows left without the normal simulation when possible.
+/*!
+   Unless the plan simulates every row, the rows where the rules behave
+   deterministically are simulated by the symbolic or the bit-sliced
+   simulation, as planned, and the abstract and the tile simulations try
+   to verify the rest. If chosen, the backward search looks for failures
+   of the rows still left. The rows solved here are skipped later; the
+   others are left for the normal simulation. The spaces with sub-circuit
+   instances, simulated with parallel steps or verifying several tables
+   are all left for the normal simulation. With several workers, the rows
+   left are simulated in worker processes. When sampling, all the rows are
+   sampled instead.
+*/
+void SimulationManager::presolve()
 {
-    if (nextRow())
+    if (subCircuits > 0)
     {
-        //TODO aquest layout no pq es pot canviar mentre se simula
-        matrix newLayout = layout;
-        vector<int> result(tableInputs.size(), nDISABLED);
-        int j = tableInputs.size() -1 ;
-        int l = row;
-        while (l > 0)
+        view->setInfo(wxString::Format(_("Simulating %d sub-circuit instances by their truth tables"), subCircuits));
+        view->setBlankLine();
+    }
+    if (options.sampling)
+    {
+        presolveSampling();
+        return;
+    }
+    if (!otherTables.empty())
+    {
+        view->setInfo(wxString::Format(_("Verifying %d truth tables with one simulation per row"), (int)otherTables.size() + 1));
+        view->setBlankLine();
+    }
+    if (isPresolvable())
+    {
+        if (plan.strategy != STRATEGY_FORWARD)
         {
-            if ((l % 2) == 1) //1 = True
+            if (plan.strategy != STRATEGY_SYMBOLIC || !presolveSymbolic())
             {
-                result[j] = nENABLED;
-            }  
-            else
+                presolveBitSliced();
+            }
+            presolveTernary();
+            presolveTiles();
+        }
+        if (options.backward)
+        {
+            presolveBackward();
+        }
+    }
+    if (options.workers > 1)
+    {
+        shardRows();
+    }
+}
+
+
+//! Simulates the rows left with the bit-sliced simulation.
+/*!
+   The rows not started yet are simulated in groups of BITSLICE_LANES.
+*/
+void SimulationManager::presolveBitSliced()
+{
+    BitSimulation engine(&rules, &patterns);
+    if (!engine.isSupported())
+    {
+        return;
+    }
+    int rows = (int)pow(2, (double)tableInputs.size());
+    int solved = 0;
+    for (int first = row; first < rows; first += BITSLICE_LANES)
+    {
+        vector<Grid> spaces;
+        for (int r = first; r < rows && r < first + BITSLICE_LANES; r++)
+        {
+            spaces.push_back(Grid(verifier.getRowLayout(r)));
+        }
+        uint64_t lanes = engine.simulate(spaces);
+        for (unsigned int k = 0; k < spaces.size(); k++)
+        {
+            if (!solvedRows[first + k] && (lanes & ((uint64_t)1 << k)))
             {
-                result[j] = nDISABLED;
+                processedLayouts[first + k].clear();
+                finalLayouts[first + k] = engine.getStableLayouts(k);
+                forbiddenLayouts[first + k] = engine.getForbiddenLayouts(k);
+                cycles[first + k] = engine.getCycles(k);
+                outOfBoundsLayouts[first + k] = engine.getOutOfBounds(k);
+                solvedRows[first + k] = true;
+                solved++;
             }
-            l /= 2;  
-            j--;
+        }
+    }
+    if (solved > 0)
+    {
+        view->setInfo(wxString::Format(_("%d rows simulated with the bit-sliced simulation"), solved));
+    }
+}
+
+
+//! Verifies the rows left with the abstract simulation.
+/*!
+   The rows verified this way have no simulation results to show.
+*/
+void SimulationManager::presolveTernary()
+{
+    TernarySimulation engine(&rules, &patterns);
+    int rows = (int)pow(2, (double)tableInputs.size());
+    int verified = 0;
+    for (int r = row; r < rows; r++)
+    {
+        if (!solvedRows[r] && engine.verifies(Grid(verifier.getRowLayout(r)), tableOutputs, table.getOutput(r), table.getCare(r)))
+        {
+            processedLayouts[r].clear();
+            finalLayouts[r].clear();
+            forbiddenLayouts[r].clear();
+            cycles[r].clear();
+            outOfBoundsLayouts[r].clear();
+            solvedRows[r] = true;
+            verified++;
+        }
     }
-    list<matrix> finalLayouts;
-    for (unsigned int k = 0; k < tableInputs.size(); k++)
+    if (verified > 0)
     {
-        newLayout[tableInputs[k].x][tableInputs[k].y] = result[k];
+        view->setInfo(wxString::Format(_("%d rows verified with the abstract simulation"), verified));
     }
-    for (unsigned int k = 0; k < tableOutputs.size(); k++)
+}
+
+
+//! Solves the rows left simulating their tiles.
+/*!
+   The tile results are shared by all the rows. The rows verified this way
+   have no simulation results to show, only their number of stable spaces.
+   The rows failing have the failure found as their only result.
+*/
+void SimulationManager::presolveTiles()
+{
+    if (tiles == NULL)
     {
-        newLayout[tableOutputs[k].x][tableOutputs[k].y] = nDISABLED;
+        tiles = new TileSimulation(&rules, &patterns);
     }
-    
-    //Here we transform all nDONTCARE positions to
-    //nDISABLED
-    for (unsigned int i = 0; i < newLayout.size(); i++)
+    TileSimulation &engine = *tiles;
+    int rows = (int)pow(2, (double)tableInputs.size());
+    int verified = 0;
+    int failed = 0;
+    for (int r = row; r < rows; r++)
+    {
+        if (solvedRows[r] || !engine.solve(Grid(verifier.getRowLayout(r)), tableOutputs, table.getOutput(r), table.getCare(r)))
+        {
+            continue;
+        }
+        processedLayouts[r].clear();
+        finalLayouts[r] = engine.getStableLayouts();
+        forbiddenLayouts[r] = engine.getForbiddenLayouts();
+        cycles[r].clear();
+        outOfBoundsLayouts[r] = engine.getOutOfBounds();
+        solvedRows[r] = true;
+        if (engine.getVerifies())
+        {
+            stableSpaces[r] = engine.getStableSpaces();
+            rowTiles[r] = engine.getTiles();
+            verified++;
+        }
+        else
+        {
+            failed++;
+        }
+    }
+    if (verified + failed > 0)
+    {
+        view->setInfo(wxString::Format(_("Tile simulation: %d rows verified, %d rows fail (%d tiles simulated, %d reused)"), verified, failed, engine.getSimulated(), engine.getReused()));
+    }
+}
+
+
+//! Searches failures of the rows left backward from the outputs.
+/*!
+   The rows where a failure is found only have that failure as results,
+   the normal simulation would report it too, so they do not verify the
+   table either way.
+*/
+void SimulationManager::presolveBackward()
+{
+    BackwardSearch engine(&rules, &patterns);
+    engine.setBidirectional(options.bidirectional);
+    int rows = (int)pow(2, (double)tableInputs.size());
+    int failed = 0;
+    int explored = 0;
+    for (int r = row; r < rows; r++)
     {
-        for (unsigned j = 0; j < newLayout[i].size(); j++)
+        if (solvedRows[r])
         {
-            if (newLayout[i][j] == nDONTCARE)
+            continue;
+        }
+        bool found = engine.findFailure(Grid(verifier.getRowLayout(r)), tableOutputs, table.getOutput(r), table.getCare(r));
+        explored += engine.getExplored();
+        if (found)
+        {
+            processedLayouts[r].clear();
+            finalLayouts[r] = engine.getStableLayouts();
+            forbiddenLayouts[r] = engine.getForbiddenLayouts();
+            cycles[r].clear();
+            outOfBoundsLayouts[r] = engine.getOutOfBounds();
+            solvedRows[r] = true;
+            failed++;
+        }
+    }
+    view->setInfo(wxString::Format(_("Backward search: %d rows fail (%d spaces searched)"), failed, explored));
+}
+
+
+//! Samples random trajectories of the rows left.
+/*!
+   The trajectories of every row are split among as many threads as
+   processors, each one with its own random stream, and their counts are
+   merged. The first trajectory reaching every outcome is kept as its
+   result, and the estimated probabilities are shown with the results.
+   All the rows are solved here, the exhaustive simulation is skipped.
+*/
+void SimulationManager::presolveSampling()
+{
+    int threads = plan.threads;
+    int trajectories = options.trajectories;
+    vector<MonteCarloSimulation *> engines;
+    for (int t = 0; t < threads; t++)
+    {
+        MonteCarloSimulation *engine = new MonteCarloSimulation(&rules, &patterns);
+        engine->setRates(ruleRates);
+        engine->setFrozen(instanceCells);
+        engines.push_back(engine);
+    }
+    int rows = (int)pow(2, (double)tableInputs.size());
+    view->setInfo(wxString::Format(_("Sampling %d trajectories of every row in %d threads"), trajectories, threads));
+    //The row being simulated is sampled too
+    int first = row;
+    if (row > 0 && !simulation->isFinished())
+    {
+        simulation->stopRow();
+        first = row - 1;
+    }
+    for (int r = first; r < rows; r++)
+    {
+        if (solvedRows[r])
+        {
+            continue;
+        }
+        Grid space(verifier.getRowLayout(r));
+        vector<SamplingThread *> running;
+        for (int t = 0; t < threads; t++)
+        {
+            //Every thread samples its share with its own stream
+            int share = trajectories / threads + (t < trajectories % threads ? 1 : 0);
+            unsigned long seed = (unsigned long)r * threads + t + 1;
+            SamplingThread *thread = new SamplingThread(engines[t], space, share, seed);
+            if (thread->Create() == wxTHREAD_NO_ERROR && thread->Run() == wxTHREAD_NO_ERROR)
+            {
+                running.push_back(thread);
+            }
+            else
             {
-                newLayout[i][j] = nDISABLED;
+                delete thread;
+                engines[t]->sample(space, share, seed);
             }
         }
+        for (unsigned int t = 0; t < running.size(); t++)
+        {
+            running[t]->Wait();
+            delete running[t];
+        }
+        for (int t = 1; t < threads; t++)
+        {
+            engines[0]->merge(*engines[t]);
+        }
+        samples[r] = engines[0]->getCounts();
+        processedLayouts[r].clear();
+        finalLayouts[r] = engines[0]->getStableLayouts();
+        forbiddenLayouts[r] = engines[0]->getForbiddenLayouts();
+        cycles[r].clear();
+        outOfBoundsLayouts[r] = engines[0]->getOutOfBounds();
+        solvedRows[r] = true;
+        
+        int stable = 0;
+        int forbidden = 0;
+        int outOfBounds = 0;
+        for (unsigned int i = 0; i < samples[r].stable.size(); i++)
+        {
+            stable += samples[r].stable[i];
+        }
+        for (unsigned int i = 0; i < samples[r].forbidden.size(); i++)
+        {
+            forbidden += samples[r].forbidden[i];
+        }
+        for (unsigned int i = 0; i < samples[r].outOfBounds.size(); i++)
+        {
+            outOfBounds += samples[r].outOfBounds[i];
+        }
+        view->setInfo(wxString::Format(_("Row %d: %d stable spaces found"), r + 1, (int)samples[r].stable.size()));
+        view->setInfo(_("Stable: ") + getEstimate(stable, r));
+        view->setInfo(_("Forbidden patterns: ") + getEstimate(forbidden, r));
+        view->setInfo(_("Out of bounds: ") + getEstimate(outOfBounds, r));
+        if (samples[r].unfinished > 0)
+        {
+            view->setInfo(wxString::Format(_("Not finished after %d steps: "), MONTECARLO_STEPS) + getEstimate(samples[r].unfinished, r));
+        }
+    }
+    for (int t = 0; t < threads; t++)
+    {
+        delete engines[t];
     }
-    
-    
-    simulation->resetSimulation(view, this, newLayout, &rules, &patterns);
-    view->setBlankLine();
-    view->setInfo(wxString::Format(_("Simulating row %d"), row));
     view->setBlankLine();
+}
+
+
+//! Formats the estimated probability of an outcome of a sampled row.
+/*!
+   \param hits trajectories ending on the outcome.
+   \param row the row.
+   \return The estimate and its confidence interval, as percentages.
+*/
+wxString SimulationManager::getEstimate(int hits, int row)
+{
+    int trials = samples[row].trajectories;
+    double low;
+    double high;
+    MonteCarloSimulation::interval(hits, trials, &low, &high);
+    double estimate = trials > 0 ? (double)hits / trials : 0;
+    return wxString::Format(_("%.1f%% (%.1f%% - %.1f%%)"), 100 * estimate, 100 * low, 100 * high);
+}
+
+
+//! Formats the estimated probability of an event of the selected row.
+/*!
+   \param hits trajectories ending on every event of a kind.
+   \param event the event.
+   \return The estimate, empty if the row was not sampled.
+*/
+wxString SimulationManager::getSampled(vector<int> &hits, unsigned int event)
+{
+    if (samples[rRow].trajectories == 0 || event >= hits.size())
+    {
+        return wxEmptyString;
     }
-    row++;
+    return _(": ") + getEstimate(hits[event], rRow);
+}
+
+
+//! Simulates the rows left in worker processes.
+/*!
+   The rows after the one being simulated here are shared among the
+   workers, and their results are gathered as if this process had
+   simulated them. The workers are polled while a progress dialog keeps
+   the views responding and lets the user stop them. The rows a worker
+   could not simulate, or did not finish before being stopped, are left
+   unsimulated: simulating them here could exhaust this process too.
+*/
+void SimulationManager::shardRows()
+{
+    vector<rowJob> jobs;
+    int rows = (int)pow(2, (double)tableInputs.size());
+    for (int r = row; r < rows; r++)
+    {
+        if (solvedRows[r])
+        {
+            continue;
+        }
+        rowJob job;
+        job.row = r;
+        matrix rowLayout = verifier.getRowLayout(r);
+        int sliced;
+        job.frozen = getRowFrozen(rowLayout, &sliced);
+        job.space = Grid(rowLayout);
+        jobs.push_back(job);
+    }
+    if (jobs.empty())
+    {
+        return;
+    }
+    ShardedSimulation engine(&rules, &patterns);
+    engine.setSemantics(options.semantics);
+    engine.setSiteMatching(plan.matcher == MATCHER_SITES);
+    engine.setCacheLimit(plan.cacheSpaces);
+    int workers = min(options.workers, (int)jobs.size());
+    view->setInfo(wxString::Format(_("Simulating %d rows in %d worker processes"), (int)jobs.size(), workers));
+    if (!engine.start(jobs, workers))
+    {
+        view->setInfo(_("The worker processes could not be started, the rows are simulated here"));
+        return;
+    }
+    //The workers are polled from the event loop, so the view keeps responding
+    wxProgressDialog progress(_("Worker processes"), wxString::Format(_("Simulating %d rows in %d worker processes"), (int)jobs.size(), workers), jobs.size(), view, wxPD_CAN_ABORT | wxPD_APP_MODAL | wxPD_ELAPSED_TIME);
+    while (!engine.poll())
+    {
+        if (!progress.Update(engine.getFinished()))
+        {
+            engine.cancel();
+            view->setInfo(_("The worker processes were stopped"));
+            break;
+        }
+        wxMilliSleep(SHARD_POLL);
+    }
+    int simulated = 0;
+    int failed = 0;
+    for (unsigned int k = 0; k < jobs.size(); k++)
+    {
+        rowResults &results = engine.getResults(k);
+        int r = jobs[k].row;
+        solvedRows[r] = true;
+        if (!results.simulated)
+        {
+            //A row that killed its worker would kill this process too
+            failedRows[r] = true;
+            failed++;
+            continue;
+        }
+        processedLayouts[r].swap(results.processed);
+        finalLayouts[r].swap(results.stable);
+        forbiddenLayouts[r].swap(results.forbidden);
+        cycles[r].swap(results.cycles);
+        outOfBoundsLayouts[r].swap(results.outOfBounds);
+        reachedStates[r].swap(results.visited);
+        frozenCells[r] = jobs[k].frozen;
+        simulatedRows[r] = true;
+        simulated++;
+        if (options.resultCache && cacheOpen)
+        {
+            cachedRow stored;
+            stored.verified = verifyRow(r, ALL_TABLES);
+            stored.stable = finalLayouts[r];
+            stored.cycles = cycles[r];
+            stored.forbidden = forbiddenLayouts[r];
+            stored.outOfBounds = outOfBoundsLayouts[r];
+            resultCache.store(jobs[k].space, jobs[k].frozen, getExpected(r), stored);
+        }
+    }
+    view->setInfo(wxString::Format(_("%d rows simulated by the workers"), simulated));
+    if (engine.getCrashed() > 0)
+    {
+        view->setInfo(wxString::Format(_("%d worker processes died"), engine.getCrashed()));
+    }
+    if (failed > 0)
+    {
+        view->setInfo(wxString::Format(_("%d rows could not be simulated by the workers, they are left unsimulated"), failed));
+    }
+}
+
+
+//! Simulates the rows left with the symbolic simulation.
+/*!
+   All the rows are simulated at once, and the ones where the rules behave
+   deterministically are skipped later. Their results are only built when
+   the row is shown.
+   \return False if the symbolic simulation could not be used.
+*/
+bool SimulationManager::presolveSymbolic()
+{
+    symbolic = new BddSimulation(&rules, &patterns);
+    if (!symbolic->simulate(Grid(verifier.getRowLayout(0)), tableInputs, tableOutputs, &table))
+    {
+        delete symbolic;
+        symbolic = NULL;
+        return false;
+    }
+    int rows = (int)pow(2, (double)tableInputs.size());
+    for (int r = row; r < rows; r++)
+    {
+        if (symbolic->isDecided(r))
+        {
+            solvedRows[r] = true;
+        }
+    }
+    view->setInfo(wxString::Format(_("Symbolic simulation: %.0f rows solved, %.0f of them verify the table (%d BDD nodes)"), symbolic->getDecided(), symbolic->getVerified(), symbolic->getNodes()));
+    return true;
+}
+
+
+//! Builds the results of a row solved by the symbolic simulation.
+/*!
+   \param row the row.
+*/
+void SimulationManager::loadRow(int row)
+{
+    if (symbolic == NULL || !solvedRows[row] || hasEvents(row) || !symbolic->isDecided(row))
+    {
+        return;
+    }
+    finalLayouts[row] = symbolic->getStableLayouts(row);
+    forbiddenLayouts[row] = symbolic->getForbiddenLayouts(row);
+    cycles[row] = symbolic->getCycles(row);
+    outOfBoundsLayouts[row] = symbolic->getOutOfBounds(row);
+}
+
+
+//! Tells if a row has simulation results.
+/*!
+   \param row the row.
+   \return False if the row has been verified without simulating it.
+*/
+bool SimulationManager::hasEvents(int row)
+{
+    return !finalLayouts[row].empty() || !cycles[row].empty() || !forbiddenLayouts[row].empty() || !outOfBoundsLayouts[row].empty();
 }
 
 
@@ -443,6 +1349,31 @@ void SimulationManager::finishedRow()
     forbiddenLayouts[row - 1] = simulation->getForbiddenLayouts();
     cycles[row - 1] = simulation->getCycles();
     outOfBoundsLayouts[row - 1] = simulation->getOutOfBounds();
+    simulatedRows[row - 1] = true;
+    reachedStates[row - 1] = simulation->getVisited();
+    frozenCells[row - 1] = frozen;
+    if (options.resultCache && cacheOpen)
+    {
+        cachedRow simulated;
+        simulated.verified = verifyRow(row - 1, ALL_TABLES);
+        simulated.stable = finalLayouts[row - 1];
+        simulated.cycles = cycles[row - 1];
+        simulated.forbidden = forbiddenLayouts[row - 1];
+        simulated.outOfBounds = outOfBoundsLayouts[row - 1];
+        resultCache.store(Grid(verifier.getRowLayout(row - 1)), frozen, getExpected(row - 1), simulated);
+    }
+    if (options.semantics != STEP_INTERLEAVED && !finalLayouts[row - 1].empty())
+    {
+        //Every parallel step is a time step of the cascade
+        unsigned int shortest = finalLayouts[row - 1].front().path.size();
+        unsigned int longest = shortest;
+        for (list<simulationStep>::iterator i = finalLayouts[row - 1].begin(); i != finalLayouts[row - 1].end(); i++)
+        {
+            shortest = min(shortest, (unsigned int)(*i).path.size());
+            longest = max(longest, (unsigned int)(*i).path.size());
+        }
+        view->setInfo(wxString::Format(_("Cascade depth: %d to %d steps"), shortest, longest));
+    }
 }
 
 
@@ -454,6 +1385,7 @@ void SimulationManager::results()
     rRow = 0;
     rInformation = 0;
     rPath = 0;
+    loadRow(rRow);
     updateRowList();
     updateInformationList();
     updatePathList();
@@ -475,6 +1407,7 @@ void SimulationManager::rowSelected(int row)
     rRow = row;
     rInformation = 0;
     rPath = 0;
+    loadRow(rRow);
     updateRowList();
     updateInformationList();
     updatePathList();
@@ -517,13 +1450,34 @@ void SimulationManager::updateRowList()
     wxArrayString s;
     for (int i = 0; i < (int)pow(2, (double)tableInputs.size()); i++)
     {
-        if (verifyRow(i))
+        wxString sampled;
+        if (samples[i].trajectories > 0)
+        {
+            sampled = wxString::Format(_(" (%d trajectories)"), samples[i].trajectories);
+        }
+        //With several tables every one gets its own result
+        wxString tables;
+        if (!otherTables.empty())
+        {
+            tables = _(" (") + table.getName() + (verifyRow(i, 0) ? _(": OK") : _(": KO"));
+            for (unsigned int t = 0; t < otherTables.size(); t++)
+            {
+                tables += _(", ") + otherTables[t].getName() + (verifyRow(i, t + 1) ? _(": OK") : _(": KO"));
+            }
+            tables += _(")");
+        }
+        if (failedRows[i])
+        {
+            s.Add(wxString::Format(_("Row %d: not simulated"), i + 1));
+            verifies = false;
+        }
+        else if (verifyRow(i, ALL_TABLES))
         {
-            s.Add(wxString::Format(_("Row %d: OK"), i + 1));
+            s.Add(wxString::Format(_("Row %d: OK"), i + 1) + tables + sampled);
         }
         else
         {
-            s.Add(wxString::Format(_("Row %d: KO"), i + 1));
+            s.Add(wxString::Format(_("Row %d: KO"), i + 1) + tables + sampled);
             verifies = false;
         }
     }
@@ -539,18 +1493,34 @@ void SimulationManager::updateInformationList()
     wxArrayString s;
     //First we must know if we must update
     //forbidden patterns or stable layouts
-    if (forbiddenLayouts[rRow].size() > 0) //FPs
+    if (!hasEvents(rRow) && stableSpaces[rRow] > 0)
+    {
+        s.Add(wxString::Format(_("Verified by %d independent tiles, %.0f stable spaces"), rowTiles[rRow], stableSpaces[rRow]));
+    }
+    else if (!hasEvents(rRow) && samples[rRow].trajectories > 0)
+    {
+        s.Add(wxString::Format(_("No trajectory finished in %d steps"), MONTECARLO_STEPS));
+    }
+    else if (!hasEvents(rRow) && !verifier.isRelevant(rRow))
+    {
+        s.Add(_("Every output is a don't-care"));
+    }
+    else if (!hasEvents(rRow))
+    {
+        s.Add(_("Verified without simulating"));
+    }
+    else if (forbiddenLayouts[rRow].size() > 0) //FPs
     {
         for (unsigned int i = 0; i < forbiddenLayouts[rRow].size(); i++)
         {
-            s.Add(wxString::Format(_("Pattern %d"), i + 1));
+            s.Add(wxString::Format(_("Pattern %d"), i + 1) + getSampled(samples[rRow].forbidden, i));
         }
     }
     else if (outOfBoundsLayouts[rRow].size() > 0) //OOB
     {
         for (unsigned int i = 0; i < outOfBoundsLayouts[rRow].size(); i++)
         {
-            s.Add(wxString::Format(_("Out of bounds %d"), i + 1));
+            s.Add(wxString::Format(_("Out of bounds %d"), i + 1) + getSampled(samples[rRow].outOfBounds, i));
         }
     }
     else 
@@ -559,7 +1529,7 @@ void SimulationManager::updateInformationList()
         {
             for (unsigned int i = 0; i < finalLayouts[rRow].size(); i++)
             {
-                s.Add(wxString::Format(_("Stable %d"), i + 1));
+                s.Add(wxString::Format(_("Stable %d"), i + 1) + getSampled(samples[rRow].stable, i));
             }
         }
         if (cycles[rRow].size() > 0)
@@ -580,7 +1550,11 @@ void SimulationManager::updateInformationList()
 void SimulationManager::updatePathList()
 {
     wxArrayString s;
-    if (forbiddenLayouts[rRow].size() > 0) //FPs
+    if (!hasEvents(rRow))
+    {
+        s.Add(wxString::Format(_("Step %d"), 1));
+    }
+    else if (forbiddenLayouts[rRow].size() > 0) //FPs
     {
         list <simulationStep>::iterator it = forbiddenLayouts[rRow].begin();
         for (int i = 0; i < rInformation; i++)
@@ -691,7 +1665,11 @@ void SimulationManager::updateGrid()
     //Rememeber. A simulation step is a list of
     //grids (path) and the final grid (space).
     simulationStep ss;
-    if (forbiddenLayouts[rRow].size() > 0) //FPs
+    if (!hasEvents(rRow)) //Only the initial space is known
+    {
+        ss.space.g = Grid(verifier.getRowLayout(rRow));
+    }
+    else if (forbiddenLayouts[rRow].size() > 0) //FPs
     {
         list <simulationStep>::iterator it = forbiddenLayouts[rRow].begin();
         for (int i = 0; i < rInformation; i++)
@@ -767,124 +1745,57 @@ void SimulationManager::updateGrid()
 }
 
 
-//! Checks if a row simulation verifies the truth table.
+//! Checks if a row simulation verifies the truth tables.
 /*!
    \param row the row to check.
+   \param checked the table to verify, 0 for the selected one and the
+   next ones for the rest of tables checked, or ALL_TABLES.
    \return True if the row verifies the table, false otherwise.
 */
-bool SimulationManager::verifyRow(int row)
+bool SimulationManager::verifyRow(int row, int checked)
 {
-    bool result = true;
-    if (forbiddenLayouts[row].size() > 0)
+    //The symbolic simulation knows the result without building the events
+    if (symbolic != NULL && solvedRows[row] && symbolic->isDecided(row))
     {
-        result = false;
+        return symbolic->verifies(row);
     }
-    if (outOfBoundsLayouts[row].size() > 0)
+    //A row the workers could not simulate verifies nothing
+    if (failedRows[row])
     {
-        result = false;
+        return false;
     }
-    if (finalLayouts[row].size() > 0)//Verify all the stable layouts
-    {
-        for (list<simulationStep>::iterator  i = finalLayouts[row].begin(); i != finalLayouts[row].end(); i++)
-        {
-            result = result && verifyGrid(row, (*i).space.g);
-        }        
-    }   
-    if (cycles[row].size() > 0) //Cycles
+    //A sampled row where no trajectory finished verifies nothing
+    if (samples[row].trajectories > 0 && !hasEvents(row))
     {
-        for (list<simulationStep>::iterator  i = cycles[row].begin(); i != cycles[row].end(); i++)
-        {
-            result = result && verifyCycle(row, (*i));
-        }
+        return false;
     }
-    return result;
-}
-
-
-//! Verifies if a grid has the correct output values for a table and a row.
-/*!
-   \param row the row to check.
-   \param g the grid to check.
-   \return True if the grid verifies the row, false otherwise.
-*/
-bool SimulationManager::verifyGrid(int row, Grid g)
-{
-    //Get the outputs values of the row
-    vector<bool> result(tableInputs.size(), false);
-    int j = tableInputs.size() -1 ;
-    int k = row;
-    while (k > 0)
-    {
-        if ((k % 2) == 1) //1 = True
-        {
-            result[j] = true;
-        }  
-        else
-        {
-            result[j] = false;
-        }
-        k /= 2;  
-        j--;
-    }
-    vector<bool> outputs = table.getOutput(result);
-    
-    //Check the outputs are ok
-    for (unsigned int i = 0; i < tableOutputs.size(); i++)
-    {
-        if (outputs[i]) //the position must be nENABLED
-        {
-            if (g(tableOutputs[i].x, tableOutputs[i].y) != nENABLED)
-            {
-                return false;
-            }
-        }
-        else //the position must be nDISABLED
-        {
-            if (g(tableOutputs[i].x, tableOutputs[i].y) != nDISABLED)
-            {
-                return false;
-            }
-        }
-    }
-    return true;
-}
-
-
-//! Verifies if a cycle has the correct output values for a table and a row.
-/*!
-   \param row the row to check.
-   \param st the cycle to check.
-   \return True if the cycle verifies the row, false otherwise.
-*/
-bool SimulationManager::verifyCycle(int row, simulationStep st)
-{
-    bool result = true;
-    
-    //We must find where the cycle begins and then that all the
-    //grids corresponding to the cycle verify the row.
-    bool layoutFound = false;
-    int j = 0;
-    for (list<spaceHighlighted>::iterator i = st.path.begin(); i != st.path.end(); i++)
-    {
-        if (((*i).g) == st.space.g) //We found the grid, we start to check here
-        {
-            layoutFound = true;
-        }
-        if (layoutFound) //Check the grid here
-        {
-            cout << "Layout Cycle found: " << j << endl;
-            result = result && verifyGrid(row, ((*i).g));
-        }
-        j++;
-    }
-    
-    return result;
+    return verifier.verifyRow(row, finalLayouts[row], cycles[row], forbiddenLayouts[row], outOfBoundsLayouts[row], checked);
 }
 
 
 //! Cleans all the simulation information.
 void SimulationManager::endSimulation()
 {
+    //The rows simulated are kept to be reused by the next simulation
+    last.rules = rules;
+    last.patterns = patterns;
+    last.semantics = options.semantics;
+    last.simulated.swap(simulatedRows);
+    last.frozen.swap(frozenCells);
+    last.reached.swap(reachedStates);
+    last.processed.swap(processedLayouts);
+    last.stable.swap(finalLayouts);
+    last.cycles.swap(cycles);
+    last.forbidden.swap(forbiddenLayouts);
+    last.outOfBounds.swap(outOfBoundsLayouts);
+    //The simulation is over, there is nothing left to resume
+    if (!checkpointFile.IsEmpty() && wxFile::Exists(checkpointFile))
+    {
+        wxRemoveFile(checkpointFile);
+    }
+    checkpointFile = wxEmptyString;
+    delete resumed;
+    resumed = NULL;
     delete simulation;
     view->Destroy();
     resultsView->Destroy();
@@ -37,6 +37,24 @@
 #include "forbiddenPatternManager.hpp"
 #include "layoutManager.hpp"
 #include "simulation.hpp"
+#include "spaceCache.hpp"
+#include "bitSimulation.hpp"
+#include "bddSimulation.hpp"
+#include "ternarySimulation.hpp"
+#include "tileSimulation.hpp"
+#include "backwardSearch.hpp"
+#include "subCircuitSummary.hpp"
+#include "monteCarloSimulation.hpp"
+#include "samplingThread.hpp"
+#include "incrementalSimulation.hpp"
+#include "resultCache.hpp"
+#include "checkpoint.hpp"
+#include "staticPruning.hpp"
+#include "ruleRotation.hpp"
+#include "simulationPlanner.hpp"
+#include "shardedSimulation.hpp"
+#include "simulationOptions.hpp"
+#include "rowVerifier.hpp"
 #include "simulationView.hpp"
 #include "resultsView.hpp"
 #include <vector>
@@ -56,11 +74,14 @@ class SimulationManager
 public:
 	SimulationManager(MainController *controller, TruthTableManager *tableManager, ForbiddenPatternManager *FPManager, RuleManager *ruleManager, LayoutManager *layoutManager);
 	virtual ~SimulationManager();
+    void setOptions(simulationOptions options);
     void prepareSimulation();
     void startSimulation();
     bool nextRow();
     void simulateRow();
+    void presolve();
     void finishedRow();
+    void checkpoint();
     void results();
     void rowSelected(int row);
     void informationSelected(int information);
@@ -68,21 +89,35 @@ public:
     void endSimulation();
     
 private:
-    void addRule(Rule newRule);
-    void addPattern(ForbiddenPattern newPattern);
-    bool findRule(Rule rule);
-    bool findPattern(ForbiddenPattern pattern);
     void printRule(Rule rule);
     void printPattern(Grid pattern);
-    bool rotateGrid(Grid originalGrid, Grid *destGrid);
-    void rotateHexCoordinate(int center, int i, int j, int *ii, int *jj);
     void updateRowList();
     void updateInformationList();
     void updatePathList();
     void updateGrid();
-    bool verifyRow(int row);
-    bool verifyGrid(int row, Grid g);
-    bool verifyCycle(int row, simulationStep st);
+    bool verifyRow(int row, int checked);
+    void presolveBitSliced();
+    bool presolveSymbolic();
+    void presolveTernary();
+    void presolveTiles();
+    void presolveBackward();
+    void presolveSampling();
+    void shardRows();
+    void reusePrevious();
+    void loadCachedRows();
+    void saveCheckpoint();
+    void resumeCheckpoint();
+    wxString getExpected(int row);
+    vector<bool> getRowFrozen(matrix &rowLayout, int *sliced);
+    void estimateSearch();
+    void planSimulation(int enabledRules);
+    bool isPresolvable();
+    wxString getDuration(double seconds);
+    wxString getSpaces(double spaces);
+    wxString getEstimate(int hits, int row);
+    wxString getSampled(vector<int> &hits, unsigned int event);
+    void loadRow(int row);
+    bool hasEvents(int row);
     
     //! Truth table controller.
     TruthTableManager *tableManager;
@@ -97,6 +132,8 @@ private:
     
     //! Rules to use for simulating.
     list<Rule> rules;
+    //! Rate of every rule to use for simulating, in the list order.
+    vector<double> ruleRates;
     //! Forbidden patterns to use for simulating.
     list<ForbiddenPattern> patterns;
     //! Truth table to simulate.
@@ -107,6 +144,10 @@ private:
     vector<coordinate> tableInputs;
     //! Output coordinates for the truth table.
     vector<coordinate> tableOutputs;
+    //! Rest of truth tables checked, verified on the same rows.
+    vector<TruthTable> otherTables;
+    //! Initial spaces and verdicts of the rows of the tables checked.
+    RowVerifier verifier;
     //! List of simulated spaces for every table row.
     vector< list<Grid> > processedLayouts;
     //! List of stable spaces reached for every table row.
@@ -117,6 +158,58 @@ private:
     vector< list<simulationStep> > outOfBoundsLayouts;
     //! List of cycles found for every table row.
     vector< list<simulationStep> > cycles;
+    //! Rows already solved before the normal simulation, skipped by it.
+    vector<bool> solvedRows;
+    //! Stable spaces of every row verified by its tiles, 0 for the rest.
+    vector<double> stableSpaces;
+    //! Independent tiles of every row verified by its tiles.
+    vector<int> rowTiles;
+    //! Trajectory counts of every row sampled, empty for the rest.
+    vector<sampleCounts> samples;
+    //! Rows simulated by the normal simulation or reused from the last one.
+    vector<bool> simulatedRows;
+    //! Rows the worker processes could not simulate, left without results.
+    vector<bool> failedRows;
+    //! Hashes of the spaces every simulated row reached.
+    vector< vector<unsigned long> > reachedStates;
+    //! Cells left out of the simulation of every simulated row.
+    vector< vector<bool> > frozenCells;
+    //! Results of the last simulation, kept for the next one.
+    lastSimulation last;
+    //! Results of the rows stored on disk.
+    ResultCache resultCache;
+    //! True if the result cache directory can be used.
+    bool cacheOpen;
+    //! Checkpoint file of the simulation, empty if not checkpointed.
+    wxString checkpointFile;
+    //! Check of the key of the simulation, stored in its checkpoint.
+    uint64_t checkpointCheck;
+    //! Time since the last checkpoint.
+    wxStopWatch checkpointWatch;
+    //! Checkpoint with the state of the row to resume, NULL if none.
+    Checkpoint *resumed;
+    //! Row to resume from the checkpoint.
+    int resumeRow;
+    //! Options of the simulation.
+    simulationOptions options;
+    //! Engine settings chosen for the simulation.
+    simulationPlan plan;
+    //! Spaces probed for every row, -1 if the rows were not probed.
+    double probedSpaces;
+    //! Search depth probed for every row, -1 if the rows were not probed.
+    double probedDepth;
+    //! Tile simulation of the rows, NULL before presolving.
+    TileSimulation *tiles;
+    //! Cells left out of the simulation of the current row.
+    vector<bool> frozen;
+    //! Cells inside the sub-circuit instances, empty if there are none.
+    vector<bool> instanceCells;
+    //! Inputs and outputs of the sub-circuit instances.
+    vector<coordinate> instancePins;
+    //! Number of sub-circuit instances simulated by their truth tables.
+    int subCircuits;
+    //! Symbolic simulation of the rows, NULL if not used.
+    BddSimulation *symbolic;
     //! Row being simulated.
     int row;
     //! Simulation presentation layer.
@@ -125,6 +218,8 @@ private:
     ResultsView *resultsView;
     //! Simulation.
     Simulation *simulation;
+    //! Results of the spaces simulated, shared by all the rows.
+    SpaceCache cache;
     //! Results row selected.
     int rRow;
     //! Results event selected.
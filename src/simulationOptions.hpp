@@ -0,0 +1,82 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \file simulationOptions.hpp
+ * \brief Options chosen by the user for a simulation.
+ * 
+ * The options are picked on the layout panel and handed to the simulation
+ * controller when the simulation starts. The engine settings left to
+ * PLAN_AUTO are chosen by the simulation planner.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef SIMULATIONOPTIONS_HPP_
+#define SIMULATIONOPTIONS_HPP_
+
+#include <vector>
+
+using namespace std;
+
+//! Every step fires one rule placement.
+#define STEP_INTERLEAVED 0
+//! Every step fires a maximal set of placements, picked in scan order.
+#define STEP_PARALLEL 1
+//! Every maximal set of placements gives a step.
+#define STEP_PARALLEL_ALL 2
+//! Maximum number of maximal sets enumerated for a space.
+#define PARALLEL_CHOICES 64
+//! The planner picks the setting.
+#define PLAN_AUTO -1
+//! Rules and patterns are looked for at every coordinate of the space.
+#define MATCHER_SCAN 0
+//! Rules and patterns are looked for from the enabled sites of the space.
+#define MATCHER_SITES 1
+//! Every row is simulated exhaustively.
+#define STRATEGY_FORWARD 0
+//! The bit-sliced, abstract and tile simulations solve rows first.
+#define STRATEGY_BITSLICED 1
+//! The symbolic, abstract and tile simulations solve rows first.
+#define STRATEGY_SYMBOLIC 2
+//! The spaces simulated are cached for the rest of the search.
+#define MEMORY_CACHED 0
+//! No space is cached.
+#define MEMORY_LEAN 1
+
+
+//! Simulation options struct.
+/*! Struct used to store the search modes enabled for a simulation. */
+struct simulationOptions
+{
+    bool backward; /*!< Search failures backward from the outputs before simulating the rows. */
+    bool bidirectional; /*!< Meet the backward search with spaces reached forward. */
+    bool sampling; /*!< Sample random trajectories of the rows instead of simulating them. */
+    int trajectories; /*!< Number of trajectories sampled for every row. */
+    vector<double> rates; /*!< Rate of every enabled rule, 1 for the rules left out. */
+    int semantics; /*!< Rule placements fired by every step, STEP_INTERLEAVED or a parallel mode. */
+    bool incremental; /*!< Reuse the rows of the last simulation that the edits since it do not affect. */
+    bool resultCache; /*!< Load and store the results of the rows in the result cache on disk. */
+    bool checkpoint; /*!< Save checkpoints of the simulation and resume it from the last one. */
+    int matcher; /*!< MATCHER_SCAN, MATCHER_SITES or PLAN_AUTO. */
+    int strategy; /*!< Engines solving rows before the exhaustive search, a STRATEGY_ value or PLAN_AUTO. */
+    int threads; /*!< Threads sampling the rows, PLAN_AUTO to pick them. */
+    int memory; /*!< MEMORY_CACHED, MEMORY_LEAN or PLAN_AUTO. */
+    int workers; /*!< Worker processes simulating the rows, 0 to simulate them in this process. */
+};
+
+#endif /*SIMULATIONOPTIONS_HPP_*/
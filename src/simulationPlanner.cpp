@@ -0,0 +1,256 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "simulationPlanner.hpp"
+#include "siteIndex.hpp"
+#include "ruleGraph.hpp"
+#include "spaceCache.hpp"
+#include "bitSimulation.hpp"
+#include <math.h>
+#include <algorithm>
+
+using namespace std;
+
+
+//! Constructor.
+/*!
+   The rules and patterns are referenced, not copied.
+   \param rules the rules to simulate, rotations included.
+   \param patterns the forbidden patterns to simulate, rotations included.
+*/
+SimulationPlanner::SimulationPlanner(list<Rule> *rules, list<ForbiddenPattern> *patterns)
+{
+    this->rules = rules;
+    this->patterns = patterns;
+    estimatedSpaces = -1;
+    estimatedDepth = -1;
+    sites = 0;
+    enabled = 0;
+    components = 0;
+    confluent = false;
+}
+
+
+//! Destructor.
+SimulationPlanner::~SimulationPlanner()
+{
+}
+
+
+//! Sets the size of the search probed for every row.
+/*!
+   \param spaces the average spaces simulated for every row.
+   \param depth the average depth of the search of every row.
+*/
+void SimulationPlanner::setEstimate(double spaces, double depth)
+{
+    estimatedSpaces = spaces;
+    estimatedDepth = depth;
+}
+
+
+//! Chooses the engine settings of a simulation.
+/*!
+   The exhaustive search costs a match of every rule and pattern for
+   every space of every row. The bit-sliced and symbolic simulations follow
+   the rows whose search is a single path, 64 rows or all of them at a time,
+   so they pay off when the rules are confluent or the searches are narrow;
+   the tile simulation splits the rest by the components of the space.
+   Without probes the search of a row is taken as one space per molecule
+   if the rules are confluent and as every order of the molecules if not.
+   \param space the space of the first row.
+   \param inputs the number of table inputs.
+   \param presolvable false if the rows can only be simulated exhaustively.
+   \param options the options of the simulation, the settings other than
+   PLAN_AUTO are kept.
+   \param cpus the number of processors.
+   \return The plan of the simulation.
+*/
+simulationPlan SimulationPlanner::plan(Grid space, int inputs, bool presolvable, simulationOptions &options, int cpus)
+{
+    SiteIndex index;
+    index.build(space);
+    vector<coordinate> molecules;
+    index.getEnabled(space, &molecules);
+    sites = index.getSites();
+    enabled = molecules.size();
+    components = index.getComponents();
+    RuleGraph graph(rules);
+    confluent = graph.isConfluent();
+    
+    simulationPlan result;
+    double rows = pow(2, (double)inputs);
+    double steps = estimatedDepth >= 0 ? estimatedDepth + 1 : enabled + 1;
+    result.spaces = estimatedSpaces;
+    if (result.spaces < 0)
+    {
+        result.spaces = confluent ? enabled + 1 : pow(2, (double)min(enabled, PLAN_MOLECULES));
+    }
+    result.spaces = max(result.spaces, 1.0);
+    
+    //Matching
+    double scan = matchCost(space, false);
+    double fromSites = matchCost(space, true);
+    result.matcher = options.matcher;
+    if (result.matcher == PLAN_AUTO)
+    {
+        result.matcher = fromSites < scan ? MATCHER_SITES : MATCHER_SCAN;
+    }
+    double match = result.matcher == MATCHER_SITES ? fromSites : scan;
+    
+    //Engines before the exhaustive search, the bit-sliced and symbolic
+    //ones match every placement of the space
+    double forward = rows * result.spaces * match;
+    double single = confluent ? 1 : min(1.0, steps / result.spaces);
+    double rest = rows * scan + (1 - single) * forward / max(components, 1);
+    double costs[3];
+    costs[STRATEGY_FORWARD] = forward;
+    costs[STRATEGY_BITSLICED] = ceil(rows / BITSLICE_LANES) * steps * scan + rest;
+    costs[STRATEGY_SYMBOLIC] = steps * scan * inputs / PLAN_BDD_INPUTS + rest;
+    result.strategy = options.strategy;
+    if (!presolvable)
+    {
+        result.strategy = STRATEGY_FORWARD;
+    }
+    else if (result.strategy == PLAN_AUTO)
+    {
+        result.strategy = STRATEGY_FORWARD;
+        for (int k = STRATEGY_BITSLICED; k <= STRATEGY_SYMBOLIC; k++)
+        {
+            if (costs[k] < costs[result.strategy])
+            {
+                result.strategy = k;
+            }
+        }
+    }
+    result.cost = costs[result.strategy];
+    
+    //Only the sampling runs in several threads
+    result.threads = 1;
+    if (options.sampling)
+    {
+        result.threads = options.threads;
+        if (result.threads == PLAN_AUTO)
+        {
+            result.threads = min(cpus, options.trajectories / PLAN_THREAD_TRAJECTORIES);
+        }
+        result.threads = max(1, min(result.threads, options.trajectories));
+        result.cost = rows * options.trajectories * steps * match / result.threads;
+    }
+    
+    //The cache is bounded by the memory its spaces take
+    double spaceBytes = sizeof(int) * (space.getWidth() + 1.0) * space.getHeight();
+    result.cacheSpaces = (int)min((double)CACHE_SPACES, PLAN_MEMORY / spaceBytes);
+    result.memory = options.memory;
+    if (result.memory == PLAN_AUTO)
+    {
+        bool small = rows * result.spaces < PLAN_LEAN_SPACES;
+        result.memory = small || result.cacheSpaces < PLAN_LEAN_SPACES ? MEMORY_LEAN : MEMORY_CACHED;
+    }
+    if (result.memory == MEMORY_LEAN)
+    {
+        result.cacheSpaces = 0;
+    }
+    return result;
+}
+
+
+//! Member accessor.
+/*!
+   \return The number of sites of the space planned.
+*/
+int SimulationPlanner::getSites()
+{
+    return sites;
+}
+
+
+//! Member accessor.
+/*!
+   \return The number of enabled sites of the space planned.
+*/
+int SimulationPlanner::getEnabled()
+{
+    return enabled;
+}
+
+
+//! Member accessor.
+/*!
+   \return The number of connected components of the sites of the space planned.
+*/
+int SimulationPlanner::getComponents()
+{
+    return components;
+}
+
+
+//! Member accessor.
+/*!
+   \return True if the rules planned are confluent.
+*/
+bool SimulationPlanner::isConfluent()
+{
+    return confluent;
+}
+
+
+//! Predicts the cost of matching all the rules and patterns on a space.
+/*!
+   \param space the space.
+   \param sites true to look for the rules and patterns needing a
+   molecule only from the enabled sites, false to scan every coordinate.
+   \return The cell checks of a match.
+*/
+double SimulationPlanner::matchCost(Grid &space, bool sites)
+{
+    double cost = sites ? this->sites : 0;
+    for (list<Rule>::iterator i = rules->begin(); i != rules->end(); i++)
+    {
+        matrix cells = (*i).getInitialMatrix();
+        cost += matchCost(space, cells, sites);
+    }
+    for (list<ForbiddenPattern>::iterator i = patterns->begin(); i != patterns->end(); i++)
+    {
+        matrix cells = (*i).getGrid().getCells();
+        cost += matchCost(space, cells, sites);
+    }
+    return cost;
+}
+
+
+//! Predicts the cost of matching a rule or a pattern on a space.
+/*!
+   \param space the space.
+   \param cells the configuration of the rule or pattern.
+   \param sites true to look for it only from the enabled sites if it
+   needs a molecule, false to scan every coordinate.
+   \return The cell checks of a match.
+*/
+double SimulationPlanner::matchCost(Grid &space, matrix &cells, bool sites)
+{
+    SiteIndex index;
+    double placements = (space.getWidth() + cells.size() - 1.0) * (space.getHeight() + cells[0].size() - 1.0);
+    if (sites && index.getPivot(cells).x >= 0)
+    {
+        placements = enabled;
+    }
+    return placements * cells.size() * cells[0].size();
+}
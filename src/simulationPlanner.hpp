@@ -0,0 +1,106 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class SimulationPlanner
+ * \brief Cost model choosing the engines of a simulation.
+ * 
+ * This class inspects the rule set (its size with the rotations and
+ * whether it is confluent), the space (its sites, the density of molecules
+ * on them and the components they form) and the number of rows, and
+ * predicts the cost, in cell checks, of the ways the rows can be solved.
+ * It chooses how the rules and patterns are matched, which engines solve
+ * rows before the exhaustive search, how many threads sample the rows and
+ * how many spaces the space cache keeps. Every setting the user fixed in
+ * the options is kept, the rest are chosen.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef SIMULATIONPLANNER_HPP_
+#define SIMULATIONPLANNER_HPP_
+
+#include "grid.hpp"
+#include "rule.hpp"
+#include "forbiddenPattern.hpp"
+#include "simulationOptions.hpp"
+#include <list>
+
+//! Cell checks done in a second.
+#define PLAN_CHECKS_SECOND 1e8
+//! Table inputs whose symbolic step costs as much as a bit-sliced step.
+#define PLAN_BDD_INPUTS 4
+//! Spaces simulated in all the rows below which no space is cached.
+#define PLAN_LEAN_SPACES 64
+//! Memory the space cache may take, in bytes.
+#define PLAN_MEMORY 1073741824.0
+//! Minimum number of trajectories sampled by every thread.
+#define PLAN_THREAD_TRAJECTORIES 100
+//! Maximum number of molecules whose orders are counted without probes.
+#define PLAN_MOLECULES 40
+
+using namespace std;
+
+
+//! Simulation plan struct.
+/*! Engine settings chosen for a simulation and their predicted cost. */
+struct simulationPlan
+{
+    int matcher; /*!< MATCHER_SCAN or MATCHER_SITES. */
+    int strategy; /*!< Engines solving rows before the exhaustive search, a STRATEGY_ value. */
+    int threads; /*!< Threads sampling the rows. */
+    int memory; /*!< MEMORY_CACHED or MEMORY_LEAN. */
+    int cacheSpaces; /*!< Maximum number of spaces the space cache keeps. */
+    double spaces; /*!< Predicted spaces simulated for every row. */
+    double cost; /*!< Predicted cost of the simulation, in cell checks. */
+};
+
+
+class SimulationPlanner
+{
+public:
+    SimulationPlanner(list<Rule> *rules, list<ForbiddenPattern> *patterns);
+    virtual ~SimulationPlanner();
+    void setEstimate(double spaces, double depth);
+    simulationPlan plan(Grid space, int inputs, bool presolvable, simulationOptions &options, int cpus);
+    int getSites();
+    int getEnabled();
+    int getComponents();
+    bool isConfluent();
+
+private:
+    double matchCost(Grid &space, bool sites);
+    double matchCost(Grid &space, matrix &cells, bool sites);
+    //! Rules to simulate, rotations included.
+    list<Rule> *rules;
+    //! Forbidden patterns to simulate, rotations included.
+    list<ForbiddenPattern> *patterns;
+    //! Spaces simulated for every row, from the probes, -1 if not probed.
+    double estimatedSpaces;
+    //! Depth of the search of every row, from the probes, -1 if not probed.
+    double estimatedDepth;
+    //! Sites of the space.
+    int sites;
+    //! Enabled sites of the space.
+    int enabled;
+    //! Connected components of the sites.
+    int components;
+    //! True if no rule firing can disable another rule applying.
+    bool confluent;
+};
+
+#endif /*SIMULATIONPLANNER_HPP_*/
@@ -0,0 +1,68 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \file simulationStep.hpp
+ * \brief Structs describing the steps of a simulation.
+ * 
+ * These are shared by the simulation and by the modules that store
+ * simulation results, so they do not depend on the presentation layer.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef SIMULATIONSTEP_HPP_
+#define SIMULATIONSTEP_HPP_
+
+#include "grid.hpp"
+#include "ruleGraph.hpp"
+#include <list>
+
+using namespace std;
+
+
+//! Highlight information struct.
+/*! Struct used to store information about a space highlighted zone. */
+struct highlight
+{
+    int top;
+    int left;
+    int width;
+    int height;
+};
+
+
+//! Step space.
+/*! Struct used to store information about a space and it's highligted zone. */
+struct spaceHighlighted
+{
+    Grid g;
+    highlight h;
+};
+
+
+//! Siulation step struct.
+/*! This is used to represent a single simulation step. */
+struct simulationStep
+{
+    list <spaceHighlighted> path; /*!< List of spaces which lead to the current space. */
+    spaceHighlighted space; /*!< Current space of the simulation step. */
+    list<ruleApplying> applicable; /*!< Rule applyings of the current space. */
+    bool matched; /*!< True if the rule applyings of the current space are known. */
+};
+
+#endif /*SIMULATIONSTEP_HPP_*/
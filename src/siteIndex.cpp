@@ -0,0 +1,213 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "siteIndex.hpp"
+#include <algorithm>
+
+using namespace std;
+
+//! Offsets of the six neighbours of a cell, closed under the rotations of the rules.
+static const int hexNeighbours[6][2] = {{1, 0}, {0, 1}, {-1, 1}, {-1, 0}, {0, -1}, {1, -1}};
+
+
+//! Constructor.
+SiteIndex::SiteIndex()
+{
+    width = 0;
+    height = 0;
+}
+
+
+//! Destructor.
+SiteIndex::~SiteIndex()
+{
+}
+
+
+//! Numbers the sites of a space.
+/*!
+   \param space the space, the sites are its cells available for use.
+*/
+void SiteIndex::build(Grid &space)
+{
+    width = space.getWidth();
+    height = space.getHeight();
+    site.assign(width * height, false);
+    sites.clear();
+    addSpace(space);
+}
+
+
+//! Adds the sites of another space with the same size.
+/*!
+   Spaces reached from a checkpoint may have cells the rules made available.
+   \param space the space.
+*/
+void SiteIndex::addSpace(Grid &space)
+{
+    for (int i = 0; i < width; i++)
+    {
+        for (int j = 0; j < height; j++)
+        {
+            if (space(i, j) != nNOSPACE)
+            {
+                addSite(i, j);
+            }
+        }
+    }
+}
+
+
+//! Adds a site.
+/*!
+   A rule writing on an unavailable cell makes it available, and so a
+   site, for the spaces reached after it. The sites are kept in column order.
+   \param x the x coordinate of the cell.
+   \param y the y coordinate of the cell.
+*/
+void SiteIndex::addSite(int x, int y)
+{
+    int cell = x * height + y;
+    if (site[cell])
+    {
+        return;
+    }
+    site[cell] = true;
+    if (sites.empty() || sites.back() < cell)
+    {
+        sites.push_back(cell);
+    }
+    else
+    {
+        sites.insert(lower_bound(sites.begin(), sites.end(), cell), cell);
+    }
+}
+
+
+//! Tells if a cell is a site.
+/*!
+   \param x the x coordinate of the cell.
+   \param y the y coordinate of the cell.
+   \return True iif the cell is inside the space and is a site.
+*/
+bool SiteIndex::isSite(int x, int y)
+{
+    if (x < 0 || x >= width || y < 0 || y >= height)
+    {
+        return false;
+    }
+    return site[x * height + y];
+}
+
+
+//! Member accessor.
+/*!
+   \return The number of sites.
+*/
+int SiteIndex::getSites()
+{
+    return sites.size();
+}
+
+
+//! Counts the connected components of the sites.
+/*!
+   \return The number of groups of sites connected through neighbour sites.
+*/
+int SiteIndex::getComponents()
+{
+    vector<bool> seen(width * height, false);
+    int components = 0;
+    for (unsigned int k = 0; k < sites.size(); k++)
+    {
+        if (seen[sites[k]])
+        {
+            continue;
+        }
+        components++;
+        seen[sites[k]] = true;
+        vector<int> pending(1, sites[k]);
+        while (!pending.empty())
+        {
+            int cell = pending.back();
+            pending.pop_back();
+            for (int n = 0; n < 6; n++)
+            {
+                int x = cell / height + hexNeighbours[n][0];
+                int y = cell % height + hexNeighbours[n][1];
+                if (isSite(x, y) && !seen[x * height + y])
+                {
+                    seen[x * height + y] = true;
+                    pending.push_back(x * height + y);
+                }
+            }
+        }
+    }
+    return components;
+}
+
+
+//! Finds the enabled sites of a space.
+/*!
+   \param space a space with the size of the indexed one.
+   \param enabled where to store the coordinates of the sites with a
+   molecule, in column order.
+*/
+void SiteIndex::getEnabled(Grid &space, vector<coordinate> *enabled)
+{
+    enabled->clear();
+    for (unsigned int k = 0; k < sites.size(); k++)
+    {
+        coordinate c;
+        c.x = sites[k] / height;
+        c.y = sites[k] % height;
+        if (space(c.x, c.y) == nENABLED)
+        {
+            enabled->push_back(c);
+        }
+    }
+}
+
+
+//! Finds the pivot of a rule or pattern configuration.
+/*!
+   \param cells the configuration.
+   \return The first enabled cell of the configuration in column order,
+   x = -1 if it has none.
+*/
+coordinate SiteIndex::getPivot(matrix &cells)
+{
+    coordinate pivot;
+    pivot.x = -1;
+    pivot.y = -1;
+    for (unsigned int i = 0; i < cells.size(); i++)
+    {
+        for (unsigned int j = 0; j < cells[i].size(); j++)
+        {
+            if (cells[i][j] == nENABLED)
+            {
+                pivot.x = i;
+                pivot.y = j;
+                return pivot;
+            }
+        }
+    }
+    return pivot;
+}
@@ -0,0 +1,67 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class SiteIndex
+ * \brief Usable cells of a space.
+ * 
+ * Spaces are mostly unavailable cells around thin wires, but a grid stores
+ * its whole bounding box. This class numbers only the cells of a space
+ * that are available for use, its sites, in column order. Every placement
+ * of a rule or pattern needing a molecule puts the first of its enabled
+ * cells, its pivot, on an enabled site, so the placements can be looked for
+ * from the enabled sites of a space instead of scanning the whole box padded
+ * by the size of the rule or pattern. The cells of the grid are hexagons
+ * in axial coordinates, so every cell has six neighbours.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef SITEINDEX_HPP_
+#define SITEINDEX_HPP_
+
+#include "grid.hpp"
+#include <vector>
+
+using namespace std;
+
+class SiteIndex
+{
+public:
+	SiteIndex();
+	virtual ~SiteIndex();
+    void build(Grid &space);
+    void addSpace(Grid &space);
+    void addSite(int x, int y);
+    bool isSite(int x, int y);
+    int getSites();
+    int getComponents();
+    void getEnabled(Grid &space, vector<coordinate> *enabled);
+    coordinate getPivot(matrix &cells);
+
+private:
+    //! Width of the space.
+    int width;
+    //! Height of the space.
+    int height;
+    //! Tells for every cell, indexed by x * height + y, if it is a site.
+    vector<bool> site;
+    //! Cells of the sites, indexed by x * height + y, in column order.
+    vector<int> sites;
+};
+
+#endif /*SITEINDEX_HPP_*/
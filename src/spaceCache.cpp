@@ -0,0 +1,150 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "spaceCache.hpp"
+#include <algorithm>
+
+using namespace std;
+
+
+//! Constructor.
+SpaceCache::SpaceCache()
+{
+    numEntries = 0;
+    numSpaces = 0;
+    limit = CACHE_SPACES;
+}
+
+
+//! Destructor.
+SpaceCache::~SpaceCache()
+{
+}
+
+
+//! Finds the entry of a space.
+/*!
+   \param space the space to find.
+   \param hash the hash of the space.
+   \return The entry of the space, or NULL if the space is not cached.
+*/
+cacheEntry *SpaceCache::find(Grid &space, unsigned long hash)
+{
+    map< unsigned long, list<cacheEntry> >::iterator found = entries.find(hash);
+    if (found == entries.end())
+    {
+        return NULL;
+    }
+    for (list<cacheEntry>::iterator i = (*found).second.begin(); i != (*found).second.end(); i++)
+    {
+        if ((*i).space == space)
+        {
+            return &(*i);
+        }
+    }
+    return NULL;
+}
+
+
+//! Checks if a space can be reached from a cached space.
+/*!
+   The results of an entry can only be reused if none of the spaces
+   leading to the cached space is reached in its subtree, as otherwise
+   the simulation would have found a cycle there instead.
+   \param entry the cache entry.
+   \param hash the hash of the space to look for.
+   \return True if a space with the given hash is in the subtree of the entry.
+*/
+bool SpaceCache::reaches(cacheEntry *entry, unsigned long hash)
+{
+    return binary_search(entry->states.begin(), entry->states.end(), hash);
+}
+
+
+//! Adds an entry to the cache.
+/*!
+   The entry is not added if its space is already cached or if the
+   cache is full.
+   \param entry the entry to add.
+   \param hash the hash of the space of the entry.
+*/
+void SpaceCache::add(cacheEntry &entry, unsigned long hash)
+{
+    if (find(entry.space, hash) != NULL)
+    {
+        return;
+    }
+    int size = 1;
+    list<simulationStep> *events[4] = {&entry.stable, &entry.cycles, &entry.forbidden, &entry.outOfBounds};
+    for (int k = 0; k < 4; k++)
+    {
+        for (list<simulationStep>::iterator i = events[k]->begin(); i != events[k]->end(); i++)
+        {
+            size += (*i).path.size() + 1;
+        }
+    }
+    if (numSpaces + size > limit)
+    {
+        return;
+    }
+    entries[hash].push_back(entry);
+    numEntries++;
+    numSpaces += size;
+}
+
+
+//! Empties the cache.
+void SpaceCache::clear()
+{
+    entries.clear();
+    numEntries = 0;
+    numSpaces = 0;
+}
+
+
+//! Member accessor.
+/*!
+   \return The number of cached spaces.
+*/
+int SpaceCache::getEntries()
+{
+    return numEntries;
+}
+
+
+//! Member accessor.
+/*!
+   \return The number of spaces stored in the cache entries.
+*/
+int SpaceCache::getSpaces()
+{
+    return numSpaces;
+}
+
+
+//! Sets the maximum number of spaces stored.
+/*!
+   The entries already stored are kept.
+   \param spaces the maximum number of spaces, 0 to store no entry.
+*/
+void SpaceCache::setLimit(int spaces)
+{
+    limit = spaces;
+}
@@ -0,0 +1,102 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class SpaceCache
+ * \brief Results of already simulated spaces.
+ * 
+ * Different rows of a truth table often reach the same intermediate
+ * spaces. This class stores, for every space whose simulation subtree has
+ * been completely explored, the events found below it (stable spaces,
+ * cycles, forbidden patterns and out of bounds) with the path relative to
+ * the space, and the spaces reached in the subtree. A later simulation,
+ * in the same row or in another one, reaching the same space can reuse
+ * those events instead of exploring the subtree again.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef SPACECACHE_HPP_
+#define SPACECACHE_HPP_
+
+#include "grid.hpp"
+#include "simulationStep.hpp"
+#include <vector>
+#include <list>
+#include <map>
+
+//! Default maximum number of spaces (events and their paths) the cache stores.
+#define CACHE_SPACES 200000
+
+using namespace std;
+
+
+//! Cache entry struct.
+/*! Results of the completely explored subtree of a space. The paths of the
+    events start at the cached space. */
+struct cacheEntry
+{
+    Grid space; /*!< Cached space. */
+    list<simulationStep> stable; /*!< Stable spaces reached. */
+    list<simulationStep> cycles; /*!< Cycles found. */
+    list<simulationStep> forbidden; /*!< Forbidden pattern spaces found. */
+    list<simulationStep> outOfBounds; /*!< Out of bounds spaces found. */
+    vector<unsigned long> states; /*!< Sorted hashes of the spaces of the subtree. */
+};
+
+
+//! Cache frame struct.
+/*! A space being simulated whose subtree is not completely explored yet. */
+struct cacheFrame
+{
+    Grid space; /*!< Space being simulated. */
+    unsigned long hash; /*!< Hash of the space. */
+    unsigned int base; /*!< Spaces queued below the space when it was simulated. */
+    unsigned int stable; /*!< Stable spaces found before the space was simulated. */
+    unsigned int cycles; /*!< Cycles found before the space was simulated. */
+    unsigned int forbidden; /*!< Forbidden spaces found before the space was simulated. */
+    unsigned int outOfBounds; /*!< Out of bounds spaces found before the space was simulated. */
+    unsigned int visited; /*!< Spaces simulated before the space. */
+    bool tainted; /*!< True if a cycle of the subtree goes back to an ancestor. */
+};
+
+
+class SpaceCache
+{
+public:
+    SpaceCache();
+    virtual ~SpaceCache();
+    cacheEntry *find(Grid &space, unsigned long hash);
+    bool reaches(cacheEntry *entry, unsigned long hash);
+    void add(cacheEntry &entry, unsigned long hash);
+    void clear();
+    int getEntries();
+    int getSpaces();
+    void setLimit(int spaces);
+
+private:
+    //! Cache entries indexed by the hash of their space.
+    map< unsigned long, list<cacheEntry> > entries;
+    //! Number of entries.
+    int numEntries;
+    //! Number of spaces stored in the entries.
+    int numSpaces;
+    //! Maximum number of spaces stored.
+    int limit;
+};
+
+#endif /*SPACECACHE_HPP_*/
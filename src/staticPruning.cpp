@@ -0,0 +1,277 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "staticPruning.hpp"
+
+using namespace std;
+
+//! Constructor.
+/*!
+   The lists are pruned in place.
+   \param rules the rule list to be applied.
+   \param patterns the forbidden pattern list to be found.
+*/
+StaticPruning::StaticPruning(list<Rule> *rules, list<ForbiddenPattern> *patterns)
+{
+    this->rules = rules;
+    this->patterns = patterns;
+    rulesPruned = 0;
+    patternsPruned = 0;
+    patternsSubsumed = 0;
+}
+
+
+//! Destructor.
+StaticPruning::~StaticPruning()
+{
+}
+
+
+//! Prunes the rules and patterns for a space.
+/*!
+   The subsumed patterns are always pruned. The rules and patterns that
+   can never match are only pruned if the abstract simulation supports the
+   rules.
+   \param space the initial space, any status on the input cells.
+   \param inputs the input cells, enabled or disabled depending on the row.
+   \param rates the rate of every rule, in the list order, pruned with it.
+   \return True if the rules and patterns that can never match were pruned.
+*/
+bool StaticPruning::prune(Grid space, vector<coordinate> &inputs, vector<double> &rates)
+{
+    pruneSubsumed();
+    
+    //The statuses every cell may have in any row
+    int height = space.getHeight();
+    vector<int> cells(space.getWidth() * height);
+    for (int x = 0; x < space.getWidth(); x++)
+    {
+        for (int y = 0; y < height; y++)
+        {
+            switch (space(x, y))
+            {
+                case nDISABLED:
+                    cells[x * height + y] = nMAYDISABLED;
+                    break;
+                case nENABLED:
+                    cells[x * height + y] = nMAYENABLED;
+                    break;
+                case nNOSPACE:
+                    cells[x * height + y] = nMAYNOSPACE;
+                    break;
+                default:
+                    cells[x * height + y] = nMAYENABLED | nMAYDISABLED;
+            }
+        }
+    }
+    for (unsigned int i = 0; i < inputs.size(); i++)
+    {
+        cells[inputs[i].x * height + inputs[i].y] = nMAYENABLED | nMAYDISABLED;
+    }
+    vector<bool> ruleFires(rules->size(), false);
+    vector<bool> patternMatches(patterns->size(), false);
+    {
+        TernarySimulation engine(rules, patterns);
+        if (!engine.reach(space.getWidth(), height, cells))
+        {
+            return false;
+        }
+        vector<bitInstance> &ruleInstances = engine.getPlacement().getRuleInstances();
+        for (unsigned int r = 0; r < ruleInstances.size(); r++)
+        {
+            if (!ruleFires[ruleInstances[r].index] && engine.mayMatch(ruleInstances[r], cells, false))
+            {
+                ruleFires[ruleInstances[r].index] = true;
+            }
+        }
+        vector<bitInstance> &patternInstances = engine.getPlacement().getPatternInstances();
+        for (unsigned int p = 0; p < patternInstances.size(); p++)
+        {
+            if (!patternMatches[patternInstances[p].index] && engine.mayMatch(patternInstances[p], cells, true))
+            {
+                patternMatches[patternInstances[p].index] = true;
+            }
+        }
+    }
+    
+    //The rates are kept aligned with the rules left
+    vector<double> ratesLeft;
+    int r = 0;
+    for (list<Rule>::iterator i = rules->begin(); i != rules->end(); r++)
+    {
+        if (ruleFires[r])
+        {
+            if (r < (int)rates.size())
+            {
+                ratesLeft.push_back(rates[r]);
+            }
+            i++;
+        }
+        else
+        {
+            i = rules->erase(i);
+            rulesPruned++;
+        }
+    }
+    rates = ratesLeft;
+    int p = 0;
+    for (list<ForbiddenPattern>::iterator i = patterns->begin(); i != patterns->end(); p++)
+    {
+        if (patternMatches[p])
+        {
+            i++;
+        }
+        else
+        {
+            i = patterns->erase(i);
+            patternsPruned++;
+        }
+    }
+    return true;
+}
+
+
+//! Returns the number of rules pruned.
+/*!
+   \return The rules that can never fire on the space.
+*/
+int StaticPruning::getRulesPruned()
+{
+    return rulesPruned;
+}
+
+
+//! Returns the number of patterns pruned because they never match.
+/*!
+   \return The patterns that can never match on the space.
+*/
+int StaticPruning::getPatternsPruned()
+{
+    return patternsPruned;
+}
+
+
+//! Returns the number of patterns pruned because others subsume them.
+/*!
+   \return The patterns subsumed by another pattern.
+*/
+int StaticPruning::getPatternsSubsumed()
+{
+    return patternsSubsumed;
+}
+
+
+//! Removes the patterns subsumed by another one.
+/*!
+   Subsumption is a strict order among different patterns, so every
+   pattern removed is subsumed by one of the patterns left.
+*/
+void StaticPruning::pruneSubsumed()
+{
+    vector<Grid> grids;
+    for (list<ForbiddenPattern>::iterator i = patterns->begin(); i != patterns->end(); i++)
+    {
+        grids.push_back((*i).getGrid());
+    }
+    int q = 0;
+    for (list<ForbiddenPattern>::iterator i = patterns->begin(); i != patterns->end(); q++)
+    {
+        bool subsumed = false;
+        for (unsigned int p = 0; p < grids.size() && !subsumed; p++)
+        {
+            subsumed = (int)p != q && !(grids[p] == grids[q]) && subsumes(grids[p], grids[q]);
+        }
+        if (subsumed)
+        {
+            i = patterns->erase(i);
+            patternsSubsumed++;
+        }
+        else
+        {
+            i++;
+        }
+    }
+}
+
+
+//! Tells if a pattern matches wherever another one does.
+/*!
+   The general pattern needs an enabled cell, so it is inside the space
+   whenever the specific one matches, even if the specific one is partly
+   out of the space.
+   \param general the pattern that may subsume the other.
+   \param specific the pattern that may be subsumed.
+   \return True if the general pattern fits in the specific one at some
+   position where every cell it needs is implied by the specific one.
+*/
+bool StaticPruning::subsumes(Grid &general, Grid &specific)
+{
+    bool enabled = false;
+    for (int i = 0; i < general.getWidth(); i++)
+    {
+        for (int j = 0; j < general.getHeight(); j++)
+        {
+            enabled = enabled || general(i, j) == nENABLED;
+        }
+    }
+    if (!enabled)
+    {
+        return false;
+    }
+    for (int left = 0; left + general.getWidth() <= specific.getWidth(); left++)
+    {
+        for (int top = 0; top + general.getHeight() <= specific.getHeight(); top++)
+        {
+            if (implies(general, specific, left, top))
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+
+//! Tells if a pattern at a position needs less than another one.
+/*!
+   Enabled and disabled cells need exactly that status, the rest of cells
+   need any status but not available, which every cell of the specific
+   pattern implies.
+   \param general the general pattern.
+   \param specific the specific pattern.
+   \param left the column of the general pattern on the specific one.
+   \param top the row of the general pattern on the specific one.
+   \return True if every cell of the general pattern is implied.
+*/
+bool StaticPruning::implies(Grid &general, Grid &specific, int left, int top)
+{
+    for (int i = 0; i < general.getWidth(); i++)
+    {
+        for (int j = 0; j < general.getHeight(); j++)
+        {
+            int needed = general(i, j);
+            if ((needed == nENABLED || needed == nDISABLED) && specific(left + i, top + j) != needed)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,69 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class StaticPruning
+ * \brief Removes the rules and patterns that can not affect a simulation.
+ * 
+ * Before simulating, the abstract simulation computes the statuses every
+ * cell of the space may ever have for any row. The rules that can not
+ * match anywhere, because their footprint always hits a cell that can
+ * never have the status they need, are removed, and so are the forbidden
+ * patterns that can never match. A forbidden pattern is also removed when
+ * another one always matches where it does, so the other one already
+ * stops the row.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef STATICPRUNING_HPP_
+#define STATICPRUNING_HPP_
+
+#include "ternarySimulation.hpp"
+#include <vector>
+#include <list>
+
+using namespace std;
+
+class StaticPruning
+{
+public:
+    StaticPruning(list<Rule> *rules, list<ForbiddenPattern> *patterns);
+    virtual ~StaticPruning();
+    bool prune(Grid space, vector<coordinate> &inputs, vector<double> &rates);
+    int getRulesPruned();
+    int getPatternsPruned();
+    int getPatternsSubsumed();
+
+private:
+    void pruneSubsumed();
+    bool subsumes(Grid &general, Grid &specific);
+    bool implies(Grid &general, Grid &specific, int left, int top);
+    
+    //! Rules to prune.
+    list<Rule> *rules;
+    //! Forbidden patterns to prune.
+    list<ForbiddenPattern> *patterns;
+    //! Number of rules that can never fire.
+    int rulesPruned;
+    //! Number of forbidden patterns that can never match.
+    int patternsPruned;
+    //! Number of forbidden patterns subsumed by another one.
+    int patternsSubsumed;
+};
+
+#endif /*STATICPRUNING_HPP_*/
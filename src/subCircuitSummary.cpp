@@ -0,0 +1,192 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "subCircuitSummary.hpp"
+#include <algorithm>
+
+using namespace std;
+
+
+//! Constructor.
+/*!
+   \param width the space width.
+   \param height the space height.
+*/
+SubCircuitSummary::SubCircuitSummary(int width, int height)
+{
+    this->width = width;
+    this->height = height;
+    covered.assign(width * height, false);
+    instances = 0;
+}
+
+
+//! Destructor.
+SubCircuitSummary::~SubCircuitSummary()
+{
+}
+
+
+//! Adds an instance of a sub-circuit.
+/*!
+   Every row of the table that enables an output becomes a rule of the size
+   of the instance, anchored on it. The rule consumes the enabled inputs, as
+   the sub-circuit does, so the instance does not fire again for the same
+   signals. The rows that leave every output disabled give no rule: their
+   inputs wait for the rest of the signals.
+   \param inputs the coordinates of the instance inputs, in table order.
+   \param outputs the coordinates of the instance outputs, in table order.
+   \param table the truth table of the sub-circuit.
+   \return False if the instance has no outputs or some of its inputs and
+   outputs are out of the space.
+*/
+bool SubCircuitSummary::addInstance(vector<coordinate> inputs, vector<coordinate> outputs, vector< vector<bool> > table)
+{
+    if (outputs.empty() || table.size() != (unsigned int)(1 << inputs.size()))
+    {
+        return false;
+    }
+    
+    //The instance covers the bounding box of its pins
+    vector<coordinate> instancePins = inputs;
+    instancePins.insert(instancePins.end(), outputs.begin(), outputs.end());
+    coordinate corner = instancePins[0];
+    coordinate last = instancePins[0];
+    for (unsigned int i = 0; i < instancePins.size(); i++)
+    {
+        if (!inside(instancePins[i]))
+        {
+            return false;
+        }
+        corner.x = min(corner.x, instancePins[i].x);
+        corner.y = min(corner.y, instancePins[i].y);
+        last.x = max(last.x, instancePins[i].x);
+        last.y = max(last.y, instancePins[i].y);
+    }
+    int boxWidth = last.x - corner.x + 1;
+    int boxHeight = last.y - corner.y + 1;
+    
+    for (unsigned int row = 0; row < table.size(); row++)
+    {
+        bool enables = false;
+        for (unsigned int k = 0; k < outputs.size(); k++)
+        {
+            enables = enables || table[row][k];
+        }
+        if (!enables)
+        {
+            continue;
+        }
+        
+        Grid initial(boxWidth, boxHeight);
+        Grid final(boxWidth, boxHeight);
+        //The first input is the most significant bit of the row
+        for (unsigned int k = 0; k < inputs.size(); k++)
+        {
+            bool value = (row >> (inputs.size() - 1 - k)) & 1;
+            initial(inputs[k].x - corner.x, inputs[k].y - corner.y) = value ? nENABLED : nDISABLED;
+            final(inputs[k].x - corner.x, inputs[k].y - corner.y) = nDISABLED;
+        }
+        for (unsigned int k = 0; k < outputs.size(); k++)
+        {
+            initial(outputs[k].x - corner.x, outputs[k].y - corner.y) = nDISABLED;
+            final(outputs[k].x - corner.x, outputs[k].y - corner.y) = table[row][k] ? nENABLED : nDISABLED;
+        }
+        Rule summary(boxWidth, boxHeight);
+        summary.setInitialGrid(initial);
+        summary.setFinalGrid(final);
+        summary.setAnchor(corner);
+        rules.push_back(summary);
+    }
+    
+    for (int i = corner.x; i <= last.x; i++)
+    {
+        for (int j = corner.y; j <= last.y; j++)
+        {
+            covered[i * height + j] = true;
+        }
+    }
+    pins.insert(pins.end(), instancePins.begin(), instancePins.end());
+    instances++;
+    return true;
+}
+
+
+//! Member accessor.
+/*!
+   \return The anchored rules summarizing the instances.
+*/
+list<Rule> SubCircuitSummary::getRules()
+{
+    return rules;
+}
+
+
+//! Returns the cells to leave out of the simulation.
+/*!
+   \return The cells covered by an instance that are not an input or an
+   output of any instance, indexed by x * height + y. Empty if there are no
+   instances.
+*/
+vector<bool> SubCircuitSummary::getFrozen()
+{
+    vector<bool> result;
+    if (instances == 0)
+    {
+        return result;
+    }
+    result = covered;
+    for (unsigned int i = 0; i < pins.size(); i++)
+    {
+        result[pins[i].x * height + pins[i].y] = false;
+    }
+    return result;
+}
+
+
+//! Member accessor.
+/*!
+   \return The inputs and outputs of all the instances.
+*/
+vector<coordinate> SubCircuitSummary::getPins()
+{
+    return pins;
+}
+
+
+//! Member accessor.
+/*!
+   \return The number of instances added.
+*/
+int SubCircuitSummary::getInstances()
+{
+    return instances;
+}
+
+
+//! Finds if a coordinate is in the space.
+/*!
+   \param c the coordinate.
+   \return True iif the coordinate is in the space.
+*/
+bool SubCircuitSummary::inside(coordinate c)
+{
+    return c.x >= 0 && c.x < width && c.y >= 0 && c.y < height;
+}
@@ -0,0 +1,71 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class SubCircuitSummary
+ * \brief Input to output summaries of verified sub-circuits.
+ * 
+ * A region of a space can be an instance of a sub-circuit already
+ * verified on its own with a truth table. The instance covers the bounding
+ * box of its inputs and outputs. Its inner cells are left out of the
+ * simulation, and every row of its table becomes a rule anchored on the
+ * instance: when the instance inputs hold the row values and its outputs
+ * are still disabled, the inputs are consumed and the outputs take the row
+ * values in one step. The
+ * simulation of a space built from many instances only explores their
+ * interface instead of their inner spaces.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef SUBCIRCUITSUMMARY_HPP_
+#define SUBCIRCUITSUMMARY_HPP_
+
+#include "rule.hpp"
+#include <vector>
+#include <list>
+
+using namespace std;
+
+class SubCircuitSummary
+{
+public:
+    SubCircuitSummary(int width, int height);
+    virtual ~SubCircuitSummary();
+    bool addInstance(vector<coordinate> inputs, vector<coordinate> outputs, vector< vector<bool> > table);
+    list<Rule> getRules();
+    vector<bool> getFrozen();
+    vector<coordinate> getPins();
+    int getInstances();
+    
+private:
+    bool inside(coordinate c);
+    //! Space width.
+    int width;
+    //! Space height.
+    int height;
+    //! Anchored rules of the instances.
+    list<Rule> rules;
+    //! Cells covered by the instances, indexed by x * height + y.
+    vector<bool> covered;
+    //! Inputs and outputs of the instances.
+    vector<coordinate> pins;
+    //! Number of instances.
+    int instances;
+};
+
+#endif /*SUBCIRCUITSUMMARY_HPP_*/
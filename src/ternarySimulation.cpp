@@ -0,0 +1,241 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "ternarySimulation.hpp"
+
+using namespace std;
+
+//! Constructor.
+/*!
+   The rules are referenced, not copied, so the list must outlive the
+   simulation.
+   \param rules the rule list to be applied.
+   \param patterns the forbidden pattern list to be found.
+*/
+TernarySimulation::TernarySimulation(list<Rule> *rules, list<ForbiddenPattern> *patterns) : placement(rules, patterns)
+{
+    width = -1;
+    height = -1;
+}
+
+
+//! Destructor.
+TernarySimulation::~TernarySimulation()
+{
+}
+
+
+//! Tells if a rule or pattern may match the reachable spaces.
+/*!
+   \param instance the rule or pattern placed at a coordinate.
+   \param cells the statuses every cell may have.
+   \param pattern true for a forbidden pattern, false for a rule.
+   \return False if some cell can never have the status the instance needs.
+*/
+bool TernarySimulation::mayMatch(bitInstance &instance, vector<int> &cells, bool pattern)
+{
+    for (unsigned int i = 0; i < instance.enabled.size(); i++)
+    {
+        if ((cells[instance.enabled[i]] & nMAYENABLED) == 0)
+        {
+            return false;
+        }
+    }
+    //Rules take not available cells as disabled, patterns do not
+    int disabled = pattern ? nMAYDISABLED : nMAYDISABLED | nMAYNOSPACE;
+    for (unsigned int i = 0; i < instance.disabled.size(); i++)
+    {
+        if ((cells[instance.disabled[i]] & disabled) == 0)
+        {
+            return false;
+        }
+    }
+    for (unsigned int i = 0; i < instance.space.size(); i++)
+    {
+        if ((cells[instance.space[i]] & (nMAYDISABLED | nMAYENABLED)) == 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//! Tries to verify a row.
+/*!
+   \param space the initial space of the row.
+   \param outputs the output coordinates of the table.
+   \param expected the output values of the row.
+   \param care the outputs that must have their value, false for the
+   don't-cares.
+   \return True if the row verifies the table for sure. False if the
+   abstraction is not precise enough or the row fails, the normal
+   simulation must be used then.
+*/
+bool TernarySimulation::verifies(Grid space, vector<coordinate> outputs, vector<bool> expected, vector<bool> care)
+{
+    vector<int> cells;
+    if (!reach(space, cells))
+    {
+        return false;
+    }
+    vector<bitInstance> &rules = placement.getRuleInstances();
+    vector<bitInstance> &patterns = placement.getPatternInstances();
+    
+    //An out of bounds may be found
+    for (unsigned int r = 0; r < rules.size(); r++)
+    {
+        bitInstance &instance = rules[r];
+        if (!mayMatch(instance, cells, false))
+        {
+            continue;
+        }
+        if (instance.outOfBounds)
+        {
+            return false;
+        }
+        for (unsigned int i = 0; i < instance.bounds.size(); i++)
+        {
+            if (cells[instance.bounds[i]] & nMAYNOSPACE)
+            {
+                return false;
+            }
+        }
+    }
+    for (unsigned int p = 0; p < patterns.size(); p++)
+    {
+        if (mayMatch(patterns[p], cells, true))
+        {
+            return false;
+        }
+    }
+    for (unsigned int o = 0; o < outputs.size(); o++)
+    {
+        int status = cells[outputs[o].x * height + outputs[o].y];
+        if (care[o] && status != (expected[o] ? nMAYENABLED : nMAYDISABLED))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//! Computes the statuses every cell may have.
+/*!
+   \param space the initial space of the row.
+   \param cells the statuses every cell may have in the spaces reachable
+   from the initial one, indexed by x * height + y.
+   \return False if the rules or the space can not be abstracted.
+*/
+bool TernarySimulation::reach(Grid space, vector<int> &cells)
+{
+    int spaceHeight = space.getHeight();
+    cells.assign(space.getWidth() * spaceHeight, 0);
+    for (int x = 0; x < space.getWidth(); x++)
+    {
+        for (int y = 0; y < spaceHeight; y++)
+        {
+            switch (space(x, y))
+            {
+                case nDISABLED:
+                    cells[x * spaceHeight + y] = nMAYDISABLED;
+                    break;
+                case nENABLED:
+                    cells[x * spaceHeight + y] = nMAYENABLED;
+                    break;
+                case nNOSPACE:
+                    cells[x * spaceHeight + y] = nMAYNOSPACE;
+                    break;
+                default:
+                    return false;
+            }
+        }
+    }
+    return reach(space.getWidth(), spaceHeight, cells);
+}
+
+
+//! Computes the statuses every cell may have from several initial spaces.
+/*!
+   \param width the width of the spaces.
+   \param height the height of the spaces.
+   \param cells the statuses every cell may have in the initial spaces,
+   indexed by x * height + y. Returns the statuses it may have in the
+   spaces reachable from them.
+   \return False if the rules can not be abstracted.
+*/
+bool TernarySimulation::reach(int width, int height, vector<int> &cells)
+{
+    if (!placement.isSupported())
+    {
+        return false;
+    }
+    if (width != this->width || height != this->height)
+    {
+        this->width = width;
+        this->height = height;
+        placement.buildInstances(width, height);
+    }
+    vector<bitInstance> &rules = placement.getRuleInstances();
+    
+    //Fire every rule that may match until the sets do not grow
+    bool changed = true;
+    while (changed)
+    {
+        changed = false;
+        for (unsigned int r = 0; r < rules.size(); r++)
+        {
+            bitInstance &instance = rules[r];
+            if (!mayMatch(instance, cells, false))
+            {
+                continue;
+            }
+            for (unsigned int i = 0; i < instance.writes.size(); i++)
+            {
+                int status = nMAYDISABLED;
+                if (instance.values[i] == nENABLED)
+                {
+                    status = nMAYENABLED;
+                }
+                else if (instance.values[i] == nNOSPACE)
+                {
+                    status = nMAYNOSPACE;
+                }
+                if ((cells[instance.writes[i]] & status) == 0)
+                {
+                    cells[instance.writes[i]] |= status;
+                    changed = true;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+
+//! Returns the rules and patterns placed at every coordinate.
+/*!
+   \return The placements of the last space abstracted.
+*/
+BitSimulation &TernarySimulation::getPlacement()
+{
+    return placement;
+}
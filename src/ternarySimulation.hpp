@@ -0,0 +1,73 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class TernarySimulation
+ * \brief Abstract simulation used to verify rows without exploring them.
+ * 
+ * Every cell holds the set of statuses it may have in any space reachable
+ * from the initial one. A rule fires whenever its initial configuration
+ * may match, adding the statuses it writes to the sets, until nothing
+ * changes. This takes polynomial time and over-approximates all the
+ * spaces of the row, so if no forbidden pattern nor out of bounds can
+ * match and the output cells can only have the expected status, the row
+ * verifies the table whatever the normal simulation would explore.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef TERNARYSIMULATION_HPP_
+#define TERNARYSIMULATION_HPP_
+
+#include "bitSimulation.hpp"
+#include <vector>
+#include <list>
+
+using namespace std;
+
+
+//! Statuses a cell may have, as bits of a set.
+enum TernaryStatus
+{
+    nMAYDISABLED = 1,
+    nMAYENABLED = 2,
+    nMAYNOSPACE = 4,
+    nMAYANY = 7
+};
+
+
+class TernarySimulation
+{
+public:
+    TernarySimulation(list<Rule> *rules, list<ForbiddenPattern> *patterns);
+    virtual ~TernarySimulation();
+    bool verifies(Grid space, vector<coordinate> outputs, vector<bool> expected, vector<bool> care);
+    bool reach(Grid space, vector<int> &cells);
+    bool reach(int width, int height, vector<int> &cells);
+    bool mayMatch(bitInstance &instance, vector<int> &cells, bool pattern);
+    BitSimulation &getPlacement();
+
+private:
+    //! Rules and patterns placed at every coordinate.
+    BitSimulation placement;
+    //! Width of the spaces the rules are placed on.
+    int width;
+    //! Height of the spaces the rules are placed on.
+    int height;
+};
+
+#endif /*TERNARYSIMULATION_HPP_*/
@@ -0,0 +1,801 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+// $Revision: 1.1 $
+
+#include "tileSimulation.hpp"
+#include <algorithm>
+
+using namespace std;
+
+
+//! Constructor.
+/*!
+   The rules are referenced, not copied, so the list must outlive the
+   simulation.
+   \param rules the rule list to be applied.
+   \param patterns the forbidden pattern list to be found.
+*/
+TileSimulation::TileSimulation(list<Rule> *rules, list<ForbiddenPattern> *patterns) : ternary(rules, patterns)
+{
+    width = -1;
+    height = -1;
+    simulated = 0;
+    reused = 0;
+    //Rules placed on a tile only reach this far from it
+    halo = 0;
+    for (list<Rule>::iterator i = rules->begin(); i != rules->end(); i++)
+    {
+        halo = max(halo, max((*i).getWidth(), (*i).getHeight()) - 1);
+    }
+    for (list<ForbiddenPattern>::iterator i = patterns->begin(); i != patterns->end(); i++)
+    {
+        halo = max(halo, max((*i).getWidth(), (*i).getHeight()) - 1);
+    }
+}
+
+
+//! Destructor.
+TileSimulation::~TileSimulation()
+{
+}
+
+
+//! Tries to solve a row simulating its tiles.
+/*!
+   \param space the initial space of the row.
+   \param outputs the output coordinates of the table.
+   \param expected the output values of the row.
+   \param care the outputs that must have their value, false for the
+   don't-cares.
+   \return True if the row has been solved, getVerifies tells then if it
+   verifies the table, and the failure found can be got with the accessors.
+   False if a tile has a cycle or is too big, the normal simulation must be
+   used then.
+*/
+bool TileSimulation::solve(Grid space, vector<coordinate> outputs, vector<bool> expected, vector<bool> care)
+{
+    verified = false;
+    stableSpaces = 1;
+    tileCount = 0;
+    stable.clear();
+    forbidden.clear();
+    outOfBounds.clear();
+    if (!simulateTiles(space, outputs))
+    {
+        return false;
+    }
+    tileCount = results.size();
+    
+    //A tile failure is a failure of the row, the other tiles wait on their
+    //initial spaces, so a tile failing there is taken first. Forbidden
+    //patterns are found before out of bounds on the same space
+    int failing = -1;
+    int best = 0;
+    for (unsigned int t = 0; t < results.size(); t++)
+    {
+        if (!results[t]->forbidden && !results[t]->outOfBounds)
+        {
+            continue;
+        }
+        int priority = results[t]->failure.empty() ? (results[t]->forbidden ? 3 : 2) : 1;
+        if (priority > best)
+        {
+            failing = t;
+            best = priority;
+        }
+    }
+    if (failing != -1)
+    {
+        vector<tileMove> moves;
+        addMoves(moves, results[failing]->failure, corners[failing]);
+        if (results[failing]->forbidden)
+        {
+            forbidden.push_back(getStep(space, moves));
+        }
+        else
+        {
+            outOfBounds.push_back(getStep(space, moves));
+        }
+        return true;
+    }
+    for (unsigned int t = 0; t < results.size(); t++)
+    {
+        if (!results[t]->complete || results[t]->cycle)
+        {
+            return false;
+        }
+    }
+    
+    //The stable spaces of the row are the combinations of the stable tiles
+    for (unsigned int t = 0; t < results.size(); t++)
+    {
+        map< vector<char>, vector<tileMove> > &tileOutputs = results[t]->outputs;
+        for (map< vector<char>, vector<tileMove> >::iterator i = tileOutputs.begin(); i != tileOutputs.end(); i++)
+        {
+            bool wrong = false;
+            for (unsigned int k = 0; k < indexes[t].size(); k++)
+            {
+                int o = indexes[t][k];
+                wrong = wrong || (care[o] && (*i).first[k] != (expected[o] ? nMAYENABLED : nMAYDISABLED));
+            }
+            if (!wrong)
+            {
+                continue;
+            }
+            //Every other tile goes to any stable space
+            vector<tileMove> moves;
+            for (unsigned int u = 0; u < results.size(); u++)
+            {
+                addMoves(moves, u == t ? (*i).second : (*results[u]->outputs.begin()).second, corners[u]);
+            }
+            stable.push_back(getStep(space, moves));
+            return true;
+        }
+        stableSpaces *= results[t]->stable;
+    }
+    verified = true;
+    return true;
+}
+
+
+//! Finds the cells of a row that can not affect its outputs.
+/*!
+   The tiles without outputs that never fail nor cycle do not change the
+   result of the row, so they can be left on their initial spaces.
+   \param space the initial space of the row.
+   \param outputs the output coordinates of the table.
+   \param frozen tells for every cell, indexed by x * height + y, if it
+   can be left on its initial status. Empty if the row can not be sliced.
+   \return The number of cells that can be left on their initial status.
+*/
+int TileSimulation::slice(Grid space, vector<coordinate> outputs, vector<bool> &frozen)
+{
+    frozen.clear();
+    if (!simulateTiles(space, outputs))
+    {
+        return 0;
+    }
+    frozen.assign(width * height, true);
+    for (unsigned int t = 0; t < results.size(); t++)
+    {
+        if (results[t]->forbidden || results[t]->outOfBounds)
+        {
+            frozen.clear();
+            return 0;
+        }
+        //Tiles with outputs, cycles or too many spaces are simulated
+        if (!indexes[t].empty() || !results[t]->complete || results[t]->cycle)
+        {
+            vector<int> &tile = members[roots[t]];
+            for (unsigned int i = 0; i < tile.size(); i++)
+            {
+                frozen[tile[i]] = false;
+            }
+        }
+    }
+    int count = 0;
+    for (unsigned int c = 0; c < frozen.size(); c++)
+    {
+        count += frozen[c] ? 1 : 0;
+    }
+    if (count == 0)
+    {
+        frozen.clear();
+    }
+    return count;
+}
+
+
+//! Splits a space into tiles and simulates them.
+/*!
+   The tiles with rules, patterns or outputs are left in results, along
+   with their cells, halo corners and output indexes.
+   \param space the initial space of the row.
+   \param outputs the output coordinates of the table.
+   \return False if the space can not be split.
+*/
+bool TileSimulation::simulateTiles(Grid &space, vector<coordinate> &outputs)
+{
+    vector<int> cells;
+    if (!ternary.reach(space, cells))
+    {
+        return false;
+    }
+    width = space.getWidth();
+    height = space.getHeight();
+    vector<bitInstance> &rules = ternary.getPlacement().getRuleInstances();
+    vector<bitInstance> &patterns = ternary.getPlacement().getPatternInstances();
+    
+    //Join the cells of every rule and pattern that may match
+    parent.resize(width * height);
+    for (unsigned int c = 0; c < parent.size(); c++)
+    {
+        parent[c] = c;
+    }
+    vector< vector<int> > tileRules(width * height);
+    vector< vector<int> > tilePatterns(width * height);
+    vector<bool> used(width * height, false);
+    for (unsigned int r = 0; r < rules.size(); r++)
+    {
+        if (!ternary.mayMatch(rules[r], cells, false))
+        {
+            continue;
+        }
+        vector<int> covered;
+        getCells(rules[r], covered);
+        //It may match the whole space or put molecules out of it forever
+        if (covered.empty())
+        {
+            return false;
+        }
+        join(covered);
+        used[covered[0]] = true;
+    }
+    for (unsigned int p = 0; p < patterns.size(); p++)
+    {
+        if (!ternary.mayMatch(patterns[p], cells, true))
+        {
+            continue;
+        }
+        vector<int> covered;
+        getCells(patterns[p], covered);
+        if (covered.empty())
+        {
+            return false;
+        }
+        join(covered);
+        used[covered[0]] = true;
+    }
+    for (unsigned int r = 0; r < rules.size(); r++)
+    {
+        vector<int> covered;
+        getCells(rules[r], covered);
+        if (!covered.empty() && ternary.mayMatch(rules[r], cells, false))
+        {
+            tileRules[findRoot(covered[0])].push_back(r);
+        }
+    }
+    for (unsigned int p = 0; p < patterns.size(); p++)
+    {
+        vector<int> covered;
+        getCells(patterns[p], covered);
+        if (!covered.empty() && ternary.mayMatch(patterns[p], cells, true))
+        {
+            tilePatterns[findRoot(covered[0])].push_back(p);
+        }
+    }
+    
+    //Cells of every tile, in order
+    members.assign(width * height, vector<int>());
+    position.resize(width * height);
+    for (int c = 0; c < width * height; c++)
+    {
+        int root = findRoot(c);
+        position[c] = members[root].size();
+        members[root].push_back(c);
+    }
+    vector<bool> isOutput(width * height, false);
+    vector<int> outputIndex(width * height, -1);
+    for (unsigned int o = 0; o < outputs.size(); o++)
+    {
+        int c = outputs[o].x * height + outputs[o].y;
+        isOutput[c] = true;
+        outputIndex[c] = o;
+    }
+    
+    results.clear();
+    corners.clear();
+    indexes.clear();
+    roots.clear();
+    for (int root = 0; root < width * height; root++)
+    {
+        vector<int> &tile = members[root];
+        if (tile.empty())
+        {
+            continue;
+        }
+        vector<int> tileOutputs;
+        vector<int> tileIndexes;
+        vector<char> start;
+        bool active = false;
+        for (unsigned int i = 0; i < tile.size(); i++)
+        {
+            int status = space(tile[i] / height, tile[i] % height);
+            start.push_back(status == nENABLED ? nMAYENABLED : status == nNOSPACE ? nMAYNOSPACE : nMAYDISABLED);
+            if (isOutput[tile[i]])
+            {
+                tileOutputs.push_back(i);
+                tileIndexes.push_back(outputIndex[tile[i]]);
+            }
+            active = active || used[tile[i]];
+        }
+        //Tiles without rules, patterns nor outputs do not matter
+        if (!active && tileOutputs.empty())
+        {
+            continue;
+        }
+        
+        coordinate corner;
+        vector<char> key = getKey(tile, start, isOutput, corner);
+        map< vector<char>, tileResult >::iterator found = tiles.find(key);
+        if (found == tiles.end())
+        {
+            tileResult result;
+            simulate(start, tileRules[root], tilePatterns[root], tileOutputs, corner, result);
+            found = tiles.insert(pair< vector<char>, tileResult >(key, result)).first;
+            simulated++;
+        }
+        else
+        {
+            reused++;
+        }
+        results.push_back(&(*found).second);
+        roots.push_back(root);
+        corners.push_back(corner);
+        indexes.push_back(tileIndexes);
+    }
+    return true;
+}
+
+
+//! Gets the cells of the space covered by a rule or pattern.
+/*!
+   \param instance the rule or pattern placed at a coordinate.
+   \param cells the cells covered.
+*/
+void TileSimulation::getCells(bitInstance &instance, vector<int> &cells)
+{
+    cells = instance.enabled;
+    cells.insert(cells.end(), instance.disabled.begin(), instance.disabled.end());
+    cells.insert(cells.end(), instance.space.begin(), instance.space.end());
+    cells.insert(cells.end(), instance.writes.begin(), instance.writes.end());
+    cells.insert(cells.end(), instance.bounds.begin(), instance.bounds.end());
+}
+
+
+//! Finds the tile of a cell.
+/*!
+   \param cell the cell.
+   \return The cell representing its tile.
+*/
+int TileSimulation::findRoot(int cell)
+{
+    while (parent[cell] != cell)
+    {
+        parent[cell] = parent[parent[cell]];
+        cell = parent[cell];
+    }
+    return cell;
+}
+
+
+//! Puts some cells in the same tile.
+/*!
+   \param cells the cells.
+*/
+void TileSimulation::join(vector<int> &cells)
+{
+    int root = findRoot(cells[0]);
+    for (unsigned int i = 1; i < cells.size(); i++)
+    {
+        int other = findRoot(cells[i]);
+        if (other != root)
+        {
+            //The lowest cell represents the tile
+            parent[max(root, other)] = min(root, other);
+            root = min(root, other);
+        }
+    }
+}
+
+
+//! Gets the key a tile result is stored under.
+/*!
+   The key holds the statuses of the tile and the halo around it, with the
+   cells of other tiles and the cells out of the space marked, so it does
+   not depend on where the tile is.
+   \param tile the cells of the tile, in order.
+   \param start the initial statuses of the tile cells.
+   \param isOutput tells if every cell is an output.
+   \param corner the top left corner of the halo.
+   \return The key.
+*/
+vector<char> TileSimulation::getKey(vector<int> &tile, vector<char> &start, vector<bool> &isOutput, coordinate &corner)
+{
+    int left = width, top = height, right = -1, bottom = -1;
+    for (unsigned int i = 0; i < tile.size(); i++)
+    {
+        left = min(left, tile[i] / height);
+        right = max(right, tile[i] / height);
+        top = min(top, tile[i] % height);
+        bottom = max(bottom, tile[i] % height);
+    }
+    left -= halo;
+    top -= halo;
+    right += halo;
+    bottom += halo;
+    corner.x = left;
+    corner.y = top;
+    
+    vector<char> key;
+    int sizes[2] = {right - left + 1, bottom - top + 1};
+    for (int k = 0; k < 2; k++)
+    {
+        for (int b = 0; b < 4; b++)
+        {
+            key.push_back((char)((sizes[k] >> (8 * b)) & 0xFF));
+        }
+    }
+    int root = findRoot(tile[0]);
+    for (int x = left; x <= right; x++)
+    {
+        for (int y = top; y <= bottom; y++)
+        {
+            if (x < 0 || x >= width || y < 0 || y >= height)
+            {
+                key.push_back(8);
+                continue;
+            }
+            int c = x * height + y;
+            if (findRoot(c) != root)
+            {
+                key.push_back(9);
+                continue;
+            }
+            key.push_back(start[position[c]] | (isOutput[c] ? 16 : 0));
+        }
+    }
+    return key;
+}
+
+
+//! Simulates a tile alone.
+/*!
+   \param start the initial statuses of the tile cells.
+   \param rules the rules that may match on the tile.
+   \param patterns the patterns that may match on the tile.
+   \param outputs the positions of the output cells in the tile.
+   \param corner the top left corner of the tile halo.
+   \param result the result of the simulation.
+*/
+void TileSimulation::simulate(vector<char> &start, vector<int> &rules, vector<int> &patterns, vector<int> &outputs, coordinate corner, tileResult &result)
+{
+    result.complete = true;
+    result.cycle = false;
+    result.forbidden = false;
+    result.outOfBounds = false;
+    result.stable = 0;
+    vector<bitInstance> &ruleSet = ternary.getPlacement().getRuleInstances();
+    vector<bitInstance> &patternSet = ternary.getPlacement().getPatternInstances();
+    //Spaces on the current path are marked with 1, finished ones with 2
+    map< vector<char>, char > marks;
+    vector< vector<char> > path;
+    //Rule placements leading to every space of the path
+    vector<int> taken;
+    vector< vector< vector<char> > > successors;
+    vector< vector<int> > applied;
+    vector<unsigned int> next;
+    vector<char> pending = start;
+    taken.push_back(-1);
+    bool push = true;
+    while (true)
+    {
+        if (push)
+        {
+            push = false;
+            if (marks.size() >= TILE_SPACES)
+            {
+                result.complete = false;
+                return;
+            }
+            for (unsigned int p = 0; p < patterns.size(); p++)
+            {
+                if (matches(patternSet[patterns[p]], pending, true))
+                {
+                    result.forbidden = true;
+                    result.failure = getMoves(taken, corner);
+                    return;
+                }
+            }
+            vector< vector<char> > following;
+            vector<int> instances;
+            for (unsigned int r = 0; r < rules.size(); r++)
+            {
+                bitInstance &instance = ruleSet[rules[r]];
+                if (!matches(instance, pending, false))
+                {
+                    continue;
+                }
+                bool outside = instance.outOfBounds;
+                for (unsigned int i = 0; i < instance.bounds.size(); i++)
+                {
+                    outside = outside || pending[position[instance.bounds[i]]] == nMAYNOSPACE;
+                }
+                if (outside)
+                {
+                    result.outOfBounds = true;
+                    result.failure = getMoves(taken, corner);
+                    return;
+                }
+                vector<char> space = pending;
+                for (unsigned int i = 0; i < instance.writes.size(); i++)
+                {
+                    int value = instance.values[i];
+                    space[position[instance.writes[i]]] = value == nENABLED ? nMAYENABLED : value == nNOSPACE ? nMAYNOSPACE : nMAYDISABLED;
+                }
+                following.push_back(space);
+                instances.push_back(rules[r]);
+            }
+            if (following.empty())
+            {
+                vector<char> statuses;
+                for (unsigned int k = 0; k < outputs.size(); k++)
+                {
+                    statuses.push_back(pending[outputs[k]]);
+                }
+                if (result.outputs.find(statuses) == result.outputs.end())
+                {
+                    result.outputs[statuses] = getMoves(taken, corner);
+                }
+                result.stable++;
+                marks[pending] = 2;
+                taken.pop_back();
+            }
+            else
+            {
+                marks[pending] = 1;
+                path.push_back(pending);
+                successors.push_back(following);
+                applied.push_back(instances);
+                next.push_back(0);
+            }
+        }
+        if (path.empty())
+        {
+            return;
+        }
+        
+        unsigned int top = path.size() - 1;
+        if (next[top] == successors[top].size())
+        {
+            marks[path[top]] = 2;
+            path.pop_back();
+            taken.pop_back();
+            successors.pop_back();
+            applied.pop_back();
+            next.pop_back();
+            continue;
+        }
+        vector<char> space = successors[top][next[top]];
+        int instance = applied[top][next[top]];
+        next[top]++;
+        map< vector<char>, char >::iterator found = marks.find(space);
+        if (found == marks.end())
+        {
+            pending = space;
+            taken.push_back(instance);
+            push = true;
+        }
+        else if ((*found).second == 1)
+        {
+            result.cycle = true;
+            return;
+        }
+    }
+}
+
+
+//! Gets the moves of a path of the tile.
+/*!
+   \param instances the rule placements of the path, the first one is not
+   used.
+   \param corner the top left corner of the tile halo.
+   \return The moves, relative to the corner.
+*/
+vector<tileMove> TileSimulation::getMoves(vector<int> &instances, coordinate corner)
+{
+    vector<bitInstance> &ruleSet = ternary.getPlacement().getRuleInstances();
+    vector<tileMove> result;
+    for (unsigned int i = 1; i < instances.size(); i++)
+    {
+        tileMove move;
+        move.rule = ruleSet[instances[i]].index;
+        move.x = ruleSet[instances[i]].c.x - corner.x;
+        move.y = ruleSet[instances[i]].c.y - corner.y;
+        result.push_back(move);
+    }
+    return result;
+}
+
+
+//! Adds the moves of a tile to a path of the space.
+/*!
+   \param moves the moves of the space.
+   \param tileMoves the moves of the tile, relative to its halo corner.
+   \param corner the top left corner of the tile halo.
+*/
+void TileSimulation::addMoves(vector<tileMove> &moves, vector<tileMove> &tileMoves, coordinate corner)
+{
+    for (unsigned int i = 0; i < tileMoves.size(); i++)
+    {
+        tileMove move = tileMoves[i];
+        move.x += corner.x;
+        move.y += corner.y;
+        moves.push_back(move);
+    }
+}
+
+
+//! Builds the simulation step reached applying some moves.
+/*!
+   \param space the initial space of the row.
+   \param moves the rules to apply, placed on the space.
+   \return The simulation step, as the normal simulation builds it.
+*/
+simulationStep TileSimulation::getStep(Grid space, vector<tileMove> &moves)
+{
+    simulationStep result;
+    for (unsigned int m = 0; m < moves.size(); m++)
+    {
+        Rule *rule = ternary.getPlacement().getRule(moves[m].rule);
+        spaceHighlighted step;
+        step.g = space;
+        step.h.top = moves[m].y - rule->getHeight() + 1;
+        step.h.left = moves[m].x - rule->getWidth() + 1;
+        step.h.width = rule->getWidth();
+        step.h.height = rule->getHeight();
+        result.path.push_back(step);
+        matrix finalCells = rule->getFinalMatrix();
+        for (int i = 0; i < rule->getWidth(); i++)
+        {
+            for (int j = 0; j < rule->getHeight(); j++)
+            {
+                int x = step.h.left + i;
+                int y = step.h.top + j;
+                if (x >= 0 && x < width && y >= 0 && y < height && finalCells[i][j] != nDONTCARE)
+                {
+                    space(x, y) = finalCells[i][j];
+                }
+            }
+        }
+    }
+    result.space.g = space;
+    result.space.h.top = result.space.h.left = result.space.h.width = result.space.h.height = 0;
+    result.matched = false;
+    return result;
+}
+
+
+//! Tells if a rule or pattern matches a tile.
+/*!
+   \param instance the rule or pattern placed at a coordinate.
+   \param space the statuses of the tile cells, as sets with one status.
+   \param pattern true for a forbidden pattern, false for a rule.
+   \return True if the instance matches the tile.
+*/
+bool TileSimulation::matches(bitInstance &instance, vector<char> &space, bool pattern)
+{
+    for (unsigned int i = 0; i < instance.enabled.size(); i++)
+    {
+        if (space[position[instance.enabled[i]]] != nMAYENABLED)
+        {
+            return false;
+        }
+    }
+    //Rules take not available cells as disabled, patterns do not
+    int disabled = pattern ? nMAYDISABLED : nMAYDISABLED | nMAYNOSPACE;
+    for (unsigned int i = 0; i < instance.disabled.size(); i++)
+    {
+        if ((space[position[instance.disabled[i]]] & disabled) == 0)
+        {
+            return false;
+        }
+    }
+    for (unsigned int i = 0; i < instance.space.size(); i++)
+    {
+        if (space[position[instance.space[i]]] == nMAYNOSPACE)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//! Tells if the last row solved verifies the table.
+/*!
+   \return True if the row verifies the table.
+*/
+bool TileSimulation::getVerifies()
+{
+    return verified;
+}
+
+
+//! Returns the number of stable spaces of the last row verified.
+/*!
+   \return The product of the stable spaces of its tiles.
+*/
+double TileSimulation::getStableSpaces()
+{
+    return stableSpaces;
+}
+
+
+//! Returns the number of tiles of the last row.
+/*!
+   \return The tiles with rules, patterns or outputs.
+*/
+int TileSimulation::getTiles()
+{
+    return tileCount;
+}
+
+
+//! Returns the stable space with wrong outputs found.
+/*!
+   \return A list with the space, empty if the row has another failure or
+   verifies the table.
+*/
+list<simulationStep> TileSimulation::getStableLayouts()
+{
+    return stable;
+}
+
+
+//! Returns the forbidden space found.
+/*!
+   \return A list with the space, empty if the row has another failure or
+   verifies the table.
+*/
+list<simulationStep> TileSimulation::getForbiddenLayouts()
+{
+    return forbidden;
+}
+
+
+//! Returns the out of bounds space found.
+/*!
+   \return A list with the space, empty if the row has another failure or
+   verifies the table.
+*/
+list<simulationStep> TileSimulation::getOutOfBounds()
+{
+    return outOfBounds;
+}
+
+
+//! Returns the number of tiles simulated.
+/*!
+   \return The tiles simulated since the object was created.
+*/
+int TileSimulation::getSimulated()
+{
+    return simulated;
+}
+
+
+//! Returns the number of tiles whose result has been reused.
+/*!
+   \return The tiles not simulated since the object was created.
+*/
+int TileSimulation::getReused()
+{
+    return reused;
+}
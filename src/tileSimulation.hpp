@@ -0,0 +1,143 @@
+/*
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+                                                                          */
+
+/**
+ * \class TileSimulation
+ * \brief Memoized simulation of the independent regions of a space.
+ * 
+ * The cells of a space are split into tiles: two cells are in the same
+ * tile if a rule or a forbidden pattern that may match, according to the
+ * abstract simulation, covers both. No rule links two tiles, so every tile
+ * evolves on its own: the stable spaces of the row are the combinations of
+ * the stable tiles, and a tile failure is a failure of the row. Every tile
+ * is simulated alone once, and its result is stored under the contents of
+ * the tile and of a halo of the size of the rules around it. Identical
+ * tiles anywhere in the space or in the next rows reuse the stored result
+ * instead of being simulated again. The interleavings of the tiles are
+ * never explored.
+ * \version $Revision: 1.1 $
+ */
+
+#ifndef TILESIMULATION_HPP_
+#define TILESIMULATION_HPP_
+
+#include "ternarySimulation.hpp"
+#include <vector>
+#include <list>
+#include <map>
+
+//! Maximum number of spaces of a tile simulated alone.
+#define TILE_SPACES 20000
+
+using namespace std;
+
+
+//! Tile move struct.
+/*! A rule applied on a tile, placed relative to the tile halo corner. */
+struct tileMove
+{
+    int rule; /*!< Rule index. */
+    int x; /*!< Horizontal coordinate of the rule placement. */
+    int y; /*!< Vertical coordinate of the rule placement. */
+};
+
+
+//! Tile result struct.
+/*! The outcome of a tile simulated alone. */
+struct tileResult
+{
+    bool complete; /*!< False if the tile had too many spaces to simulate. */
+    bool cycle; /*!< True if the tile has a cycle. */
+    bool forbidden; /*!< True if the tile reaches a forbidden pattern. */
+    bool outOfBounds; /*!< True if the tile reaches an out of bounds. */
+    vector<tileMove> failure; /*!< Moves leading to the forbidden pattern or out of bounds. */
+    double stable; /*!< Number of stable spaces of the tile. */
+    map< vector<char>, vector<tileMove> > outputs; /*!< Statuses of the output cells on the stable spaces, and the moves leading to one of them. */
+};
+
+
+class TileSimulation
+{
+public:
+    TileSimulation(list<Rule> *rules, list<ForbiddenPattern> *patterns);
+    virtual ~TileSimulation();
+    bool solve(Grid space, vector<coordinate> outputs, vector<bool> expected, vector<bool> care);
+    int slice(Grid space, vector<coordinate> outputs, vector<bool> &frozen);
+    bool getVerifies();
+    double getStableSpaces();
+    int getTiles();
+    list<simulationStep> getStableLayouts();
+    list<simulationStep> getForbiddenLayouts();
+    list<simulationStep> getOutOfBounds();
+    int getSimulated();
+    int getReused();
+
+private:
+    bool simulateTiles(Grid &space, vector<coordinate> &outputs);
+    int findRoot(int cell);
+    void join(vector<int> &cells);
+    vector<char> getKey(vector<int> &tile, vector<char> &start, vector<bool> &isOutput, coordinate &corner);
+    void simulate(vector<char> &start, vector<int> &rules, vector<int> &patterns, vector<int> &outputs, coordinate corner, tileResult &result);
+    vector<tileMove> getMoves(vector<int> &instances, coordinate corner);
+    void addMoves(vector<tileMove> &moves, vector<tileMove> &tileMoves, coordinate corner);
+    simulationStep getStep(Grid space, vector<tileMove> &moves);
+    bool matches(bitInstance &instance, vector<char> &space, bool pattern);
+    void getCells(bitInstance &instance, vector<int> &cells);
+    //! Abstract simulation, it also places the rules and patterns.
+    TernarySimulation ternary;
+    //! Width of the last space.
+    int width;
+    //! Height of the last space.
+    int height;
+    //! Cells outside the tiles the rules can reach.
+    int halo;
+    //! Union-find parent of every cell.
+    vector<int> parent;
+    //! Position of every cell in its tile.
+    vector<int> position;
+    //! Cells of every tile, by the cell representing it.
+    vector< vector<int> > members;
+    //! Results of the tiles of the last space with rules, patterns or outputs.
+    vector<tileResult*> results;
+    //! Cell representing every tile of the last space.
+    vector<int> roots;
+    //! Top left corner of the halo of every tile of the last space.
+    vector<coordinate> corners;
+    //! Table output indexes of the output cells of every tile of the last space.
+    vector< vector<int> > indexes;
+    //! Results of the tiles simulated, by the contents of the tile.
+    map< vector<char>, tileResult > tiles;
+    //! Does the last row solved verify the table?
+    bool verified;
+    //! Number of stable spaces of the last row verified.
+    double stableSpaces;
+    //! Number of tiles with rules, patterns or outputs of the last row.
+    int tileCount;
+    //! Stable space with wrong outputs found.
+    list<simulationStep> stable;
+    //! Forbidden space found.
+    list<simulationStep> forbidden;
+    //! Out of bounds space found.
+    list<simulationStep> outOfBounds;
+    //! Number of tiles simulated.
+    int simulated;
+    //! Number of tiles whose result has been reused.
+    int reused;
+};
+
+#endif /*TILESIMULATION_HPP_*/
@@ -16,32 +16,25 @@
  *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
                                                                           */
 
-// $Revision: 1.8 $
+// $Revision: 1.9 $
 
 #include "truthTable.hpp"
-#include <math.h>
 #include <iostream>
 
 //! Constructor.
 /*!
+   No values are stored until an output is set, every output is false.
    \param name the table name.
    \param inputs the table number of inputs.
    \param outputs the table number of outputs.
 */
 TruthTable::TruthTable(wxString name, int inputs, int outputs)
 {
-    table.resize((int)(pow(2, (double)inputs)));
-    //We have 2^inputs outputs, so we must
-    //initialize 2^input false values
-    for (unsigned int i = 0; i < table.size(); i++)
-    {
-        table[i].resize(outputs);
-        for (unsigned int j = 0; j < table[i].size(); j++)
-        {
-            table[i][j] = false;
-        }
-    }
-    
+    columns.resize(outputs);
+    careColumns.resize(outputs);
+    expressions.resize(outputs);
+    programs.resize(outputs);
+
     this->inputs = inputs;
     this->outputs = outputs;
     this->name = name;
@@ -51,7 +44,7 @@ TruthTable::TruthTable(wxString name, int inputs, int outputs)
 //! Constructor.
 /*!
    Builds an empty table.
-*/   
+*/
 TruthTable::TruthTable()
 {
     inputs = 0;
@@ -72,7 +65,44 @@ TruthTable::~TruthTable()
 */
 vector<bool> TruthTable::getOutput(vector<bool> input)
 {
-    return table[getIndex(input)];
+    return getOutput(getIndex(input));
+}
+
+
+//! Returns the outputs of a row.
+/*!
+   \param row the row index.
+   \return The values of the outputs of the row.
+*/
+vector<bool> TruthTable::getOutput(int row)
+{
+    vector<bool> result(outputs);
+    for (int i = 0; i < outputs; i++)
+    {
+        result[i] = getOutput(row, i);
+    }
+    return result;
+}
+
+
+//! Returns a concrete output of a row.
+/*!
+   The expression outputs are evaluated for the row.
+   \param row the row index.
+   \param output the output number.
+   \return The output value in the row.
+*/
+bool TruthTable::getOutput(int row, int output)
+{
+    if (!programs[output].empty())
+    {
+        return evaluate(programs[output], row);
+    }
+    if (columns[output].empty())
+    {
+        return false;
+    }
+    return columns[output][row];
 }
 
 
@@ -94,7 +124,7 @@ int TruthTable::getIndex(vector<bool> input)
         if (input[input.size() - 1 - i])
         {
             result += base;
-        } 
+        }
         base *= 2;
     }
     return result;
@@ -109,7 +139,49 @@ int TruthTable::getIndex(vector<bool> input)
 */
 void TruthTable::setOutput(vector<bool> input, vector<bool> output)
 {
-    table[getIndex(input)] = output;
+    int row = getIndex(input);
+    for (unsigned int i = 0; i < output.size(); i++)
+    {
+        setOutput(row, i, output[i]);
+    }
+}
+
+
+//! Sets a concrete output of an input combination.
+/*!
+   \param input the input combination.
+   \param output the output number.
+   \param value the output value.
+*/
+void TruthTable::setOutput(vector<bool> input, int output, bool value)
+{
+    setOutput(getIndex(input), output, value);
+}
+
+
+//! Sets a concrete output of a row.
+/*!
+   An output defined by an expression keeps the values of the expression
+   for the rest of rows.
+   \param row the row index.
+   \param output the output number.
+   \param value the output value.
+*/
+void TruthTable::setOutput(int row, int output, bool value)
+{
+    if (!programs[output].empty())
+    {
+        storeExpression(output);
+    }
+    if (columns[output].empty())
+    {
+        if (!value)
+        {
+            return;
+        }
+        columns[output].assign(getRows(), false);
+    }
+    columns[output][row] = value;
 }
 
 
@@ -133,15 +205,35 @@ int TruthTable::getOutputs()
 }
 
 
+//! Returns the number of rows of the table.
+/*!
+   \return 2^inputs.
+*/
+int TruthTable::getRows()
+{
+    return 1 << inputs;
+}
+
+
 //! Returns the outputs of an input combination.
 /*!
    \param input the input combination ("1" = true, "0" = false).
-   \return The outputs of the input combination in string form ("1" = true, "0" = false).
+   \return The outputs of the input combination in string form ("1" = true,
+   "0" = false, "X" = don't-care).
 */
 wxString TruthTable::getOutput(wxString input)
 {
     vector<bool> vInput = stringToVector(input);
-    return vectorToString(getOutput(vInput));
+    wxString result = vectorToString(getOutput(vInput));
+    vector<bool> vCare = getCare(vInput);
+    for (unsigned int i = 0; i < vCare.size(); i++)
+    {
+        if (!vCare[i])
+        {
+            result[i] = 'X';
+        }
+    }
+    return result;
 }
 
 
@@ -154,7 +246,7 @@ wxString TruthTable::getOutput(wxString input)
 */
 bool TruthTable::getOutput(vector<bool> input, int output)
 {
-    return getOutput(input)[output];
+    return getOutput(getIndex(input), output);
 }
 
 
@@ -167,22 +259,61 @@ bool TruthTable::getOutput(vector<bool> input, int output)
 */
 bool TruthTable::getOutput(wxString input, int output)
 {
-    vector<bool> vInput = stringToVector(input);
-    return getOutput(vInput)[output];
+    return getOutput(getIndex(input), output);
 }
-    
-    
+
+
 //! Sets the output values for an input combination.
 /*!
+   An "X" input sets the rows with both values of the input, and an "X"
+   output is a don't-care.
    \param input the input combination in string form.
    \param output the output values for the input combination in string form.
    \sa setOutput(vector<bool> input, vector<bool> output)
 */
 void TruthTable::setOutput(wxString input, wxString output)
 {
-    vector<bool> vInput = stringToVector(input);
     vector<bool> vOutput = stringToVector(output);
-    setOutput(vInput, vOutput);
+    vector<bool> vCare(output.length(), true);
+    for (unsigned int i = 0; i < output.length(); i++)
+    {
+        if (output[i] == 'X' || output[i] == 'x')
+        {
+            vOutput[i] = false;
+            vCare[i] = false;
+        }
+    }
+    setCube(input, 0, vOutput, vCare);
+}
+
+
+//! Sets the outputs of every row matching a partial input combination.
+/*!
+   \param input the input combination in string form, "X" for both values.
+   \param position the first input not expanded yet.
+   \param output the output values.
+   \param outputCare the outputs that must have their value.
+*/
+void TruthTable::setCube(wxString input, unsigned int position, vector<bool> &output, vector<bool> &outputCare)
+{
+    while (position < input.length() && input[position] != 'X' && input[position] != 'x')
+    {
+        position++;
+    }
+    if (position < input.length())
+    {
+        input[position] = '0';
+        setCube(input, position + 1, output, outputCare);
+        input[position] = '1';
+        setCube(input, position + 1, output, outputCare);
+        return;
+    }
+    int index = getIndex(input);
+    for (unsigned int i = 0; i < output.size(); i++)
+    {
+        setOutput(index, i, output[i]);
+        setCare(index, i, outputCare[i]);
+    }
 }
 
 
@@ -222,7 +353,7 @@ vector <bool> TruthTable::stringToVector(wxString input)
             result[i] = true;
         }
     }
-    
+
     return result;
 }
 
@@ -247,19 +378,451 @@ wxString TruthTable::vectorToString(vector<bool> input)
             result += '0';
         }
     }
-    
+
     return result;
 }
 
 
 //! Returns the table.
 /*!
+   The expression outputs are evaluated for every row.
    \return A vector of vector of booleans containing the output values
    of the table (the inputs can be recreated).
 */
 vector< vector<bool> > TruthTable::getTable()
 {
-    return table;
+    vector< vector<bool> > result(getRows());
+    for (unsigned int i = 0; i < result.size(); i++)
+    {
+        result[i] = getOutput(i);
+    }
+    return result;
+}
+
+
+//! Returns the outputs that must have their value for an input combination.
+/*!
+   \param input the input combination.
+   \return True for the outputs with a value, false for the don't-cares.
+*/
+vector<bool> TruthTable::getCare(vector<bool> input)
+{
+    return getCare(getIndex(input));
+}
+
+
+//! Returns the outputs of a row that must have their value.
+/*!
+   \param row the row index.
+   \return True for the outputs with a value, false for the don't-cares.
+*/
+vector<bool> TruthTable::getCare(int row)
+{
+    vector<bool> result(outputs);
+    for (int i = 0; i < outputs; i++)
+    {
+        result[i] = isCare(row, i);
+    }
+    return result;
+}
+
+
+//! Tells if an output of a row must have its value.
+/*!
+   The expression outputs have no don't-cares.
+   \param row the row index.
+   \param output the output number.
+   \return False iif the output is a don't-care.
+*/
+bool TruthTable::isCare(int row, int output)
+{
+    if (!programs[output].empty() || careColumns[output].empty())
+    {
+        return true;
+    }
+    return careColumns[output][row];
+}
+
+
+//! Makes an output of an input combination a don't-care or not.
+/*!
+   \param input the input combination.
+   \param output the output number.
+   \param care false if any value verifies the output.
+*/
+void TruthTable::setCare(vector<bool> input, int output, bool care)
+{
+    setCare(getIndex(input), output, care);
+}
+
+
+//! Makes an output of a row a don't-care or not.
+/*!
+   \param row the row index.
+   \param output the output number.
+   \param care false if any value verifies the output.
+*/
+void TruthTable::setCare(int row, int output, bool care)
+{
+    if (!programs[output].empty())
+    {
+        if (care)
+        {
+            return;
+        }
+        storeExpression(output);
+    }
+    if (careColumns[output].empty())
+    {
+        if (care)
+        {
+            return;
+        }
+        careColumns[output].assign(getRows(), true);
+    }
+    careColumns[output][row] = care;
+}
+
+
+//! Returns the don't-cares of the table.
+/*!
+   \return For every row, true for the outputs with a value and false for
+   the don't-cares.
+*/
+vector< vector<bool> > TruthTable::getCareTable()
+{
+    vector< vector<bool> > result(getRows());
+    for (unsigned int i = 0; i < result.size(); i++)
+    {
+        result[i] = getCare(i);
+    }
+    return result;
+}
+
+
+//! Sets the don't-cares of the table.
+/*!
+   \param care for every row, true for the outputs with a value and false
+   for the don't-cares.
+*/
+void TruthTable::setCareTable(vector< vector<bool> > care)
+{
+    for (int i = 0; i < outputs; i++)
+    {
+        careColumns[i].clear();
+    }
+    for (unsigned int i = 0; i < care.size(); i++)
+    {
+        for (unsigned int j = 0; j < care[i].size(); j++)
+        {
+            setCare(i, j, care[i][j]);
+        }
+    }
+}
+
+
+//! Tells if a row has to be verified.
+/*!
+   \param row the row index.
+   \return False iif all the outputs of the row are don't-cares.
+*/
+bool TruthTable::isRelevant(int row)
+{
+    for (int i = 0; i < outputs; i++)
+    {
+        if (isCare(row, i))
+        {
+            return true;
+        }
+    }
+    return outputs == 0;
+}
+
+
+//! Defines an output with a boolean expression of the inputs.
+/*!
+   The inputs are x1 to xN, in the table order, and the expression can use
+   the constants 0 and 1, parenthesis and the operators ! or ~ (not),
+   & or * (and), ^ (xor) and | or + (or), from the highest priority to the
+   lowest. The expression is evaluated for every row when needed, without
+   storing its values. An empty expression keeps the values of the
+   current one.
+   \param output the output number.
+   \param expression the expression of the output.
+   \return False if the expression is not valid, leaving the output as it
+   was.
+*/
+bool TruthTable::setExpression(int output, wxString expression)
+{
+    if (expression.Trim().Trim(false).IsEmpty())
+    {
+        if (!programs[output].empty())
+        {
+            storeExpression(output);
+        }
+        return true;
+    }
+    vector<int> program;
+    unsigned int position = 0;
+    if (!compileOr(expression, position, program) || nextSymbol(expression, position, wxEmptyString) || position < expression.length())
+    {
+        return false;
+    }
+    expressions[output] = expression;
+    programs[output] = program;
+    vector<bool>().swap(columns[output]);
+    vector<bool>().swap(careColumns[output]);
+    return true;
+}
+
+
+//! Returns the expression of an output.
+/*!
+   \param output the output number.
+   \return The expression of the output, empty if it has values.
+*/
+wxString TruthTable::getExpression(int output)
+{
+    return expressions[output];
+}
+
+
+//! Tells if any output is defined by an expression.
+/*!
+   \return True iif some output has an expression.
+*/
+bool TruthTable::hasExpressions()
+{
+    for (int i = 0; i < outputs; i++)
+    {
+        if (!programs[i].empty())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+//! Replaces the expression of an output by its values.
+/*!
+   \param output the output number.
+*/
+void TruthTable::storeExpression(int output)
+{
+    vector<int> program = programs[output];
+    programs[output].clear();
+    expressions[output] = wxEmptyString;
+    columns[output].assign(getRows(), false);
+    for (unsigned int i = 0; i < columns[output].size(); i++)
+    {
+        columns[output][i] = evaluate(program, i);
+    }
+}
+
+
+//! Evaluates a compiled expression for a row.
+/*!
+   \param program the expression in postfix form.
+   \param row the row index, giving the input values.
+   \return The value of the expression.
+*/
+bool TruthTable::evaluate(vector<int> &program, int row)
+{
+    vector<bool> stack;
+    stack.reserve(program.size());
+    for (unsigned int i = 0; i < program.size(); i++)
+    {
+        bool value;
+        switch (program[i])
+        {
+            case EXPRESSION_FALSE:
+                stack.push_back(false);
+                continue;
+            case EXPRESSION_TRUE:
+                stack.push_back(true);
+                continue;
+            case EXPRESSION_NOT:
+                stack.back() = !stack.back();
+                continue;
+            default:
+                break;
+        }
+        if (program[i] >= 0)
+        {
+            stack.push_back(((row >> (inputs - 1 - program[i])) & 1) == 1);
+            continue;
+        }
+        value = stack.back();
+        stack.pop_back();
+        if (program[i] == EXPRESSION_AND)
+        {
+            stack.back() = stack.back() && value;
+        }
+        else if (program[i] == EXPRESSION_XOR)
+        {
+            stack.back() = stack.back() != value;
+        }
+        else
+        {
+            stack.back() = stack.back() || value;
+        }
+    }
+    return stack.back();
+}
+
+
+//! Compiles a disjunction of an expression.
+/*!
+   \param expression the expression.
+   \param position the first character to compile, moved after the
+   disjunction.
+   \param program the postfix program where the disjunction is appended.
+   \return False if there is a syntax error.
+*/
+bool TruthTable::compileOr(wxString &expression, unsigned int &position, vector<int> &program)
+{
+    if (!compileXor(expression, position, program))
+    {
+        return false;
+    }
+    while (nextSymbol(expression, position, _("|+")))
+    {
+        position++;
+        if (!compileXor(expression, position, program))
+        {
+            return false;
+        }
+        program.push_back(EXPRESSION_OR);
+    }
+    return true;
+}
+
+
+//! Compiles an exclusive disjunction of an expression.
+/*!
+   \param expression the expression.
+   \param position the first character to compile, moved after the
+   exclusive disjunction.
+   \param program the postfix program where it is appended.
+   \return False if there is a syntax error.
+*/
+bool TruthTable::compileXor(wxString &expression, unsigned int &position, vector<int> &program)
+{
+    if (!compileAnd(expression, position, program))
+    {
+        return false;
+    }
+    while (nextSymbol(expression, position, _("^")))
+    {
+        position++;
+        if (!compileAnd(expression, position, program))
+        {
+            return false;
+        }
+        program.push_back(EXPRESSION_XOR);
+    }
+    return true;
+}
+
+
+//! Compiles a conjunction of an expression.
+/*!
+   \param expression the expression.
+   \param position the first character to compile, moved after the
+   conjunction.
+   \param program the postfix program where the conjunction is appended.
+   \return False if there is a syntax error.
+*/
+bool TruthTable::compileAnd(wxString &expression, unsigned int &position, vector<int> &program)
+{
+    if (!compileNot(expression, position, program))
+    {
+        return false;
+    }
+    while (nextSymbol(expression, position, _("&*")))
+    {
+        position++;
+        if (!compileNot(expression, position, program))
+        {
+            return false;
+        }
+        program.push_back(EXPRESSION_AND);
+    }
+    return true;
+}
+
+
+//! Compiles a negation, a constant, an input or a parenthesis.
+/*!
+   \param expression the expression.
+   \param position the first character to compile, moved after the term.
+   \param program the postfix program where the term is appended.
+   \return False if there is a syntax error.
+*/
+bool TruthTable::compileNot(wxString &expression, unsigned int &position, vector<int> &program)
+{
+    if (nextSymbol(expression, position, _("!~")))
+    {
+        position++;
+        if (!compileNot(expression, position, program))
+        {
+            return false;
+        }
+        program.push_back(EXPRESSION_NOT);
+        return true;
+    }
+    if (nextSymbol(expression, position, _("(")))
+    {
+        position++;
+        if (!compileOr(expression, position, program) || !nextSymbol(expression, position, _(")")))
+        {
+            return false;
+        }
+        position++;
+        return true;
+    }
+    if (nextSymbol(expression, position, _("01")))
+    {
+        program.push_back(expression[position] == '1' ? EXPRESSION_TRUE : EXPRESSION_FALSE);
+        position++;
+        return true;
+    }
+    if (!nextSymbol(expression, position, _("xX")))
+    {
+        return false;
+    }
+    position++;
+    int input = 0;
+    unsigned int first = position;
+    while (position < expression.length() && expression[position] >= '0' && expression[position] <= '9' && input <= inputs)
+    {
+        input = input * 10 + (expression[position] - '0');
+        position++;
+    }
+    if (position == first || input < 1 || input > inputs)
+    {
+        return false;
+    }
+    program.push_back(input - 1);
+    return true;
+}
+
+
+//! Skips the blanks of an expression and looks at the next character.
+/*!
+   \param expression the expression.
+   \param position the first character to look at, moved after the blanks.
+   \param symbols the characters expected.
+   \return True iif the next character is one of the symbols.
+*/
+bool TruthTable::nextSymbol(wxString &expression, unsigned int &position, wxString symbols)
+{
+    while (position < expression.length() && (expression[position] == ' ' || expression[position] == '\t'))
+    {
+        position++;
+    }
+    return position < expression.length() && symbols.Find(expression[position]) != wxNOT_FOUND;
 }
 
 
@@ -269,7 +832,10 @@ vector< vector<bool> > TruthTable::getTable()
 */
 void TruthTable::copyTable(TruthTable newTable)
 {
-    table = newTable.getTable();
+    columns = newTable.columns;
+    careColumns = newTable.careColumns;
+    expressions = newTable.expressions;
+    programs = newTable.programs;
     name = newTable.getName();
     inputs = newTable.getInputs();
     outputs = newTable.getOutputs();
@@ -298,9 +864,26 @@ void TruthTable::setName(wxString newName)
 
 //! Sets the table values.
 /*!
+   The expressions of the outputs are replaced by the values.
    \param table values to set.
 */
 void TruthTable::setTable(vector< vector<bool> > table)
 {
-    this->table = table;
+    for (int i = 0; i < outputs; i++)
+    {
+        columns[i].clear();
+        programs[i].clear();
+        expressions[i] = wxEmptyString;
+        if ((int)table.size() != getRows())
+        {
+            careColumns[i].clear();
+        }
+    }
+    for (unsigned int i = 0; i < table.size(); i++)
+    {
+        for (unsigned int j = 0; j < table[i].size(); j++)
+        {
+            setOutput(i, j, table[i][j]);
+        }
+    }
 }
@@ -21,6 +21,11 @@
  * \brief Model class for a truth table.
  * 
  * This is a class representing a truth table.
+ * Every output of every row can be a don't-care, which any value verifies.
+ * The rows whose outputs are all don't-cares need no simulation.
+ * The values are kept by output, one bit per row, and an output can also
+ * be defined by a boolean expression of the inputs evaluated row by row,
+ * so large tables are never built row by row.
  * \author Bernat Rfales Mulet <the_bell@users.sourceforge.net>
  * \version $Revision: 1.7 $
  */
@@ -29,11 +34,23 @@
 #define TRUTHTABLE_HPP_
 
 #include <wx/wx.h>
+#include "rowOutputs.hpp"
 #include <vector>
 
 using namespace std;
 
-class TruthTable
+//! Maximum number of inputs of a table, its rows must fit in an int.
+#define TRUTHTABLE_MAX_INPUTS 30
+
+//! Operators of the compiled expressions, the inputs are positive values.
+#define EXPRESSION_FALSE -1
+#define EXPRESSION_TRUE -2
+#define EXPRESSION_NOT -3
+#define EXPRESSION_AND -4
+#define EXPRESSION_XOR -5
+#define EXPRESSION_OR -6
+
+class TruthTable : public RowOutputs
 {
 public:
 	TruthTable(wxString name, int inputs, int outputs);
@@ -43,15 +60,31 @@ public:
     wxString getOutput(wxString input);
     bool getOutput(vector<bool> input, int output);
     bool getOutput(wxString input, int output);
+    vector<bool> getOutput(int row);
+    bool getOutput(int row, int output);
+    void setOutput(vector<bool> input, int output, bool value);
     wxString getName();
     void setOutput(vector<bool> input, vector<bool> output);
     void setOutput(wxString input, wxString output);
+    void setOutput(int row, int output, bool value);
     void setName(wxString newName);
     void setTable(vector< vector<bool> > table);
     int getInputs();
     int getOutputs();
+    int getRows();
     void copyTable(TruthTable newTable);
     vector< vector<bool> > getTable();
+    vector<bool> getCare(vector<bool> input);
+    vector<bool> getCare(int row);
+    bool isCare(int row, int output);
+    void setCare(vector<bool> input, int output, bool care);
+    void setCare(int row, int output, bool care);
+    vector< vector<bool> > getCareTable();
+    void setCareTable(vector< vector<bool> > care);
+    bool isRelevant(int row);
+    bool setExpression(int output, wxString expression);
+    wxString getExpression(int output);
+    bool hasExpressions();
     
 private:
     //! Truth table name.
@@ -60,11 +93,27 @@ private:
     int inputs;
     //! Truth table #outputs.
     int outputs;
-    vector< vector<bool> > table;
+    //! Value of every row for every output, empty while all are false.
+    vector< vector<bool> > columns;
+    //! Rows of every output that must have their value, false for the
+    //! don't-cares, empty while all must.
+    vector< vector<bool> > careColumns;
+    //! Expression of every output, empty for the outputs with values.
+    vector<wxString> expressions;
+    //! Expressions compiled into postfix form.
+    vector< vector<int> > programs;
+    void setCube(wxString input, unsigned int position, vector<bool> &output, vector<bool> &outputCare);
     int getIndex(vector<bool>input);
     int getIndex(wxString input);
     vector <bool> stringToVector(wxString input);
     wxString vectorToString(vector<bool> input);
+    void storeExpression(int output);
+    bool evaluate(vector<int> &program, int row);
+    bool compileOr(wxString &expression, unsigned int &position, vector<int> &program);
+    bool compileXor(wxString &expression, unsigned int &position, vector<int> &program);
+    bool compileAnd(wxString &expression, unsigned int &position, vector<int> &program);
+    bool compileNot(wxString &expression, unsigned int &position, vector<int> &program);
+    bool nextSymbol(wxString &expression, unsigned int &position, wxString symbols);
 };
 
 #endif /*TRUTHTABLE_HPP_*/
@@ -93,7 +93,7 @@ TruthTableCanvas::TruthTableCanvas(wxWindow *parent, wxWindowID id, TruthTable i
     initColours();
     if ((initialTable.getInputs() > 0) && (initialTable.getOutputs() > 0))
     {
-        CreateGrid((int)pow(2, (double)table.getInputs()), table.getInputs() + table.getOutputs());
+        CreateGrid(getRows(), table.getInputs() + table.getOutputs());
         setTable();
     }
     else
@@ -118,9 +118,9 @@ void TruthTableCanvas::setNewTable(TruthTable newTable)
     DeleteRows(0, GetNumberRows());
     if ((newTable.getInputs() > 0) && (newTable.getOutputs() > 0))
     {
-        InsertRows(0, (int)pow(2, (double)table.getInputs()));
+        InsertRows(0, getRows());
         InsertCols(0, table.getInputs() + table.getOutputs());
-        CreateGrid((int)pow(2, (double)table.getInputs()), table.getInputs() + table.getOutputs());
+        CreateGrid(getRows(), table.getInputs() + table.getOutputs());
         setTable();
         Show(true);
     }
@@ -144,10 +144,11 @@ TruthTableCanvas::~TruthTableCanvas()
 */
 void TruthTableCanvas::setTable()
 {
-    for (int i = 0; i < pow(2, (double)table.getInputs()); i++)
+    for (int i = 0; i < getRows(); i++)
     {
         vector<wxString> labels = getInputsString(i);
-        vector<bool> outputs = table.getOutput(getInputsVector(i));
+        vector<bool> outputs = table.getOutput(i);
+        vector<bool> care = table.getCare(i);
         for (int j = 0; j < table.getInputs(); j++)
         {
             SetColLabelValue(j, _("Input ") + wxString::Format(_("%d"), j+1));
@@ -166,7 +167,16 @@ void TruthTableCanvas::setTable()
         for(int j = table.getInputs(); j < table.getInputs() + table.getOutputs(); j++)
         {
             SetColLabelValue(j, _("Output ") + wxString::Format(_("%d"), j - table.getInputs()+1));
-            if (outputs[j - table.getInputs()])
+            if (!table.getExpression(j - table.getInputs()).IsEmpty())
+            {
+                SetColLabelValue(j, _("Output ") + wxString::Format(_("%d"), j - table.getInputs()+1) + _(" = ") + table.getExpression(j - table.getInputs()));
+            }
+            if (!care[j - table.getInputs()])
+            {
+                SetCellValue(i, j, _("Don't care"));
+                SetCellBackgroundColour(i, j, *colourOutputDontCare);
+            }
+            else if (outputs[j - table.getInputs()])
             {
                 SetCellValue(i, j, _("True"));
                 SetCellBackgroundColour(i, j, *colourOutputTrue);
@@ -183,6 +193,20 @@ void TruthTableCanvas::setTable()
 }
 
 
+//! Returns the number of rows shown.
+/*!
+   \return The rows of the table, up to CANVAS_MAX_ROWS.
+*/
+int TruthTableCanvas::getRows()
+{
+    if (table.getRows() > CANVAS_MAX_ROWS)
+    {
+        return CANVAS_MAX_ROWS;
+    }
+    return table.getRows();
+}
+
+
 //! Returns the string outputs for a given table index.
 /*!
    \param i the table index. The table input combination can be
@@ -282,6 +306,11 @@ void TruthTableCanvas::OnCellChanged(wxGridEvent& ev)
         if (editable)
         {
             if (GetCellValue(ev.GetRow(), ev.GetCol()) == _("True"))
+            {
+                SetCellValue(ev.GetRow(), ev.GetCol(), _("Don't care"));
+                SetCellBackgroundColour(ev.GetRow(), ev.GetCol(), *colourOutputDontCare);
+            }
+            else if (GetCellValue(ev.GetRow(), ev.GetCol()) == _("Don't care"))
             {
                 SetCellValue(ev.GetRow(), ev.GetCol(), _("False"));
                 SetCellBackgroundColour(ev.GetRow(), ev.GetCol(), *colourOutputFalse);
@@ -308,6 +337,7 @@ void TruthTableCanvas::initColours()
     colourInputFalse = new wxColour(237, 167, 167);
     colourOutputTrue = new wxColour(66, 174, 13);
     colourOutputFalse = new wxColour(215, 72, 72);
+    colourOutputDontCare = new wxColour(190, 190, 190);
 }
 
 
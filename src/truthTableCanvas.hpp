@@ -37,6 +37,9 @@
 
 using namespace std;
 
+//! Maximum number of rows shown, the larger tables show their first rows.
+#define CANVAS_MAX_ROWS 4096
+
 class TruthTableCanvas : public wxGrid
 {
 public:
@@ -49,6 +52,7 @@ public:
 private:
     DECLARE_EVENT_TABLE()
     void setTable();
+    int getRows();
     vector<wxString> getInputsString(int i);
     vector<bool> getInputsVector(int i);
     void OnCellChanged(wxGridEvent& ev);
@@ -58,6 +62,7 @@ private:
     wxColour *colourInputFalse;
     wxColour *colourOutputTrue;
     wxColour *colourOutputFalse;
+    wxColour *colourOutputDontCare;
     //! The truth table.
     TruthTable table;
     //! If the table is read only.
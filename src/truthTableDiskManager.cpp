@@ -92,6 +92,8 @@ bool TruthTableDiskManager::saveTableList(list<TruthTable*> tables)
 
 //! Saves a table to the file.
 /*!
+   The tables with expressions have an E followed by the expression of
+   every output, ended by a semicolon and empty for the outputs with values.
    \param table table to be saved.
    \return True iif the table was saved correctly.
 */
@@ -99,24 +101,53 @@ bool TruthTableDiskManager::saveTable(TruthTable *table)
 {
     file.AddLine(table->getName());
     file.AddLine(wxString::Format(_("%d %d"), table->getInputs(), table->getOutputs()));
-    saveVector(table->getTable());
+    if (table->hasExpressions())
+    {
+        file.AddLine(_("E"));
+        for (int i = 0; i < table->getOutputs(); i++)
+        {
+            file.AddLine(table->getExpression(i) + _(" ;"));
+        }
+    }
+    saveVector(table);
     file.AddLine(wxEmptyString);
     return true;
 }
 
 
-//! Saves a boolean vector to the file.
+//! Saves the values of a table to the file.
 /*!
-   \param booleans the boolean vector to save.
-   \return True iif the vector was saved correctly.
+   The don't-cares are saved as X. The outputs with an expression have no
+   values saved.
+   \param table the table to save.
+   \return True iif the values were saved correctly.
 */
-bool TruthTableDiskManager::saveVector(vector< vector<bool> > booleans)
+bool TruthTableDiskManager::saveVector(TruthTable *table)
 {
-    for(unsigned int i = 0; i < booleans.size(); i++)
+    vector<bool> stored(table->getOutputs());
+    bool anyStored = false;
+    for (unsigned int j = 0; j < stored.size(); j++)
     {
-        for (unsigned int j = 0; j < booleans[i].size(); j++)
+        stored[j] = table->getExpression(j).IsEmpty();
+        anyStored = anyStored || stored[j];
+    }
+    if (!anyStored)
+    {
+        return true;
+    }
+    for(int i = 0; i < table->getRows(); i++)
+    {
+        for (unsigned int j = 0; j < stored.size(); j++)
         {
-            if (booleans[i][j])
+            if (!stored[j])
+            {
+                continue;
+            }
+            if (!table->isCare(i, j))
+            {
+                file.AddLine(_("X"));
+            }
+            else if (table->getOutput(i, j))
             {
                 file.AddLine(_("1"));
             }
@@ -142,9 +173,32 @@ bool TruthTableDiskManager::openTables(wxString fileName)
     if (!fb.open (fileName.mb_str(), ios::in))
     {
         //cout << "Error opening the file" << endl;
+        delete tableList;
         return false;
     }
     istream *is = new istream(&fb);
+    bool result = readTables(is, tableList);
+    delete is;
+    fb.close();
+    if (result)
+    {
+        returnTables(tableList);
+    }
+    delete tableList;
+    return result;
+}
+
+
+//! Reads the truth tables of a tables file from a stream.
+/*!
+   The tables are not returned to the controller, so this can be used
+   without one.
+   \param is the input stream.
+   \param tableList list of tables where the tables read are appended.
+   \return True iif the stream was read correctly.
+*/
+bool TruthTableDiskManager::readTables(istream *is, list<TruthTable *> *tableList)
+{
     int result;
     int inputs;
     int outputs;
@@ -158,10 +212,7 @@ bool TruthTableDiskManager::openTables(wxString fileName)
         if (!((result == IDENTIFIER) || (result == UPPER) || (result == LOWER)))
         {
             //cout << "Identifier expected, file format error" << endl;
-            delete tableList;
-            delete is;
             delete lexer;
-            fb.close();
             return false;
         }
         else
@@ -170,10 +221,7 @@ bool TruthTableDiskManager::openTables(wxString fileName)
             if (lexer->yylex() != NUMBER)
             {
                 //cout << "Number expected, file format error" << endl;
-                delete tableList;
-                delete is;
                 delete lexer;
-                fb.close();
                 return false;
             }
             else
@@ -182,10 +230,7 @@ bool TruthTableDiskManager::openTables(wxString fileName)
                 if (lexer->yylex() != NUMBER)
                 {
                     //cout << "Number expected, file format error" << endl;
-                    delete tableList;
-                    delete is;
                     delete lexer;
-                    fb.close();
                     return false;
                 }
                 else
@@ -193,10 +238,7 @@ bool TruthTableDiskManager::openTables(wxString fileName)
                     outputs = atoi(lexer->YYText());
                     if (!readTable(name, inputs, outputs, tableList, lexer))
                     {
-                        delete tableList;
-                        delete is;
                         delete lexer;
-                        fb.close();
                         return false;
                     }
                 }
@@ -205,10 +247,7 @@ bool TruthTableDiskManager::openTables(wxString fileName)
         
         result = lexer->yylex();
     }
-    
-    fb.close();
-    returnTables(tableList);
-    delete tableList;
+    delete lexer;
     return true;
 }
 
@@ -224,25 +263,56 @@ bool TruthTableDiskManager::openTables(wxString fileName)
 */
 bool TruthTableDiskManager::readTable(wxString name, int inputs, int outputs, list<TruthTable *> *tableList, FlexLexer *lexer)
 {
+    if (inputs > TRUTHTABLE_MAX_INPUTS)
+    {
+        return false;
+    }
     TruthTable *table = new TruthTable(name ,inputs, outputs);
-    vector< vector<bool> > booleans;
-    booleans.resize((int)(pow(2, (double)inputs)));
-    for (unsigned int i = 0; i < booleans.size(); i++)
+    vector<bool> stored(outputs, true);
+    bool anyStored = true;
+    int token = lexer->yylex();
+    if (token == UPPER && wxString(lexer->YYText(), wxConvUTF8).Trim() == _("E"))
     {
-        booleans[i].resize(outputs);
-        for (unsigned int j = 0; j < booleans[i].size(); j++)
+        if (!readExpressions(table, stored, lexer))
+        {
+            delete table;
+            return false;
+        }
+        anyStored = false;
+        for (unsigned int j = 0; j < stored.size(); j++)
+        {
+            anyStored = anyStored || stored[j];
+        }
+        if (anyStored)
         {
-            switch (lexer->yylex())
+            token = lexer->yylex();
+        }
+    }
+    bool first = true;
+    for (int i = 0; anyStored && i < table->getRows(); i++)
+    {
+        for (int j = 0; j < outputs; j++)
+        {
+            if (!stored[j])
+            {
+                continue;
+            }
+            if (!first)
+            {
+                token = lexer->yylex();
+            }
+            first = false;
+            switch (token)
             {
                 case NUMBER:
                 {
                     if (atoi(lexer->YYText()) == 0)
                     {
-                        booleans[i][j] = false;
+                        table->setOutput(i, j, false);
                     }
                     else if (atoi(lexer->YYText()) == 1)
                     {
-                        booleans[i][j] = true;
+                        table->setOutput(i, j, true);
                     }
                     else
                     {
@@ -252,6 +322,16 @@ bool TruthTableDiskManager::readTable(wxString name, int inputs, int outputs, li
                     }
                     break;
                 }
+                case UPPER: //Don't-care
+                {
+                    if (wxString(lexer->YYText(), wxConvUTF8).Trim() != _("X"))
+                    {
+                        delete table;
+                        return false;
+                    }
+                    table->setCare(i, j, false);
+                    break;
+                }
                 default: //Error
                 {
                     //cout << "1 or 0 expected, file format error" << endl;
@@ -261,12 +341,46 @@ bool TruthTableDiskManager::readTable(wxString name, int inputs, int outputs, li
             }
         }
     }
-    table->setTable(booleans);
     tableList->push_back(table);
     return true;
 }
 
 
+//! Reads the expressions of a truth table from a stream.
+/*!
+   \param table the table whose outputs are defined.
+   \param stored set to false for the outputs with an expression.
+   \param lexer the input stream.
+   \return True iif the expressions were read correctly.
+*/
+bool TruthTableDiskManager::readExpressions(TruthTable *table, vector<bool> &stored, FlexLexer *lexer)
+{
+    for (int j = 0; j < table->getOutputs(); j++)
+    {
+        wxString expression;
+        while (true)
+        {
+            if (lexer->yylex() == 0)
+            {
+                return false;
+            }
+            wxString token = wxString(lexer->YYText(), wxConvUTF8).Trim();
+            if (token == _(";"))
+            {
+                break;
+            }
+            expression += token + _(" ");
+        }
+        stored[j] = expression.IsEmpty();
+        if (!stored[j] && !table->setExpression(j, expression))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
 //! Returns the tables to the controller.
 /*!
    \param tableList the list of tables to return.
@@ -47,6 +47,7 @@ public:
 	virtual ~TruthTableDiskManager();
     bool saveTables(list<TruthTable*> tables, wxString fileName);
     bool openTables(wxString fileName);
+    bool readTables(istream *is, list<TruthTable *> *tableList);
     
 private:
     //! Truth table controller.
@@ -55,8 +56,9 @@ private:
     wxTextFile file;
     bool saveTableList(list<TruthTable*> tables);
     bool saveTable(TruthTable *table);
-    bool saveVector(vector< vector<bool> > booleans);
+    bool saveVector(TruthTable *table);
     bool readTable(wxString name, int inputs, int outputs, list<TruthTable *> *tableList, FlexLexer *lexer);
+    bool readExpressions(TruthTable *table, vector<bool> &stored, FlexLexer *lexer);
     void returnTables(list<TruthTable *> *tableList);
 };
 
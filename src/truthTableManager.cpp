@@ -161,18 +161,45 @@ void TruthTableManager::removeTable()
 
 //! Changes the status of the selected table.
 /*!
+   The output goes from false to true, from true to don't-care and from
+   don't-care to false. An output defined by an expression keeps its
+   values for the rest of input combinations.
    \param input the input combination.
-   \param output the new output values to set at the given input combination.
+   \param output the output to change at the given input combination.
 */
 void TruthTableManager::tableChanged(vector<bool> input, int output)
 {
-    vector<bool> newOutput = tableList[currentTable]->getOutput(input);
-    newOutput[output] = !newOutput[output];
-    tableList[currentTable]->setOutput(input, newOutput);
+    TruthTable *table = tableList[currentTable];
+    bool expression = !table->getExpression(output).IsEmpty();
+    bool value = table->getOutput(input, output);
+    bool care = table->getCare(input)[output];
+    table->setCare(input, output, !(care && value));
+    table->setOutput(input, output, care && !value);
     modified = true;
     //Optimization: since we already update the table on the
-    //event we don't need to update it.
-    //updateTable();
+    //event we don't need to update it, unless the expression is gone.
+    if (expression)
+    {
+        updateTable();
+    }
+    controller->elementChanged();
+}
+
+
+//! Defines an output of the selected table with a boolean expression.
+/*!
+   \param output the output number.
+   \param expression the expression, empty to keep the current values.
+*/
+void TruthTableManager::expressionChanged(int output, wxString expression)
+{
+    if (!tableList[currentTable]->setExpression(output, expression))
+    {
+        view->errorMsg(_("The expression is not valid"));
+        return;
+    }
+    modified = true;
+    updateTable();
     controller->elementChanged();
 }
 
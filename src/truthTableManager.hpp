@@ -55,6 +55,7 @@ public:
     void newTable(TruthTable *table);
     void tableSelected(wxString TableId);
     void tableChanged(vector<bool> input, int output);
+    void expressionChanged(int output, wxString expression);
     void removeTable();
     bool saveFile();
     bool saveFileAs();
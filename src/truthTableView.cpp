@@ -36,6 +36,7 @@ enum
     ID_BUTTON_SAVE,
     ID_BUTTON_SAVEAS,
     ID_BUTTON_REMOVE,
+    ID_BUTTON_EXPRESSION,
     ID_LIST_TABLES,
     ID_CANVAS
 };
@@ -49,6 +50,7 @@ BEGIN_EVENT_TABLE(TruthTableView, wxPanel)
     EVT_BUTTON  (ID_BUTTON_OPEN, TruthTableView::OnOpen)
     EVT_BUTTON  (ID_BUTTON_SAVE, TruthTableView::OnSave)
     EVT_BUTTON  (ID_BUTTON_SAVEAS, TruthTableView::OnSaveAs)
+    EVT_BUTTON  (ID_BUTTON_EXPRESSION, TruthTableView::OnExpression)
 END_EVENT_TABLE()
 
 
@@ -98,9 +100,12 @@ void TruthTableView::initControls()
     buttonSaveAs->SetToolTip(_("Save selected truth table to a new file"));
     buttonRemove = new wxBitmapButton(this, ID_BUTTON_REMOVE, removeBitmap);
     buttonRemove->SetToolTip(_("Delete selected truth table"));
+    buttonExpression = new wxButton(this, ID_BUTTON_EXPRESSION, _("Expression"));
+    buttonExpression->SetToolTip(_("Define an output of the selected truth table with a boolean expression"));
     buttonSave->Enable(false);
     buttonSaveAs->Enable(false);
     buttonRemove->Enable(false);
+    buttonExpression->Enable(false);
     
     //Other controls
     listTables = new wxListBox(this, ID_LIST_TABLES);
@@ -137,6 +142,7 @@ void TruthTableView::initSizers()
                 buttonSizer->Add(buttonRemove, 0, wxEXPAND | wxALL);
                 buttonSizer->Add(buttonSave, 0, wxEXPAND | wxALL);
                 buttonSizer->Add(buttonSaveAs, 0, wxEXPAND | wxALL);
+                buttonSizer->Add(buttonExpression, 0, wxEXPAND | wxALL);
                 
             listSizer->Add(buttonSizer, 0, wxEXPAND | wxALL, 2);
             
@@ -202,7 +208,7 @@ void TruthTableView::OnNew(wxCommandEvent &event)
     wxEmptyString,
         _("Insert the number of inputs"),
         _("New Truth Table"),
-        1, 1, 100);
+        1, 1, TRUTHTABLE_MAX_INPUTS);
     if (inputDialog.ShowModal() == wxID_OK)
     {
         inputs = (int)(inputDialog.GetValue());
@@ -229,6 +235,39 @@ void TruthTableView::OnNew(wxCommandEvent &event)
 }
 
 
+//! Expression button click event method.
+/*!
+   \param event the event.
+*/
+void TruthTableView::OnExpression(wxCommandEvent &event)
+{
+    TruthTable table = canvas->getTable();
+    int output = 0;
+    if (table.getOutputs() > 1)
+    {
+        wxNumberEntryDialog outputDialog(this,
+        wxEmptyString,
+            _("Insert the number of the output"),
+            _("Output Expression"),
+            1, 1, table.getOutputs());
+        if (outputDialog.ShowModal() != wxID_OK)
+        {
+            return;
+        }
+        output = (int)(outputDialog.GetValue()) - 1;
+    }
+    
+    wxTextEntryDialog expressionDialog(this,
+        _("Insert the expression of the output, using x1, x2... for the inputs,\n0, 1, parenthesis and the operators ! (not), & (and), ^ (xor) and | (or).\nLeave it empty to keep the values of the expression."),
+        _("Output Expression"),
+        table.getExpression(output));
+    if (expressionDialog.ShowModal() == wxID_OK)
+    {
+        controller->expressionChanged(output, expressionDialog.GetValue());
+    }
+}
+
+
 //! Listbox selection event method.
 /*!
    \param event the event.
@@ -244,6 +283,7 @@ void TruthTableView::OnSelection(wxCommandEvent &event)
         buttonRemove->Enable(true);
         buttonSave->Enable(true);
         buttonSaveAs->Enable(true);
+        buttonExpression->Enable(true);
     }
 }
 
@@ -279,6 +319,7 @@ void TruthTableView::updateList(wxArrayString strings)
     buttonRemove->Enable(strings.size() > 0);
     buttonSave->Enable(strings.size() > 0);
     buttonSaveAs->Enable(strings.size() > 0);
+    buttonExpression->Enable(strings.size() > 0);
     labelInfo->Show(strings.size() > 0);
 }
 
@@ -296,6 +337,7 @@ void TruthTableView::selectTable(wxString table)
         buttonRemove->Enable(true);
         buttonSave->Enable(true);
         buttonSaveAs->Enable(true);
+        buttonExpression->Enable(true);
         labelInfo->Show(true);
     }
 }
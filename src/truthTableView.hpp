@@ -41,6 +41,7 @@ public:
     void updateTable(TruthTable table);
     void OnClick(TruthTableCanvasEvent &event);
     void OnNew(wxCommandEvent &event);
+    void OnExpression(wxCommandEvent &event);
     void OnSelection(wxCommandEvent &event);
     void OnRemove(wxCommandEvent &event);
     void updateList(wxArrayString strings);
@@ -67,6 +68,7 @@ private:
     wxBitmapButton *buttonSave;
     wxBitmapButton *buttonSaveAs;
     wxBitmapButton *buttonRemove;
+    wxButton *buttonExpression;
     
     //Other controls
     wxListBox *listTables;